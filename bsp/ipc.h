@@ -40,6 +40,7 @@ typedef enum {
     DB_IPC_RADIO_DIS_REQ,               ///< Request for radio disable
     DB_IPC_RADIO_TX_REQ,                ///< Request for radio tx
     DB_IPC_RADIO_RSSI_REQ,              ///< Request for RSSI
+    DB_IPC_RADIO_STATS_REQ,             ///< Request for reading the radio reception statistics
     DB_IPC_RNG_INIT_REQ,                ///< Request for rng init
     DB_IPC_RNG_READ_REQ,                ///< Request for rng read
     DB_IPC_TDMA_CLIENT_INIT_REQ,        ///< Request for TDMA client initialization
@@ -49,12 +50,14 @@ typedef enum {
     DB_IPC_TDMA_CLIENT_FLUSH_REQ,       ///< Request for flushing the TDMA client message buffer
     DB_IPC_TDMA_CLIENT_EMPTY_REQ,       ///< Request for erasing the TDMA client message buffer
     DB_IPC_TDMA_CLIENT_STATUS_REQ,      ///< Request for reading the TDMA client driver status
+    DB_IPC_TDMA_CLIENT_QUEUE_REQ,       ///< Request for reading the TDMA client message buffer statistics
     DB_IPC_TDMA_SERVER_INIT_REQ,        ///< Request for TDMA server initialization
     DB_IPC_TDMA_SERVER_GET_TABLE_REQ,   ///< Request for reading the TDMA server timing table general info
     DB_IPC_TDMA_SERVER_GET_CLIENT_REQ,  ///< Request for reading the info about a specific client
     DB_IPC_TDMA_SERVER_TX_REQ,          ///< Request for a TDMA server TX
     DB_IPC_TDMA_SERVER_FLUSH_REQ,       ///< Request for flushing the TDMA server message buffer
     DB_IPC_TDMA_SERVER_EMPTY_REQ,       ///< Request for erasing the TDMA server message buffer
+    DB_IPC_TDMA_SERVER_QUEUE_REQ,       ///< Request for reading the TDMA server message buffer statistics
 } ipc_req_t;
 
 typedef enum {
@@ -68,13 +71,22 @@ typedef struct __attribute__((packed)) {
 } ipc_radio_pdu_t;
 
 typedef struct __attribute__((packed)) {
-    db_radio_mode_t mode;       ///< db_radio_init function parameters
-    uint8_t         frequency;  ///< db_set_frequency function parameters
-    uint8_t         channel;    ///< db_set_channel function parameters
-    uint32_t        addr;       ///< db_set_network_address function parameters
-    ipc_radio_pdu_t tx_pdu;     ///< PDU to send
-    ipc_radio_pdu_t rx_pdu;     ///< Received pdu
-    int8_t          rssi;       ///< RSSI value
+    ipc_radio_pdu_t        pdu;       ///< Received pdu
+    db_radio_rx_metadata_t metadata;  ///< Metadata of the received pdu
+} ipc_radio_rx_t;
+
+typedef struct __attribute__((packed)) {
+    db_radio_mode_t        mode;                    ///< db_radio_init function parameters
+    uint8_t                frequency;               ///< db_set_frequency function parameters
+    uint8_t                channel;                 ///< db_set_channel function parameters
+    uint32_t               addr;                    ///< db_set_network_address function parameters
+    ipc_radio_pdu_t        tx_pdu;                  ///< PDU to send
+    ipc_radio_rx_t         rx[RADIO_RX_PDU_COUNT];  ///< Ring of the received pdus, written by the network core and read by the application core
+    uint8_t                rx_write;                ///< Index of the next pdu of the ring written by the network core
+    uint8_t                rx_read;                 ///< Index of the next pdu of the ring read by the application core
+    int8_t                 rssi;                    ///< RSSI value
+    db_radio_mode_t        stats_mode;              ///< db_radio_get_stats function parameter
+    db_radio_stats_t       stats;                   ///< db_radio_get_stats function parameter
 } ipc_radio_data_t;
 
 typedef struct {
@@ -82,25 +94,27 @@ typedef struct {
 } ipc_rng_data_t;
 
 typedef struct __attribute__((packed)) {
-    db_radio_mode_t              mode;                ///< db_radio_init function parameters
-    uint8_t                      frequency;           ///< db_set_frequency function parameters
-    tdma_client_table_t          table_set;           ///< db_tdma_client_set_table function parameter
-    tdma_client_table_t          table_get;           ///< db_tdma_client_get_table function parameter
-    ipc_radio_pdu_t              tx_pdu;              ///< PDU to send
-    ipc_radio_pdu_t              rx_pdu;              ///< Received pdu
-    db_tdma_registration_state_t registration_state;  ///< db_tdma_client_get_status return value
+    db_radio_mode_t              mode;                                     ///< db_radio_init function parameters
+    uint8_t                      frequency;                                ///< db_set_frequency function parameters
+    tdma_client_table_t          table_set;                                ///< db_tdma_client_set_table function parameter
+    tdma_client_table_t          table_get;                                ///< db_tdma_client_get_table function parameter
+    ipc_radio_pdu_t              tx_pdu;                                   ///< PDU to send
+    ipc_radio_pdu_t              rx_pdu;                                   ///< Received pdu
+    db_tdma_registration_state_t registration_state;                       ///< db_tdma_client_get_status return value
+    db_packet_queue_stats_t      queue_stats[DB_PROTOCOL_PRIORITY_COUNT];  ///< db_tdma_client_get_queue_stats function parameter
 } ipc_tdma_client_data_t;
 
 typedef struct __attribute__((packed)) {
-    db_radio_mode_t    mode;               ///< db_radio_init function parameters
-    uint8_t            frequency;          ///< db_set_frequency function parameters
-    uint32_t           frame_duration_us;  ///< db_tdma_server_get_table_info function parameter
-    uint16_t           num_clients;        ///< db_tdma_server_get_table_info function parameter
-    uint16_t           table_index;        ///< db_tdma_server_get_table_info function parameter
-    uint8_t            client_id;          ///< db_tdma_server_get_client_info function parameter
-    tdma_table_entry_t client_entry;       ///< db_tdma_server_get_client_info function parameter
-    ipc_radio_pdu_t    tx_pdu;             ///< PDU to send
-    ipc_radio_pdu_t    rx_pdu;             ///< Received pdu
+    db_radio_mode_t         mode;                                     ///< db_radio_init function parameters
+    uint8_t                 frequency;                                ///< db_set_frequency function parameters
+    uint32_t                frame_duration_us;                        ///< db_tdma_server_get_table_info function parameter
+    uint16_t                num_clients;                              ///< db_tdma_server_get_table_info function parameter
+    uint16_t                table_index;                              ///< db_tdma_server_get_table_info function parameter
+    uint16_t                client_id;                                ///< db_tdma_server_get_client_info function parameter
+    tdma_table_entry_t      client_entry;                             ///< db_tdma_server_get_client_info function parameter
+    ipc_radio_pdu_t         tx_pdu;                                   ///< PDU to send
+    ipc_radio_pdu_t         rx_pdu;                                   ///< Received pdu
+    db_packet_queue_stats_t queue_stats[DB_PROTOCOL_PRIORITY_COUNT];  ///< db_tdma_server_get_queue_stats function parameter
 } ipc_tdma_server_data_t;
 
 typedef struct __attribute__((packed)) {
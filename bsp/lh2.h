@@ -23,13 +23,52 @@
 
 //=========================== defines ==========================================
 
-#define LH2_BASESTATION_COUNT 4                          ///< Number of supported concurrent basestations
-#define LH2_POLYNOMIAL_COUNT  LH2_BASESTATION_COUNT * 2  ///< Number of supported LFSR polynomials, two per basestation
-#define LH2_SWEEP_COUNT       2                          ///< Number of laser sweeps per basestations rotation
+#ifndef LH2_BASESTATION_COUNT
+#define LH2_BASESTATION_COUNT 4  ///< Number of supported concurrent basestations, the basestations must use the channels 1 to LH2_BASESTATION_COUNT (max 16)
+#endif
+#define LH2_POLYNOMIAL_COUNT (LH2_BASESTATION_COUNT * 2)  ///< Number of supported LFSR polynomials, two per basestation
+#define LH2_SWEEP_COUNT      2                            ///< Number of laser sweeps per basestations rotation
+#define LH2_CAPTURE_SIZE     64                           ///< Number of bytes in a raw SPI capture of the LH2 signal
+
+#if LH2_BASESTATION_COUNT < 1 || LH2_BASESTATION_COUNT > 16
+#error "LH2_BASESTATION_COUNT must be between 1 and 16"
+#endif
 
 // Un-comment the following line if you want to enable the Anti-Mocap fiter
 // #define LH2_MOCAP_FILTER 1   ///< Defined when the LH2 needs to coexits with a Qualysis Mocap system. It enables harsher anti-outlier filters
 
+// Un-comment the following line if you want to measure the time spent in each stage of the LH2 pipeline, see db_lh2_get_stats()
+// #define LH2_PROFILING 1   ///< Defined to profile the LH2 pipeline with the DWT cycle counter (the monotonic clock, in nanoseconds, on a host build)
+
+#define LH2_STATS_HISTOGRAM_BINS     16  ///< Number of buckets of the duration histogram of a pipeline stage
+#define LH2_STATS_HISTOGRAM_MIN_LOG2 5   ///< Bucket i counts durations in [2^(i+5), 2^(i+6)), the first and last buckets also count shorter and longer durations
+
+#ifndef LH2_LFSR_SOLVER_BABY_STEPS
+/// Number of baby steps stored per polynomial by the baby-step/giant-step LFSR solver (power of two).
+/// Each polynomial costs 8 bytes of RAM per baby step, and a lookup takes at most 2^17 / LH2_LFSR_SOLVER_BABY_STEPS giant steps.
+/// Set to 0 to use the checkpoint search instead, with the flash tables of bsp/nrf/lh2_checkpoints.h, or these generated in build/include by make lh2-checkpoints.
+/// Fewer baby steps would save RAM but slow down every sweep, so above 4 basestations the default is the checkpoint search.
+#if LH2_BASESTATION_COUNT <= 4
+#define LH2_LFSR_SOLVER_BABY_STEPS 256
+#else
+#define LH2_LFSR_SOLVER_BABY_STEPS 0
+#endif
+#endif
+
+#ifndef LH2_LFSR_SOLVER_STEP_BUDGET
+/// Max cost of a lookup of the LFSR solver, checked at build time, in steps of the checkpoint search (an LFSR step in each direction).
+/// A giant step costs about two of them, the default allows 256 baby steps or checkpoints every 2048 LFSR positions.
+#define LH2_LFSR_SOLVER_STEP_BUDGET 1024
+#endif
+
+#ifndef LH2_RAM_BUDGET
+#define LH2_RAM_BUDGET 32768  ///< Max number of bytes of RAM used by the LH2 decoding tables, checked at build time
+#endif
+
+#ifndef LH2_CAPTURE_MAX_AGE_US
+#define LH2_CAPTURE_MAX_AGE_US 100000  ///< SPI captures that waited longer than this (in microseconds) are skipped by db_lh2_drain()
+#endif
+
 /// LH2 data ready buffer state
 typedef enum {
     DB_LH2_NO_NEW_DATA,               ///< The data occupying this spot of the buffer has already been sent.
@@ -56,9 +95,55 @@ typedef struct {
     db_lh2_location_t         locations[LH2_SWEEP_COUNT][LH2_BASESTATION_COUNT];   ///< buffer holding the computed locations
     uint32_t                  timestamps[LH2_SWEEP_COUNT][LH2_BASESTATION_COUNT];  ///< timestamp of when the raw data was received
     db_lh2_data_ready_state_t data_ready[LH2_SWEEP_COUNT][LH2_BASESTATION_COUNT];  ///< Is the data in the buffer ready to send over radio, or has it already been sent ?
-    uint8_t                  *spi_ring_buffer_count_ptr;                           ///< pointer to the SPI rung buffer packet count, so the user application can read how many spi captures are waiting to be processed.
 } db_lh2_t;
 
+/// LH2 SPI capture ring buffer statistics
+typedef struct {
+    uint8_t  pending;    ///< number of SPI captures waiting to be processed
+    uint32_t overflows;  ///< number of times the ring buffer got full
+    uint32_t dropped;    ///< number of SPI captures lost because the ring buffer was full
+} db_lh2_capture_stats_t;
+
+/// LH2 raw SPI capture, as streamed out and replayed by the capture tools
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp;                  ///< time of the capture, in microseconds
+    uint8_t  samples[LH2_CAPTURE_SIZE];  ///< samples of the TS4231 data line, 1 bit per sample at 32MHz, MSB first
+} db_lh2_capture_t;
+
+/// Report of a db_lh2_drain() call
+typedef struct {
+    uint8_t processed;  ///< number of SPI captures processed
+    uint8_t stale;      ///< number of SPI captures skipped because they were older than LH2_CAPTURE_MAX_AGE_US
+    uint8_t max_depth;  ///< largest number of SPI captures waiting in the ring buffer during the call
+    uint8_t remaining;  ///< number of SPI captures still waiting when the call returned
+} db_lh2_drain_stats_t;
+
+/// Stages of the LH2 pipeline measured when LH2_PROFILING is defined
+typedef enum {
+    DB_LH2_STAGE_SPIM_ISR = 0,          ///< SPIM end of capture interrupt handler, ring insert included
+    DB_LH2_STAGE_RING_INSERT,           ///< Insertion of a capture in the ring buffer
+    DB_LH2_STAGE_DEMODULATE,            ///< Demodulation of a capture
+    DB_LH2_STAGE_DETERMINE_POLYNOMIAL,  ///< Search of the polynomial of the demodulated bits
+    DB_LH2_STAGE_REVERSE_COUNT,         ///< Search of the LFSR position of the demodulated bits, checkpoint update included
+    DB_LH2_STAGE_UPDATE_CHECKPOINTS,    ///< Update of the dynamic LFSR checkpoints (checkpoint solver only)
+    DB_LH2_STAGE_SELECT_SWEEP,          ///< Selection of the sweep slot of a decoded capture
+    DB_LH2_STAGE_COUNT,                 ///< Number of measured stages
+} db_lh2_stage_t;
+
+/// Duration statistics of one LH2 pipeline stage, in CPU cycles
+typedef struct __attribute__((packed)) {
+    uint32_t count;                                ///< number of measures
+    uint32_t min;                                  ///< shortest duration
+    uint32_t avg;                                  ///< average duration
+    uint32_t max;                                  ///< longest duration
+    uint16_t histogram[LH2_STATS_HISTOGRAM_BINS];  ///< number of measures per log2 bucket of duration, saturates at UINT16_MAX
+} db_lh2_stage_stats_t;
+
+/// Duration statistics of the LH2 pipeline
+typedef struct {
+    db_lh2_stage_stats_t stages[DB_LH2_STAGE_COUNT];  ///< statistics of each stage, indexed by db_lh2_stage_t
+} db_lh2_stats_t;
+
 //=========================== public ===========================================
 
 /**
@@ -84,6 +169,55 @@ void db_lh2_process_raw_data(db_lh2_t *lh2);
  */
 void db_lh2_process_location(db_lh2_t *lh2);
 
+/**
+ * @brief Process the pending SPI captures until the ring buffer is empty or the time budget is spent
+ *
+ * @param[in]   lh2                 pointer to the lh2 instance
+ * @param[in]   compute_location    true to compute the locations (see db_lh2_process_location), false to only process the raw data (see db_lh2_process_raw_data)
+ * @param[in]   budget_us           time budget in microseconds, checked before each capture, 0 for no limit
+ * @param[out]  stats               pointer to the report of the call, can be NULL
+ */
+void db_lh2_drain(db_lh2_t *lh2, bool compute_location, uint32_t budget_us, db_lh2_drain_stats_t *stats);
+
+/**
+ * @brief Take the oldest raw SPI capture out of the ring buffer, without processing it
+ *
+ * @param[out]  capture pointer to where the capture is copied
+ *
+ * @return true if a capture was available, false if the ring buffer is empty
+ */
+bool db_lh2_get_capture(db_lh2_capture_t *capture);
+
+/**
+ * @brief Queue a raw SPI capture as if it was just received, e.g to replay a recording. Only use while the acquisition is stopped.
+ *
+ * @param[in]   capture pointer to the capture to queue
+ *
+ * @return true if the capture was queued, false if the ring buffer is full
+ */
+bool db_lh2_inject_capture(const db_lh2_capture_t *capture);
+
+/**
+ * @brief Read the statistics of the SPI capture ring buffer
+ *
+ * @param[out]  stats pointer to the statistics to fill
+ */
+void db_lh2_get_capture_stats(db_lh2_capture_stats_t *stats);
+
+/**
+ * @brief Read the duration statistics of the LH2 pipeline stages
+ *
+ * @param[out]  stats pointer to the statistics to fill
+ *
+ * @return true if the statistics were filled, false if LH2_PROFILING is not defined
+ */
+bool db_lh2_get_stats(db_lh2_stats_t *stats);
+
+/**
+ * @brief Clear the duration statistics of the LH2 pipeline stages
+ */
+void db_lh2_reset_stats(void);
+
 /**
  * @brief Start the LH2 frame acquisition
  *
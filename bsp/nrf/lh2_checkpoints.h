@@ -0,0 +1,769 @@
+/*
+ * PLEASE DON'T EDIT
+ *
+ * This file was automatically generated by dist/scripts/lh2_checkpoints/lh2_checkpoints.py
+ * with: --spacing 2048 --polynomials 32
+ */
+
+#ifndef __LH2_CHECKPOINTS_H
+#define __LH2_CHECKPOINTS_H
+
+#include <stdint.h>
+
+#include "lh2.h"
+
+#define LH2_CHECKPOINT_SPACING     2048        ///< Number of LFSR positions between 2 checkpoints
+#define LH2_CHECKPOINT_COUNT       64          ///< Number of checkpoints per polynomial
+#define LH2_CHECKPOINT_POLYNOMIALS 32          ///< Number of polynomials with checkpoints
+#define LH2_CHECKPOINT_INDEX_POS   17          ///< Position of the checkpoint index in a table entry, the LFSR state uses the 17 lower bits
+#define LH2_CHECKPOINT_BUCKET_BITS 4           ///< log2 of the number of displacement buckets per polynomial
+#define LH2_CHECKPOINT_BUCKET_MULT 0x9E3779B1  ///< Multiplier hashing an LFSR state into its displacement bucket
+#define LH2_CHECKPOINT_SLOT_BITS   7           ///< log2 of the number of table slots per polynomial
+#define LH2_CHECKPOINT_SLOT_MULT   0x85EBCA6B  ///< Multiplier hashing a displaced LFSR state into its table slot
+#define LH2_CHECKPOINT_FLASH_BYTES 544         ///< Flash used by the tables of each polynomial
+
+#if LH2_POLYNOMIAL_COUNT <= LH2_CHECKPOINT_POLYNOMIALS
+// Only the polynomials of the LH2_BASESTATION_COUNT basestations use flash
+
+/// Displacement of each bucket, chosen so that no two checkpoints of a polynomial share a slot
+static const uint16_t _lh2_checkpoint_displacements[LH2_POLYNOMIAL_COUNT][1 << LH2_CHECKPOINT_BUCKET_BITS] = {
+    {
+        0, 5, 0, 0, 0, 2, 1, 1, 8, 1, 0, 27, 0, 17, 16, 1,
+    },
+    {
+        4, 4, 5, 0, 3, 1, 2, 4, 0, 1, 4, 1, 4, 0, 3, 8,
+    },
+#if LH2_POLYNOMIAL_COUNT > 2
+    {
+        0, 0, 0, 3, 0, 11, 4, 0, 6, 5, 1, 6, 10, 2, 5, 1,
+    },
+    {
+        0, 0, 1, 2, 5, 0, 0, 10, 12, 0, 0, 9, 0, 1, 11, 14,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 4
+    {
+        1, 1, 4, 2, 7, 2, 2, 0, 0, 0, 3, 7, 1, 0, 5, 1,
+    },
+    {
+        0, 1, 2, 9, 0, 1, 3, 5, 0, 8, 13, 0, 8, 0, 4, 1,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 6
+    {
+        22, 4, 0, 0, 0, 6, 0, 2, 9, 0, 1, 5, 2, 0, 3, 0,
+    },
+    {
+        0, 5, 0, 3, 0, 0, 10, 0, 0, 8, 8, 0, 0, 3, 0, 0,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 8
+    {
+        0, 1, 3, 1, 2, 1, 7, 1, 3, 1, 2, 4, 0, 0, 0, 2,
+    },
+    {
+        0, 0, 1, 0, 1, 1, 0, 3, 0, 3, 1, 26, 0, 8, 0, 7,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 10
+    {
+        4, 0, 6, 1, 2, 0, 13, 4, 1, 0, 6, 1, 2, 0, 1, 0,
+    },
+    {
+        0, 3, 1, 0, 3, 0, 0, 3, 3, 0, 7, 0, 3, 1, 0, 5,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 12
+    {
+        0, 0, 3, 0, 6, 1, 0, 0, 4, 14, 2, 6, 12, 2, 6, 1,
+    },
+    {
+        0, 0, 10, 0, 1, 3, 8, 7, 1, 6, 1, 4, 9, 2, 0, 3,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 14
+    {
+        0, 2, 0, 3, 8, 0, 3, 1, 3, 10, 0, 0, 1, 1, 0, 0,
+    },
+    {
+        1, 7, 2, 0, 8, 0, 1, 7, 5, 0, 0, 0, 2, 4, 0, 1,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 16
+    {
+        0, 2, 0, 1, 2, 0, 0, 2, 2, 0, 0, 3, 1, 10, 1, 3,
+    },
+    {
+        0, 5, 4, 0, 0, 0, 0, 0, 0, 9, 0, 2, 1, 3, 1, 0,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 18
+    {
+        0, 5, 11, 2, 8, 5, 5, 0, 3, 7, 3, 0, 0, 2, 1, 0,
+    },
+    {
+        0, 0, 5, 1, 0, 0, 0, 0, 3, 9, 6, 0, 14, 1, 3, 1,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 20
+    {
+        7, 3, 3, 1, 0, 0, 0, 9, 0, 0, 10, 0, 6, 7, 0, 21,
+    },
+    {
+        0, 0, 2, 8, 3, 0, 3, 6, 2, 0, 2, 6, 1, 0, 9, 5,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 22
+    {
+        5, 0, 4, 3, 0, 0, 4, 6, 0, 5, 0, 0, 11, 11, 0, 0,
+    },
+    {
+        1, 0, 3, 0, 0, 7, 0, 0, 3, 1, 6, 0, 2, 1, 6, 17,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 24
+    {
+        0, 6, 0, 7, 4, 2, 0, 10, 0, 4, 6, 4, 6, 2, 1, 0,
+    },
+    {
+        1, 2, 7, 1, 1, 1, 0, 0, 2, 1, 1, 15, 16, 13, 2, 14,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 26
+    {
+        2, 0, 0, 1, 0, 0, 23, 0, 9, 3, 0, 3, 1, 1, 1, 10,
+    },
+    {
+        2, 0, 0, 2, 1, 4, 0, 1, 0, 3, 1, 11, 1, 7, 0, 7,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 28
+    {
+        0, 2, 0, 1, 2, 2, 1, 5, 0, 4, 3, 15, 0, 8, 11, 0,
+    },
+    {
+        1, 1, 5, 0, 5, 3, 0, 3, 4, 5, 1, 4, 0, 0, 1, 1,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 30
+    {
+        0, 9, 0, 9, 6, 0, 9, 6, 3, 1, 0, 8, 0, 1, 5, 0,
+    },
+    {
+        0, 2, 0, 1, 1, 1, 0, 2, 0, 6, 3, 8, 0, 3, 3, 0,
+    },
+#endif
+};
+
+/// Checkpoint table, entries are (index << LH2_CHECKPOINT_INDEX_POS) | state, 0 for empty slots
+static const uint32_t _lh2_checkpoint_table[LH2_POLYNOMIAL_COUNT][1 << LH2_CHECKPOINT_SLOT_BITS] = {
+    {
+        0x00000001, 0x006D1B24, 0x00630A6C, 0x003BA07C, 0x00000000, 0x00000000, 0x0044B72A, 0x00000000,
+        0x001AFEF6, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x002D7E63, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00246EE6, 0x00000000, 0x00000000, 0x0008AB3B,
+        0x00000000, 0x00000000, 0x00777D9F, 0x000D63CD, 0x006F9724, 0x001FC46E, 0x00000000, 0x002346A9,
+        0x0064DC43, 0x00000000, 0x00513621, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00161387,
+        0x005DFC12, 0x00000000, 0x00000000, 0x00308CBE, 0x00000000, 0x005224CB, 0x00000000, 0x003EA94B,
+        0x00745A80, 0x00000000, 0x00040563, 0x004D9E5B, 0x0059173E, 0x0032FB08, 0x00000000, 0x0006E060,
+        0x00665997, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x002E5167, 0x00000000,
+        0x00000000, 0x00730D7A, 0x00571C13, 0x00000000, 0x0021963F, 0x00000000, 0x00000000, 0x00263A06,
+        0x00000000, 0x003430A6, 0x00000000, 0x003C6926, 0x005AF187, 0x00781AD7, 0x00000000, 0x00378DC1,
+        0x0069276E, 0x000E6E06, 0x00000000, 0x00144A30, 0x00000000, 0x00000000, 0x00000000, 0x0071733B,
+        0x00000000, 0x00000000, 0x000A8577, 0x00000000, 0x00020035, 0x00000000, 0x00000000, 0x00000000,
+        0x00489A3C, 0x002B6D46, 0x00469238, 0x00000000, 0x007C574C, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x002846BD, 0x004EF545, 0x00000000, 0x00102AB5, 0x0040E337, 0x006B6F24, 0x00000000,
+        0x00542BA2, 0x00000000, 0x007E39BE, 0x00000000, 0x001CC963, 0x00000000, 0x00000000, 0x00193205,
+        0x001328FB, 0x004B22E5, 0x005FB705, 0x006195EA, 0x00000000, 0x0039C563, 0x007AB3B3, 0x0042FC13,
+    },
+    {
+        0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00336D54, 0x00000000, 0x00277086, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x0055CE9E, 0x00000000, 0x0049CDAD, 0x0017DBDD, 0x00000000,
+        0x0042C761, 0x00000000, 0x001F568A, 0x0005FC75, 0x0078F339, 0x00000000, 0x00000000, 0x003DD8C1,
+        0x00000000, 0x00000000, 0x00000000, 0x007599EF, 0x00000000, 0x00368577, 0x00000000, 0x002D53C7,
+        0x00000000, 0x00000000, 0x004B42F6, 0x00000000, 0x00000000, 0x0010DE79, 0x00000000, 0x007C6FB0,
+        0x005E0778, 0x00000000, 0x0006E3B0, 0x002E8C79, 0x00000000, 0x00000000, 0x00000000, 0x0030453D,
+        0x000A30F5, 0x001BBC3A, 0x003B5E6D, 0x00000000, 0x00508E87, 0x00000000, 0x006F734B, 0x00000000,
+        0x0062BD63, 0x00000000, 0x005B287A, 0x006C9027, 0x00406043, 0x00000000, 0x003E146E, 0x00000000,
+        0x000207C1, 0x00000000, 0x0013B641, 0x00000000, 0x00000000, 0x00000000, 0x0060CA6C, 0x00000000,
+        0x00190ADF, 0x0052D886, 0x0044851A, 0x00290C69, 0x00000000, 0x00000000, 0x0058ED0B, 0x00703476,
+        0x00691FCC, 0x00243094, 0x00000000, 0x00000000, 0x00000000, 0x00479FD1, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x0065B903, 0x007E62A3, 0x004CA489, 0x00000000, 0x00000000, 0x00732870,
+        0x00000000, 0x0066713B, 0x002343A0, 0x007B630C, 0x00000000, 0x004E439E, 0x00000000, 0x006B9EC6,
+        0x005DAFA7, 0x003897A2, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0077E049, 0x000E71A4,
+        0x00000000, 0x00000000, 0x0009437D, 0x001D0072, 0x00000000, 0x000C5E3A, 0x00000000, 0x0034B925,
+        0x005695E0, 0x0015DB2A, 0x00000000, 0x002A34B8, 0x00000000, 0x00000000, 0x00000000, 0x0020B8DD,
+    },
+#if LH2_POLYNOMIAL_COUNT > 2
+    {
+        0x007DE5CF, 0x0004EE0E, 0x00000000, 0x004CDCFE, 0x0028D9F5, 0x0033E8D9, 0x005F2062, 0x00000000,
+        0x00086D89, 0x00690F55, 0x00000000, 0x00000001, 0x00000000, 0x00000000, 0x00498AF7, 0x00272577,
+        0x003C3219, 0x00000000, 0x00000000, 0x00000000, 0x006BFFA6, 0x00000000, 0x0046902D, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00192CD5, 0x0065B092, 0x004BA962, 0x00000000,
+        0x007E1B3A, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0021C7B4, 0x00000000, 0x00000000,
+        0x0050E0DE, 0x00066AF6, 0x00555B33, 0x00000000, 0x00000000, 0x000FD0ED, 0x00000000, 0x005D2FCE,
+        0x00000000, 0x00000000, 0x00000000, 0x00033935, 0x00457845, 0x004F5ABD, 0x00785BDC, 0x00000000,
+        0x0074FD16, 0x0061FAFE, 0x00000000, 0x0056CF4E, 0x0058AE70, 0x00000000, 0x00000000, 0x00000000,
+        0x002D2C0C, 0x00127CB9, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x003825D3, 0x00000000,
+        0x001D0862, 0x0011752C, 0x00000000, 0x006E9271, 0x00000000, 0x000B8793, 0x00000000, 0x001E6FD3,
+        0x00000000, 0x00000000, 0x0035D915, 0x00000000, 0x00530B22, 0x00000000, 0x00000000, 0x00000000,
+        0x0076BCC0, 0x003A970E, 0x00000000, 0x004009D6, 0x003E0EF9, 0x00000000, 0x0063E37C, 0x0073F76C,
+        0x006C2CA4, 0x00000000, 0x002A4560, 0x007A89B1, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x0015F696, 0x000C8C59, 0x00000000, 0x00000000, 0x00236A6E,
+        0x00666804, 0x0036816E, 0x00245ADE, 0x00000000, 0x00000000, 0x005B4889, 0x004341A2, 0x001B9B94,
+        0x00000000, 0x00000000, 0x00712E07, 0x00000000, 0x00000000, 0x0016D145, 0x002E2C10, 0x0030C702,
+    },
+    {
+        0x0059F518, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0073FA56, 0x001A4104, 0x0060D5BF,
+        0x00000000, 0x00207D18, 0x002E9626, 0x00000000, 0x00000000, 0x007C709E, 0x00000000, 0x00000000,
+        0x0011101A, 0x00000000, 0x00000000, 0x0074651B, 0x00635864, 0x0026EDFE, 0x000ECD2B, 0x00000000,
+        0x0033C88A, 0x0002B044, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00166DE2, 0x0037480C,
+        0x007EAE9B, 0x004335DF, 0x00000000, 0x00198C2D, 0x000430F1, 0x00516966, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x005B82D1, 0x00000000, 0x00000000, 0x0077E7DB, 0x00000000,
+        0x00704344, 0x00096F2C, 0x0054BA18, 0x003A0372, 0x00000000, 0x001CD9F0, 0x002905E6, 0x003E9F14,
+        0x00000000, 0x00000000, 0x00000000, 0x006AE414, 0x00665CB7, 0x00000000, 0x00785F5C, 0x00000000,
+        0x00000000, 0x002C6C58, 0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00493CA8,
+        0x001EDDC3, 0x00000000, 0x005C2F38, 0x00307715, 0x00342EE2, 0x00000000, 0x00000000, 0x00000000,
+        0x004A0108, 0x00000000, 0x006CF747, 0x0069D956, 0x005E325B, 0x000A4A56, 0x00000000, 0x000D33BF,
+        0x00000000, 0x007A7744, 0x00000000, 0x006F3C07, 0x00000000, 0x0040F10B, 0x00000000, 0x00134D59,
+        0x004F1C50, 0x00000000, 0x00000000, 0x00063A66, 0x003C4542, 0x0015F342, 0x004D4DD9, 0x0065AEE1,
+        0x00221618, 0x00450925, 0x00382CF1, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x002B6007,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0052829E, 0x00000000, 0x002561E5,
+        0x00565677, 0x00000000, 0x00478893, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 4
+    {
+        0x003D519D, 0x0024C0F0, 0x00090FEB, 0x00000000, 0x002123C1, 0x002EB95A, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x003B0BB6, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x007C6AC2,
+        0x001971F9, 0x00000000, 0x003F4F2E, 0x0043DA03, 0x0022DC42, 0x005F4693, 0x00000000, 0x00000000,
+        0x001E4C49, 0x0035DBA5, 0x00000000, 0x0071E221, 0x00000000, 0x001B3DBF, 0x0026B09F, 0x000A91F6,
+        0x001C952C, 0x0054315D, 0x007A2B48, 0x00000000, 0x00000000, 0x00411574, 0x00000000, 0x0045AC44,
+        0x0078EEC6, 0x00078631, 0x00000000, 0x00000000, 0x007EF2AC, 0x0016B268, 0x00000000, 0x005B25EE,
+        0x004A7890, 0x00000000, 0x00000000, 0x006334CF, 0x00000000, 0x00000000, 0x005C0D2B, 0x00000000,
+        0x00000000, 0x0011F84A, 0x00000000, 0x006B0823, 0x00000000, 0x0028452C, 0x006D23EB, 0x0069B324,
+        0x0036B8ED, 0x0051D3D1, 0x00000001, 0x00000000, 0x0047B78B, 0x00000000, 0x007497D7, 0x00135BD6,
+        0x006EB918, 0x00000000, 0x00000000, 0x0052C1FC, 0x00000000, 0x00000000, 0x0015C438, 0x00578FB2,
+        0x00000000, 0x0072E430, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x004CD75E, 0x00330B4C,
+        0x0048F637, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0064D9B8, 0x00000000, 0x000C4306, 0x002B2744,
+        0x00000000, 0x00054E49, 0x00308A76, 0x00000000, 0x0076EC44, 0x00614AD4, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x000E23CB, 0x00000000, 0x004E7EBA, 0x00000000,
+        0x002D470C, 0x0066E14B, 0x0002F579, 0x00000000, 0x00598879, 0x00000000, 0x00000000, 0x0038F651,
+    },
+    {
+        0x0042FEC6, 0x0074BF04, 0x0055B849, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00403B61, 0x000C8D1E, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x004D7E27, 0x00637B18, 0x003104F4, 0x00000000, 0x00000000,
+        0x00374B0A, 0x00000000, 0x00614C50, 0x00000000, 0x00000000, 0x003D18D1, 0x00000000, 0x000F7750,
+        0x00000000, 0x004FC454, 0x00000000, 0x00706B34, 0x00000000, 0x00000000, 0x0064AF72, 0x002CE651,
+        0x00000000, 0x00216E68, 0x0078241D, 0x00000000, 0x00000000, 0x0051852E, 0x0073A865, 0x006A51CE,
+        0x004503BB, 0x00000000, 0x007FAB87, 0x00000000, 0x00000000, 0x0069678F, 0x00199D16, 0x0012F7E6,
+        0x001C685D, 0x00392121, 0x00000000, 0x0049E4CB, 0x0047063A, 0x002EEC38, 0x00000000, 0x003A5EBD,
+        0x00000000, 0x00000000, 0x002AEEF3, 0x000BFF7D, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x0076DCAA, 0x0009213D, 0x006D797B, 0x0007BCB3, 0x00000000, 0x003506C2, 0x005A4161, 0x00000000,
+        0x00000000, 0x00000000, 0x005ECF56, 0x00000000, 0x0014C86A, 0x00000000, 0x00000000, 0x00000000,
+        0x00106AC5, 0x00000000, 0x00000001, 0x00000000, 0x00000000, 0x005DEE3D, 0x001F2698, 0x00269030,
+        0x001A8B3C, 0x00000000, 0x00000000, 0x00292099, 0x00169D9F, 0x00591AC5, 0x00000000, 0x007D42E3,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00220B88, 0x00000000, 0x00000000, 0x0025ED22,
+        0x0004533B, 0x0056B48E, 0x006650F6, 0x00000000, 0x007A0B70, 0x0053AE3E, 0x00000000, 0x00000000,
+        0x004A1A96, 0x003FC508, 0x003249CE, 0x00000000, 0x00000000, 0x0002193B, 0x006FE3BB, 0x00000000,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 6
+    {
+        0x00000000, 0x00000000, 0x001D845F, 0x00000000, 0x00000000, 0x0009DAEC, 0x0036E443, 0x004E139A,
+        0x00000000, 0x006974C0, 0x00000000, 0x00000000, 0x0076818C, 0x00000000, 0x0073AFDE, 0x00000000,
+        0x002FC922, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0028348F, 0x005ECF47,
+        0x00000000, 0x0022478C, 0x00000000, 0x00000000, 0x00000000, 0x0065D22C, 0x0056245A, 0x00312360,
+        0x00000000, 0x00553212, 0x004B85AC, 0x006C1DDF, 0x00000000, 0x00000000, 0x00000000, 0x007E5646,
+        0x00000000, 0x002B9D69, 0x006B1162, 0x00000000, 0x00492E88, 0x00000000, 0x00336820, 0x005B6789,
+        0x00409892, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x007DAA9D, 0x0063A817, 0x00000000, 0x00248C82, 0x00000000, 0x0021C4E0,
+        0x00000000, 0x00608CD9, 0x00000001, 0x00512DCF, 0x00000000, 0x004DFE0B, 0x00000000, 0x00000000,
+        0x002C2A22, 0x00000000, 0x0012E893, 0x0045CE2D, 0x00000000, 0x007B1B54, 0x0053B995, 0x001F43FA,
+        0x00024872, 0x00430C62, 0x00000000, 0x006E47FA, 0x00000000, 0x003D6782, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x000537F9, 0x00359A19, 0x0010FC46, 0x00000000, 0x00000000, 0x004776A0,
+        0x0071E59F, 0x00000000, 0x00390E5A, 0x00000000, 0x000CE72C, 0x000E6395, 0x00000000, 0x000B541C,
+        0x001BCA6B, 0x002621D0, 0x00000000, 0x00000000, 0x007494C4, 0x000653BF, 0x00000000, 0x0079344C,
+        0x00000000, 0x00000000, 0x001678E8, 0x00593651, 0x00186B66, 0x00000000, 0x00000000, 0x001446ED,
+        0x00000000, 0x00676C71, 0x003AE8E4, 0x005DEB35, 0x00000000, 0x003EC11F, 0x00000000, 0x00000000,
+    },
+    {
+        0x003F7641, 0x005E945F, 0x001629B0, 0x007A3F08, 0x00000000, 0x0018954E, 0x0033371A, 0x004946A7,
+        0x002259DC, 0x00000000, 0x00000000, 0x000696A0, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x0003FF96, 0x004F1469, 0x00000000, 0x00000000, 0x004ACA30, 0x00107C3F, 0x00404355, 0x002C15A6,
+        0x00653049, 0x00000000, 0x005932E8, 0x00000000, 0x00000000, 0x001CB47F, 0x00000000, 0x00000000,
+        0x001FE8B3, 0x003BCDDC, 0x0046042F, 0x006B56E4, 0x00000000, 0x00000000, 0x00000000, 0x003D47F0,
+        0x00721C09, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00688478, 0x00000000, 0x00000000,
+        0x00000000, 0x0077A58F, 0x006062DE, 0x00000000, 0x0066A9E3, 0x00000000, 0x0012638F, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x005459AE, 0x00000000, 0x00000000, 0x0015A112,
+        0x00000000, 0x0027372D, 0x0052B35D, 0x003706B6, 0x007D997A, 0x00000000, 0x0031241A, 0x002BB239,
+        0x007E15A1, 0x00090B9E, 0x00000000, 0x00000000, 0x0071D0A1, 0x0044065A, 0x005BD224, 0x00000000,
+        0x00000000, 0x0039CF49, 0x00000000, 0x00000000, 0x002537F4, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x0020398C, 0x001BCBAC,
+        0x00000000, 0x00000000, 0x00621CAC, 0x00000000, 0x000C51E3, 0x00000000, 0x00000000, 0x00000000,
+        0x0043E4E5, 0x002FFE5A, 0x00000000, 0x00000000, 0x00000000, 0x007512C2, 0x00000000, 0x0004B6CD,
+        0x005D6CDD, 0x00000000, 0x0035033A, 0x000A4462, 0x00000000, 0x000E5B86, 0x00506C6A, 0x00290DFD,
+        0x0079493D, 0x006F153C, 0x00000000, 0x004D3757, 0x00000000, 0x006DE1D5, 0x0056D31C, 0x00000000,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 8
+    {
+        0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x001F719E, 0x00757261,
+        0x00279EE3, 0x00000000, 0x00183B60, 0x00000000, 0x00701BE5, 0x00000000, 0x00238AF7, 0x00000000,
+        0x005E521A, 0x0050023A, 0x0047F868, 0x00000000, 0x0060B3C8, 0x0056AF15, 0x00000000, 0x00528EBC,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x007803ED, 0x0021DEC1, 0x0033E09D, 0x00000000,
+        0x00000000, 0x002A2812, 0x00000000, 0x00000000, 0x00000000, 0x007CE859, 0x00041FE3, 0x00288D7F,
+        0x0015AF3E, 0x00000000, 0x00000000, 0x00431303, 0x00000000, 0x00353855, 0x000EB78F, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x002E313C, 0x00000000,
+        0x000C3587, 0x00000000, 0x007BE8AE, 0x0012992C, 0x00000000, 0x00655830, 0x00241914, 0x0016F67C,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x006A4ECD,
+        0x00622C98, 0x003E976D, 0x001A2EB7, 0x004C47CB, 0x00000000, 0x006661FA, 0x00000000, 0x00075E74,
+        0x00000000, 0x0076E31A, 0x006FC2F4, 0x004BE0AB, 0x00000000, 0x00000000, 0x00000000, 0x004F94C4,
+        0x00020A42, 0x00591F27, 0x00363701, 0x00723B51, 0x00000000, 0x00444213, 0x00000000, 0x000AD672,
+        0x003CFC5C, 0x00098921, 0x00000000, 0x002C055C, 0x0048BF3A, 0x00000000, 0x00000000, 0x003957EE,
+        0x005CA85A, 0x00000000, 0x0030B635, 0x00000000, 0x00541149, 0x001D20B1, 0x003B1577, 0x00000000,
+        0x00000000, 0x005A36CA, 0x007EC2F6, 0x006DFB69, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x0040E877, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0068653F, 0x00000000, 0x001073F0,
+    },
+    {
+        0x00000000, 0x00000000, 0x0074364C, 0x00307BF8, 0x001C2770, 0x00000001, 0x00000000, 0x00000000,
+        0x00239B17, 0x00100135, 0x00000000, 0x00728225, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x004063ED, 0x00000000, 0x00000000,
+        0x005CEB69, 0x00000000, 0x00000000, 0x00000000, 0x003E4ED0, 0x006604B5, 0x0064622A, 0x0053A7B2,
+        0x00000000, 0x0032A4B6, 0x00000000, 0x0060BCF2, 0x00000000, 0x00340707, 0x00000000, 0x00571EEA,
+        0x006E3706, 0x001A34D4, 0x0048F914, 0x00000000, 0x00000000, 0x00000000, 0x006DCB1A, 0x001F2C87,
+        0x0054F727, 0x00000000, 0x00000000, 0x00634CDD, 0x00284478, 0x00076BB0, 0x00000000, 0x00000000,
+        0x007ED7E9, 0x00000000, 0x004B389B, 0x00000000, 0x00242463, 0x00000000, 0x000BA16B, 0x00000000,
+        0x00000000, 0x002A9E15, 0x003B9995, 0x007D4E11, 0x00000000, 0x005B562C, 0x00058B76, 0x00000000,
+        0x00000000, 0x00166708, 0x00000000, 0x00785A5F, 0x00000000, 0x00273F25, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x007B01A2, 0x00000000, 0x00134A4A, 0x00000000, 0x00000000, 0x004747AC,
+        0x00692352, 0x005E55AA, 0x004FC47D, 0x004C7616, 0x002CF52F, 0x00447602, 0x0008F328, 0x00709F39,
+        0x000DBF99, 0x00000000, 0x003D2361, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x0037D101, 0x00000000, 0x000E0814, 0x00000000, 0x002FBFD9, 0x00000000, 0x0039526E, 0x0043A04A,
+        0x00000000, 0x00000000, 0x00512EF9, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0076628E,
+        0x006A0B8E, 0x00218F28, 0x00000000, 0x00000000, 0x00023FDE, 0x0058AAFC, 0x00149855, 0x0018F3E0,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 10
+    {
+        0x00000000, 0x00603957, 0x00000000, 0x00000000, 0x00000000, 0x0067169A, 0x002F8ED7, 0x00292D7B,
+        0x005786D3, 0x00000000, 0x00000000, 0x00760423, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x007F5CF6, 0x00000000, 0x001C716F, 0x006FC652, 0x00000000, 0x00216DEF, 0x00000000, 0x003CB731,
+        0x00000000, 0x00000000, 0x005CD2FE, 0x007944A4, 0x00386124, 0x00000000, 0x00000000, 0x00000000,
+        0x00480442, 0x000B9C23, 0x00163EF5, 0x0042ED14, 0x00231C09, 0x00000000, 0x0011BBE0, 0x00098AE8,
+        0x00000000, 0x000470B6, 0x00000000, 0x00000000, 0x0040BA16, 0x00000000, 0x0044BEEC, 0x00728B7A,
+        0x001EFA75, 0x0032F64C, 0x00000000, 0x005AAF1F, 0x00000000, 0x005F3CE8, 0x0036D6A4, 0x00000000,
+        0x00000000, 0x007092A8, 0x00000000, 0x006BF837, 0x00507623, 0x002BE051, 0x007D36C7, 0x00000000,
+        0x0075CA0A, 0x00000000, 0x00000001, 0x00000000, 0x001418D4, 0x001AD1DE, 0x0002AFA6, 0x00000000,
+        0x00000000, 0x00646490, 0x00130779, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0062F94C,
+        0x00000000, 0x00000000, 0x00000000, 0x0053821B, 0x003F1D72, 0x00580874, 0x00000000, 0x00000000,
+        0x0018B979, 0x00000000, 0x00260587, 0x00000000, 0x00243D2F, 0x00000000, 0x00000000, 0x00000000,
+        0x004E3853, 0x00000000, 0x00000000, 0x00000000, 0x004C9DE6, 0x00000000, 0x00000000, 0x00076B16,
+        0x00000000, 0x00000000, 0x00000000, 0x00475668, 0x004BB692, 0x007A9895, 0x00000000, 0x003A1DB6,
+        0x00000000, 0x002DB423, 0x00000000, 0x00000000, 0x00000000, 0x0031D20D, 0x006DB47A, 0x000DF469,
+        0x00000000, 0x00553AF9, 0x000F33CF, 0x00000000, 0x00000000, 0x00350952, 0x00000000, 0x0068B4B4,
+    },
+    {
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0059D161, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x007FB776, 0x002178CB, 0x00000000, 0x00347FF3, 0x00000000, 0x00000000, 0x00174F02,
+        0x00000000, 0x002253F6, 0x00485206, 0x005F17E0, 0x006B70B6, 0x00000000, 0x0046FC6F, 0x000D583A,
+        0x00000000, 0x000A7425, 0x006350B7, 0x00000000, 0x00528AB1, 0x00000000, 0x000E0E3A, 0x00000000,
+        0x00000000, 0x00791211, 0x006D2BBD, 0x00000000, 0x00000000, 0x00000000, 0x0018A183, 0x00000000,
+        0x00619843, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00507442,
+        0x00457CD2, 0x00000000, 0x0056BA18, 0x00000000, 0x00000000, 0x001E44FB, 0x00000000, 0x001C4BFD,
+        0x0032225C, 0x00000000, 0x002826AB, 0x00678445, 0x00000000, 0x0040A037, 0x00000000, 0x00000000,
+        0x0012842F, 0x00000000, 0x00000001, 0x00000000, 0x005A300E, 0x00000000, 0x002F8944, 0x0025EE1D,
+        0x00000000, 0x00000000, 0x0039C34A, 0x00000000, 0x0075B65E, 0x0002340A, 0x003A2C9B, 0x00544FD2,
+        0x00000000, 0x00000000, 0x00000000, 0x004A6ED1, 0x00000000, 0x002BACEF, 0x003C7655, 0x007BF7BE,
+        0x00000000, 0x001171FF, 0x0042F7B6, 0x003EEFC5, 0x00000000, 0x00000000, 0x0006F8A5, 0x002DAD00,
+        0x00000000, 0x00000000, 0x0037BEAF, 0x00089414, 0x00057661, 0x004D3B07, 0x0026FB06, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00659A76, 0x007C4AB6, 0x00000000, 0x001A207D, 0x00000000,
+        0x0014E9E4, 0x00000000, 0x005C216F, 0x00000000, 0x00721F61, 0x0068B534, 0x00000000, 0x00000000,
+        0x006E0B8E, 0x004F1420, 0x00000000, 0x00000000, 0x0076AD30, 0x00707D0F, 0x003180B9, 0x00000000,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 12
+    {
+        0x000B3876, 0x0065119B, 0x00000000, 0x00000000, 0x00000000, 0x00619087, 0x0010795B, 0x00000000,
+        0x00000000, 0x00401B30, 0x00000000, 0x00000000, 0x003A3436, 0x004B37DF, 0x00000000, 0x00000000,
+        0x00000000, 0x0024C383, 0x00000000, 0x002B4918, 0x0045D779, 0x003DB1FD, 0x000D1F67, 0x007A81E9,
+        0x00563552, 0x00000000, 0x00787A6B, 0x00000000, 0x001C2C1E, 0x00000000, 0x00427249, 0x00000000,
+        0x0036B453, 0x000381D1, 0x00000000, 0x00000000, 0x00673E7B, 0x00000000, 0x006D0A7B, 0x002EFD4F,
+        0x00000000, 0x00000000, 0x00000000, 0x00269A6C, 0x0052D26B, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00391B35, 0x006B5E6D, 0x00000000, 0x00000000, 0x00490E76, 0x00000000, 0x0014E62D,
+        0x00000000, 0x00202185, 0x0013410F, 0x00000000, 0x00000000, 0x005437BD, 0x0050AEEE, 0x00000000,
+        0x00314C4C, 0x00182CE9, 0x00000000, 0x00685B4A, 0x001A8C76, 0x00000000, 0x0076779B, 0x00000000,
+        0x00000000, 0x004C3A32, 0x0032576B, 0x00000000, 0x00000000, 0x00175770, 0x00000000, 0x00066DA1,
+        0x00000000, 0x005A29FC, 0x00000000, 0x006F48AF, 0x00000000, 0x0029AC66, 0x0008584A, 0x005DBDD6,
+        0x00230D6F, 0x00000000, 0x00000000, 0x00000000, 0x00357DE5, 0x005827D6, 0x00000000, 0x00000000,
+        0x00000000, 0x001FB639, 0x00000000, 0x003FAE34, 0x00000000, 0x005E8092, 0x002D90D7, 0x00000000,
+        0x00639799, 0x00000000, 0x00708013, 0x00000000, 0x00000001, 0x00000000, 0x000FAA29, 0x004E9459,
+        0x00000000, 0x00737F1D, 0x0004F896, 0x00000000, 0x007C900E, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x004643C1, 0x00000000, 0x00000000, 0x00000000, 0x00743EF8, 0x007EB666, 0x00000000,
+    },
+    {
+        0x005134A6, 0x00000000, 0x00000000, 0x00711E5B, 0x00000000, 0x006E9ED0, 0x00000000, 0x00000000,
+        0x000CC2D9, 0x00000000, 0x001B0A19, 0x00000000, 0x00000000, 0x002EE73B, 0x00000000, 0x0042CF1D,
+        0x00400774, 0x00522DB7, 0x002B8246, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00289242,
+        0x00000000, 0x00000000, 0x00000000, 0x0045E5EE, 0x003D3850, 0x00000000, 0x00000000, 0x006592EF,
+        0x0037C990, 0x00476AA6, 0x00000000, 0x0017B1ED, 0x00000000, 0x0058365A, 0x007D65C6, 0x005C0A85,
+        0x00000000, 0x00000000, 0x00000000, 0x0023F3B7, 0x00000000, 0x005AC615, 0x004A231A, 0x001E5442,
+        0x006AA1D6, 0x0025933C, 0x00000000, 0x00000000, 0x002DFB75, 0x0077FF87, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x004D1E17, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x005E70BF, 0x00000000, 0x007B051B, 0x00682683, 0x00000000, 0x00000000, 0x00673A3A, 0x00000000,
+        0x00053FA2, 0x00000000, 0x00755038, 0x003A54A2, 0x0007FF19, 0x00000000, 0x00000000, 0x00000000,
+        0x00276E01, 0x00000000, 0x00000000, 0x00188D21, 0x00000001, 0x00000000, 0x00791C41, 0x000A0D0E,
+        0x00350692, 0x00000000, 0x00624AAB, 0x00000000, 0x001D9ADA, 0x0013A232, 0x0054473A, 0x000F3BD7,
+        0x00000000, 0x00000000, 0x003FEAAC, 0x004EA9F0, 0x00307A11, 0x006C5861, 0x00496027, 0x00000000,
+        0x00000000, 0x00096FE5, 0x00726FB8, 0x00149D43, 0x0010B890, 0x00000000, 0x00000000, 0x007F5D53,
+        0x0033A227, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00201312, 0x00608361, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00397A47, 0x005745C9, 0x0002665B, 0x00000000, 0x00000000,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 14
+    {
+        0x00000000, 0x005D1D16, 0x00000000, 0x00000000, 0x004A0840, 0x00000000, 0x002BD032, 0x007709ED,
+        0x00000000, 0x002C201A, 0x007D6522, 0x0028D3A1, 0x00615C4E, 0x00000000, 0x00000000, 0x004F3FF3,
+        0x00000000, 0x00715839, 0x001740AA, 0x00000000, 0x00000000, 0x00073926, 0x00000000, 0x00144043,
+        0x00000000, 0x0079F025, 0x003CD5AE, 0x006E473A, 0x004681A8, 0x000ECCD0, 0x005666CF, 0x00000000,
+        0x00000000, 0x0041815E, 0x000C7938, 0x00264092, 0x001830F1, 0x00000000, 0x00254AFF, 0x00000000,
+        0x0045475C, 0x00000000, 0x00357A5E, 0x002EC700, 0x0074629B, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x003340DF, 0x004CA727, 0x00000000, 0x00000000, 0x006B8B9C, 0x00000000,
+        0x00000000, 0x00000000, 0x005503D5, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x007F574C,
+        0x00000000, 0x00000000, 0x0059B3D2, 0x00000000, 0x00000000, 0x00000000, 0x000BE79D, 0x00660CEE,
+        0x00000000, 0x00000000, 0x00000000, 0x000953BF, 0x0048488E, 0x0069FE7D, 0x00000000, 0x00000000,
+        0x001E4A96, 0x0062A506, 0x00000000, 0x00000000, 0x00000000, 0x005E3A36, 0x00000000, 0x00000000,
+        0x00360D8B, 0x00111EE4, 0x00000000, 0x0031ACEF, 0x00000000, 0x00000000, 0x0073B54B, 0x005A84F5,
+        0x00000001, 0x00131B85, 0x00000000, 0x0052AFB1, 0x00000000, 0x00000000, 0x00000000, 0x006CE976,
+        0x003AB83A, 0x00000000, 0x001CA16F, 0x00000000, 0x00000000, 0x00214B15, 0x00000000, 0x000501B4,
+        0x003FF1B2, 0x00000000, 0x007B730B, 0x001B67CC, 0x00000000, 0x0002C202, 0x00000000, 0x00000000,
+        0x00429CF9, 0x00000000, 0x00643CF5, 0x00000000, 0x00000000, 0x00393551, 0x0050BF2D, 0x00222274,
+    },
+    {
+        0x0041B109, 0x000A98C4, 0x00000000, 0x00000000, 0x004D2A59, 0x00000000, 0x00000000, 0x0042AD89,
+        0x001B083D, 0x0018BC7E, 0x00000000, 0x0076E86A, 0x00336C62, 0x00000000, 0x00000000, 0x005D38E3,
+        0x00000000, 0x006C5C26, 0x0010772D, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00230D52,
+        0x000FAEDB, 0x00000000, 0x00000000, 0x00000000, 0x0061F904, 0x003136E1, 0x001402FE, 0x00000000,
+        0x00000000, 0x0012D864, 0x0027E74D, 0x006BA0F3, 0x00000000, 0x00000000, 0x002D52ED, 0x00000000,
+        0x003A3FCF, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0006997A, 0x00000000, 0x0028C9C5,
+        0x00463EEC, 0x005839ED, 0x00000000, 0x00000000, 0x00000000, 0x00578A06, 0x00000000, 0x003DFBEB,
+        0x00000000, 0x00058340, 0x00000000, 0x00000000, 0x00000000, 0x00626A55, 0x00000000, 0x00034BC8,
+        0x005B0395, 0x00000000, 0x00000001, 0x007D2CF6, 0x001660B3, 0x00000000, 0x00000000, 0x004EBACC,
+        0x00000000, 0x00453046, 0x00000000, 0x00000000, 0x00000000, 0x00551809, 0x00000000, 0x007FD2ED,
+        0x0050DC96, 0x002E7715, 0x00000000, 0x00000000, 0x00363F31, 0x007A2766, 0x00000000, 0x00687C91,
+        0x00000000, 0x001D8D99, 0x00000000, 0x00000000, 0x005F00EB, 0x00000000, 0x0008EAB1, 0x000DC18A,
+        0x00000000, 0x004BFAE1, 0x0039212E, 0x00742A45, 0x001F7D39, 0x00347D00, 0x003F3470, 0x0079AA78,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0024F7BB, 0x00718F21, 0x00536502, 0x002A2210,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x0065A6BF, 0x00737041, 0x00000000, 0x00000000, 0x006F9FB5, 0x00675248, 0x004935D1, 0x00213F98,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 16
+    {
+        0x00000000, 0x00000000, 0x0070E913, 0x0002428E, 0x006D651E, 0x00000000, 0x00000000, 0x004C9422,
+        0x00000000, 0x0004CDB9, 0x00000000, 0x00668EB8, 0x00632855, 0x005CA55C, 0x00000000, 0x00000000,
+        0x00000000, 0x007F10D7, 0x00645FF4, 0x00000000, 0x002DBB9D, 0x00000000, 0x00000000, 0x00000000,
+        0x00504C49, 0x00000000, 0x00000000, 0x0038C05B, 0x001E5DDA, 0x00697997, 0x00066981, 0x00000000,
+        0x000C3002, 0x00751B1A, 0x00453E93, 0x00000000, 0x002FF40B, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x002A2C0D, 0x00000000, 0x005EB4AF, 0x00000000, 0x00000000, 0x00157246, 0x00000000,
+        0x00000000, 0x00228A0E, 0x00000000, 0x0076466B, 0x0032E275, 0x0020C875, 0x005BF378, 0x00587470,
+        0x0008A1CA, 0x007BC829, 0x00000000, 0x00468003, 0x00119274, 0x0012E9BF, 0x00000000, 0x006BC038,
+        0x00000000, 0x00000000, 0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00198F84,
+        0x00000000, 0x00000000, 0x007D7CC4, 0x0031A82D, 0x00000000, 0x003DFC09, 0x00289360, 0x001CD30F,
+        0x00264F3B, 0x00000000, 0x00000000, 0x003F5E8D, 0x001BF983, 0x0052C406, 0x00000000, 0x00000000,
+        0x00000000, 0x000FEE1F, 0x00000000, 0x00000000, 0x0055BEA8, 0x00561B3B, 0x0079EF38, 0x004B8379,
+        0x00000000, 0x0041A732, 0x00600824, 0x00000000, 0x00000000, 0x0016B0F6, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0042320F, 0x00000000, 0x00000000,
+        0x00000000, 0x004F1AC9, 0x0073FF8E, 0x000BC9AC, 0x00245546, 0x003B3332, 0x00000000, 0x006FD8C9,
+        0x00000000, 0x00000000, 0x00000000, 0x0034F986, 0x0048F677, 0x0037BAFC, 0x00000000, 0x00000000,
+    },
+    {
+        0x00000000, 0x005F0E4F, 0x00000000, 0x00000000, 0x003219C1, 0x00768D1D, 0x0002F0DA, 0x00000000,
+        0x0019404A, 0x00000000, 0x002CC1E6, 0x001C05C7, 0x005ACD4D, 0x00000000, 0x00782BEE, 0x00719D36,
+        0x00000000, 0x00463182, 0x00643EDB, 0x007DCC56, 0x003B60D6, 0x00000000, 0x00000000, 0x00000001,
+        0x00000000, 0x00379D0D, 0x00000000, 0x00000000, 0x001A7147, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00255F00, 0x007411F6, 0x006E05A0,
+        0x00000000, 0x00670A0F, 0x00000000, 0x00000000, 0x0004BC08, 0x002944EB, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x0013F595, 0x00000000, 0x00342437, 0x00000000, 0x000B94A5, 0x001181BB,
+        0x00000000, 0x0068D521, 0x007B1D3C, 0x00000000, 0x0023C50A, 0x002B0250, 0x00000000, 0x00000000,
+        0x00000000, 0x006AA837, 0x00000000, 0x003DCB89, 0x00061916, 0x004D3517, 0x00488543, 0x00086C5F,
+        0x001528AA, 0x00000000, 0x006330C6, 0x00000000, 0x00000000, 0x001EA608, 0x0056B12F, 0x00000000,
+        0x000FDC35, 0x00000000, 0x00000000, 0x006D440A, 0x004FD0CF, 0x00000000, 0x00000000, 0x005D0DBF,
+        0x00000000, 0x00000000, 0x00585E5C, 0x00314185, 0x002E3C14, 0x00000000, 0x0050C4B6, 0x00000000,
+        0x002648C0, 0x00000000, 0x00000000, 0x004ACFF3, 0x0055E14C, 0x00000000, 0x00000000, 0x00522DA7,
+        0x00000000, 0x00000000, 0x0042ED6E, 0x00000000, 0x003804FC, 0x00000000, 0x004442F4, 0x0060A1C6,
+        0x00000000, 0x000C412C, 0x00000000, 0x00000000, 0x00000000, 0x0041DB12, 0x003E1162, 0x007EB488,
+        0x0073DCD9, 0x00000000, 0x00000000, 0x00000000, 0x00179B53, 0x00211E59, 0x00000000, 0x00000000,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 18
+    {
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0065D6DC, 0x0072A56C, 0x00000000, 0x00000000,
+        0x003AB989, 0x00718713, 0x004667F7, 0x00268DA2, 0x0068E55E, 0x0063E941, 0x00000000, 0x00671AD0,
+        0x00000000, 0x00000001, 0x00435C41, 0x0023B072, 0x00000000, 0x0031F16A, 0x00567187, 0x007B889D,
+        0x00000000, 0x001E88EB, 0x00000000, 0x007EF97E, 0x00000000, 0x00000000, 0x00000000, 0x00557380,
+        0x0029D85C, 0x00000000, 0x00360504, 0x00747EA1, 0x00000000, 0x00138544, 0x00000000, 0x001B6601,
+        0x000DDF5F, 0x00000000, 0x00000000, 0x0017AFE8, 0x002CC0EE, 0x00000000, 0x00000000, 0x00513010,
+        0x00000000, 0x00098FAD, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x003C6A0D,
+        0x004499DC, 0x00000000, 0x0011A038, 0x00490C4E, 0x00000000, 0x00245B43, 0x00607CE7, 0x006DE986,
+        0x00000000, 0x0014ACD9, 0x00000000, 0x007CF57C, 0x002B8BCF, 0x004AD526, 0x00000000, 0x005F9E87,
+        0x00000000, 0x004EE7D2, 0x005AD94A, 0x00000000, 0x0077A86D, 0x00000000, 0x00000000, 0x0058B53E,
+        0x002E0C46, 0x00000000, 0x00321CD9, 0x00000000, 0x000F8A88, 0x00344EBB, 0x001C4D0E, 0x000BCBBE,
+        0x00000000, 0x0003E62E, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x006BDBCF,
+        0x003936E9, 0x00000000, 0x006FD5E0, 0x00534578, 0x00000000, 0x00056A56, 0x00000000, 0x00791C0A,
+        0x0041B48E, 0x00000000, 0x00000000, 0x003FC4D9, 0x00000000, 0x004D9116, 0x00000000, 0x00000000,
+        0x0007F4FD, 0x00000000, 0x00000000, 0x00000000, 0x001868F3, 0x00000000, 0x005DC03B, 0x0020D7D6,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+    },
+    {
+        0x00529841, 0x002F4FAB, 0x00000000, 0x00000000, 0x00000000, 0x00629B44, 0x00000000, 0x00000000,
+        0x00305C4C, 0x00000000, 0x006F5773, 0x00000000, 0x00000000, 0x007BBD82, 0x00000000, 0x00000000,
+        0x0055BCE3, 0x000AD88F, 0x00000000, 0x0014B002, 0x00000000, 0x00185BB5, 0x0008AF92, 0x00000001,
+        0x00000000, 0x00000000, 0x00589718, 0x00000000, 0x0038E7EA, 0x00279D66, 0x007D2F70, 0x0006D2BB,
+        0x00000000, 0x00672F09, 0x005B14C4, 0x00000000, 0x0078BC1B, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00703C2E, 0x00000000, 0x00000000, 0x002A7DF7, 0x00000000, 0x0004510B, 0x00000000,
+        0x0041D79B, 0x00000000, 0x0051D320, 0x00000000, 0x001E9445, 0x00000000, 0x00000000, 0x0024C863,
+        0x004B5798, 0x006C0F72, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x002C5575,
+        0x001D8039, 0x0012ED60, 0x00000000, 0x0057ECE8, 0x005EA8E6, 0x00733971, 0x00779A7E, 0x00000000,
+        0x0048BB49, 0x003AE8EC, 0x00000000, 0x00000000, 0x000E5E6D, 0x0043A374, 0x00686F5F, 0x00000000,
+        0x00000000, 0x000C2327, 0x00174A5A, 0x0047ABA4, 0x00039CE0, 0x00000000, 0x00000000, 0x0011E682,
+        0x00000000, 0x00750DAB, 0x0028C386, 0x00000000, 0x00000000, 0x004F936E, 0x00000000, 0x003E3A49,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x003D2AE6, 0x00000000, 0x00000000,
+        0x00000000, 0x00618FE7, 0x00000000, 0x00237B88, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x0035D53D, 0x00440DBE, 0x00379835, 0x005D8F68, 0x00000000, 0x00000000, 0x006B57C2,
+        0x00000000, 0x0065919C, 0x00337AE5, 0x004DB3FD, 0x00000000, 0x00202015, 0x001ABB0E, 0x007EB800,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 20
+    {
+        0x00000000, 0x00000000, 0x0061FF65, 0x005B3FB6, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x0021407B, 0x001E88FF, 0x00000000, 0x00661201, 0x004CD6C3, 0x00000000,
+        0x001B263A, 0x00418F78, 0x00000000, 0x00553687, 0x002750B2, 0x00000000, 0x004BC62C, 0x0031E01A,
+        0x00000000, 0x00000000, 0x00000000, 0x00058CD7, 0x00637A2E, 0x000CFF66, 0x006B14E9, 0x00000000,
+        0x00000000, 0x0014F075, 0x00024359, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x00457B8B, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x007428DE, 0x002968A4,
+        0x006DE0ED, 0x00000000, 0x00000000, 0x00000000, 0x002E518C, 0x007D418A, 0x00000000, 0x00000000,
+        0x00000000, 0x006FCBB5, 0x00330831, 0x003CFDCA, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x002A4131, 0x0042FC68, 0x00000001, 0x0016019D, 0x00572B00, 0x00000000, 0x0073166A, 0x0051101E,
+        0x00000000, 0x00359FD7, 0x004614B4, 0x00000000, 0x00719BCF, 0x00000000, 0x0038EF40, 0x007F9C4E,
+        0x0012BF0E, 0x001DABA9, 0x00000000, 0x00787CC7, 0x006545E6, 0x00694FB3, 0x007BA9E1, 0x00000000,
+        0x00000000, 0x0009C934, 0x00000000, 0x00000000, 0x00000000, 0x0023397F, 0x00000000, 0x00364957,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x003AE680, 0x00000000, 0x00000000,
+        0x0059D142, 0x00773B17, 0x00492FE9, 0x002490A3, 0x00000000, 0x002D60B3, 0x005296E2, 0x0006A8DF,
+        0x005FE034, 0x00000000, 0x005C7819, 0x00000000, 0x001016F4, 0x00000000, 0x00189EF5, 0x004F0872,
+        0x003FE257, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x000E9E69, 0x000AD54E, 0x00000000,
+    },
+    {
+        0x00000000, 0x003E36E4, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x007681CE,
+        0x00000000, 0x00000000, 0x001E7CFE, 0x00000000, 0x0073E057, 0x00000000, 0x00000000, 0x00000000,
+        0x0021440A, 0x00000000, 0x0017213F, 0x0063CFE0, 0x00000000, 0x00670693, 0x00000000, 0x0053A43A,
+        0x004C2B2D, 0x00000000, 0x0046F8FC, 0x004BCD9E, 0x003377BB, 0x00000000, 0x00000000, 0x00000000,
+        0x0018CB4D, 0x005F2C95, 0x0044E7EF, 0x005D8BEF, 0x00000000, 0x002B7796, 0x0029D060, 0x0069F240,
+        0x007A7E62, 0x000D8B10, 0x00000000, 0x00000000, 0x003B7D94, 0x0024E610, 0x00000000, 0x0007934B,
+        0x00000000, 0x00000000, 0x00031523, 0x00000000, 0x005B8DE3, 0x000B2FD1, 0x00000000, 0x000ED690,
+        0x0036AB52, 0x00000000, 0x00793C27, 0x00000000, 0x00000000, 0x00000000, 0x007E5991, 0x00000000,
+        0x00000000, 0x00000000, 0x00000001, 0x002FA6A6, 0x00270CF6, 0x0022986C, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x0048861B, 0x00000000, 0x0043DC08, 0x00655583, 0x00000000,
+        0x006EF274, 0x003C27CF, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x007DADF8,
+        0x0015FA72, 0x004FE9FE, 0x00753000, 0x00000000, 0x00000000, 0x0051C835, 0x002D74CE, 0x00000000,
+        0x0009B901, 0x00000000, 0x00000000, 0x003401D1, 0x00000000, 0x001292E4, 0x0041F98C, 0x006C29DA,
+        0x00000000, 0x001D80DC, 0x006B7666, 0x00000000, 0x00000000, 0x00118A3F, 0x0058E7C2, 0x001A1FA6,
+        0x00000000, 0x00048055, 0x005553DC, 0x00000000, 0x00000000, 0x00602102, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00395B25, 0x00000000, 0x00719A79, 0x0031BA2E, 0x0057B646,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 22
+    {
+        0x00000000, 0x005B8168, 0x00000000, 0x001AA915, 0x00000000, 0x006104DB, 0x004A2459, 0x00344861,
+        0x0039F500, 0x000D9C11, 0x00000000, 0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00700FBC,
+        0x004D8C38, 0x0005F828, 0x00000000, 0x00000000, 0x00778C94, 0x00258E2F, 0x00000000, 0x00000000,
+        0x006FD3C5, 0x00423F5E, 0x00000000, 0x00000000, 0x00000000, 0x00450EAF, 0x002705A0, 0x003DDCBB,
+        0x0032798B, 0x0068C3DF, 0x00000000, 0x00000000, 0x006BE1B8, 0x000EEFBF, 0x00000000, 0x00000000,
+        0x00641C05, 0x00000000, 0x00000000, 0x0011D3B6, 0x00169AEB, 0x00000000, 0x00000000, 0x0008D770,
+        0x00000000, 0x0003E2C0, 0x00000000, 0x00060817, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x00216F12, 0x005DBC67, 0x00000000, 0x002C0F5D, 0x00000000, 0x00792A86, 0x00000000, 0x00000000,
+        0x004EED1F, 0x006C0960, 0x0047964F, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00182FCF, 0x001EAEA3, 0x0048C77D, 0x00000000, 0x00405EEC, 0x0031CC6A, 0x0023FF3F,
+        0x002927BF, 0x005856D5, 0x005356F1, 0x00000000, 0x00737F52, 0x00000000, 0x00000000, 0x00000000,
+        0x0054280F, 0x00000000, 0x00000000, 0x00361BE3, 0x00000000, 0x002BB48D, 0x00000000, 0x00000000,
+        0x00000000, 0x0056457E, 0x00000000, 0x001DB3B2, 0x00000000, 0x00000000, 0x003F9AFE, 0x007C8E68,
+        0x00000000, 0x00000000, 0x00000000, 0x0050C692, 0x00000000, 0x00757C56, 0x005F5038, 0x0015D320,
+        0x007A643C, 0x00000000, 0x00000000, 0x00000000, 0x007F1C4F, 0x00000000, 0x000A7EFE, 0x003BD3E5,
+        0x001256B7, 0x00000000, 0x002E6105, 0x00000000, 0x00635CCB, 0x00000000, 0x006684EC, 0x00000000,
+    },
+    {
+        0x00000001, 0x00000000, 0x0030F105, 0x0042043A, 0x005B388E, 0x00000000, 0x00000000, 0x000E7C53,
+        0x00000000, 0x00000000, 0x004CF017, 0x00000000, 0x00000000, 0x0034CC76, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x0033A056, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x0040D30D, 0x0048C299, 0x00000000, 0x00000000, 0x001F5314, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x000A9020, 0x0071F692, 0x0059F5FC, 0x00793532, 0x0028B04E, 0x002C8E10, 0x0020D4DC,
+        0x00000000, 0x00109134, 0x00000000, 0x003E58CC, 0x0026E0EF, 0x003D211E, 0x0045F232, 0x0065CFBC,
+        0x00000000, 0x007C1E0B, 0x00000000, 0x00000000, 0x0073AE66, 0x00000000, 0x00000000, 0x006D70C4,
+        0x00000000, 0x00752ECC, 0x00000000, 0x00000000, 0x002ADFF6, 0x00000000, 0x00000000, 0x00000000,
+        0x00236DE7, 0x000DC811, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x002E7196, 0x00000000,
+        0x00628E7E, 0x00000000, 0x007FCAFA, 0x00552F07, 0x00000000, 0x00671173, 0x00000000, 0x0006A980,
+        0x001946EF, 0x00000000, 0x00000000, 0x001C5561, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x006A858A, 0x0053BA71, 0x00000000, 0x00000000, 0x004B2FB3, 0x00000000, 0x00517021, 0x001BC030,
+        0x005C306E, 0x00021FB6, 0x006E9583, 0x0017F9F4, 0x0076338E, 0x0012CB7A, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00378E30, 0x00099804, 0x00000000, 0x00159BB8, 0x00000000, 0x00386A8C,
+        0x005F4CDA, 0x00475781, 0x00000000, 0x00000000, 0x00000000, 0x0025A1A7, 0x006934CC, 0x0061C2AB,
+        0x004EFD3F, 0x003BD8B5, 0x00000000, 0x005673DC, 0x00000000, 0x007A2A7A, 0x000573E4, 0x00000000,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 24
+    {
+        0x0011D14A, 0x00000000, 0x00088136, 0x00000000, 0x002B4383, 0x00000000, 0x00000000, 0x00439031,
+        0x00000000, 0x001B6A5B, 0x00000000, 0x00000000, 0x00000000, 0x006FF5D9, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x000C6FD0, 0x00401919, 0x00000000, 0x0057DC63, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x0025BE53, 0x00331EE5, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00395A81, 0x00000000, 0x00000000, 0x00138EA4, 0x00724797, 0x00000000, 0x00000000,
+        0x00000000, 0x0027C014, 0x00000000, 0x0004EF77, 0x004EE24B, 0x00000000, 0x00000000, 0x002C58E2,
+        0x00000000, 0x003FC6E0, 0x00000000, 0x00231371, 0x007401C6, 0x00000000, 0x00000000, 0x005F27CA,
+        0x00000000, 0x00000000, 0x006BD0DC, 0x0069E064, 0x00000000, 0x00000000, 0x0044CB53, 0x002F0F15,
+        0x00604172, 0x005C028B, 0x00078812, 0x00000000, 0x007FE8C4, 0x00711A89, 0x00000000, 0x00161796,
+        0x00000000, 0x0037F0B5, 0x00031A0F, 0x006CCD7A, 0x0028A1FB, 0x005141D0, 0x00000001, 0x00000000,
+        0x00000000, 0x003C8EE0, 0x00000000, 0x0035B239, 0x00000000, 0x0078252B, 0x00000000, 0x00000000,
+        0x003A001E, 0x00000000, 0x00000000, 0x00000000, 0x0065FCB1, 0x00000000, 0x00000000, 0x00464D78,
+        0x0021ECB1, 0x001CEEF7, 0x00533946, 0x001FE767, 0x00551B56, 0x000BEFB9, 0x00676706, 0x0049104C,
+        0x00000000, 0x00312AFD, 0x00000000, 0x00000000, 0x00000000, 0x001577AB, 0x004B6777, 0x00000000,
+        0x00585FD3, 0x007BBABB, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0063FDB3,
+        0x00777D28, 0x004C79AD, 0x005AFEC1, 0x00000000, 0x00188A7C, 0x000F4C49, 0x007DB34B, 0x00000000,
+    },
+    {
+        0x00000001, 0x00000000, 0x00000000, 0x005FE7D7, 0x00292BB3, 0x00000000, 0x004A0875, 0x006DE462,
+        0x00453E1C, 0x00000000, 0x0023E745, 0x001497C2, 0x005DC014, 0x001FC461, 0x0003BDC3, 0x004D3DC8,
+        0x003EE680, 0x005A7D40, 0x002B6B5E, 0x0066E296, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x000CD699, 0x00000000, 0x0047F432, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0061F621,
+        0x00000000, 0x00000000, 0x000E75EE, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x001AAC5D, 0x00486AF7, 0x0075D799, 0x00000000, 0x007F6581, 0x00000000, 0x00000000, 0x00000000,
+        0x00364388, 0x00652CBD, 0x003834AC, 0x00000000, 0x0012612E, 0x00000000, 0x00000000, 0x00000000,
+        0x00693B33, 0x00000000, 0x00000000, 0x0035372D, 0x002D6A42, 0x0050656A, 0x00000000, 0x00000000,
+        0x006AC238, 0x00636E27, 0x0025738D, 0x00262400, 0x00000000, 0x00000000, 0x00000000, 0x0008A648,
+        0x00000000, 0x00113AA6, 0x001D0735, 0x00000000, 0x007226B0, 0x00000000, 0x00000000, 0x0077013D,
+        0x0055EFEF, 0x00428F25, 0x00000000, 0x00000000, 0x00000000, 0x0019BA9B, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x0079D6D0, 0x0033FAD8, 0x0058A218, 0x0056C3F3, 0x0030F076, 0x00060E50,
+        0x00000000, 0x0017FA07, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x007CB505, 0x00000000,
+        0x00404FC4, 0x00000000, 0x003CB635, 0x00000000, 0x00000000, 0x0021D44F, 0x00000000, 0x00000000,
+        0x00045560, 0x00000000, 0x00000000, 0x006E5736, 0x000B5270, 0x00719703, 0x002E3417, 0x00000000,
+        0x00000000, 0x004E69CD, 0x00000000, 0x007BE9D9, 0x00000000, 0x0053D90C, 0x003AB627, 0x00000000,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 26
+    {
+        0x001BFD5E, 0x007C9092, 0x00000000, 0x004E3C8D, 0x00000000, 0x00000001, 0x004B0C74, 0x00000000,
+        0x00000000, 0x006C97D9, 0x0018F133, 0x00053236, 0x005760A8, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x005F968A, 0x00000000, 0x00000000, 0x00427C3E, 0x00000000, 0x00507D84,
+        0x00498C69, 0x00000000, 0x001222E9, 0x00000000, 0x00230154, 0x00664D23, 0x0003025B, 0x005A50DB,
+        0x00000000, 0x00549702, 0x00000000, 0x00000000, 0x004C7774, 0x00000000, 0x00701B3F, 0x002181E1,
+        0x00000000, 0x00000000, 0x00000000, 0x001F53C7, 0x00000000, 0x00000000, 0x000CDA03, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x001DB9FE, 0x0030B679, 0x003E1AD6, 0x00000000, 0x0041944F,
+        0x0047BA92, 0x00268F2A, 0x00000000, 0x00000000, 0x00630A95, 0x0036D4F4, 0x000887C9, 0x007745C3,
+        0x002DA07B, 0x00000000, 0x00000000, 0x00734508, 0x0079AF58, 0x0035BA3E, 0x003D7CAE, 0x00000000,
+        0x00000000, 0x00743894, 0x00000000, 0x00000000, 0x00382BDA, 0x0060F24B, 0x00000000, 0x002BE2CA,
+        0x000790B7, 0x00000000, 0x00000000, 0x006ED66E, 0x00000000, 0x00592141, 0x00000000, 0x00290DBF,
+        0x00000000, 0x00000000, 0x0010362A, 0x007B38BE, 0x005D3EBA, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x003BF635, 0x00000000, 0x0053CDF5, 0x00000000, 0x00000000, 0x00148692, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x000FDEB2, 0x0044BBC8, 0x00000000,
+        0x0064BBB3, 0x007F4D9E, 0x002F6664, 0x000BDFC5, 0x006ACF37, 0x00000000, 0x00000000, 0x00000000,
+        0x0069FAE3, 0x00176A48, 0x00000000, 0x00000000, 0x0032C428, 0x00000000, 0x00252BA6, 0x00000000,
+    },
+    {
+        0x007EE59A, 0x00589EC2, 0x00000000, 0x001E11E8, 0x00000000, 0x00000001, 0x00000000, 0x004DFD87,
+        0x00000000, 0x0023CD55, 0x00000000, 0x000D45A2, 0x0002A97E, 0x00000000, 0x00000000, 0x0069D42F,
+        0x00000000, 0x005FB1A1, 0x00000000, 0x00000000, 0x00000000, 0x001592D5, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00387C04, 0x00000000, 0x00000000, 0x00000000, 0x005B4207,
+        0x00736AFD, 0x00000000, 0x0029A748, 0x00000000, 0x00000000, 0x007BF702, 0x00000000, 0x00000000,
+        0x0071EB1E, 0x00000000, 0x00000000, 0x00000000, 0x0007A4EE, 0x00058AAA, 0x006B8224, 0x004239BD,
+        0x004741CD, 0x00000000, 0x003408EC, 0x002D89D2, 0x000BC3C4, 0x003EDCFB, 0x00178F28, 0x0062FA1D,
+        0x00000000, 0x0012AE4B, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00264E5D,
+        0x0040F707, 0x00000000, 0x003699B1, 0x003B53CF, 0x0061C41F, 0x00640745, 0x00000000, 0x00000000,
+        0x00792EA9, 0x0025BEFA, 0x00000000, 0x00000000, 0x0052654F, 0x00000000, 0x003D546B, 0x006C7F18,
+        0x006F58FB, 0x00000000, 0x0033705D, 0x002AE384, 0x000E2607, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x0051CC2C, 0x0057DAD9, 0x00000000, 0x004AFBA4, 0x00000000, 0x005D07E9,
+        0x00085B11, 0x00000000, 0x001A1ABC, 0x00203B3E, 0x00000000, 0x00187F7A, 0x00000000, 0x00000000,
+        0x00312EDE, 0x00000000, 0x00000000, 0x00450A64, 0x00000000, 0x00000000, 0x00000000, 0x001C94F0,
+        0x007677A3, 0x004F3D3C, 0x0054CE32, 0x00000000, 0x00000000, 0x00000000, 0x00491330, 0x00676825,
+        0x00000000, 0x001010F7, 0x00000000, 0x00000000, 0x0075400A, 0x002FB3E6, 0x00000000, 0x007CC8FB,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 28
+    {
+        0x00000000, 0x0050662C, 0x00000000, 0x00000000, 0x00000000, 0x0020057D, 0x004D677E, 0x00000000,
+        0x00000000, 0x0043DEDB, 0x002DD60B, 0x006B1423, 0x00000000, 0x00000000, 0x001378E4, 0x005A024F,
+        0x00000000, 0x00026048, 0x00000000, 0x00000000, 0x006CB3C4, 0x00000000, 0x0018BE5D, 0x00000000,
+        0x00063A32, 0x00000000, 0x00000000, 0x00000000, 0x003DB88F, 0x0036F1B8, 0x000A37C5, 0x00000000,
+        0x004758A9, 0x00704622, 0x005F9A31, 0x00000000, 0x00000000, 0x002355F2, 0x000ECC25, 0x004E5413,
+        0x000C2318, 0x003AC15B, 0x00000000, 0x00000000, 0x001C3353, 0x00000000, 0x000882CB, 0x00328B7F,
+        0x0041624F, 0x00000000, 0x00785B8D, 0x00000000, 0x00000000, 0x002AB501, 0x005630F3, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00456CE2, 0x00559475,
+        0x00000000, 0x00000000, 0x00534B56, 0x00000000, 0x002F81A1, 0x003F70B1, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00751E3A, 0x00000000, 0x00318985, 0x00000000, 0x00000001, 0x00000000,
+        0x00399C32, 0x007B9CB4, 0x00485D17, 0x00737FE8, 0x00000000, 0x00280BC4, 0x00000000, 0x0024AAC6,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0010E052, 0x00636562,
+        0x00765189, 0x00000000, 0x001E0940, 0x00157445, 0x00607C4C, 0x007CFA83, 0x00000000, 0x00686155,
+        0x00000000, 0x007E25A6, 0x0066812C, 0x00260E54, 0x005C34D6, 0x001ABD37, 0x00653A52, 0x0035DD01,
+        0x00000000, 0x000524E9, 0x0016DB0D, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x005863C6, 0x00000000, 0x004A9FD6, 0x00000000, 0x00000000, 0x006E8DB9, 0x00000000,
+    },
+    {
+        0x0034681E, 0x005E945F, 0x00000000, 0x0050C46C, 0x00793A7B, 0x000AD246, 0x0063115B, 0x00000000,
+        0x00000000, 0x00033365, 0x00000000, 0x00000001, 0x0068389D, 0x00000000, 0x00000000, 0x006DE685,
+        0x00000000, 0x00000000, 0x00000000, 0x0021616E, 0x00000000, 0x00104732, 0x00000000, 0x00000000,
+        0x00000000, 0x00280820, 0x00336F9F, 0x00000000, 0x00701527, 0x00098AD0, 0x00462C4B, 0x00000000,
+        0x00000000, 0x00000000, 0x00224C66, 0x005B5A70, 0x00000000, 0x004E4757, 0x00000000, 0x00000000,
+        0x001BAA95, 0x00000000, 0x000758C3, 0x00376CF1, 0x00484B62, 0x0041B31E, 0x0054639E, 0x003B2CC5,
+        0x007FC3E9, 0x006563A9, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x005D6C5A, 0x00000000, 0x00000000, 0x00000000, 0x0045218E, 0x00000000, 0x00000000, 0x001DBD87,
+        0x00000000, 0x002BC974, 0x0016954E, 0x007683BD, 0x00000000, 0x0015B598, 0x00000000, 0x00000000,
+        0x00138625, 0x00000000, 0x006E1129, 0x00529CD4, 0x00000000, 0x00000000, 0x00000000, 0x006A5FF3,
+        0x001E6632, 0x002CD21A, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00678846, 0x00000000,
+        0x00000000, 0x00000000, 0x002F5B82, 0x0061F409, 0x00752807, 0x00000000, 0x00000000, 0x00053BDE,
+        0x00000000, 0x00000000, 0x007CCCFA, 0x003C8062, 0x00000000, 0x00000000, 0x00000000, 0x004DBF05,
+        0x00000000, 0x00429B2F, 0x00000000, 0x003EF063, 0x00000000, 0x000DEE55, 0x0059A912, 0x0019F925,
+        0x00269A58, 0x00000000, 0x00725FFC, 0x00000000, 0x007A9608, 0x003141FC, 0x0038CABC, 0x00000000,
+        0x00571B8D, 0x00000000, 0x0025DBAA, 0x00000000, 0x00000000, 0x004B42FF, 0x00000000, 0x000ECD9A,
+    },
+#endif
+#if LH2_POLYNOMIAL_COUNT > 30
+    {
+        0x00000001, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x003103C4, 0x00043431, 0x0026DC94,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x006F2EE3, 0x00000000, 0x006BCDEE, 0x00000000,
+        0x00000000, 0x002B0679, 0x00000000, 0x00000000, 0x00000000, 0x001AEF11, 0x00000000, 0x00118663,
+        0x00121F72, 0x0007C69A, 0x00000000, 0x0061F35B, 0x007B173F, 0x002131FA, 0x00000000, 0x005DAD30,
+        0x00000000, 0x00000000, 0x002CBD8C, 0x0016A227, 0x00785245, 0x0025CDBD, 0x00000000, 0x0056E30A,
+        0x00000000, 0x000E24F4, 0x002F60F2, 0x0059236D, 0x00000000, 0x00000000, 0x005AE600, 0x00000000,
+        0x0009F568, 0x00000000, 0x00000000, 0x003FB204, 0x00000000, 0x00000000, 0x00000000, 0x00446A08,
+        0x00000000, 0x006D0694, 0x00000000, 0x0062B856, 0x006479AB, 0x003A098B, 0x00000000, 0x00398412,
+        0x000A1D62, 0x007FD23E, 0x003C83D2, 0x00000000, 0x00734474, 0x00000000, 0x00000000, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0023B65E, 0x004D52C9, 0x00000000, 0x0068897F,
+        0x00000000, 0x00000000, 0x0015E705, 0x00428DFC, 0x00665629, 0x00000000, 0x00000000, 0x004B3C38,
+        0x0046190E, 0x00295587, 0x00000000, 0x0075F330, 0x00000000, 0x00000000, 0x00538E31, 0x004830CD,
+        0x00000000, 0x00000000, 0x00000000, 0x001EAC25, 0x0040831E, 0x00000000, 0x00000000, 0x0051420A,
+        0x000DAE8D, 0x004F3193, 0x0077E6CB, 0x00000000, 0x00000000, 0x001D4BEC, 0x00000000, 0x003304FF,
+        0x00000000, 0x00000000, 0x00710FC6, 0x00356FBD, 0x00000000, 0x00000000, 0x00000000, 0x00000000,
+        0x005F68A6, 0x005410B6, 0x00186EB2, 0x00000000, 0x007CD522, 0x00000000, 0x0036E1EA, 0x0003D564,
+    },
+    {
+        0x003BFC31, 0x00000000, 0x00000000, 0x001D747F, 0x00000000, 0x00000000, 0x000F58B6, 0x00000000,
+        0x00000000, 0x00000000, 0x000D23C4, 0x00000000, 0x00000000, 0x007A2F39, 0x00000000, 0x0062ACA0,
+        0x005D105B, 0x002039B2, 0x00000000, 0x00000000, 0x00224C34, 0x0056D978, 0x00376E6E, 0x005EB3AD,
+        0x00000000, 0x00000000, 0x000AF37C, 0x00000000, 0x003924A3, 0x00000000, 0x00000000, 0x0024A972,
+        0x0048775E, 0x00689565, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x0058C9F5, 0x00000000,
+        0x00000000, 0x00062091, 0x00000000, 0x00120A5F, 0x006F1F82, 0x00000000, 0x00000000, 0x00036D4A,
+        0x00656B58, 0x0009AD77, 0x00000000, 0x00000000, 0x00000000, 0x004FA210, 0x0005357C, 0x007DF5ED,
+        0x00000000, 0x003F0FA4, 0x005B7014, 0x00000000, 0x0071B98C, 0x0019CFEF, 0x00000000, 0x00000000,
+        0x00000000, 0x00612A58, 0x00000000, 0x002DE95A, 0x006653DC, 0x00000000, 0x006AADB6, 0x0077B4AF,
+        0x003CB0EC, 0x007F6060, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00270C7A,
+        0x00000000, 0x00000000, 0x00000000, 0x004CF5D9, 0x00000001, 0x00000000, 0x002A42EA, 0x00000000,
+        0x00000000, 0x00000000, 0x0050C155, 0x0073E65A, 0x00000000, 0x002E1AFA, 0x0075AB2F, 0x00780C59,
+        0x00000000, 0x00000000, 0x00558E8A, 0x0030369B, 0x00000000, 0x00000000, 0x00000000, 0x003330D0,
+        0x00142F01, 0x0047C8BB, 0x00351215, 0x00000000, 0x004BA0F6, 0x00000000, 0x00000000, 0x0043FDC5,
+        0x0053BDC3, 0x00000000, 0x004456B5, 0x001E0578, 0x00000000, 0x0010EA7C, 0x004133B7, 0x00000000,
+        0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00295144, 0x001A1227, 0x006C453D, 0x00165CB0,
+    },
+#endif
+};
+#endif
+
+#endif /* __LH2_CHECKPOINTS_H */
@@ -19,33 +19,67 @@
 #include "gpio.h"
 #include "lh2.h"
 #include "timer_hf.h"
+#if defined(LH2_PROFILING) && !defined(__arm__)
+#include <time.h>
+#endif
+#if LH2_LFSR_SOLVER_BABY_STEPS == 0
+// Searched in the include path, so that the tables generated in build/include by make lh2-checkpoints replace these of bsp/nrf
+#include <lh2_checkpoints.h>
+#endif
 
 //=========================== defines =========================================
 
 #define SPIM_INTERRUPT_PRIORITY                2                                                              ///< Interrupt priority, as high as it will go
-#define SPI_BUFFER_SIZE                        64                                                             ///< Size of buffers used for SPI communications
+#define SPI_BUFFER_SIZE                        LH2_CAPTURE_SIZE                                               ///< Size of buffers used for SPI communications
 #define SPI_FAKE_SCK_PIN                       6                                                              ///< NOTE: SPIM needs an SCK pin to be defined, P1.6 is used because it's not an available pin in the BCM module.
 #define SPI_FAKE_SCK_PORT                      1                                                              ///< NOTE: SPIM needs an SCK pin to be defined, P1.6 is used because it's not an available pin in the BCM module.
 #define FUZZY_CHIP                             0xFF                                                           ///< not sure what this is about
 #define LH2_LOCATION_ERROR_INDICATOR           0xFFFFFFFF                                                     ///< indicate the location value is false
 #define LH2_POLYNOMIAL_ERROR_INDICATOR         0xFF                                                           ///< indicate the polynomial index is invalid
 #define POLYNOMIAL_BIT_ERROR_INITIAL_THRESHOLD 4                                                              ///< initial threshold of polynomial error
-#define LH2_BUFFER_SIZE                        10                                                             ///< Amount of lh2 frames the buffer can contain
+#define LH2_BUFFER_SIZE                        16                                                             ///< Amount of lh2 frames the buffer can contain, one of them is always reserved for the ongoing SPI capture (power of two)
+#define LH2_BUFFER_MASK                        (LH2_BUFFER_SIZE - 1)                                          ///< Mask selecting a slot of the capture ring buffer from a head or tail counter
 #define GPIOTE_CH_IN_ENV_HiToLo                1                                                              ///< falling edge gpio channel
 #define GPIOTE_CH_IN_ENV_LoToHi                2                                                              ///< rising edge gpio channel
 #define PPI_SPI_START_CHAN                     2                                                              ///< PPI channel for starting the GPIOTE to SPI capture ppi
 #define PPI_SPI_GROUP                          0                                                              ///< PPI group for automatically dissabling the ppi after a successful spi capture
-#define HASH_TABLE_BITS                        11                                                             ///< How many bits will be used for the hashtable for the _end_buffers
-#define HASH_TABLE_SIZE                        (1 << HASH_TABLE_BITS)                                         ///< How big will the hashtable for the _end_buffers
-#define HASH_TABLE_MASK                        ((1 << HASH_TABLE_BITS) - 1)                                   ///< Mask selecting the HAS_TABLE_BITS least significant bits
-#define NUM_LSFR_COUNT_CHECKPOINTS             64                                                             ///< How many lsfr checkpoints are per polynomial
-#define DISTANCE_BETWEEN_LSFR_CHECKPOINTS      2048                                                           ///< How many lsfr checkpoints are per polynomial
-#define CHECKPOINT_TABLE_BITS                  6                                                              ///< How many bits will be used for the checkpoint table for the lfsr search
-#define CHECKPOINT_TABLE_MASK_LOW              ((1 << CHECKPOINT_TABLE_BITS) - 1)                             ///< How big will the checkpoint table for the lfsr search
-#define CHECKPOINT_TABLE_MASK_HIGH             (((1 << CHECKPOINT_TABLE_BITS) - 1) << CHECKPOINT_TABLE_BITS)  ///< Mask selecting the CHECKPOINT_TABLE_BITS least significant bits
 #define LH2_MAX_DATA_VALID_TIME_US             2000000                                                        //< Data older than this is considered outdate and should be erased (in microseconds)
 #define LH2_SWEEP_PERIOD_US                    20000                                                          ///< time, in microseconds, between two full rotations of the LH2 motor
 #define LH2_SWEEP_PERIOD_THRESHOLD_US          1000                                                           ///< How close a LH2 pulse must arrive relative to LH2_SWEEP_PERIOD_US, to be considered the same type of sweep (first sweep or second second). (in microseconds)
+#define LH2_LFSR_PERIOD                        131071                                                         ///< Period of the 17-bit maximum length LFSRs (2^17 - 1)
+#define LH2_LFSR_WIDTH                         17                                                             ///< Number of bits in the state of the LH2 LFSRs
+#define POLYNOMIAL_LANES_MASK                  ((uint32_t)((1ULL << LH2_POLYNOMIAL_COUNT) - 1))               ///< One bit lane per polynomial in the bit-sliced polynomial search
+#if LH2_POLYNOMIAL_COUNT > 32
+#error "The bit-sliced polynomial search supports at most 32 polynomials"
+#endif
+#if LH2_LFSR_SOLVER_BABY_STEPS > 0
+#if (LH2_LFSR_SOLVER_BABY_STEPS & (LH2_LFSR_SOLVER_BABY_STEPS - 1)) != 0
+#error "LH2_LFSR_SOLVER_BABY_STEPS must be a power of two"
+#endif
+#define LFSR_BSGS_GIANT_STEPS  ((LH2_LFSR_PERIOD + LH2_LFSR_SOLVER_BABY_STEPS - 1) / LH2_LFSR_SOLVER_BABY_STEPS)  ///< Max number of giant steps needed to find any LFSR state
+#define LFSR_BSGS_TABLE_SIZE   (2 * LH2_LFSR_SOLVER_BABY_STEPS)                                                 ///< Size of the baby-step hash table, kept half empty so probing stays short
+#define LFSR_BSGS_TABLE_MASK   (LFSR_BSGS_TABLE_SIZE - 1)                                                       ///< Mask selecting a slot of the baby-step hash table
+#define LFSR_BSGS_INDEX_POS    17                                                                               ///< Position of the baby-step index in a hash table entry, the LFSR state uses the 17 lower bits
+#define LFSR_BSGS_JUMP_NIBBLES 5                                                                                ///< Number of 4-bit chunks needed to cover a 17-bit LFSR state
+#define LFSR_BSGS_GIANT_COST   2                                                                                ///< Cost of a giant step, in steps of the checkpoint search
+#define LH2_TABLES_RAM_BYTES   (LH2_POLYNOMIAL_COUNT * (LFSR_BSGS_TABLE_SIZE + LFSR_BSGS_JUMP_NIBBLES * 16) * 4)         ///< RAM used by the solver tables
+#define LH2_TABLES_FLASH_BYTES 0                                                                                ///< Flash used by the solver tables
+#define LH2_SOLVER_MAX_STEPS   (LFSR_BSGS_GIANT_STEPS * LFSR_BSGS_GIANT_COST)                                   ///< Worst case cost of a lookup, in steps of the checkpoint search
+#else
+#if LH2_POLYNOMIAL_COUNT > LH2_CHECKPOINT_POLYNOMIALS
+#error "lh2_checkpoints.h lacks polynomials, regenerate it with dist/scripts/lh2_checkpoints/lh2_checkpoints.py"
+#endif
+#define LH2_TABLES_RAM_BYTES   (LH2_POLYNOMIAL_COUNT * LH2_SWEEP_COUNT * 8)           ///< RAM used by the dynamic checkpoints, the checkpoint tables are in flash
+#define LH2_TABLES_FLASH_BYTES (LH2_POLYNOMIAL_COUNT * LH2_CHECKPOINT_FLASH_BYTES)  ///< Flash used by the checkpoint tables
+#define LH2_SOLVER_MAX_STEPS   (LH2_CHECKPOINT_SPACING / 2)                         ///< Worst case cost of a lookup, a checkpoint is at most half the spacing away in one direction
+#endif
+#if LH2_TABLES_RAM_BYTES > LH2_RAM_BUDGET
+#error "The LH2 decoding tables exceed LH2_RAM_BUDGET, reduce LH2_LFSR_SOLVER_BABY_STEPS or set it to 0"
+#endif
+#if LH2_SOLVER_MAX_STEPS > LH2_LFSR_SOLVER_STEP_BUDGET
+#error "A lookup of the LFSR solver exceeds LH2_LFSR_SOLVER_STEP_BUDGET, use more baby steps or denser checkpoints"
+#endif
+#define LH2_LFSR_SEED 0x00001  ///< State of all the LFSRs at count 0
 #if defined(NRF5340_XXAA) && defined(NRF_APPLICATION)
 #define LH2_TIMER_DEV 2  ///< Timer device used for LH2
 #else
@@ -69,22 +103,54 @@
 #define SPIM_IRQ_HANDLER SPIM3_IRQHandler
 #endif
 
+#if (LH2_BUFFER_SIZE & LH2_BUFFER_MASK) != 0 || LH2_BUFFER_SIZE > 128
+#error "LH2_BUFFER_SIZE must be a power of two, not larger than 128"
+#endif
+
+#if defined(LH2_PROFILING)
+#if defined(__arm__)
+#define LH2_PROFILING_NOW() (DWT->CYCCNT)  ///< Cycle counter used to measure the pipeline stages
+#else
+#define LH2_PROFILING_NOW() _lh2_profiling_host_now()  ///< Host stand-in of the cycle counter, in nanoseconds
+#endif
+#define LH2_PROFILING_START(start)       uint32_t start = LH2_PROFILING_NOW()                      ///< Start measuring a pipeline stage
+#define LH2_PROFILING_STOP(stage, start) _lh2_profiling_record(stage, LH2_PROFILING_NOW() - start)  ///< Record the duration of a pipeline stage
+#else
+#define LH2_PROFILING_START(start)        ///< Compiled out without LH2_PROFILING
+#define LH2_PROFILING_STOP(stage, start)  ///< Compiled out without LH2_PROFILING
+#endif
+
+/// Single producer (SPIM interrupt), single consumer (main loop) ring of SPI captures
 typedef struct {
-    uint8_t  buffer[LH2_BUFFER_SIZE][SPI_BUFFER_SIZE];  ///< arrays of bits for local storage, contents of SPI transfer are copied into this
-    uint32_t timestamps[LH2_BUFFER_SIZE];               ///< arrays of timestamps of when different SPI transfers happened
-    uint8_t  write_index;                               // Index for next write
-    uint8_t  read_index;                                // Index for next read
-    uint8_t  count;                                     // Number of arrays in buffer
+    uint8_t          buffer[LH2_BUFFER_SIZE][SPI_BUFFER_SIZE];  ///< arrays of bits for local storage, the SPIM EasyDMA writes directly into the slot at head
+    uint32_t         timestamps[LH2_BUFFER_SIZE];               ///< arrays of timestamps of when different SPI transfers happened
+    volatile uint8_t head;                                      ///< number of captures written (wrapping), only modified by the SPIM interrupt
+    volatile uint8_t tail;                                      ///< number of captures consumed (wrapping), only modified by the main loop
+    volatile bool    full;                                      ///< the ring is full and the SPIM is overwriting the slot at head
+    uint32_t         overflows;                                 ///< number of times the ring got full
+    uint32_t         dropped;                                   ///< number of captures lost because the ring was full
 } lh2_ring_buffer_t;
 
+/// Duration measures of one pipeline stage
+typedef struct {
+    uint32_t count;                                ///< number of measures
+    uint32_t min;                                  ///< shortest duration
+    uint32_t max;                                  ///< longest duration
+    uint64_t total;                                ///< sum of the durations
+    uint16_t histogram[LH2_STATS_HISTOGRAM_BINS];  ///< number of measures per log2 bucket of duration
+} lh2_stage_profile_t;
+
 typedef struct {
-    uint8_t           spi_rx_buffer[SPI_BUFFER_SIZE];  ///< buffer where data coming from SPI are stored
-    lh2_ring_buffer_t data;                            ///< array containing demodulation data of each locations
+    lh2_ring_buffer_t data;  ///< array containing demodulation data of each locations
+#if defined(LH2_PROFILING)
+    lh2_stage_profile_t profiles[DB_LH2_STAGE_COUNT];  ///< duration measures of each pipeline stage
+#endif
 } lh2_vars_t;
 
 //=========================== variables ========================================
 
-static const uint32_t _polynomials[LH2_POLYNOMIAL_COUNT] = {
+/// Polynomials of the 16 basestation channels, two per channel. Only the first LH2_POLYNOMIAL_COUNT are searched.
+static const uint32_t _polynomials[32] = {
     0x0001D258,
     0x00017E04,
     0x0001FF6B,
@@ -93,553 +159,46 @@ static const uint32_t _polynomials[LH2_POLYNOMIAL_COUNT] = {
     0x000198D1,
     0x000178C7,
     0x00018A55,
+    0x00015777,
+    0x0001D911,
+    0x00015769,
+    0x0001991F,
+    0x00012BD0,
+    0x0001CF73,
+    0x0001365D,
+    0x000197F5,
+    0x000194A0,
+    0x0001B279,
+    0x00013A34,
+    0x0001AE41,
+    0x000180D4,
+    0x00017891,
+    0x00012E64,
+    0x00017C72,
+    0x00019C6D,
+    0x00013F32,
+    0x0001AE14,
+    0x00014E76,
+    0x00013C97,
+    0x000130CB,
+    0x00013750,
+    0x0001CB8D,
 };
 
-static const uint32_t _end_buffers[LH2_POLYNOMIAL_COUNT][NUM_LSFR_COUNT_CHECKPOINTS] = {
-    {
-        // p0
-        0x00000000000000001,  // [0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1] starting seed, little endian
-        0b10000000000011010,
-        0b10000001010110001,
-        0b10111000000110000,
-        0b10101010110011101,
-        0b10100001010111011,
-        0b01011000111100110,
-        0b00011011100000011,
-        0b10001010101011010,
-        0b01001010001111101,
-        0b00010010100011000,
-        0b00000100111000011,
-        0b11001100100000010,
-        0b00111111101111011,
-        0b10110010010110001,
-        0b01110001000110111,
-        0b01100101100011111,
-        0b11010001101010100,
-        0b00011011101110011,
-        0b10001110100000011,
-        0b10010001101011110,
-        0b11011011010100011,
-        0b11011111100110001,
-        0b00010100010110011,
-        0b10100011001011111,
-        0b00111110110000100,
-        0b10001100001010011,
-        0b11100011011100000,
-        0b11110001010110001,
-        0b11101000000111110,
-        0b00011010010010011,
-        0b10101010010100101,
-        0b10111000110011011,
-        0b10111111000001001,
-        0b00101101110010101,
-        0b10100100100011100,
-        0b10100110100011110,
-        0b11001000101110010,
-        0b11100111100101101,
-        0b00111101010100010,
-        0b11001101100010000,
-        0b00001001001100101,
-        0b10001010111010001,
-        0b01000111000001001,
-        0b01000101110011111,
-        0b00111100011000011,
-        0b11111111000001001,
-        0b11101101110000010,
-        0b11100101011110101,
-        0b01000010100110110,
-        0b10110111000100001,
-        0b10010110011001011,
-        0b01001001110110111,
-        0b01011011110010010,
-        0b01000110110010010,
-        0b01100101110010010,
-        0b11011100110011101,
-        0b01000011010111101,
-        0b10010110101000000,
-        0b01011111011001111,
-        0b10000110101101011,
-        0b00101100111011001,
-        0b10010101110100110,
-        0b00001110011011111,
-    },
-    {
-        // p1
-        0x00000000000000001,  // [0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1] starting seed, little endian
-        0b00000001111100000,
-        0b11111111000111010,
-        0b10111000111011000,
-        0b11010000110111110,
-        0b10001100001111010,
-        0b10010111100011101,
-        0b10011100011010010,
-        0b10110111100111100,
-        0b11101101100100000,
-        0b11110110110010101,
-        0b01110110111101110,
-        0b11000010101101111,
-        0b01101111000011101,
-        0b01000000000111001,
-        0b01010101101000101,
-        0b00101110001101110,
-        0b11010000111010000,
-        0b00001100001001010,
-        0b11011100001000011,
-        0b01000011000110100,
-        0b00001101001011100,
-        0b11010100111100011,
-        0b10100011000111100,
-        0b00010001010011110,
-        0b01011011010101010,
-        0b10101110010010010,
-        0b10100001010111011,
-        0b10100101111010001,
-        0b01010111100110110,
-        0b11110110001100000,
-        0b10000101000110111,
-        0b10011000000100001,
-        0b00110001110110000,
-        0b10100001010001101,
-        0b11100111111101000,
-        0b01110011011010110,
-        0b11010000101111011,
-        0b10101001001000100,
-        0b00010000111001111,
-        0b00100011101000011,
-        0b00110110001000011,
-        0b11110011101001111,
-        0b10100101011110000,
-        0b10111011010000101,
-        0b11001010000111101,
-        0b11101011111010011,
-        0b00000001110111100,
-        0b00110010100110110,
-        0b00101111010110001,
-        0b11101110010000001,
-        0b10011100010011101,
-        0b01000111111100110,
-        0b01100111101100011,
-        0b10100100000010011,
-        0b11011100110100101,
-        0b10001101000111011,
-        0b01001010000111000,
-        0b11100110011110111,
-        0b11111000000100100,
-        0b00111100110011100,
-        0b11011000110000110,
-        0b00011011111011000,
-        0b10011000101010001,
-    },
-    {
-        // p2
-        0x00000000000000001,  // [0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1] starting seed, little endian
-        0b11001110010011010,
-        0b00111011100000111,
-        0b10011010101111011,
-        0b00011011011000100,
-        0b01100001111001001,
-        0b00100011000101100,
-        0b01110100001110110,
-        0b01011101010010110,
-        0b00011111001011100,
-        0b11111101101001011,
-        0b00110100010100010,
-        0b11001011001101010,
-        0b01100110111001010,
-        0b01000010000110001,
-        0b00011011111101001,
-        0b01110001111011010,
-        0b01011010100110111,
-        0b10010110101101111,
-        0b01001001010111011,
-        0b10110110011111010,
-        0b10010001010110000,
-        0b11001011000000110,
-        0b00001011000001000,
-        0b10110001110000001,
-        0b11111010001101100,
-        0b01110110010001010,
-        0b00100000010110111,
-        0b10001001011101001,
-        0b00100101110000111,
-        0b10001100100001100,
-        0b10000011101111100,
-        0b00000010011101011,
-        0b01010000011010001,
-        0b01011110000100010,
-        0b00100100000010110,
-        0b01100010101111011,
-        0b01101010010110001,
-        0b00110111001111111,
-        0b11010110101011110,
-        0b00111000001101111,
-        0b01000010110010001,
-        0b01010110110011001,
-        0b00110011110100111,
-        0b10101011100111000,
-        0b11010010001000100,
-        0b11001011111100111,
-        0b01001000000110001,
-        0b01111110101111111,
-        0b01111000110111110,
-        0b11101100001001001,
-        0b00011010000000010,
-        0b01000011110101010,
-        0b11111111111010011,
-        0b10001011001010010,
-        0b00100100100111000,
-        0b01001011100000011,
-        0b11111101110110110,
-        0b10111111010001011,
-        0b10101111001100000,
-        0b00010110111101110,
-        0b10100010011011000,
-        0b01111001011100111,
-        0b10000110110011101,
-    },
-    {
-        // p3
-        0x00000000000000001,  // [0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1] starting seed, little endian
-        0b00101100000100010,
-        0b10001100001111000,
-        0b10001110100110011,
-        0b11011011110010110,
-        0b00010010100101011,
-        0b01001100111011111,
-        0b00110011010010101,
-        0b11000100000001101,
-        0b01010011010101100,
-        0b01111100110100001,
-        0b10011011011110001,
-        0b11100011000010110,
-        0b00010000010000010,
-        0b10110110011111000,
-        0b00110111011100001,
-        0b00011111010001100,
-        0b00000101100001100,
-        0b01011000011110010,
-        0b10111011011111111,
-        0b11000001011110011,
-        0b11011000000000011,
-        0b00011011000101100,
-        0b10100101100010011,
-        0b10011101110001010,
-        0b11110010001000101,
-        0b10001011101110001,
-        0b01010010000000110,
-        0b00001011001111000,
-        0b10000000110111001,
-        0b00010001010100001,
-        0b10100111110001010,
-        0b00111100010000101,
-        0b11001101011101111,
-        0b11000010010010010,
-        0b01100010001001001,
-        0b01001111001010100,
-        0b10000000010000100,
-        0b11010011011101100,
-        0b01000111000101000,
-        0b01011010010110011,
-        0b10100000101001111,
-        0b10101110100001100,
-        0b00010101100111011,
-        0b11111101010001100,
-        0b01100000101101000,
-        0b10001011110011100,
-        0b10001100100101101,
-        0b00110101011011111,
-        0b11010110000110010,
-        0b11101011101110000,
-        0b00010111001011011,
-        0b01110110010101011,
-        0b00111001000001010,
-        0b10111101110100011,
-        0b11001111000000011,
-        0b00010000110100010,
-        0b01111110100101011,
-        0b00011001010001101,
-        0b11111001111101101,
-        0b00010111110101110,
-        0b10011101110100010,
-        0b10011100001001111,
-        0b00101011101001101,
-    },
-    {
-        // p4
-        0x00000000000000001,  // [0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1] starting seed, little endian
-        0b00111101010111100,
-        0b01010011100100100,
-        0b01100001100011000,
-        0b11000011111110101,
-        0b00100100011111011,
-        0b00010000110000011,
-        0b10001000111100101,
-        0b01111110000100101,
-        0b11010110111101011,
-        0b01110001000011100,
-        0b10101100100110100,
-        0b01011100011111100,
-        0b11001111011011111,
-        0b00100101010010110,
-        0b00010011000100100,
-        0b11001000111100000,
-        0b10110111000100001,
-        0b00110000001111000,
-        0b10101100001001111,
-        0b00010001010010110,
-        0b01001001110100010,
-        0b01010001110000110,
-        0b00101110010101101,
-        0b00100010100111011,
-        0b01000010110100110,
-        0b01110110111010010,
-        0b10101110001110110,
-        0b10111101100101000,
-        0b01000010111011011,
-        0b11010100011001110,
-        0b01010011110010111,
-        0b01000101010111010,
-        0b11110110100000001,
-        0b01101011000100010,
-        0b01101101111000101,
-        0b10111101100011011,
-        0b10011110001001000,
-        0b00110101110101111,
-        0b10011111101011101,
-        0b11110100111101000,
-        0b10110000011111110,
-        0b00001100010101110,
-        0b11100011111011001,
-        0b11100010000111100,
-        0b11001001011110111,
-        0b10000011010010101,
-        0b01010001101001001,
-        0b11010010101101010,
-        0b01001101001100111,
-        0b00110110011011100,
-        0b00111000010100101,
-        0b01101100110010010,
-        0b01000010000010001,
-        0b01001000111110101,
-        0b10101110010001100,
-        0b11111000100010000,
-        0b10111001000011000,
-        0b00100101111101011,
-        0b00111011000100010,
-        0b00111011101100011,
-        0b10001010110100100,
-        0b10011010101100001,
-        0b10111100101010110,
-    },
-    {
-        // p5
-        0x00000000000000001,  // [0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1] starting seed, little endian
-        0b10000110010011101,
-        0b10010100110011101,
-        0b11101111001011001,
-        0b11001000010011110,
-        0b01111111110111110,
-        0b00100011010001111,
-        0b01011101110101000,
-        0b10011010101100010,
-        0b00111101111110011,
-        0b00110010000110101,
-        0b10100111011001111,
-        0b01100111010001011,
-        0b00100010110011110,
-        0b00011010000101110,
-        0b11001001101001100,
-        0b11011011100110100,
-        0b00000010111000100,
-        0b11111011010010001,
-        0b00100100000011000,
-        0b01001000001001100,
-        0b10111011101111001,
-        0b00111001100101000,
-        0b00111011000011100,
-        0b11000001001111010,
-        0b10010010011100111,
-        0b11000001101100001,
-        0b11010010110000101,
-        0b11001000010010000,
-        0b00010111101011110,
-        0b01000110001101000,
-        0b01110001010000100,
-        0b10001110110110000,
-        0b00111111101100011,
-        0b01000000111011101,
-        0b11000001100011101,
-        0b11111001001100101,
-        0b10000110101001011,
-        0b01011111100010011,
-        0b11110001000101010,
-        0b01100001010010111,
-        0b01101011100011111,
-        0b01101110000100100,
-        0b00101101001000111,
-        0b01000110101100010,
-        0b10010000010110000,
-        0b01111011100011110,
-        0b00110011110101011,
-        0b11010011000101000,
-        0b01011110110001100,
-        0b00101011110111001,
-        0b00010100001111011,
-        0b01011001111000111,
-        0b00010100011100111,
-        0b11011110010111101,
-        0b11111000111011101,
-        0b10011010110011010,
-        0b01101010000110010,
-        0b10101111110000010,
-        0b00110111001010101,
-        0b00001001000001110,
-        0b00000010110111000,
-        0b11010000101110001,
-        0b01101010111000011,
-    },
-    {
-        // p6
-        0x00000000000000001,  // [0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1] starting seed, little endian
-        0b00010010000111001,
-        0b01001101111111100,
-        0b00010100111011111,
-        0b01110110101110110,
-        0b01010101000001110,
-        0b00111001110010110,
-        0b00011000111001010,
-        0b00111111000100011,
-        0b00111010001001001,
-        0b10010001101110110,
-        0b10011110001110100,
-        0b10011010110110011,
-        0b11110010100110101,
-        0b11100001000101111,
-        0b11010000111111101,
-        0b11110001001110000,
-        0b10010001111000110,
-        0b10100011001000001,
-        0b10001000011101000,
-        0b10001101001000111,
-        0b11100111010110100,
-        0b00001010100010001,
-        0b01110010010010001,
-        0b01001000110110000,
-        0b01011010000010000,
-        0b01100110100001100,
-        0b10111001000100001,
-        0b01000011100101101,
-        0b10111010001110010,
-        0b11011001111000001,
-        0b10110000010001111,
-        0b00100110001001001,
-        0b11000011000110001,
-        0b11110011100010110,
-        0b01011101101010000,
-        0b11001011101000100,
-        0b11100001011010110,
-        0b11111111100000101,
-        0b10000100111001101,
-        0b11001011011100111,
-        0b11101110011001010,
-        0b11001100100001001,
-        0b10001001000101101,
-        0b11001101100101000,
-        0b01011001111000100,
-        0b01111010110011010,
-        0b00110011110100011,
-        0b00100011001101100,
-        0b11101010000001011,
-        0b11110100100010110,
-        0b11011011000111000,
-        0b01011101001100000,
-        0b11000100010110001,
-        0b10000111011101111,
-        0b10010001111111101,
-        0b11111001011001111,
-        0b11101011111101111,
-        0b00100101001100010,
-        0b10100000011000110,
-        0b01001101000100110,
-        0b11000110110101010,
-        0b01101010101001110,
-        0b00010101100100011,
-    },
-    {
-        // p7
-        0x00000000000000001,  // [0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1] starting seed, little endian
-        0b11111111111001011,
-        0b10101101101100110,
-        0b00100101101010000,
-        0b01000010111001111,
-        0b10010001000110001,
-        0b10010100011110001,
-        0b10010110111000011,
-        0b00011111000011111,
-        0b00011000111000111,
-        0b01101000010001001,
-        0b00001010011011000,
-        0b00100101010100111,
-        0b01110010111010110,
-        0b00101101000111111,
-        0b11111010001011001,
-        0b10001110011000110,
-        0b10010110011101110,
-        0b11001101111111010,
-        0b01001101110010110,
-        0b01000011011111110,
-        0b11101100100011100,
-        0b10000101011010011,
-        0b11111111100101101,
-        0b01001001000001101,
-        0b11001101110001101,
-        0b01000000110011101,
-        0b11000001101011011,
-        0b01110011110100100,
-        0b01110011011101110,
-        0b01010001111111000,
-        0b01011101100100000,
-        0b10010000110101010,
-        0b11111001001110010,
-        0b10000001100101101,
-        0b10000001000010111,
-        0b01010001101010011,
-        0b10110010100011000,
-        0b11001101110101011,
-        0b01000101000110100,
-        0b00011011000110101,
-        0b10101100110101110,
-        0b10010110011010111,
-        0b00110100110001110,
-        0b11001100101110100,
-        0b11110100100010010,
-        0b11011011001101110,
-        0b10100101000101111,
-        0b10011000101101111,
-        0b10000111001010110,
-        0b01001100000100100,
-        0b00101010011110001,
-        0b10100001000111100,
-        0b11010101101110010,
-        0b11111000011101010,
-        0b11000101010011110,
-        0b11110100001010000,
-        0b00000111000000100,
-        0b01000100101100001,
-        0b01101001011000111,
-        0b01010010010011110,
-        0b10001111110000100,
-        0b11100110010111101,
-        0b10000101011010000,
-    },
-};
-
-static uint16_t _end_buffers_hashtable[HASH_TABLE_SIZE] = { 0 };
-
+#if LH2_LFSR_SOLVER_BABY_STEPS == 0
 // Dynamic checkpoint
 static uint32_t _lfsr_checkpoint_bits[LH2_POLYNOMIAL_COUNT][LH2_SWEEP_COUNT]  = { 0 };  ///<
 static uint32_t _lfsr_checkpoint_count[LH2_POLYNOMIAL_COUNT][LH2_SWEEP_COUNT] = { 0 };
 static uint32_t _lsfr_checkpoint_average                                      = 0;
+#else
+// Baby-step/giant-step LFSR solver tables, computed once at init
+static uint32_t _lfsr_baby_steps[LH2_POLYNOMIAL_COUNT][LFSR_BSGS_TABLE_SIZE];          ///< hash table of the states reached after [0, LH2_LFSR_SOLVER_BABY_STEPS) steps from the seed, entries are (index << 17) | state
+static uint32_t _lfsr_jump_table[LH2_POLYNOMIAL_COUNT][LFSR_BSGS_JUMP_NIBBLES][16];  ///< jump matrix moving a state LH2_LFSR_SOLVER_BABY_STEPS steps backward, split in per-nibble lookup tables
+#endif
+
+// Bit-sliced polynomial search, bit i of each word belongs to polynomial i
+static uint32_t _polynomial_taps[LH2_LFSR_WIDTH];                 ///< bit n of each polynomial, packed in one word per LFSR tap
+static uint8_t  _polynomial_search_order[LH2_POLYNOMIAL_COUNT];  ///< polynomial indexes, from the most to the least recently identified
 
 ///! NOTE: SPIM needs an SCK pin to be defined, P1.6 is used because it's not an available pin in the BCM module
 static const gpio_t _lh2_spi_fake_sck_gpio = {
@@ -670,7 +229,7 @@ void _initialize_ts4231(const gpio_t *gpio_d, const gpio_t *gpio_e);
 
 /**
  * @brief
- * @param[in] sample_buffer: SPI samples loaded into a local buffer
+ * @param[in] sample_buffer: SPI_BUFFER_SIZE bytes of SPI samples, demodulated as if followed by as many bytes of silence
  * @return chipsH: 64-bits of demodulated data
  */
 uint64_t _demodulate_light(uint8_t *sample_buffer);
@@ -696,6 +255,26 @@ uint64_t _poly_check(uint32_t poly, uint32_t bits, uint8_t numbits);
  */
 uint8_t _determine_polynomial(uint64_t chipsH1, int8_t *start_val);
 
+/**
+ * @brief run all the polynomial LFSRs forward at once from the same seed, one bit lane per polynomial,
+ *        and count how many generated bits differ from the demodulated ones
+ *
+ * @param[in] seed: 17-bit starting state, shared by all the polynomials
+ * @param[in] expected: demodulated bits following the seed, the first generated bit is compared with bit numbits-1
+ * @param[in] numbits: number of bits to generate
+ * @param[in] skipbits: number of generated bits, at the beginning, which are not compared
+ * @param[in] threshold: maximum number of differing bits (at most 7)
+ *
+ * @return index of the polynomial with the fewest differing bits, ties going to the most recently identified one,
+ *         or LH2_POLYNOMIAL_ERROR_INDICATOR if all polynomials are above threshold
+ */
+uint8_t _bitsliced_poly_search(uint32_t seed, uint64_t expected, uint8_t numbits, uint8_t skipbits, uint8_t threshold);
+
+/**
+ * @brief fill the per-tap words used by the bit-sliced polynomial search and reset the polynomial search order
+ */
+void _fill_polynomial_taps(void);
+
 /**
  * @brief counts the number of 1s in a 64-bit
  *
@@ -705,6 +284,7 @@ uint8_t _determine_polynomial(uint64_t chipsH1, int8_t *start_val);
  */
 uint64_t _hamming_weight(uint64_t bits_in);
 
+#if LH2_LFSR_SOLVER_BABY_STEPS == 0
 /**
  * @brief finds the position of a 17-bit sequence (bits) in the sequence generated by polynomial3 with initial seed 1
  *
@@ -714,6 +294,23 @@ uint64_t _hamming_weight(uint64_t bits_in);
  * @return count: location of the sequence
  */
 uint32_t _reverse_count_p(uint8_t index, uint32_t bits);
+#else
+/**
+ * @brief fills the baby-step hash tables and the giant-step jump matrices of every polynomial.
+ */
+void _fill_bsgs_tables(void);
+
+/**
+ * @brief finds the position of a 17-bit sequence (bits) in the sequence generated by a polynomial with initial seed 1,
+ *        using a baby-step/giant-step search bounded to LFSR_BSGS_GIANT_STEPS lookups
+ *
+ * @param[in] index: index of polynomial
+ * @param[in] bits: 17-bit sequence
+ *
+ * @return count: location of the sequence, or LH2_LOCATION_ERROR_INDICATOR if bits is not a valid LFSR state
+ */
+uint32_t _reverse_count_p_bsgs(uint8_t index, uint32_t bits);
+#endif
 
 /**
  * @brief Set a gpio as an INPUT with no pull-up or pull-down
@@ -747,29 +344,43 @@ void _ppi_setup(void);
 void _spi_setup(const gpio_t *gpio_d);
 
 /**
- * @brief add one element to the ring buffer for spi captures
+ * @brief publish the capture the SPIM just wrote in the head slot of the ring buffer, or drop it if the ring buffer is full. Only called from the SPIM interrupt.
  *
  * @param[in]   cb          pointer to ring buffer structure
- * @param[in]   data        pointer to the data array to save in the ring buffer
  * @param[in]   timestamp   timestamp of when the LH2 measurement was taken. (taken with timer_hf_now())
+ *
+ * @return pointer to the slot where the SPIM must write the next capture
  */
-void _add_to_spi_ring_buffer(lh2_ring_buffer_t *cb, uint8_t *data, uint32_t timestamp);
+uint8_t *_add_to_spi_ring_buffer(lh2_ring_buffer_t *cb, uint32_t timestamp);
 
 /**
- * @brief retreive the oldest element from the ring buffer for spi captures
+ * @brief retreive the oldest element from the ring buffer for spi captures, without copying it. The slot stays reserved until _release_spi_ring_buffer() is called
  *
  * @param[in]    cb          pointer to ring buffer structure
- * @param[out]   data        pointer to the array where the ring buffer data will be saved
+ * @param[out]   data        pointer to the SPI_BUFFER_SIZE bytes of the capture, inside the ring buffer
  * @param[out]   timestamp   timestamp of when the LH2 measurement was taken. (taken with timer_hf_now())
+ *
+ * @return true if a capture was available, false if the ring buffer is empty
  */
-bool _get_from_spi_ring_buffer(lh2_ring_buffer_t *cb, uint8_t *data, uint32_t *timestamp);
+bool _get_from_spi_ring_buffer(lh2_ring_buffer_t *cb, uint8_t **data, uint32_t *timestamp);
 
 /**
- * @brief generates a hashtable from the LSFR checpoints and stores it in an array.
+ * @brief give the slot of the oldest element of the ring buffer back to the SPIM
  *
- * @param[in]   hash_table  pointer to the array where the hashtable will be stored
+ * @param[in]    cb          pointer to ring buffer structure
  */
-void _fill_hash_table(uint16_t *hash_table);
+void _release_spi_ring_buffer(lh2_ring_buffer_t *cb);
+
+#if LH2_LFSR_SOLVER_BABY_STEPS == 0
+/**
+ * @brief looks a LFSR state up in the checkpoint tables generated in lh2_checkpoints.h
+ *
+ * @param[in] index: index of polynomial
+ * @param[in] state: 17-bit LFSR state
+ *
+ * @return position of the checkpoint in the LFSR sequence, or LH2_LOCATION_ERROR_INDICATOR if state is not a checkpoint
+ */
+uint32_t _find_lfsr_checkpoint(uint8_t index, uint32_t state);
 
 /**
  * @brief Accesses the global tables _lfsr_checkpoint_hashtable & _lfsr_checkpoint_count
@@ -780,6 +391,7 @@ void _fill_hash_table(uint16_t *hash_table);
  * @param[in] count: position of the received laser sweep in the LSFR sequence
  */
 void _update_lfsr_checkpoints(uint8_t polynomial, uint32_t bits, uint32_t count);
+#endif
 
 /**
  * @brief LH2 sweeps come with an almost perfect 20ms difference.
@@ -799,6 +411,25 @@ uint8_t _select_sweep(db_lh2_t *lh2, uint8_t polynomial, uint32_t timestamp);
  * @return True if interference is found, False otherwise
  */
 bool _check_mocap_interference(uint8_t *arr);
+#if defined(LH2_PROFILING)
+/**
+ * @brief add a duration measure to the statistics of a pipeline stage
+ *
+ * @param[in]   stage       measured stage
+ * @param[in]   duration    duration of the stage, in cycles
+ */
+void _lh2_profiling_record(db_lh2_stage_t stage, uint32_t duration);
+
+#if !defined(__arm__)
+/**
+ * @brief read the monotonic clock of the host, stand-in for the DWT cycle counter
+ *
+ * @return time in nanoseconds, wrapping
+ */
+uint32_t _lh2_profiling_host_now(void);
+#endif
+#endif
+
 //=========================== public ===========================================
 
 void db_lh2_init(db_lh2_t *lh2, const gpio_t *gpio_d, const gpio_t *gpio_e) {
@@ -812,15 +443,11 @@ void db_lh2_init(db_lh2_t *lh2, const gpio_t *gpio_d, const gpio_t *gpio_e) {
     _spi_setup(gpio_d);
 
     // Setup the LH2 local variables
-    memset(_lh2_vars.spi_rx_buffer, 0, SPI_BUFFER_SIZE);
-    // initialize the spi ring buffer
+    // initialize the spi ring buffer, the SPIM writes the first capture in slot 0
     memset(&_lh2_vars.data, 0, sizeof(lh2_ring_buffer_t));
 
-    // Setup LH2 data
-    lh2->spi_ring_buffer_count_ptr = &_lh2_vars.data.count;  // pointer to the size of the spi ring buffer,
-
     for (uint8_t sweep = 0; sweep < LH2_SWEEP_COUNT; sweep++) {
-        for (uint8_t basestation = 0; basestation < LH2_SWEEP_COUNT; basestation++) {
+        for (uint8_t basestation = 0; basestation < LH2_BASESTATION_COUNT; basestation++) {
             lh2->raw_data[sweep][basestation].bits_sweep           = 0;
             lh2->raw_data[sweep][basestation].selected_polynomial  = LH2_POLYNOMIAL_ERROR_INDICATOR;
             lh2->raw_data[sweep][basestation].bit_offset           = 0;
@@ -832,8 +459,23 @@ void db_lh2_init(db_lh2_t *lh2, const gpio_t *gpio_d, const gpio_t *gpio_e) {
     }
     memset(_lh2_vars.data.buffer[0], 0, LH2_BUFFER_SIZE);
 
-    // Initialize the hash table for the lsfr checkpoints
-    _fill_hash_table(_end_buffers_hashtable);
+    // Initialize the bit-sliced polynomial search
+    _fill_polynomial_taps();
+
+#if defined(LH2_PROFILING)
+#if defined(__arm__)
+    // Start the DWT cycle counter used to measure the pipeline stages
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    db_lh2_reset_stats();
+#endif
+
+#if LH2_LFSR_SOLVER_BABY_STEPS > 0
+    // Initialize the baby-step/giant-step tables of the lfsr solver
+    _fill_bsgs_tables();
+#endif
 
     // initialize GPIOTEs
     _gpiote_setup(gpio_e);
@@ -842,6 +484,59 @@ void db_lh2_init(db_lh2_t *lh2, const gpio_t *gpio_d, const gpio_t *gpio_e) {
     _ppi_setup();
 }
 
+bool db_lh2_get_capture(db_lh2_capture_t *capture) {
+    uint8_t *temp_spi_bits  = NULL;
+    uint32_t temp_timestamp = 0;  // the capture is packed, its timestamp may be unaligned
+    if (!_get_from_spi_ring_buffer(&_lh2_vars.data, &temp_spi_bits, &temp_timestamp)) {
+        return false;
+    }
+    capture->timestamp = temp_timestamp;
+    memcpy(capture->samples, temp_spi_bits, SPI_BUFFER_SIZE);
+    _release_spi_ring_buffer(&_lh2_vars.data);
+    return true;
+}
+
+bool db_lh2_inject_capture(const db_lh2_capture_t *capture) {
+    lh2_ring_buffer_t *cb = &_lh2_vars.data;
+    if ((uint8_t)(cb->head - cb->tail) >= LH2_BUFFER_SIZE - 1) {
+        return false;
+    }
+
+    // Write the capture where the SPIM would have, and publish it the same way
+    memcpy(cb->buffer[cb->head & LH2_BUFFER_MASK], capture->samples, SPI_BUFFER_SIZE);
+    NRF_SPIM->RXD.PTR = (uint32_t)_add_to_spi_ring_buffer(cb, capture->timestamp);
+    return true;
+}
+
+void db_lh2_get_capture_stats(db_lh2_capture_stats_t *stats) {
+    stats->pending   = (uint8_t)(_lh2_vars.data.head - _lh2_vars.data.tail);
+    stats->overflows = _lh2_vars.data.overflows;
+    stats->dropped   = _lh2_vars.data.dropped;
+}
+
+bool db_lh2_get_stats(db_lh2_stats_t *stats) {
+#if defined(LH2_PROFILING)
+    for (uint8_t stage = 0; stage < DB_LH2_STAGE_COUNT; stage++) {
+        const lh2_stage_profile_t *profile = &_lh2_vars.profiles[stage];
+        stats->stages[stage].count         = profile->count;
+        stats->stages[stage].min           = profile->min;
+        stats->stages[stage].avg           = (profile->count) ? (uint32_t)(profile->total / profile->count) : 0;
+        stats->stages[stage].max           = profile->max;
+        memcpy(stats->stages[stage].histogram, profile->histogram, sizeof(profile->histogram));
+    }
+    return true;
+#else
+    (void)stats;
+    return false;
+#endif
+}
+
+void db_lh2_reset_stats(void) {
+#if defined(LH2_PROFILING)
+    memset(_lh2_vars.profiles, 0, sizeof(_lh2_vars.profiles));
+#endif
+}
+
 void db_lh2_start(void) {
 
     NRF_PPI->TASKS_CHG[PPI_SPI_GROUP].EN = 1;
@@ -866,36 +561,33 @@ void db_lh2_reset(db_lh2_t *lh2) {
 }
 
 void db_lh2_process_raw_data(db_lh2_t *lh2) {
-    if (_lh2_vars.data.count == 0) {
-        return;
-    }
-
-    // Get value before it's overwritten by the ringbuffer.
-    uint8_t temp_spi_bits[SPI_BUFFER_SIZE * 2] = { 0 };  // The temp buffer has to be 128 long because _demodulate_light() expects it to be so
-                                                         // Making it smaller causes a hardfault
-                                                         // I don't know why, the SPI buffer is clearly 64bytes long.
-                                                         // should ask fil about this
-
-    // stop the interruptions while you're reading the data.
+    // Read the capture in place, the SPIM won't touch this slot until it's released
+    uint8_t *temp_spi_bits  = NULL;
     uint32_t temp_timestamp = 0;  // default timestamp
-    if (!_get_from_spi_ring_buffer(&_lh2_vars.data, temp_spi_bits, &temp_timestamp)) {
+    if (!_get_from_spi_ring_buffer(&_lh2_vars.data, &temp_spi_bits, &temp_timestamp)) {
         return;
     }
 
 // Check if Qualysis Mocap data is interfering with the SPI capture
 #if defined(LH2_MOCAP_FILTER)
     if (_check_mocap_interference(temp_spi_bits)) {
+        _release_spi_ring_buffer(&_lh2_vars.data);
         return;  // if a qualysis pulse caused a false spi trigger, leave the function.
     }
 #endif
 
     // perform the demodulation + poly search on the received packets
     // convert the SPI reading to bits via zero-crossing counter demodulation and differential/biphasic manchester decoding
+    LH2_PROFILING_START(demodulate_start);
     uint64_t temp_bits_sweep = _demodulate_light(temp_spi_bits);
+    LH2_PROFILING_STOP(DB_LH2_STAGE_DEMODULATE, demodulate_start);
+    _release_spi_ring_buffer(&_lh2_vars.data);
 
     // figure out which polynomial each one of the two samples come from.
+    LH2_PROFILING_START(polynomial_start);
     int8_t  temp_bit_offset          = 0;  // default offset
     uint8_t temp_selected_polynomial = _determine_polynomial(temp_bits_sweep, &temp_bit_offset);
+    LH2_PROFILING_STOP(DB_LH2_STAGE_DETERMINE_POLYNOMIAL, polynomial_start);
 
     // If there was an error with the polynomial, leave without updating anything
     if (temp_selected_polynomial == LH2_POLYNOMIAL_ERROR_INDICATOR) {
@@ -903,7 +595,9 @@ void db_lh2_process_raw_data(db_lh2_t *lh2) {
     }
 
     // Figure in which of the two sweep slots we should save the new data.
+    LH2_PROFILING_START(select_start);
     uint8_t sweep = _select_sweep(lh2, temp_selected_polynomial, temp_timestamp);
+    LH2_PROFILING_STOP(DB_LH2_STAGE_SELECT_SWEEP, select_start);
 
     // Put the newly read polynomials in the data structure (polynomial 0,1 must map to LH0, 2,3 to LH1. This can be accomplish by  integer-dividing the selected poly in 2, a shift >> accomplishes this.)
     // This structur always holds the two most recent sweeps from any lighthouse
@@ -915,32 +609,28 @@ void db_lh2_process_raw_data(db_lh2_t *lh2) {
 }
 
 void db_lh2_process_location(db_lh2_t *lh2) {
-    if (_lh2_vars.data.count == 0) {
-        return;
-    }
-
     //*********************************************************************************//
     //                              Prepare Raw Data                                   //
     //*********************************************************************************//
 
-    // Get value before it's overwritten by the ringbuffer.
-    uint8_t temp_spi_bits[SPI_BUFFER_SIZE * 2] = { 0 };  // The temp buffer has to be 128 long because _demodulate_light() expects it to be so
-                                                         // Making it smaller causes a hardfault
-                                                         // I don't know why, the SPI buffer is clearly 64bytes long.
-                                                         // should ask fil about this
-
-    // stop the interruptions while you're reading the data.
+    // Read the capture in place, the SPIM won't touch this slot until it's released
+    uint8_t *temp_spi_bits  = NULL;
     uint32_t temp_timestamp = 0;  // default timestamp
-    if (!_get_from_spi_ring_buffer(&_lh2_vars.data, temp_spi_bits, &temp_timestamp)) {
+    if (!_get_from_spi_ring_buffer(&_lh2_vars.data, &temp_spi_bits, &temp_timestamp)) {
         return;
     }
     // perform the demodulation + poly search on the received packets
     // convert the SPI reading to bits via zero-crossing counter demodulation and differential/biphasic manchester decoding
+    LH2_PROFILING_START(demodulate_start);
     uint64_t temp_bits_sweep = _demodulate_light(temp_spi_bits);
+    LH2_PROFILING_STOP(DB_LH2_STAGE_DEMODULATE, demodulate_start);
+    _release_spi_ring_buffer(&_lh2_vars.data);
 
     // figure out which polynomial each one of the two samples come from.
+    LH2_PROFILING_START(polynomial_start);
     int8_t  temp_bit_offset          = 0;  // default offset
     uint8_t temp_selected_polynomial = _determine_polynomial(temp_bits_sweep, &temp_bit_offset);
+    LH2_PROFILING_STOP(DB_LH2_STAGE_DETERMINE_POLYNOMIAL, polynomial_start);
 
     // If there was an error with the polynomial, leave without updating anything
     if (temp_selected_polynomial == LH2_POLYNOMIAL_ERROR_INDICATOR) {
@@ -948,7 +638,9 @@ void db_lh2_process_location(db_lh2_t *lh2) {
     }
 
     // Figure in which of the two sweep slots we should save the new data.
+    LH2_PROFILING_START(select_start);
     uint8_t sweep = _select_sweep(lh2, temp_selected_polynomial, temp_timestamp);
+    LH2_PROFILING_STOP(DB_LH2_STAGE_SELECT_SWEEP, select_start);
 
     // Put the newly read polynomials in the data structure (polynomial 0,1 must map to LH0, 2,3 to LH1. This can be accomplish by  integer-dividing the selected poly in 2, a shift >> accomplishes this.)
     // This structur always holds the two most recent sweeps from any lighthouse
@@ -966,10 +658,20 @@ void db_lh2_process_location(db_lh2_t *lh2) {
     }
 
     // Compute and save the lsfr location.
-    uint32_t lfsr_loc_temp = _reverse_count_p(
-                                 temp_selected_polynomial,
-                                 temp_bits_sweep >> (47 - temp_bit_offset)) -
-                             temp_bit_offset;
+    LH2_PROFILING_START(reverse_count_start);
+#if LH2_LFSR_SOLVER_BABY_STEPS > 0
+    uint32_t lfsr_loc_temp = _reverse_count_p_bsgs(temp_selected_polynomial, temp_bits_sweep >> (47 - temp_bit_offset));
+#else
+    uint32_t lfsr_loc_temp = _reverse_count_p(temp_selected_polynomial, temp_bits_sweep >> (47 - temp_bit_offset));
+#endif
+    LH2_PROFILING_STOP(DB_LH2_STAGE_REVERSE_COUNT, reverse_count_start);
+
+    // The bits are not a state of the LFSR of this polynomial, mark the data as wrong and keep going
+    if (lfsr_loc_temp == LH2_LOCATION_ERROR_INDICATOR) {
+        lh2->data_ready[sweep][basestation] = DB_LH2_NO_NEW_DATA;
+        return;
+    }
+    lfsr_loc_temp -= temp_bit_offset;
 
     //*********************************************************************************//
     //                                 Store results                                   //
@@ -987,6 +689,48 @@ void db_lh2_process_location(db_lh2_t *lh2) {
     lh2->data_ready[sweep][basestation] = DB_LH2_PROCESSED_DATA_AVAILABLE;
 }
 
+void db_lh2_drain(db_lh2_t *lh2, bool compute_location, uint32_t budget_us, db_lh2_drain_stats_t *stats) {
+    db_lh2_drain_stats_t report = { 0 };
+    uint32_t             start  = db_timer_hf_now(LH2_TIMER_DEV);
+
+    while (1) {
+        uint8_t depth = (uint8_t)(_lh2_vars.data.head - _lh2_vars.data.tail);
+        if (depth > report.max_depth) {
+            report.max_depth = depth;
+        }
+        if (depth == 0) {
+            break;
+        }
+
+        uint32_t now = db_timer_hf_now(LH2_TIMER_DEV);
+        if (budget_us != 0 && now - start >= budget_us) {
+            break;
+        }
+
+        // Skip the captures which waited too long, newer sweeps are already queued behind them
+        uint8_t *temp_spi_bits  = NULL;
+        uint32_t temp_timestamp = 0;
+        _get_from_spi_ring_buffer(&_lh2_vars.data, &temp_spi_bits, &temp_timestamp);
+        if (now - temp_timestamp > LH2_CAPTURE_MAX_AGE_US) {
+            _release_spi_ring_buffer(&_lh2_vars.data);
+            report.stale++;
+            continue;
+        }
+
+        if (compute_location) {
+            db_lh2_process_location(lh2);
+        } else {
+            db_lh2_process_raw_data(lh2);
+        }
+        report.processed++;
+    }
+
+    report.remaining = (uint8_t)(_lh2_vars.data.head - _lh2_vars.data.tail);
+    if (stats != NULL) {
+        *stats = report;
+    }
+}
+
 //=========================== private ==========================================
 
 void _initialize_ts4231(const gpio_t *gpio_d, const gpio_t *gpio_e) {
@@ -1108,14 +852,10 @@ uint64_t _demodulate_light(uint8_t *sample_buffer) {  // bad input variable name
     // TODO: make it a void and have chips be a modified pointer thingie
     // FIXME: there is an edge case where I throw away an initial "1" and do not count it in the bit-shift offset, resulting in an incorrect error of 1 in the LFSR location
     uint8_t chip_index;
-    uint8_t local_buffer[128];
     uint8_t zccs_1[128];
-    uint8_t chips1[128];  // TODO: give this a better name.
-    uint8_t temp_byte_N;  // TODO: bad variable name "temp byte"
-    uint8_t temp_byte_M;  // TODO: bad variable name "temp byte"
+    uint8_t chips1[128 + 2];  // TODO: give this a better name. The demodulation looks up to two chips past the last one
 
     // initialize loop variables
-    uint8_t  ii = 0x00;
     int      jj = 0;
     int      kk = 0;
     uint64_t gg = 0;
@@ -1127,37 +867,31 @@ uint64_t _demodulate_light(uint8_t *sample_buffer) {  // bad input variable name
     uint64_t chipsH1 = 0;
 
     // FIND ZERO CROSSINGS
-    chip_index         = 0;
-    zccs_1[chip_index] = 0x01;
-
-    memcpy(local_buffer, sample_buffer, 128);
-
-    // for loop over bytes of the SPI buffer (jj), nested with a for loop over bits in each byte (ii)
-    for (jj = 0; jj < 128; jj++) {
-        // edge case - check if last bit (LSB) of previous byte is the same as first bit (MSB) of current byte
-        // if it is not, increment chip_index and reset count
-        if (jj != 0) {
-            temp_byte_M = (local_buffer[jj - 1]) & (0x01);   // previous byte's LSB
-            temp_byte_N = (local_buffer[jj] >> 7) & (0x01);  // current byte's MSB
-            if (temp_byte_M != temp_byte_N) {
-                chip_index++;
-                zccs_1[chip_index] = 1;
-            } else {
-                zccs_1[chip_index] += 1;
-            }
-        }
-        // look at one byte at a time
-        for (ii = 7; ii > 0; ii--) {
-            temp_byte_M = ((local_buffer[jj]) >> (ii)) & (0x01);      // bit shift by ii and mask
-            temp_byte_N = ((local_buffer[jj]) >> (ii - 1)) & (0x01);  // bit shift by ii-1 and mask
-            if (temp_byte_M == temp_byte_N) {
-                zccs_1[chip_index] += 1;
-            } else {
-                chip_index++;
-                zccs_1[chip_index] = 1;
+    // The SPI samples are processed 32 at a time (MSB first): XOR-ing a word with itself shifted left by one sample
+    // sets a bit on every sample followed by a different one, CLZ then jumps directly from one zero crossing to the next.
+    memset(zccs_1, 0, sizeof(zccs_1));
+    uint32_t run_count = 0;  // number of completed runs of identical samples
+    uint32_t run_start = 0;  // index of the first sample of the current run
+    for (jj = 0; jj < SPI_BUFFER_SIZE; jj += 4) {
+        uint32_t word = ((uint32_t)sample_buffer[jj] << 24) | ((uint32_t)sample_buffer[jj + 1] << 16) | ((uint32_t)sample_buffer[jj + 2] << 8) | sample_buffer[jj + 3];
+        // first sample of the next word, the capture is followed by silence
+        uint32_t next_sample = (jj + 4 < SPI_BUFFER_SIZE) ? (sample_buffer[jj + 4] >> 7) : 0;
+        uint32_t crossings   = word ^ ((word << 1) | next_sample);
+        while (crossings != 0) {
+            uint32_t position = __builtin_clz(crossings);  // position of the last sample of the run in the current word
+            uint32_t run_end  = jj * 8 + position + 1;
+            if (run_count < 128) {
+                zccs_1[run_count] = (uint8_t)(run_end - run_start);
             }
+            run_count++;
+            run_start = run_end;
+            crossings &= ~(0x80000000 >> position);
         }
     }
+    // the last run ends with the silence following the capture (SPI_BUFFER_SIZE bytes of it)
+    if (run_count < 128) {
+        zccs_1[run_count] = (uint8_t)(SPI_BUFFER_SIZE * 2 * 8 - run_start);
+    }
 
     // threshold the zero crossings into: likely one chip, likely two zero chips, or fuzzy
     for (jj = 0; jj < 128; jj++) {
@@ -1170,6 +904,9 @@ uint64_t _demodulate_light(uint8_t *sample_buffer) {  // bad input variable name
             chips1[jj] = FUZZY_CHIP;  // fuzzy
         }
     }
+    // the chips past the last one are zeros, like the silence following the capture
+    chips1[128] = 0;
+    chips1[129] = 0;
     // final bit is bugged, make it fuzzy:
     // chips1[127] = 0xFF;
 
@@ -1394,15 +1131,12 @@ uint8_t _determine_polynomial(uint64_t chipsH1, int8_t *start_val) {
 
     *start_val = 8;  // TODO: remove this? possible that I modify start value during the demodulation process
 
-    int32_t  bits_N_for_comp                      = 47 - *start_val;
-    uint32_t bit_buffer1                          = (uint32_t)(((0xFFFF800000000000) & chipsH1) >> 47);
-    uint64_t bits_from_poly[LH2_POLYNOMIAL_COUNT] = { 0 };
-    uint64_t weights[LH2_POLYNOMIAL_COUNT]        = { 0xFFFFFFFFFFFFFFFF };
-    uint8_t  selected_poly                        = LH2_POLYNOMIAL_ERROR_INDICATOR;  // initialize to error condition
-    uint8_t  min_weight_idx                       = LH2_POLYNOMIAL_ERROR_INDICATOR;
-    uint64_t min_weight                           = LH2_POLYNOMIAL_ERROR_INDICATOR;
-    uint64_t bits_to_compare                      = 0;
-    int32_t  threshold                            = POLYNOMIAL_BIT_ERROR_INITIAL_THRESHOLD;
+    int32_t  bits_N_for_comp = 47 - *start_val;
+    uint32_t bit_buffer1     = (uint32_t)(((0xFFFF800000000000) & chipsH1) >> 47);
+    uint64_t bits_to_compare = 0;
+    uint8_t  skip_bits       = 0;
+    uint8_t  selected_poly   = LH2_POLYNOMIAL_ERROR_INDICATOR;  // initialize to error condition
+    int32_t  threshold       = POLYNOMIAL_BIT_ERROR_INITIAL_THRESHOLD;
 
 #if defined(LH2_MOCAP_FILTER)
     threshold = 0;
@@ -1418,27 +1152,17 @@ uint8_t _determine_polynomial(uint64_t chipsH1, int8_t *start_val) {
     // run polynomial search on the first capture
     while (1) {
 
-        // TODO: do this math stuff in multiple operations to: (a) make it readable (b) ensure order-of-execution
+        // seed: the 17 bits following the first start_val bits
         bit_buffer1     = (uint32_t)(((0xFFFF800000000000 >> (*start_val)) & chipsH1) >> (64 - 17 - (*start_val)));
-        bits_to_compare = (chipsH1 & (0xFFFFFFFFFFFFFFFF << (64 - 17 - (*start_val) - bits_N_for_comp)));
-        // reset the minimum polynomial match found
-        min_weight_idx = LH2_POLYNOMIAL_ERROR_INDICATOR;
-        min_weight     = LH2_POLYNOMIAL_ERROR_INDICATOR;
-        // Check against all the known polynomials
-        for (uint8_t i = 0; i < LH2_POLYNOMIAL_COUNT; i++) {
-            bits_from_poly[i] = (((_poly_check(_polynomials[i], bit_buffer1, bits_N_for_comp)) << (64 - 17 - (*start_val) - bits_N_for_comp)) | (chipsH1 & (0xFFFFFFFFFFFFFFFF << (64 - (*start_val)))));
-            // weights[i]        = _hamming_weight(bits_from_poly[i] ^ bits_to_compare);
-            weights[i] = __builtin_popcount(bits_from_poly[i] ^ bits_to_compare);
-            // Keep track of the minimum weight value and which polinimial generated it.
-            if (weights[i] < min_weight) {
-                min_weight_idx = i;
-                min_weight     = weights[i];
-            }
-        }
+        bits_to_compare = (chipsH1 >> (64 - 17 - (*start_val) - bits_N_for_comp)) & ((1ULL << bits_N_for_comp) - 1);
+        // only the bits landing in the 32 LSBs of the capture are compared, the first generated ones are skipped
+        skip_bits = (47 - *start_val > 32) ? (47 - *start_val - 32) : 0;
+
+        // Check against all the known polynomials at once
+        selected_poly = _bitsliced_poly_search(bit_buffer1, bits_to_compare, bits_N_for_comp, skip_bits, threshold);
 
         // If you found a sufficiently good value, then return which polinomial generated it
-        if (min_weight <= (uint64_t)threshold) {
-            selected_poly = min_weight_idx;
+        if (selected_poly != LH2_POLYNOMIAL_ERROR_INDICATOR) {
             break;
             // match failed, try again removing bits from the end
         } else if (*start_val > 8) {
@@ -1460,9 +1184,91 @@ uint8_t _determine_polynomial(uint64_t chipsH1, int8_t *start_val) {
             break;
         }
     }
+
+    // move the identified polynomial to the front of the search order
+    if (selected_poly != LH2_POLYNOMIAL_ERROR_INDICATOR) {
+        uint8_t position = 0;
+        while (_polynomial_search_order[position] != selected_poly) {
+            position++;
+        }
+        memmove(&_polynomial_search_order[1], &_polynomial_search_order[0], position);
+        _polynomial_search_order[0] = selected_poly;
+    }
     return selected_poly;
 }
 
+uint8_t _bitsliced_poly_search(uint32_t seed, uint64_t expected, uint8_t numbits, uint8_t skipbits, uint8_t threshold) {
+    // history[i + 16 - n] holds bit n of the LFSR states before generating bit i, the same for every lane at the seed
+    uint32_t history[LH2_LFSR_WIDTH + 64];
+    for (uint8_t n = 0; n < LH2_LFSR_WIDTH; n++) {
+        history[LH2_LFSR_WIDTH - 1 - n] = ((seed >> n) & 0x01) ? POLYNOMIAL_LANES_MASK : 0;
+    }
+
+    // per-lane budget of remaining bit errors, stored as 3 bit planes, a borrow out of the last plane exceeds the threshold
+    uint32_t budget_0 = (threshold & 0x01) ? POLYNOMIAL_LANES_MASK : 0;
+    uint32_t budget_1 = (threshold & 0x02) ? POLYNOMIAL_LANES_MASK : 0;
+    uint32_t budget_2 = (threshold & 0x04) ? POLYNOMIAL_LANES_MASK : 0;
+    uint32_t failed   = 0;
+
+    for (uint8_t i = 0; i < numbits; i++) {
+        const uint32_t *state    = &history[i];
+        uint32_t        feedback = 0;
+        for (uint8_t n = 0; n < LH2_LFSR_WIDTH; n++) {
+            feedback ^= state[LH2_LFSR_WIDTH - 1 - n] & _polynomial_taps[n];
+        }
+        history[LH2_LFSR_WIDTH + i] = feedback;
+
+        if (i < skipbits) {
+            continue;
+        }
+
+        uint32_t expected_bit = ((expected >> (numbits - 1 - i)) & 0x01) ? POLYNOMIAL_LANES_MASK : 0;
+        uint32_t borrow       = feedback ^ expected_bit;
+        uint32_t next_borrow  = borrow & ~budget_0;
+        budget_0 ^= borrow;
+        borrow      = next_borrow;
+        next_borrow = borrow & ~budget_1;
+        budget_1 ^= borrow;
+        borrow      = next_borrow;
+        next_borrow = borrow & ~budget_2;
+        budget_2 ^= borrow;
+        failed |= next_borrow;
+
+        // every polynomial is already above threshold
+        if (failed == POLYNOMIAL_LANES_MASK) {
+            return LH2_POLYNOMIAL_ERROR_INDICATOR;
+        }
+    }
+
+    // keep the polynomial with the largest remaining budget, the first one found wins the ties
+    uint8_t selected_poly = LH2_POLYNOMIAL_ERROR_INDICATOR;
+    int8_t  max_budget    = -1;
+    for (uint8_t i = 0; i < LH2_POLYNOMIAL_COUNT; i++) {
+        uint8_t poly = _polynomial_search_order[i];
+        if ((failed >> poly) & 0x01) {
+            continue;
+        }
+        int8_t budget = ((budget_0 >> poly) & 0x01) | (((budget_1 >> poly) & 0x01) << 1) | (((budget_2 >> poly) & 0x01) << 2);
+        if (budget > max_budget) {
+            max_budget    = budget;
+            selected_poly = poly;
+        }
+    }
+    return selected_poly;
+}
+
+void _fill_polynomial_taps(void) {
+    for (uint8_t n = 0; n < LH2_LFSR_WIDTH; n++) {
+        _polynomial_taps[n] = 0;
+        for (uint8_t poly = 0; poly < LH2_POLYNOMIAL_COUNT; poly++) {
+            _polynomial_taps[n] |= ((_polynomials[poly] >> n) & 0x01) << poly;
+        }
+    }
+    for (uint8_t poly = 0; poly < LH2_POLYNOMIAL_COUNT; poly++) {
+        _polynomial_search_order[poly] = poly;
+    }
+}
+
 uint64_t _hamming_weight(uint64_t bits_in) {  // TODO: bad name for function? or is it, it might be a good name for a function, because it describes exactly what it does
     uint64_t weight = bits_in;
     weight          = weight - ((weight >> 1) & 0x5555555555555555);                         // find # of 1s in every 2-bit block
@@ -1475,62 +1281,46 @@ uint64_t _hamming_weight(uint64_t bits_in) {  // TODO: bad name for function? or
     return weight;
 }
 
+#if LH2_LFSR_SOLVER_BABY_STEPS == 0
 uint32_t _reverse_count_p(uint8_t index, uint32_t bits) {
 
-    bits                 = bits & 0x0001FFFF;  // initialize buffer to initial bits, masked
+    bits = bits & 0x0001FFFF;  // initialize buffer to initial bits, masked
+
+    // The all zeros state is not in the sequence, it would match the empty slots of the checkpoint tables
+    if (bits == 0) {
+        return LH2_LOCATION_ERROR_INDICATOR;
+    }
+
     uint32_t buffer_down = bits;
     uint32_t buffer_up   = bits;
 
-    uint32_t count_down      = 0;
-    uint32_t count_up        = 0;
-    uint32_t b17             = 0;
-    uint32_t b1              = 0;
-    uint32_t masked_buff     = 0;
-    uint8_t  hash_index_down = 0;
-    uint8_t  hash_index_up   = 0;
-
-    // Copy const variables (Flash) into local variables (RAM) to speed up execution.
-    uint32_t _end_buffers_local[NUM_LSFR_COUNT_CHECKPOINTS] = { 0 };
-    uint32_t polynomials_local                              = _polynomials[index];
-    for (size_t i = 0; i < NUM_LSFR_COUNT_CHECKPOINTS; i++) {
-        _end_buffers_local[i] = _end_buffers[index][i];
-    }
+    uint32_t count_down        = 0;
+    uint32_t count_up          = 0;
+    uint32_t b17               = 0;
+    uint32_t b1                = 0;
+    uint32_t masked_buff       = 0;
+    uint32_t checkpoint        = 0;
+    uint32_t polynomials_local = _polynomials[index];
 
-    while (buffer_up != _end_buffers_local[0])  // do until buffer reaches one of the saved states
-    {
+    // Going both ways, a checkpoint is reached in at most half the spacing
+    while (count_up <= LH2_CHECKPOINT_SPACING / 2) {
 
         //
         // CHECKPOINT CHECKING
         //
 
-        // Check end_buffer backward count
-        // Lower hash option in the hash table
-        hash_index_down = _end_buffers_hashtable[(buffer_down >> 2) & HASH_TABLE_MASK] & CHECKPOINT_TABLE_MASK_LOW;
-        if (buffer_down == _end_buffers_local[hash_index_down]) {
-            count_down = count_down + 2048 * hash_index_down - 1;
-            _update_lfsr_checkpoints(index, bits, count_down);
-            return count_down;
-        }
-        // Upper hash option in the hash table
-        hash_index_down = (_end_buffers_hashtable[(buffer_down >> 2) & HASH_TABLE_MASK] & CHECKPOINT_TABLE_MASK_HIGH) >> CHECKPOINT_TABLE_BITS;
-        if (buffer_down == _end_buffers_local[hash_index_down]) {
-            count_down = count_down + 2048 * hash_index_down - 1;
+        // Check the checkpoints, backward
+        checkpoint = _find_lfsr_checkpoint(index, buffer_down);
+        if (checkpoint != LH2_LOCATION_ERROR_INDICATOR) {
+            count_down = checkpoint + count_down;
             _update_lfsr_checkpoints(index, bits, count_down);
             return count_down;
         }
 
-        // Check end_buffer forward count
-        // Lower hash option in the hash table
-        hash_index_up = _end_buffers_hashtable[(buffer_up >> 2) & HASH_TABLE_MASK] & CHECKPOINT_TABLE_MASK_LOW;
-        if (buffer_up == _end_buffers_local[hash_index_up]) {
-            count_up = 2048 * hash_index_up - count_up - 1;
-            _update_lfsr_checkpoints(index, bits, count_up);
-            return count_up;
-        }
-        // Upper hash option in the hash table
-        hash_index_up = (_end_buffers_hashtable[(buffer_up >> 2) & HASH_TABLE_MASK] & CHECKPOINT_TABLE_MASK_HIGH) >> CHECKPOINT_TABLE_BITS;
-        if (buffer_up == _end_buffers_local[hash_index_up]) {
-            count_up = 2048 * hash_index_up - count_up - 1;
+        // Check the checkpoints, forward. The first checkpoint is also the end of the sequence
+        checkpoint = _find_lfsr_checkpoint(index, buffer_up);
+        if (checkpoint != LH2_LOCATION_ERROR_INDICATOR) {
+            count_up = (checkpoint == 0 ? LH2_LFSR_PERIOD : checkpoint) - count_up;
             _update_lfsr_checkpoints(index, bits, count_up);
             return count_up;
         }
@@ -1574,8 +1364,82 @@ uint32_t _reverse_count_p(uint8_t index, uint32_t bits) {
         buffer_up = ((buffer_up << 1) | b1) & (0x0001FFFF);
         count_up++;
     }
-    return count_up;
+
+    // bits is not part of the LFSR sequence (e.g all zeros)
+    return LH2_LOCATION_ERROR_INDICATOR;
+}
+#else
+void _fill_bsgs_tables(void) {
+
+    for (size_t poly = 0; poly < LH2_POLYNOMIAL_COUNT; poly++) {
+        uint32_t polynomial = _polynomials[poly];
+
+        // Baby steps: hash every state reached from the seed in less than LH2_LFSR_SOLVER_BABY_STEPS steps
+        memset(_lfsr_baby_steps[poly], 0, sizeof(_lfsr_baby_steps[poly]));  // 0 is never a valid LFSR state, use it to mark empty slots
+        uint32_t state = LH2_LFSR_SEED;
+        for (uint32_t step = 0; step < LH2_LFSR_SOLVER_BABY_STEPS; step++) {
+            uint32_t slot = ((state * 0x9E3779B1) >> 16) & LFSR_BSGS_TABLE_MASK;
+            while (_lfsr_baby_steps[poly][slot] != 0) {
+                slot = (slot + 1) & LFSR_BSGS_TABLE_MASK;
+            }
+            _lfsr_baby_steps[poly][slot] = (step << LFSR_BSGS_INDEX_POS) | state;
+            state                        = ((state << 1) | (__builtin_popcount(state & polynomial) & 0x01)) & 0x0001FFFF;
+        }
+
+        // Giant step: the LFSR is linear, so running it backward LH2_LFSR_SOLVER_BABY_STEPS times is a 17x17 matrix.
+        // Compute the image of each single-bit state, then combine them into one lookup table per nibble.
+        uint32_t columns[17] = { 0 };
+        for (uint8_t bit = 0; bit < 17; bit++) {
+            uint32_t buffer = 1 << bit;
+            for (uint32_t step = 0; step < LH2_LFSR_SOLVER_BABY_STEPS; step++) {
+                uint32_t b17 = buffer & 0x00000001;
+                buffer       = (buffer & 0x0001FFFE) >> 1;
+                buffer       = buffer | (((__builtin_popcount(buffer & polynomial) ^ b17) & 0x00000001) << 16);
+            }
+            columns[bit] = buffer;
+        }
+        for (uint8_t nibble = 0; nibble < LFSR_BSGS_JUMP_NIBBLES; nibble++) {
+            for (uint8_t value = 0; value < 16; value++) {
+                uint32_t jump = 0;
+                for (uint8_t bit = 0; bit < 4 && (nibble * 4 + bit) < 17; bit++) {
+                    if (value & (1 << bit)) {
+                        jump ^= columns[nibble * 4 + bit];
+                    }
+                }
+                _lfsr_jump_table[poly][nibble][value] = jump;
+            }
+        }
+    }
+}
+
+uint32_t _reverse_count_p_bsgs(uint8_t index, uint32_t bits) {
+
+    uint32_t        state      = bits & 0x0001FFFF;
+    const uint32_t *baby_steps = _lfsr_baby_steps[index];
+    const uint32_t(*jump)[16]  = _lfsr_jump_table[index];
+
+    for (uint32_t giant_step = 0; giant_step < LFSR_BSGS_GIANT_STEPS; giant_step++) {
+        // Is the current state one of the baby steps?
+        uint32_t slot = ((state * 0x9E3779B1) >> 16) & LFSR_BSGS_TABLE_MASK;
+        while (baby_steps[slot] != 0) {
+            if ((baby_steps[slot] & 0x0001FFFF) == state) {
+                return giant_step * LH2_LFSR_SOLVER_BABY_STEPS + (baby_steps[slot] >> LFSR_BSGS_INDEX_POS);
+            }
+            slot = (slot + 1) & LFSR_BSGS_TABLE_MASK;
+        }
+
+        // No match, jump LH2_LFSR_SOLVER_BABY_STEPS states backward
+        state = jump[0][state & 0x0F] ^
+                jump[1][(state >> 4) & 0x0F] ^
+                jump[2][(state >> 8) & 0x0F] ^
+                jump[3][(state >> 12) & 0x0F] ^
+                jump[4][(state >> 16) & 0x01];
+    }
+
+    // bits is not part of the LFSR sequence (e.g all zeros)
+    return LH2_LOCATION_ERROR_INDICATOR;
 }
+#endif
 
 void _lh2_pin_set_input(const gpio_t *gpio) {
     // Configure Data pin as INPUT, with no pullup or pull down.
@@ -1658,8 +1522,8 @@ void _spi_setup(const gpio_t *gpio_d) {
     NRF_SPIM->CONFIG    = SPIM_CONFIG_ORDER_MsbFirst << SPIM_CONFIG_ORDER_Pos;  // Set MsB out first
 
     // Configure the EasyDMA channel, only using RX
-    NRF_SPIM->RXD.MAXCNT = SPI_BUFFER_SIZE;                    // Set the size of the input buffer.
-    NRF_SPIM->RXD.PTR    = (uint32_t)_lh2_vars.spi_rx_buffer;  // Set the input buffer pointer.
+    NRF_SPIM->RXD.MAXCNT = SPI_BUFFER_SIZE;                     // Set the size of the input buffer.
+    NRF_SPIM->RXD.PTR    = (uint32_t)_lh2_vars.data.buffer[0];  // The first capture goes in the first slot of the ring buffer.
 
     NRF_SPIM->INTENSET = SPIM_INTENSET_END_Enabled << SPIM_INTENSET_END_Pos;  // Enable interruption for when a packet arrives
     NVIC_SetPriority(SPIM_IRQ, SPIM_INTERRUPT_PRIORITY);                      // Set priority for Radio interrupts to 1
@@ -1670,50 +1534,63 @@ void _spi_setup(const gpio_t *gpio_d) {
     NRF_SPIM->ENABLE = SPIM_ENABLE_ENABLE_Enabled << SPIM_ENABLE_ENABLE_Pos;
 }
 
-void _add_to_spi_ring_buffer(lh2_ring_buffer_t *cb, uint8_t *data, uint32_t timestamp) {
+uint8_t *_add_to_spi_ring_buffer(lh2_ring_buffer_t *cb, uint32_t timestamp) {
 
-    memcpy(cb->buffer[cb->write_index], data, SPI_BUFFER_SIZE);
-    cb->timestamps[cb->write_index] = timestamp;
-    cb->write_index                 = (cb->write_index + 1) % LH2_BUFFER_SIZE;
+    cb->timestamps[cb->head & LH2_BUFFER_MASK] = timestamp;
 
-    if (cb->count < LH2_BUFFER_SIZE) {
-        cb->count++;
+    // The slot at head is always owned by the SPIM, so at most LH2_BUFFER_SIZE - 1 captures are waiting
+    if ((uint8_t)(cb->head - cb->tail) < LH2_BUFFER_SIZE - 1) {
+        // make the capture and its timestamp visible before moving the head
+        __DMB();
+        cb->head++;
+        cb->full = false;
     } else {
-        // Overwrite oldest data, adjust read_index
-        cb->read_index = (cb->read_index + 1) % LH2_BUFFER_SIZE;
+        // Ring is full: keep the consumer's data and let the next capture overwrite this one
+        if (!cb->full) {
+            cb->overflows++;
+            cb->full = true;
+        }
+        cb->dropped++;
     }
+
+    return cb->buffer[cb->head & LH2_BUFFER_MASK];
 }
 
-bool _get_from_spi_ring_buffer(lh2_ring_buffer_t *cb, uint8_t *data, uint32_t *timestamp) {
-    if (cb->count == 0) {
+bool _get_from_spi_ring_buffer(lh2_ring_buffer_t *cb, uint8_t **data, uint32_t *timestamp) {
+    if (cb->head == cb->tail) {
         // Buffer is empty
         return false;
     }
 
-    memcpy(data, cb->buffer[cb->read_index], SPI_BUFFER_SIZE);
-    *timestamp     = cb->timestamps[cb->read_index];
-    cb->read_index = (cb->read_index + 1) % LH2_BUFFER_SIZE;
-    cb->count--;
+    // read the head before the capture it publishes
+    __DMB();
+    *data      = cb->buffer[cb->tail & LH2_BUFFER_MASK];
+    *timestamp = cb->timestamps[cb->tail & LH2_BUFFER_MASK];
 
     return true;
 }
 
-void _fill_hash_table(uint16_t *hash_table) {
+void _release_spi_ring_buffer(lh2_ring_buffer_t *cb) {
+    // done reading the capture before handing the slot back
+    __DMB();
+    cb->tail++;
+}
 
-    // Iterate over all the checkpoints and save the HASH_TABLE_BITS 11 bits as a a index for the hashtable
-    for (size_t poly = 0; poly < LH2_POLYNOMIAL_COUNT; poly++) {
-        for (size_t checkpoint = 1; checkpoint < NUM_LSFR_COUNT_CHECKPOINTS; checkpoint++) {
-            if (hash_table[(_end_buffers[poly][checkpoint] >> 2) & HASH_TABLE_MASK] == 0) {  // We shift by 2 to the right because we precomputed that that hash has the least amount of collisions in the hash table
+#if LH2_LFSR_SOLVER_BABY_STEPS == 0
+uint32_t _find_lfsr_checkpoint(uint8_t index, uint32_t state) {
+    uint32_t bucket = (state * LH2_CHECKPOINT_BUCKET_MULT) >> (32 - LH2_CHECKPOINT_BUCKET_BITS);
+    uint32_t slot   = ((state ^ _lh2_checkpoint_displacements[index][bucket]) * LH2_CHECKPOINT_SLOT_MULT) >> (32 - LH2_CHECKPOINT_SLOT_BITS);
+    uint32_t entry  = _lh2_checkpoint_table[index][slot];
 
-                hash_table[(_end_buffers[poly][checkpoint] >> 2) & HASH_TABLE_MASK] = checkpoint & CHECKPOINT_TABLE_MASK_LOW;  // that element of the hash table is empty, copy the checkpoint into the lower 6 bits
-            } else {
-                hash_table[(_end_buffers[poly][checkpoint] >> 2) & HASH_TABLE_MASK] |= (checkpoint << CHECKPOINT_TABLE_BITS) & CHECKPOINT_TABLE_MASK_HIGH;  // If the element is already occupied, use the upper 6 bits
-            }
-        }
+    // The perfect hash sends every checkpoint to its own slot, any other state is rejected by the comparison
+    if ((entry & 0x0001FFFF) != state) {
+        return LH2_LOCATION_ERROR_INDICATOR;
     }
+    return (entry >> LH2_CHECKPOINT_INDEX_POS) * LH2_CHECKPOINT_SPACING;
 }
 
 void _update_lfsr_checkpoints(uint8_t polynomial, uint32_t bits, uint32_t count) {
+    LH2_PROFILING_START(update_start);
 
     // Update the current running weighted sum. 75% of old value +25% of new value
     _lsfr_checkpoint_average = (((_lsfr_checkpoint_average * 3) >> 2) + (count >> 2));
@@ -1724,7 +1601,9 @@ void _update_lfsr_checkpoints(uint8_t polynomial, uint32_t bits, uint32_t count)
     // Save the new count in the correct place in the checkpoint array
     _lfsr_checkpoint_bits[polynomial][index]  = bits;
     _lfsr_checkpoint_count[polynomial][index] = count;
+    LH2_PROFILING_STOP(DB_LH2_STAGE_UPDATE_CHECKPOINTS, update_start);
 }
+#endif
 
 uint8_t _select_sweep(db_lh2_t *lh2, uint8_t polynomial, uint32_t timestamp) {
     // TODO: check the exact, per-mode period of each polynomial instead of using a blanket 20ms
@@ -1837,18 +1716,55 @@ bool _check_mocap_interference(uint8_t *arr) {
     return false;  // No error found
 }
 
+#if defined(LH2_PROFILING)
+void _lh2_profiling_record(db_lh2_stage_t stage, uint32_t duration) {
+    lh2_stage_profile_t *profile = &_lh2_vars.profiles[stage];
+
+    if (profile->count == 0 || duration < profile->min) {
+        profile->min = duration;
+    }
+    if (duration > profile->max) {
+        profile->max = duration;
+    }
+    profile->count++;
+    profile->total += duration;
+
+    // log2 buckets, the first and last ones also collect the shorter and longer durations
+    uint8_t log2 = 31 - __builtin_clz(duration | 1);
+    uint8_t bin  = (log2 > LH2_STATS_HISTOGRAM_MIN_LOG2) ? log2 - LH2_STATS_HISTOGRAM_MIN_LOG2 : 0;
+    if (bin >= LH2_STATS_HISTOGRAM_BINS) {
+        bin = LH2_STATS_HISTOGRAM_BINS - 1;
+    }
+    if (profile->histogram[bin] < UINT16_MAX) {
+        profile->histogram[bin]++;
+    }
+}
+
+#if !defined(__arm__)
+uint32_t _lh2_profiling_host_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+#endif
+#endif
+
 //=========================== interrupts =======================================
 
 void SPIM_IRQ_HANDLER(void) {
+    LH2_PROFILING_START(isr_start);
     // Check if the interrupt was caused by a fully send package
     if (NRF_SPIM->EVENTS_END) {
         // Clear the Interrupt flag
         NRF_SPIM->EVENTS_END = 0;
-        // Reenable the PPI channel
-        db_lh2_start();
         // Read the current time.
         uint32_t timestamp = db_timer_hf_now(LH2_TIMER_DEV);
-        // Add new reading to the ring buffer
-        _add_to_spi_ring_buffer(&_lh2_vars.data, _lh2_vars.spi_rx_buffer, timestamp);
+        // Add new reading to the ring buffer and point the EasyDMA to the next free slot, before the capture is re-armed
+        LH2_PROFILING_START(insert_start);
+        NRF_SPIM->RXD.PTR = (uint32_t)_add_to_spi_ring_buffer(&_lh2_vars.data, timestamp);
+        LH2_PROFILING_STOP(DB_LH2_STAGE_RING_INSERT, insert_start);
+        // Reenable the PPI channel
+        db_lh2_start();
     }
+    LH2_PROFILING_STOP(DB_LH2_STAGE_SPIM_ISR, isr_start);
 }
@@ -20,6 +20,42 @@ void db_lh2_init(db_lh2_t *lh2, const gpio_t *gpio_d, const gpio_t *gpio_e) {
     (void)gpio_e;
 }
 
+bool db_lh2_get_capture(db_lh2_capture_t *capture) {
+    (void)capture;
+    return false;
+}
+
+bool db_lh2_inject_capture(const db_lh2_capture_t *capture) {
+    (void)capture;
+    return false;
+}
+
+void db_lh2_get_capture_stats(db_lh2_capture_stats_t *stats) {
+    stats->pending   = 0;
+    stats->overflows = 0;
+    stats->dropped   = 0;
+}
+
+bool db_lh2_get_stats(db_lh2_stats_t *stats) {
+    (void)stats;
+    return false;
+}
+
+void db_lh2_reset_stats(void) {
+}
+
+void db_lh2_drain(db_lh2_t *lh2, bool compute_location, uint32_t budget_us, db_lh2_drain_stats_t *stats) {
+    (void)lh2;
+    (void)compute_location;
+    (void)budget_us;
+    if (stats != NULL) {
+        stats->processed = 0;
+        stats->stale     = 0;
+        stats->max_depth = 0;
+        stats->remaining = 0;
+    }
+}
+
 void db_lh2_start(void) {
 }
 
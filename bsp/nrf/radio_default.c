@@ -10,8 +10,8 @@
  * @copyright Inria, 2022-2024
  */
 #include <nrf.h>
+#include <stdbool.h>
 #include <stdint.h>
-#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
@@ -23,13 +23,21 @@
 
 #if defined(NRF5340_XXAA) && defined(NRF_NETWORK)
 #define NRF_RADIO NRF_RADIO_NS
+#define NRF_PPI   NRF_DPPIC_NS
 #endif
 
 #if defined(NRF5340_XXAA) && defined(NRF_NETWORK)
 #define RADIO_INTERRUPT_PRIORITY 2
+#define RADIO_RX_SWI_IRQn        SWI0_IRQn
+#define RADIO_RX_SWI_IRQHandler  SWI0_IRQHandler
 #else
 #define RADIO_INTERRUPT_PRIORITY 1
+#define RADIO_RX_SWI_IRQn        SWI0_EGU0_IRQn
+#define RADIO_RX_SWI_IRQHandler  SWI0_EGU0_IRQHandler
 #endif
+#define RADIO_RX_SWI_PRIORITY (RADIO_INTERRUPT_PRIORITY + 1)  ///< The received packets are handed to the callback below the radio interrupt priority
+
+#define RADIO_PPI_CHAN_TIMESTAMP 10  ///< (D)PPI channel used to capture the time of the ADDRESS event
 
 #define RADIO_TIFS          0U  ///< Inter frame spacing in us. zero means IFS is enforced by software, not the hardware
 #define RADIO_SHORTS_COMMON (RADIO_SHORTS_READY_START_Enabled << RADIO_SHORTS_READY_START_Pos) |                 \
@@ -38,6 +46,7 @@
                                 (RADIO_SHORTS_DISABLED_RSSISTOP_Enabled << RADIO_SHORTS_DISABLED_RSSISTOP_Pos)
 #define RADIO_INTERRUPTS (RADIO_INTENSET_DISABLED_Enabled << RADIO_INTENSET_DISABLED_Pos) | \
                              (RADIO_INTENSET_ADDRESS_Enabled << RADIO_INTENSET_ADDRESS_Pos)
+#define RADIO_TX_INTERRUPTS (RADIO_INTENSET_DISABLED_Enabled << RADIO_INTENSET_DISABLED_Pos)
 #define RADIO_STATE_IDLE 0x00
 #define RADIO_STATE_RX   0x01
 #define RADIO_STATE_TX   0x02
@@ -50,10 +59,22 @@ typedef struct __attribute__((packed)) {
 } radio_pdu_t;
 
 typedef struct {
-    radio_pdu_t     pdu;       ///< Variable that stores the radio PDU (protocol data unit) that arrives and the radio packets that are about to be sent.
-    radio_cb_t      callback;  ///< Function pointer, stores the callback to use in the RADIO_Irq handler.
-    uint8_t         state;     ///< Internal state of the radio
-    db_radio_mode_t mode;      ///< PHY protocol used by the radio (BLE, IEEE 802.15.4)
+    radio_pdu_t            rx_pdu[RADIO_RX_PDU_COUNT];       ///< Ring of PDUs (protocol data units) where the packets are received
+    db_radio_rx_metadata_t rx_metadata[RADIO_RX_PDU_COUNT];  ///< Metadata of the packets stored in rx_pdu
+    volatile uint8_t       rx_write;                         ///< Index of the PDU the radio receives in, only moved by the radio interrupt
+    volatile uint8_t       rx_read;                          ///< Index of the oldest received PDU, only moved once the callback is done with it
+    int8_t                 rssi;                             ///< RSSI of the last packet handed to the callback
+    radio_cb_t             callback;                         ///< Function pointer, stores the callback to use in the RADIO_Irq handler.
+    uint8_t                state;                            ///< Internal state of the radio
+    db_radio_mode_t        mode;                             ///< PHY protocol used by the radio (BLE, IEEE 802.15.4)
+    radio_pdu_t            tx_pdu[2];                        ///< Packets about to be sent, with db_radio_tx_async the one on air and the queued follow-up
+    radio_tx_cb_t          tx_callback[2];                   ///< Callbacks of the packets stored in tx_pdu
+    uint8_t                tx_index;                         ///< Index of the packet on air in tx_pdu
+    bool                   tx_queued;                        ///< Set when a follow-up packet waits in tx_pdu
+    bool                   timestamp_enabled;                ///< Set when the received packets are timestamped
+    timer_hf_t             timestamp_timer;                  ///< Timer capturing the time of the received packets
+    uint8_t                timestamp_channel;                ///< TIMER channel where the time of the received packets is captured
+    db_radio_stats_t       stats[DB_RADIO_MODE_COUNT];       ///< Reception statistics of each radio mode
 } radio_vars_t;
 
 //=========================== variables ========================================
@@ -75,6 +96,12 @@ static radio_vars_t radio_vars = { 0 };
 //========================== prototypes ========================================
 
 static void _radio_enable(void);
+static void _radio_set_packet_ptr(radio_pdu_t *pdu);
+static void _radio_tx_start(void);
+static bool _radio_tx_next(void);
+static void _radio_tx_done(void);
+static void _radio_rx_start(void);
+static void _radio_rx_commit(bool crc_ok);
 
 //=========================== public ===========================================
 
@@ -194,11 +221,9 @@ void db_radio_init(radio_cb_t callback, db_radio_mode_t mode) {
     }
 
     // Configure pointer to PDU for EasyDMA
-    if (mode == DB_RADIO_IEEE802154_250Kbit) {
-        NRF_RADIO->PACKETPTR = (uint32_t)((uint8_t *)&radio_vars.pdu + 1);  // Skip header for IEEE 802.15.4
-    } else {
-        NRF_RADIO->PACKETPTR = (uint32_t)&radio_vars.pdu;
-    }
+    radio_vars.rx_write = 0;
+    radio_vars.rx_read  = 0;
+    _radio_set_packet_ptr(&radio_vars.rx_pdu[radio_vars.rx_write]);
 
     // Assign the callback function that will be called when a radio packet is received.
     radio_vars.callback = callback;
@@ -212,6 +237,27 @@ void db_radio_init(radio_cb_t callback, db_radio_mode_t mode) {
     // Clear all radio interruptions
     NRF_RADIO->INTENCLR = 0xffffffff;
     NVIC_EnableIRQ(RADIO_IRQn);
+
+    // The received packets are handed to the callback from a software interrupt
+    NVIC_SetPriority(RADIO_RX_SWI_IRQn, RADIO_RX_SWI_PRIORITY);
+    NVIC_ClearPendingIRQ(RADIO_RX_SWI_IRQn);
+    NVIC_EnableIRQ(RADIO_RX_SWI_IRQn);
+}
+
+void db_radio_set_timestamp_timer(timer_hf_t timer, uint8_t channel) {
+    radio_vars.timestamp_timer   = timer;
+    radio_vars.timestamp_channel = channel;
+    db_timer_hf_capture_on_ppi(timer, channel, RADIO_PPI_CHAN_TIMESTAMP);
+
+    // The ADDRESS event triggers the capture
+#if defined(NRF5340_XXAA)
+    NRF_RADIO->PUBLISH_ADDRESS = (RADIO_PUBLISH_ADDRESS_EN_Enabled << RADIO_PUBLISH_ADDRESS_EN_Pos) |
+                                 (RADIO_PPI_CHAN_TIMESTAMP << RADIO_PUBLISH_ADDRESS_CHIDX_Pos);
+#else
+    NRF_PPI->CH[RADIO_PPI_CHAN_TIMESTAMP].EEP = (uint32_t)&NRF_RADIO->EVENTS_ADDRESS;
+#endif
+    NRF_PPI->CHENSET             = (1 << RADIO_PPI_CHAN_TIMESTAMP);
+    radio_vars.timestamp_enabled = true;
 }
 
 void db_radio_set_frequency(uint8_t freq) {
@@ -235,12 +281,12 @@ void db_radio_set_network_address(uint32_t addr) {
 }
 
 void db_radio_tx(const uint8_t *tx_buffer, uint8_t length) {
-    radio_vars.pdu.length = length;
-    memcpy(radio_vars.pdu.payload, tx_buffer, length);
-
-    NRF_RADIO->SHORTS = RADIO_SHORTS_COMMON | (RADIO_SHORTS_DISABLED_RXEN_Enabled << RADIO_SHORTS_DISABLED_RXEN_Pos);
-
     if (radio_vars.state == RADIO_STATE_IDLE) {
+        radio_vars.tx_pdu[radio_vars.tx_index].length = length;
+        memcpy(radio_vars.tx_pdu[radio_vars.tx_index].payload, tx_buffer, length);
+        _radio_set_packet_ptr(&radio_vars.tx_pdu[radio_vars.tx_index]);
+
+        NRF_RADIO->SHORTS = RADIO_SHORTS_COMMON;
 
         // Enable the Radio to send the packet
         NRF_RADIO->EVENTS_DISABLED = 0;  // We must use EVENT_DISABLED, if we use EVENT_END. the interrupts will be enabled in the time between the END event and the Disable event, triggering an undesired interrupt
@@ -252,18 +298,43 @@ void db_radio_tx(const uint8_t *tx_buffer, uint8_t length) {
         // We also clear both flags to avoid insta-triggering an interrupt as soon as we assert INTENSET
         NRF_RADIO->EVENTS_ADDRESS  = 0;
         NRF_RADIO->EVENTS_DISABLED = 0;
-        _radio_enable();
+        _radio_rx_start();
     }
     radio_vars.state = RADIO_STATE_RX;
 }
 
-void db_radio_rx(void) {
-    NRF_RADIO->SHORTS   = RADIO_SHORTS_COMMON | (RADIO_SHORTS_DISABLED_RXEN_Enabled << RADIO_SHORTS_DISABLED_RXEN_Pos);
-    NRF_RADIO->INTENSET = RADIO_INTERRUPTS;
+bool db_radio_tx_async(const uint8_t *tx_buffer, uint8_t length, radio_tx_cb_t callback) {
+    bool accepted = true;
 
+    // The radio interrupt also updates the TX state, keep it away while the packet is stored
+    NVIC_DisableIRQ(RADIO_IRQn);
     if (radio_vars.state == RADIO_STATE_IDLE) {
-        _radio_enable();
-        NRF_RADIO->TASKS_RXEN = RADIO_TASKS_RXEN_TASKS_RXEN_Trigger;
+        radio_vars.tx_pdu[radio_vars.tx_index].length = length;
+        memcpy(radio_vars.tx_pdu[radio_vars.tx_index].payload, tx_buffer, length);
+        radio_vars.tx_callback[radio_vars.tx_index] = callback;
+        _radio_tx_start();
+    } else if ((radio_vars.state & RADIO_STATE_TX) && !radio_vars.tx_queued) {
+        // A packet is on air, the follow-up packet is sent as soon as it ends
+        uint8_t index                   = radio_vars.tx_index ^ 1;
+        radio_vars.tx_pdu[index].length = length;
+        memcpy(radio_vars.tx_pdu[index].payload, tx_buffer, length);
+        radio_vars.tx_callback[index] = callback;
+        radio_vars.tx_queued          = true;
+    } else {
+        accepted = false;
+    }
+    NVIC_EnableIRQ(RADIO_IRQn);
+
+    return accepted;
+}
+
+void db_radio_rx(void) {
+    // The radio goes back to RX on its own once the packets sent with db_radio_tx_async are on air
+    if (radio_vars.state & RADIO_STATE_TX) {
+        return;
+    }
+    if (radio_vars.state == RADIO_STATE_IDLE) {
+        _radio_rx_start();
     }
     radio_vars.state = RADIO_STATE_RX;
 }
@@ -274,11 +345,19 @@ void db_radio_disable(void) {
     NRF_RADIO->EVENTS_DISABLED = 0;
     NRF_RADIO->TASKS_DISABLE   = RADIO_TASKS_DISABLE_TASKS_DISABLE_Trigger << RADIO_TASKS_DISABLE_TASKS_DISABLE_Pos;
     while (NRF_RADIO->EVENTS_DISABLED == 0) {}
-    radio_vars.state = RADIO_STATE_IDLE;
+    // Drop the packet queued with db_radio_tx_async
+    radio_vars.tx_queued = false;
+    radio_vars.state     = RADIO_STATE_IDLE;
 }
 
 int8_t db_radio_rssi(void) {
-    return (uint8_t)NRF_RADIO->RSSISAMPLE * -1;
+    return radio_vars.rssi;
+}
+
+void db_radio_get_stats(db_radio_mode_t mode, db_radio_stats_t *stats) {
+    stats->rx_packets    = radio_vars.stats[mode].rx_packets;
+    stats->rx_crc_errors = radio_vars.stats[mode].rx_crc_errors;
+    stats->rx_overruns   = radio_vars.stats[mode].rx_overruns;
 }
 
 //=========================== private ==========================================
@@ -288,14 +367,102 @@ static void _radio_enable(void) {
     NRF_RADIO->INTENSET        = RADIO_INTERRUPTS;
 }
 
+static void _radio_set_packet_ptr(radio_pdu_t *pdu) {
+    if (radio_vars.mode == DB_RADIO_IEEE802154_250Kbit) {
+        NRF_RADIO->PACKETPTR = (uint32_t)((uint8_t *)pdu + 1);  // Skip header for IEEE 802.15.4
+    } else {
+        NRF_RADIO->PACKETPTR = (uint32_t)pdu;
+    }
+}
+
+static void _radio_tx_start(void) {
+    _radio_set_packet_ptr(&radio_vars.tx_pdu[radio_vars.tx_index]);
+
+    // READY->START and END->DISABLE shortcuts: the radio sends the packet and stops on its own,
+    // the DISABLED interrupt then signals the end of the transmission
+    NRF_RADIO->SHORTS          = RADIO_SHORTS_COMMON;
+    NRF_RADIO->INTENCLR        = RADIO_INTERRUPTS;
+    NRF_RADIO->EVENTS_DISABLED = 0;
+    NRF_RADIO->INTENSET        = RADIO_TX_INTERRUPTS;
+    radio_vars.state           = RADIO_STATE_TX;
+    NRF_RADIO->TASKS_TXEN      = RADIO_TASKS_TXEN_TASKS_TXEN_Trigger << RADIO_TASKS_TXEN_TASKS_TXEN_Pos;
+}
+
+static bool _radio_tx_next(void) {
+    if (!radio_vars.tx_queued) {
+        return false;
+    }
+    radio_vars.tx_queued = false;
+    radio_vars.tx_index ^= 1;
+    _radio_tx_start();
+    return true;
+}
+
+static void _radio_tx_done(void) {
+    radio_tx_cb_t callback = radio_vars.tx_callback[radio_vars.tx_index];
+
+    // The ADDRESS event of the outgoing packet sets the busy flag, it doesn't matter here
+    radio_vars.state = RADIO_STATE_TX;
+
+    // Put the follow-up packet on air before calling the callback, so that it can queue the next one
+    bool on_air = _radio_tx_next();
+    if (callback) {
+        callback();
+    }
+    if (on_air || _radio_tx_next()) {
+        return;
+    }
+
+    // The callback switched the radio off
+    if (radio_vars.state == RADIO_STATE_IDLE) {
+        return;
+    }
+
+    // Last packet sent, go back to RX like db_radio_tx does
+    NRF_RADIO->EVENTS_ADDRESS = 0;
+    _radio_rx_start();
+    radio_vars.state = RADIO_STATE_RX;
+}
+
+static void _radio_rx_start(void) {
+    // The radio stops after each packet (no DISABLED->RXEN shortcut), so that PACKETPTR only
+    // moves to the next PDU of the ring while the radio is disabled
+    _radio_set_packet_ptr(&radio_vars.rx_pdu[radio_vars.rx_write]);
+    NRF_RADIO->SHORTS = RADIO_SHORTS_COMMON;
+    _radio_enable();
+    NRF_RADIO->TASKS_RXEN = RADIO_TASKS_RXEN_TASKS_RXEN_Trigger;
+}
+
+static void _radio_rx_commit(bool crc_ok) {
+    db_radio_stats_t *stats = &radio_vars.stats[radio_vars.mode];
+    stats->rx_packets++;
+    if (!crc_ok) {
+        stats->rx_crc_errors++;
+    }
+
+    uint8_t next = (radio_vars.rx_write + 1) % RADIO_RX_PDU_COUNT;
+    if (next == radio_vars.rx_read) {
+        // The callback didn't catch up, the packet is dropped and its PDU receives the next one
+        stats->rx_overruns++;
+        return;
+    }
+
+    db_radio_rx_metadata_t *metadata = &radio_vars.rx_metadata[radio_vars.rx_write];
+    metadata->timestamp              = radio_vars.timestamp_enabled ? db_timer_hf_get_capture(radio_vars.timestamp_timer, radio_vars.timestamp_channel) : 0;
+    metadata->rssi                   = (uint8_t)NRF_RADIO->RSSISAMPLE * -1;
+    metadata->crc_ok                 = crc_ok;
+    radio_vars.rx_write              = next;
+    NVIC_SetPendingIRQ(RADIO_RX_SWI_IRQn);
+}
+
 //=========================== interrupt handlers ===============================
 
 /**
  * @brief Interruption handler for the Radio.
  *
  * This function will be called each time a radio packet is received.
- * it will clear the interrupt, copy the last received packet
- * and called the user-defined callback to process the package.
+ * it will clear the interrupt, keep the last received packet in the RX ring
+ * and let the software interrupt call the user-defined callback to process the package.
  *
  */
 void RADIO_IRQHandler(void) {
@@ -309,15 +476,33 @@ void RADIO_IRQHandler(void) {
         // Clear the Interrupt flag
         NRF_RADIO->EVENTS_DISABLED = 0;
 
-        if (radio_vars.state == (RADIO_STATE_BUSY | RADIO_STATE_RX)) {
-            if (NRF_RADIO->CRCSTATUS != RADIO_CRCSTATUS_CRCSTATUS_CRCOk) {
-                puts("Invalid CRC");
-            } else if (radio_vars.callback) {
-                radio_vars.callback(radio_vars.pdu.payload, radio_vars.pdu.length);
+        if (radio_vars.state & RADIO_STATE_TX) {
+            _radio_tx_done();
+        } else if (radio_vars.state & RADIO_STATE_RX) {
+            if (radio_vars.state & RADIO_STATE_BUSY) {
+                _radio_rx_commit(NRF_RADIO->CRCSTATUS == RADIO_CRCSTATUS_CRCSTATUS_CRCOk);
             }
+            // Listen again right away, in the next free PDU of the ring
+            _radio_rx_start();
             radio_vars.state = RADIO_STATE_RX;
-        } else {  // TX
-            radio_vars.state = RADIO_STATE_RX;
         }
     }
 }
+
+/**
+ * @brief Software interrupt handler handing the received packets to the callback.
+ *
+ * It runs below the radio interrupt priority, so the radio keeps receiving
+ * in the other PDUs of the ring while the callback processes a packet.
+ */
+void RADIO_RX_SWI_IRQHandler(void) {
+    while (radio_vars.rx_read != radio_vars.rx_write) {
+        uint8_t index   = radio_vars.rx_read;
+        radio_vars.rssi = radio_vars.rx_metadata[index].rssi;
+        if (radio_vars.callback) {
+            radio_vars.callback(radio_vars.rx_pdu[index].payload, radio_vars.rx_pdu[index].length, &radio_vars.rx_metadata[index]);
+        }
+        // The PDU can now be used for a new packet
+        radio_vars.rx_read = (index + 1) % RADIO_RX_PDU_COUNT;
+    }
+}
@@ -8,6 +8,7 @@
  *
  * @copyright Inria, 2022
  */
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 #include <nrf.h>
@@ -19,7 +20,10 @@
 
 //=========================== variables ========================================
 
-static radio_cb_t _radio_callback = NULL;
+static radio_cb_t    _radio_callback    = NULL;
+static radio_tx_cb_t _radio_tx_callback = NULL;
+static bool          _radio_tx_active   = false;
+static bool          _radio_tx_queued   = false;
 
 extern volatile __attribute__((section(".shared_data"))) ipc_shared_data_t ipc_shared_data;
 
@@ -53,6 +57,13 @@ void db_radio_init(radio_cb_t callback, db_radio_mode_t mode) {
     db_ipc_network_call(DB_IPC_RADIO_INIT_REQ);
 }
 
+void db_radio_set_timestamp_timer(timer_hf_t timer, uint8_t channel) {
+    // The radio events of the network core can't trigger the timers of the application core,
+    // the received packets are not timestamped
+    (void)timer;
+    (void)channel;
+}
+
 void db_radio_set_frequency(uint8_t freq) {
     ipc_shared_data.radio.frequency = freq;
     db_ipc_network_call(DB_IPC_RADIO_FREQ_REQ);
@@ -74,6 +85,36 @@ void db_radio_tx(const uint8_t *tx_buffer, uint8_t length) {
     db_ipc_network_call(DB_IPC_RADIO_TX_REQ);
 }
 
+bool db_radio_tx_async(const uint8_t *tx_buffer, uint8_t length, radio_tx_cb_t callback) {
+    if (_radio_tx_queued) {
+        return false;
+    }
+
+    ipc_shared_data.radio.tx_pdu.length = length;
+    memcpy((void *)ipc_shared_data.radio.tx_pdu.buffer, tx_buffer, length);
+    _radio_tx_callback = callback;
+    _radio_tx_queued   = true;
+    if (_radio_tx_active) {
+        // Called from a completion callback, the packet is sent once the callback returns
+        return true;
+    }
+
+    // The network core sends the packets one at a time, the follow-up packets are sent in a loop
+    // rather than from nested callbacks
+    _radio_tx_active = true;
+    while (_radio_tx_queued) {
+        radio_tx_cb_t tx_callback = _radio_tx_callback;
+        _radio_tx_queued          = false;
+        db_ipc_network_call(DB_IPC_RADIO_TX_REQ);
+        if (tx_callback) {
+            tx_callback();
+        }
+    }
+    _radio_tx_active = false;
+
+    return true;
+}
+
 void db_radio_rx(void) {
     db_ipc_network_call(DB_IPC_RADIO_RX_REQ);
 }
@@ -83,6 +124,14 @@ int8_t db_radio_rssi(void) {
     return ipc_shared_data.radio.rssi;
 }
 
+void db_radio_get_stats(db_radio_mode_t mode, db_radio_stats_t *stats) {
+    ipc_shared_data.radio.stats_mode = mode;
+    db_ipc_network_call(DB_IPC_RADIO_STATS_REQ);
+    stats->rx_packets    = ipc_shared_data.radio.stats.rx_packets;
+    stats->rx_crc_errors = ipc_shared_data.radio.stats.rx_crc_errors;
+    stats->rx_overruns   = ipc_shared_data.radio.stats.rx_overruns;
+}
+
 void db_radio_disable(void) {
     db_ipc_network_call(DB_IPC_RADIO_DIS_REQ);
 }
@@ -92,10 +141,24 @@ void db_radio_disable(void) {
 void IPC_IRQHandler(void) {
     if (NRF_IPC_S->EVENTS_RECEIVE[DB_IPC_CHAN_RADIO_RX]) {
         NRF_IPC_S->EVENTS_RECEIVE[DB_IPC_CHAN_RADIO_RX] = 0;
-        if (_radio_callback) {
+        // One event may stand for several packets, take them all out of the ring. The network core keeps
+        // writing the next ones while the callback runs
+        while (ipc_shared_data.radio.rx_read != ipc_shared_data.radio.rx_write) {
+            uint8_t packet[UINT8_MAX];
             mutex_lock();
-            _radio_callback((uint8_t *)ipc_shared_data.radio.rx_pdu.buffer, ipc_shared_data.radio.rx_pdu.length);
+            uint8_t                read     = ipc_shared_data.radio.rx_read;
+            uint8_t                length   = ipc_shared_data.radio.rx[read].pdu.length;
+            db_radio_rx_metadata_t metadata = {
+                .timestamp = 0,
+                .rssi      = ipc_shared_data.radio.rx[read].metadata.rssi,
+                .crc_ok    = ipc_shared_data.radio.rx[read].metadata.crc_ok,
+            };
+            memcpy(packet, (void *)ipc_shared_data.radio.rx[read].pdu.buffer, length);
+            ipc_shared_data.radio.rx_read = (read + 1) % RADIO_RX_PDU_COUNT;
             mutex_unlock();
+            if (_radio_callback) {
+                _radio_callback(packet, length, &metadata);
+            }
         }
     }
 }
@@ -20,6 +20,14 @@
 
 #define TIMER_MAX_CHANNELS (6U)
 
+#if defined(NRF5340_XXAA)
+#if defined(NRF_NETWORK) || defined(NRF_TRUSTZONE_NONSECURE)
+#define NRF_PPI NRF_DPPIC_NS
+#else
+#define NRF_PPI NRF_DPPIC_S
+#endif
+#endif
+
 typedef struct {
     NRF_TIMER_Type *p;
     IRQn_Type       irq;
@@ -158,6 +166,21 @@ void db_timer_hf_set_oneshot_s(timer_hf_t timer, uint8_t channel, uint32_t s, ti
     db_timer_hf_set_oneshot_us(timer, channel, s * 1000UL * 1000UL, cb);
 }
 
+void db_timer_hf_capture_on_ppi(timer_hf_t timer, uint8_t channel, uint8_t ppi_channel) {
+    assert(channel >= 0 && channel < _devs[timer].cc_num);  // Make sure the required channel is correct
+
+#if defined(NRF5340_XXAA)
+    _devs[timer].p->SUBSCRIBE_CAPTURE[channel] = (TIMER_SUBSCRIBE_CAPTURE_EN_Enabled << TIMER_SUBSCRIBE_CAPTURE_EN_Pos) |
+                                                 (ppi_channel << TIMER_SUBSCRIBE_CAPTURE_CHIDX_Pos);
+#else
+    NRF_PPI->CH[ppi_channel].TEP = (uint32_t)&_devs[timer].p->TASKS_CAPTURE[channel];
+#endif
+}
+
+uint32_t db_timer_hf_get_capture(timer_hf_t timer, uint8_t channel) {
+    return _devs[timer].p->CC[channel];
+}
+
 void db_timer_hf_delay_us(timer_hf_t timer, uint32_t us) {
     _devs[timer].p->TASKS_CAPTURE[_devs[timer].cc_num] = 1;
     _devs[timer].p->CC[_devs[timer].cc_num] += us;
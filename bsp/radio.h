@@ -19,15 +19,26 @@
  * @}
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <nrf.h>
 
+#include "timer_hf.h"
+
 //=========================== defines ==========================================
 
 #ifndef DEFAULT_NETWORK_ADDRESS
 #define DEFAULT_NETWORK_ADDRESS 0x12345678UL  ///< Default network address
 #endif
 
+#ifndef RADIO_RX_PDU_COUNT
+#define RADIO_RX_PDU_COUNT 4  ///< Number of PDUs of the RX ring, the received packets wait there until the callback is done with them
+#endif
+
+#if RADIO_RX_PDU_COUNT < 2
+#error "RADIO_RX_PDU_COUNT must be at least 2"
+#endif
+
 #define DB_BLE_PAYLOAD_MAX_LENGTH        UINT8_MAX
 #define DB_IEEE802154_PAYLOAD_MAX_LENGTH (125UL)  ///< Total usable payload for IEEE 802.15.4 is 125 octets (PSDU) when CRC is activated
 
@@ -40,7 +51,24 @@ typedef enum {
     DB_RADIO_IEEE802154_250Kbit
 } db_radio_mode_t;
 
-typedef void (*radio_cb_t)(uint8_t *packet, uint8_t length);  ///< Function pointer to the callback function called on packet receive
+#define DB_RADIO_MODE_COUNT (DB_RADIO_IEEE802154_250Kbit + 1)  ///< Number of modes supported by the radio
+
+/// Metadata of a received packet
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp;  ///< Time of the ADDRESS event of the packet, in microseconds of the timer set with db_radio_set_timestamp_timer (0 if not set)
+    int8_t   rssi;       ///< RSSI of the packet, in dBm
+    bool     crc_ok;     ///< true if the CRC of the packet is valid, the packet must be ignored otherwise
+} db_radio_rx_metadata_t;
+
+/// Radio reception statistics of a radio mode
+typedef struct __attribute__((packed)) {
+    uint32_t rx_packets;     ///< number of packets received, CRC errors included
+    uint32_t rx_crc_errors;  ///< number of packets received with an invalid CRC
+    uint32_t rx_overruns;    ///< number of packets dropped because the RX ring was full
+} db_radio_stats_t;
+
+typedef void (*radio_cb_t)(uint8_t *packet, uint8_t length, const db_radio_rx_metadata_t *metadata);  ///< Function pointer to the callback function called on packet receive
+typedef void (*radio_tx_cb_t)(void);                                                                   ///< Function pointer to the callback function called when a packet is sent
 
 //=========================== public ===========================================
 
@@ -50,12 +78,26 @@ typedef void (*radio_cb_t)(uint8_t *packet, uint8_t length);  ///< Function poin
  * After this function you must explicitly set the frequency of the radio
  * with the db_radio_set_frequency function.
  *
- * @param[in] callback pointer to a function that will be called each time a packet is received.
+ * @param[in] callback pointer to a function that will be called each time a packet is received,
+ *                     packets with an invalid CRC included (see db_radio_rx_metadata_t).
+ *                     It runs from a software interrupt, below the radio interrupt priority, while
+ *                     the radio receives the next packets in the other PDUs of the RX ring.
  * @param[in] mode     Mode used by the radio BLE (1MBit, 2MBit, LR125KBit, LR500Kbit) or IEEE 802.15.4 (250Kbit)
  *
  */
 void db_radio_init(radio_cb_t callback, db_radio_mode_t mode);
 
+/**
+ * @brief Timestamp the received packets with a high frequency timer
+ *
+ * The time of the ADDRESS event of each packet is captured by the timer through (D)PPI,
+ * without software latency, and reported in the metadata of the packet.
+ *
+ * @param[in] timer     timer used, it must be initialized with db_timer_hf_init
+ * @param[in] channel   TIMER channel where the time is captured, not used for anything else
+ */
+void db_radio_set_timestamp_timer(timer_hf_t timer, uint8_t channel);
+
 /**
  * @brief Set the tx-rx frequency of the radio, by the following formula
  *
@@ -100,11 +142,32 @@ void db_radio_set_network_address(uint32_t addr);
  */
 void db_radio_tx(const uint8_t *packet, uint8_t length);
 
+/**
+ * @brief Sends a packet through the Radio without waiting for the end of the transmission
+ *
+ * The packet is copied, so the buffer can be reused right away. The callback is called from
+ * the radio interrupt once the packet is sent. While a packet is on air, one follow-up packet
+ * can be queued (e.g. from the callback): it is sent right after the current one. Once the
+ * last packet is sent, the radio goes back to RX, like with db_radio_tx, unless the callback
+ * of that packet calls db_radio_disable.
+ *
+ * NOTE: The radio must not be receiving packets when calling this function.
+ * (first call db_radio_disable if needed)
+ *
+ * @param[in] packet    pointer to the array of data to send over the radio
+ * @param[in] length    Number of bytes to send
+ * @param[in] callback  function called when the packet is sent, can be NULL
+ *
+ * @return true if the packet was sent or queued, false if a follow-up packet is already queued or the radio is receiving
+ */
+bool db_radio_tx_async(const uint8_t *packet, uint8_t length, radio_tx_cb_t callback);
+
 /**
  * @brief Starts Receiving packets through the Radio
  *
  * NOTE: Must configure the radio and the frequency before calling this function.
  * (with the functions db_radio_init db_radio_set_frequency).
+ * While packets sent with db_radio_tx_async are on air, the radio starts receiving once they are sent.
  *
  */
 void db_radio_rx(void);
@@ -113,11 +176,24 @@ void db_radio_rx(void);
  * @brief Reads the RSSI of a received packet
  *
  * Should be called after a packet is received, e.g. in the radio callback
+ *
+ * @return RSSI of the last packet handed to the radio callback
  */
 int8_t db_radio_rssi(void);
 
+/**
+ * @brief Reads the reception statistics of the radio
+ *
+ * @param[in]  mode  radio mode the statistics are read for
+ * @param[out] stats pointer to the statistics to fill
+ */
+void db_radio_get_stats(db_radio_mode_t mode, db_radio_stats_t *stats);
+
 /**
  * @brief Disables the radio, no packet can be received and energy consumption is minimal
+ *
+ * A packet sent with db_radio_tx_async is aborted and the queued follow-up packet is dropped,
+ * their callbacks are not called.
  */
 void db_radio_disable(void);
 
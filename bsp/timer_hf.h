@@ -77,6 +77,21 @@ void db_timer_hf_set_oneshot_ms(timer_hf_t timer, uint8_t channel, uint32_t ms,
  */
 void db_timer_hf_set_oneshot_s(timer_hf_t timer, uint8_t channel, uint32_t s, timer_hf_cb_t cb);
 
+/**
+ * @brief Capture the timer time in a channel each time a (D)PPI channel is triggered, e.g by a peripheral event
+ * @param[in] timer         timer reference used
+ * @param[in] channel       TIMER channel where the time is captured
+ * @param[in] ppi_channel   (D)PPI channel triggering the capture, its event side is set by the caller
+ */
+void db_timer_hf_capture_on_ppi(timer_hf_t timer, uint8_t channel, uint8_t ppi_channel);
+
+/**
+ * @brief Return the last time captured in a channel, in microseconds
+ * @param[in] timer     timer reference used
+ * @param[in] channel   TIMER channel read
+ */
+uint32_t db_timer_hf_get_capture(timer_hf_t timer, uint8_t channel);
+
 /**
  * @brief Add a delay in us using the high frequency timer
  *
@@ -0,0 +1,167 @@
+#ifndef __NRF_H
+#define __NRF_H
+
+/**
+ * @file
+ * @brief       Host replacement of the nRF MDK header, for the LH2 decoding benchmarks
+ *
+ * Only provides what the nRF52833 flavor of the LH2 driver needs to build. The peripherals are
+ * plain variables that nothing reads back, the benchmarks feed the decoding functions directly
+ * with captures and never start the SPIM.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Peripheral to peripheral channel endpoints
+typedef struct {
+    uint32_t EEP;  ///< Event end point
+    uint32_t TEP;  ///< Task end point
+} PPI_CH_Type;
+
+/// Channel group tasks
+typedef struct {
+    uint32_t EN;   ///< Enable the channel group
+    uint32_t DIS;  ///< Disable the channel group
+} PPI_TASKS_CHG_Type;
+
+/// Fork task end point
+typedef struct {
+    uint32_t TEP;  ///< Task end point
+} PPI_FORK_Type;
+
+/// Programmable peripheral interconnect registers
+typedef struct {
+    PPI_TASKS_CHG_Type TASKS_CHG[6];  ///< Channel group tasks
+    uint32_t           CHEN;          ///< Channel enable
+    uint32_t           CHENSET;       ///< Channel enable set
+    uint32_t           CHENCLR;       ///< Channel enable clear
+    PPI_CH_Type        CH[20];        ///< Channel end points
+    uint32_t           CHG[6];        ///< Channel groups
+    PPI_FORK_Type      FORK[32];      ///< Fork task end points
+} NRF_PPI_Type;
+
+/// SPIM pin selection
+typedef struct {
+    uint32_t SCK;   ///< Pin select for SCK
+    uint32_t MOSI;  ///< Pin select for MOSI
+    uint32_t MISO;  ///< Pin select for MISO
+} SPIM_PSEL_Type;
+
+/// SPIM EasyDMA channel
+typedef struct {
+    uint32_t PTR;     ///< Data pointer
+    uint32_t MAXCNT;  ///< Maximum number of bytes in the buffer
+    uint32_t AMOUNT;  ///< Number of bytes transferred in the last transaction
+} SPIM_DMA_Type;
+
+/// Serial peripheral interface master registers
+typedef struct {
+    uint32_t       TASKS_START;      ///< Start the SPI transaction
+    uint32_t       TASKS_STOP;       ///< Stop the SPI transaction
+    uint32_t       SUBSCRIBE_START;  ///< Subscribe configuration of TASKS_START (nRF5340)
+    uint32_t       EVENTS_END;       ///< End of the transaction
+    uint32_t       INTENSET;         ///< Enable interrupt
+    uint32_t       ENABLE;           ///< Enable the SPIM
+    SPIM_PSEL_Type PSEL;             ///< Pin selection
+    uint32_t       FREQUENCY;        ///< SPI frequency
+    SPIM_DMA_Type  RXD;              ///< Receive EasyDMA channel
+    SPIM_DMA_Type  TXD;              ///< Transmit EasyDMA channel
+    uint32_t       CONFIG;           ///< Configuration register
+} NRF_SPIM_Type;
+
+/// GPIO tasks and events registers
+typedef struct {
+    uint32_t EVENTS_IN[8];  ///< Event generated from the pin of each channel
+    uint32_t CONFIG[8];     ///< Configuration of each channel
+} NRF_GPIOTE_Type;
+
+/// GPIO port registers
+typedef struct {
+    uint32_t OUT;          ///< Write GPIO port
+    uint32_t OUTSET;       ///< Set individual bits in GPIO port
+    uint32_t OUTCLR;       ///< Clear individual bits in GPIO port
+    uint32_t IN;           ///< Read GPIO port
+    uint32_t DIRSET;       ///< DIR set register
+    uint32_t PIN_CNF[32];  ///< Configuration of each pin
+} NRF_GPIO_Type;
+
+/// Interrupt numbers
+typedef enum {
+    SPIM3_IRQn = 47,  ///< SPIM3 interrupt
+} IRQn_Type;
+
+extern NRF_PPI_Type    bench_ppi;     ///< Programmable peripheral interconnect
+extern NRF_SPIM_Type   bench_spim;    ///< SPI master used by the LH2 driver
+extern NRF_GPIOTE_Type bench_gpiote;  ///< GPIO tasks and events
+extern NRF_GPIO_Type   bench_p0;      ///< GPIO port 0
+extern NRF_GPIO_Type   bench_p1;      ///< GPIO port 1
+
+#define NRF_PPI    (&bench_ppi)     ///< Programmable peripheral interconnect
+#define NRF_SPIM3  (&bench_spim)    ///< SPI master used by the LH2 driver
+#define NRF_GPIOTE (&bench_gpiote)  ///< GPIO tasks and events
+#define NRF_P0     (&bench_p0)      ///< GPIO port 0
+#define NRF_P1     (&bench_p1)      ///< GPIO port 1
+
+#define GPIO_PIN_CNF_DIR_Pos        0  ///< Pin direction
+#define GPIO_PIN_CNF_DIR_Input      0  ///< Configure pin as an input pin
+#define GPIO_PIN_CNF_DIR_Output     1  ///< Configure pin as an output pin
+#define GPIO_PIN_CNF_INPUT_Pos      1  ///< Connect or disconnect input buffer
+#define GPIO_PIN_CNF_INPUT_Connect  0  ///< Connect input buffer
+#define GPIO_PIN_CNF_PULL_Pos       2  ///< Pull configuration
+#define GPIO_PIN_CNF_PULL_Disabled  0  ///< No pull
+#define GPIO_PIN_CNF_DRIVE_Pos      8  ///< Drive configuration
+#define GPIO_PIN_CNF_DRIVE_S0S1     0  ///< Standard '0', standard '1'
+
+#define GPIOTE_CONFIG_MODE_Pos        0  ///< Mode
+#define GPIOTE_CONFIG_MODE_Event      1  ///< Event mode
+#define GPIOTE_CONFIG_PSEL_Pos        8  ///< GPIO number
+#define GPIOTE_CONFIG_PORT_Pos        13  ///< Port number
+#define GPIOTE_CONFIG_POLARITY_Pos    16  ///< Polarity
+#define GPIOTE_CONFIG_POLARITY_LoToHi 1   ///< Rising edge
+#define GPIOTE_CONFIG_POLARITY_HiToLo 2   ///< Falling edge
+#define GPIOTE_CONFIG_POLARITY_Toggle 3   ///< Both edges
+
+#define SPIM_CONFIG_ORDER_Pos            0           ///< Bit order
+#define SPIM_CONFIG_ORDER_MsbFirst       0           ///< Most significant bit shifted out first
+#define SPIM_ENABLE_ENABLE_Pos           0           ///< Enable or disable SPIM
+#define SPIM_ENABLE_ENABLE_Enabled       7           ///< Enable SPIM
+#define SPIM_FREQUENCY_FREQUENCY_M32     0x14000000  ///< 32 Mbps
+#define SPIM_INTENSET_END_Pos            6           ///< Enable interrupt for event END
+#define SPIM_INTENSET_END_Enabled        1           ///< Enable
+#define SPIM_PSEL_SCK_PIN_Pos            0           ///< Pin number
+#define SPIM_PSEL_SCK_PORT_Pos           5           ///< Port number
+#define SPIM_PSEL_SCK_CONNECT_Pos        31          ///< Connection
+#define SPIM_PSEL_SCK_CONNECT_Connected  0           ///< Connect
+#define SPIM_PSEL_MOSI_PIN_Pos           0           ///< Pin number
+#define SPIM_PSEL_MOSI_PORT_Pos          5           ///< Port number
+#define SPIM_PSEL_MOSI_CONNECT_Pos       31          ///< Connection
+#define SPIM_PSEL_MOSI_CONNECT_Connected 0           ///< Connect
+#define SPIM_PSEL_MISO_PIN_Pos           0           ///< Pin number
+#define SPIM_PSEL_MISO_PORT_Pos          5           ///< Port number
+#define SPIM_PSEL_MISO_CONNECT_Pos       31          ///< Connection
+#define SPIM_PSEL_MISO_CONNECT_Connected 0           ///< Connect
+
+#define __DMB() __sync_synchronize()  ///< Data memory barrier
+#define __NOP() ((void)0)             ///< No operation
+
+static inline void NVIC_EnableIRQ(IRQn_Type irq) {
+    (void)irq;
+}
+
+static inline void NVIC_DisableIRQ(IRQn_Type irq) {
+    (void)irq;
+}
+
+static inline void NVIC_ClearPendingIRQ(IRQn_Type irq) {
+    (void)irq;
+}
+
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) {
+    (void)irq;
+    (void)priority;
+}
+
+#endif
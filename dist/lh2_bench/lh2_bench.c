@@ -0,0 +1,641 @@
+/**
+ * @file
+ * @brief       Host tests and benchmarks of the LH2 decoding pipeline
+ *
+ * The LH2 driver is built for the host computer, on top of dummy peripherals (see lh2_bench_bsp.c),
+ * and its decoding functions are called directly. Each command checks one stage of the pipeline
+ * against a reference and reports its speed:
+ *
+ * - `solver`: the LFSR position solver, on every state of every polynomial, against the position
+ *   counted by stepping the LFSR one bit at a time from the seed
+ * - `demodulate`: the demodulator, against the previous one that counted the samples between zero
+ *   crossings one at a time (see lh2_reference.c)
+ * - `polynomial`: the bit-sliced polynomial search, on the demodulated captures, against the
+ *   previous one that ran the seed through each polynomial one after the other
+ * - `position`: the planar position solver, on the counts of COUNT positions drawn from SEED and
+ *   seen by 2 basestations through their calibration homographies, against the drawn positions
+ * - `budget`: the RAM and flash used by the decoding tables and the worst case cost of a lookup of
+ *   the solver, for the LH2_BASESTATION_COUNT of the build (also `make lh2-budget`)
+ *
+ * The commands working on captures take them from a file recorded with dist/scripts/lh2_capture
+ * (`-f FILE`), or synthesize COUNT of them, half clean and half noisy, from the SEED of a
+ * pseudo-random generator (`-n COUNT -s SEED`). Build it from the root of the repository with
+ * `make lh2-bench`, then for example:
+ *
+ *     dist/lh2_bench/lh2_bench solver
+ *     dist/lh2_bench/lh2_bench demodulate -n 100000 -s 7
+ *     dist/lh2_bench/lh2_bench demodulate -f captures.bin
+ *     dist/lh2_bench/lh2_bench polynomial -n 100000
+ *     dist/lh2_bench/lh2_bench position -n 100000 -s 3
+ *
+ * The driver is built with its default configuration, the build flags select another one, for
+ * example the bit-serial checkpoint solver instead of the baby-step/giant-step one:
+ *
+ *     make lh2-bench LH2_BENCH_CFLAGS="-DLH2_LFSR_SOLVER_BABY_STEPS=0"
+ *
+ * A checkpoint spacing regenerates the checkpoint tables in build/include and selects that solver:
+ *
+ *     make lh2-bench LH2_CHECKPOINT_SPACING=512
+ *
+ * The commands exit with an error status if the results differ from the reference.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include "nrf/lh2_default.c"
+
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lh2_position.h"
+#include "lh2_reference.h"
+
+//=========================== defines ==========================================
+
+#define BENCH_LFSR_STATES (1 << LH2_LFSR_WIDTH)  ///< Number of values of an LFSR state, the all zeros one included
+#define BENCH_MAX_ERRORS  5                      ///< Max number of mismatches printed per command
+#define BENCH_CAPTURES    10000                  ///< Default number of synthesized captures
+#define BENCH_SEED        1                      ///< Default seed of the synthesized captures
+#define BENCH_ROUNDS      10                     ///< Number of times the captures are decoded to time a decoding stage
+
+#define BENCH_FILE_MAGIC     "LH2C"           ///< First bytes of a capture file
+#define BENCH_FILE_VERSION   1                ///< Version of the capture file format
+#define BENCH_SAMPLES        (LH2_CAPTURE_SIZE * 8)  ///< Number of SPI samples in a capture
+#define BENCH_CHIP_SAMPLES   (32.0 / 6.0)     ///< Number of SPI samples per chip, 6 Mchips/s sampled at 32MHz
+#define BENCH_EDGE_JITTER    1.2              ///< Peak to peak jitter of the edges of a noisy capture, in samples
+#define BENCH_FLIP_RATE      0.01             ///< Probability of a wrong sample in a noisy capture
+#define BENCH_MAX_RUNS       256              ///< Number of runs of identical samples after which the previous demodulator wraps around
+
+#define BENCH_POSITION_BASESTATIONS ((LH2_BASESTATION_COUNT < 2) ? LH2_BASESTATION_COUNT : 2)  ///< Number of calibrated basestations of the position command
+#define BENCH_POSITION_AREA         2000.0  ///< Side of the square the positions are drawn in, in millimeters
+#define BENCH_POSITION_MARGIN       200.0   ///< Distance between the positions and the sides of the square, in millimeters
+#define BENCH_POSITION_TOLERANCE    1.0     ///< Max distance between a computed position and the drawn one, in millimeters
+#define BENCH_ROTATION_US           16000   ///< Time between 2 fixes, about one rotation of a basestation
+#define BENCH_LFSR_TICKS            8       ///< Number of 48MHz basestation ticks per LFSR bit
+#define BENCH_SWEEP_ANGLE           (M_PI / 3)  ///< Angle between the 2 tilted laser planes of a basestation
+
+#if LH2_LFSR_SOLVER_BABY_STEPS > 0
+#define BENCH_SOLVER_NAME "baby-step/giant-step"  ///< Name of the solver built in the driver
+#define BENCH_REVERSE_COUNT(polynomial, bits) _reverse_count_p_bsgs(polynomial, bits)
+#else
+#define BENCH_SOLVER_NAME "bit-serial checkpoint"  ///< Name of the solver built in the driver
+#define BENCH_REVERSE_COUNT(polynomial, bits) _reverse_count_p(polynomial, bits)
+#endif
+
+/// Command of the benchmark
+typedef struct {
+    const char *name;           ///< Name given on the command line
+    int (*run)(void);           ///< Run the command, returns the number of mismatches
+    const char *description;    ///< Help text
+} bench_command_t;
+
+/// Options of the commands
+typedef struct {
+    const char *file;   ///< Capture file recorded with lh2_capture.py, NULL to synthesize the captures
+    uint32_t    count;  ///< Number of captures to synthesize
+    uint32_t    seed;   ///< Seed of the synthesized captures
+} bench_options_t;
+
+//=========================== prototypes =======================================
+
+/**
+ * @brief   Read the monotonic clock of the host
+ *
+ * @return  time in nanoseconds
+ */
+static uint64_t _bench_now_ns(void);
+
+/**
+ * @brief   Check the LFSR position solver on every state of every polynomial
+ *
+ * @return  number of states where the solver differs from the reference
+ */
+static int _bench_solver(void);
+
+/**
+ * @brief   Check the demodulator against the previous one on the captures
+ *
+ * @return  number of captures demodulated differently
+ */
+static int _bench_demodulate(void);
+
+/**
+ * @brief   Check the polynomial search against the previous one on the demodulated captures
+ *
+ * @return  number of captures where the polynomial or the bit offset differ
+ */
+static int _bench_polynomial(void);
+
+/**
+ * @brief   Check the planar position solver on the counts of positions seen by calibrated basestations
+ *
+ * @return  number of positions computed further than BENCH_POSITION_TOLERANCE from the drawn ones
+ */
+static int _bench_position(void);
+
+/**
+ * @brief   Compute the LFSR counts of the sweeps of a basestation hitting a position of the floor plane
+ *
+ * @param[in]   basestation     index of the basestation
+ * @param[in]   x               X coordinate of the position, in millimeters
+ * @param[in]   y               Y coordinate of the position, in millimeters
+ * @param[out]  counts          LFSR counts of both sweeps, as decoded by the driver
+ *
+ * @return  true if the position is in the field of view of the basestation
+ */
+static bool _bench_position_counts(uint8_t basestation, double x, double y, uint32_t counts[LH2_SWEEP_COUNT]);
+
+/**
+ * @brief   Print the footprint of the decoding tables and the worst case cost of a lookup
+ *
+ * @return  0, the build already checked them against LH2_RAM_BUDGET and LH2_LFSR_SOLVER_STEP_BUDGET
+ */
+static int _bench_budget(void);
+
+/**
+ * @brief   Parse the options following the command
+ *
+ * @param[in]   argc    number of arguments, the command included
+ * @param[in]   argv    arguments, starting with the command
+ *
+ * @return  true if the options are valid
+ */
+static bool _bench_parse_options(int argc, char **argv);
+
+/**
+ * @brief   Read the captures from the capture file or synthesize them, depending on the options
+ *
+ * @return  true if the captures are ready
+ */
+static bool _bench_load_captures(void);
+
+/**
+ * @brief   Synthesize the SPI samples of a random sweep of a random polynomial
+ *
+ * @param[out]  samples     LH2_CAPTURE_SIZE bytes of SPI samples
+ * @param[in]   noisy       jitter the edges and flip some samples
+ */
+static void _bench_synthesize_capture(uint8_t *samples, bool noisy);
+
+/**
+ * @brief   Count the runs of identical samples of a capture followed by silence
+ *
+ * @param[in]   samples     LH2_CAPTURE_SIZE bytes of SPI samples
+ *
+ * @return  number of runs
+ */
+static uint32_t _bench_run_count(const uint8_t *samples);
+
+/**
+ * @brief   Pseudo-random generator (xorshift32) of the synthesized captures
+ *
+ * @return  uniformly distributed number in [0, 1)
+ */
+static double _bench_random(void);
+
+//=========================== variables ========================================
+
+static uint32_t _bench_positions[BENCH_LFSR_STATES];  ///< Position of each LFSR state in the sequence of a polynomial
+
+/// Calibration homographies of the position command, from the camera points to millimeters on the floor,
+/// one basestation in front of the area and the other one on its side, both tilted
+static const float _bench_homographies[2][3][3] = {
+    {
+        { 1200.0f, 60.0f, 1000.0f },
+        { -40.0f, 1150.0f, 1000.0f },
+        { 0.02f, -0.05f, 1.0f },
+    },
+    {
+        { 50.0f, -1100.0f, 1000.0f },
+        { 1250.0f, 30.0f, 1000.0f },
+        { -0.04f, 0.03f, 1.0f },
+    },
+};
+
+/// Rotation period of the calibrated basestations, in 48MHz ticks
+static const uint32_t _bench_basestation_periods[2] = { 959000, 957000 };
+
+static bench_options_t _bench_options = {
+    .file  = NULL,
+    .count = BENCH_CAPTURES,
+    .seed  = BENCH_SEED,
+};
+
+static uint8_t (*_bench_captures)[LH2_CAPTURE_SIZE] = NULL;  ///< Captures used by the commands
+static uint32_t _bench_capture_count                 = 0;     ///< Number of captures
+static uint32_t _bench_random_state                  = 0;     ///< State of the pseudo-random generator
+
+static const bench_command_t _bench_commands[] = {
+    { "solver", _bench_solver, "check the LFSR position solver on every state of every polynomial" },
+    { "demodulate", _bench_demodulate, "check the demodulator against the previous one on the captures" },
+    { "polynomial", _bench_polynomial, "check the polynomial search against the previous one on the demodulated captures" },
+    { "position", _bench_position, "check the position solver on the counts of positions seen by 2 calibrated basestations" },
+    { "budget", _bench_budget, "print the memory used by the decoding tables and the worst case cost of a lookup" },
+};
+
+//=========================== main =============================================
+
+int main(int argc, char **argv) {
+
+    for (size_t command = 0; argc >= 2 && command < sizeof(_bench_commands) / sizeof(_bench_commands[0]); command++) {
+        if (strcmp(argv[1], _bench_commands[command].name) == 0) {
+            if (!_bench_parse_options(argc - 1, &argv[1])) {
+                break;
+            }
+            int errors = _bench_commands[command].run();
+            printf("%s: %s\n", _bench_commands[command].name, errors ? "FAILED" : "ok");
+            return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+    }
+
+    printf("Usage: %s COMMAND [-f FILE | -n COUNT -s SEED]\n\nCommands:\n", argv[0]);
+    for (size_t command = 0; command < sizeof(_bench_commands) / sizeof(_bench_commands[0]); command++) {
+        printf("  %-12s %s\n", _bench_commands[command].name, _bench_commands[command].description);
+    }
+    printf("\nOptions:\n");
+    printf("  -f FILE      read the captures from a file recorded with lh2_capture.py\n");
+    printf("  -n COUNT     number of captures (or positions) to synthesize (default: %u)\n", BENCH_CAPTURES);
+    printf("  -s SEED      seed of the synthesized captures (default: %u)\n", BENCH_SEED);
+    return EXIT_FAILURE;
+}
+
+//=========================== private ==========================================
+
+static uint64_t _bench_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static int _bench_solver(void) {
+
+    int errors = 0;
+
+#if LH2_LFSR_SOLVER_BABY_STEPS > 0
+    _fill_bsgs_tables();
+#endif
+    printf("%s solver, %u polynomials\n", BENCH_SOLVER_NAME, LH2_POLYNOMIAL_COUNT);
+
+    for (uint8_t polynomial = 0; polynomial < LH2_POLYNOMIAL_COUNT; polynomial++) {
+
+        // Reference: step the LFSR one bit at a time through its whole sequence
+        memset(_bench_positions, 0xFF, sizeof(_bench_positions));
+        uint32_t state = LH2_LFSR_SEED;
+        for (uint32_t position = 0; position < LH2_LFSR_PERIOD; position++) {
+            _bench_positions[state] = position;
+            state                   = ((state << 1) | (__builtin_popcount(state & _polynomials[polynomial]) & 0x01)) & 0x0001FFFF;
+        }
+
+        // Time all the lookups together, the clock is slower to read than a lookup
+        volatile uint32_t sink  = 0;
+        uint64_t          start = _bench_now_ns();
+        for (uint32_t bits = 1; bits < BENCH_LFSR_STATES; bits++) {
+            sink += BENCH_REVERSE_COUNT(polynomial, bits);
+        }
+        uint64_t total_ns = _bench_now_ns() - start;
+
+        // The all zeros state is never part of the sequence, every other one is
+        uint32_t mismatches = 0;
+        for (uint32_t bits = 0; bits < BENCH_LFSR_STATES; bits++) {
+            uint32_t position = BENCH_REVERSE_COUNT(polynomial, bits);
+            if (position != _bench_positions[bits]) {
+                if (errors + mismatches < BENCH_MAX_ERRORS) {
+                    printf("  polynomial %u, state 0x%05X: position %u instead of %u\n", polynomial, bits, position, _bench_positions[bits]);
+                }
+                mismatches++;
+            }
+        }
+
+        printf("  polynomial %u: %u/%u states wrong, %.0f ns per lookup\n", polynomial, mismatches, BENCH_LFSR_STATES, (double)total_ns / LH2_LFSR_PERIOD);
+        errors += mismatches;
+    }
+
+    return errors;
+}
+
+static int _bench_demodulate(void) {
+
+    if (!_bench_load_captures()) {
+        return 1;
+    }
+
+    // The previous demodulator wraps around after 256 runs, it is only a reference below that
+    uint32_t compared   = 0;
+    uint32_t mismatches = 0;
+    for (uint32_t capture = 0; capture < _bench_capture_count; capture++) {
+        if (_bench_run_count(_bench_captures[capture]) > BENCH_MAX_RUNS) {
+            continue;
+        }
+        compared++;
+        uint64_t bits           = _demodulate_light(_bench_captures[capture]);
+        uint64_t reference_bits = reference_demodulate_light(_bench_captures[capture]);
+        if (bits != reference_bits) {
+            if (mismatches < BENCH_MAX_ERRORS) {
+                printf("  capture %u: 0x%016llX instead of 0x%016llX\n", capture, (unsigned long long)bits, (unsigned long long)reference_bits);
+            }
+            mismatches++;
+        }
+    }
+
+    volatile uint64_t sink  = 0;
+    uint64_t          start = _bench_now_ns();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        for (uint32_t capture = 0; capture < _bench_capture_count; capture++) {
+            sink += reference_demodulate_light(_bench_captures[capture]);
+        }
+    }
+    uint64_t reference_ns = _bench_now_ns() - start;
+
+    start = _bench_now_ns();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        for (uint32_t capture = 0; capture < _bench_capture_count; capture++) {
+            sink += _demodulate_light(_bench_captures[capture]);
+        }
+    }
+    uint64_t demodulate_ns = _bench_now_ns() - start;
+
+    printf("  %u/%u captures demodulated differently, %u with more than %u runs skipped\n", mismatches, compared, _bench_capture_count - compared, BENCH_MAX_RUNS);
+    printf("  previous demodulator: %.0f ns per capture\n", (double)reference_ns / (BENCH_ROUNDS * _bench_capture_count));
+    printf("  demodulator:          %.0f ns per capture (x%.1f)\n", (double)demodulate_ns / (BENCH_ROUNDS * _bench_capture_count), (double)reference_ns / demodulate_ns);
+
+    return mismatches;
+}
+
+static int _bench_polynomial(void) {
+
+    if (!_bench_load_captures()) {
+        return 1;
+    }
+    _fill_polynomial_taps();
+
+    uint64_t *bits = malloc((size_t)_bench_capture_count * sizeof(uint64_t));
+    for (uint32_t capture = 0; capture < _bench_capture_count; capture++) {
+        bits[capture] = _demodulate_light(_bench_captures[capture]);
+    }
+
+    uint32_t found      = 0;
+    uint32_t mismatches = 0;
+    for (uint32_t capture = 0; capture < _bench_capture_count; capture++) {
+        // The previous search breaks the ties in the order of the polynomials, not of the last identified ones
+        for (uint8_t poly = 0; poly < LH2_POLYNOMIAL_COUNT; poly++) {
+            _polynomial_search_order[poly] = poly;
+        }
+        int8_t  offset           = 0;
+        int8_t  reference_offset = 0;
+        uint8_t polynomial       = _determine_polynomial(bits[capture], &offset);
+        uint8_t reference        = reference_determine_polynomial(_polynomials, LH2_POLYNOMIAL_COUNT, bits[capture], &reference_offset);
+        if (polynomial != reference || (reference != LH2_POLYNOMIAL_ERROR_INDICATOR && offset != reference_offset)) {
+            if (mismatches < BENCH_MAX_ERRORS) {
+                printf("  capture %u: polynomial %u offset %d instead of polynomial %u offset %d\n", capture, polynomial, offset, reference, reference_offset);
+            }
+            mismatches++;
+        }
+        found += reference != LH2_POLYNOMIAL_ERROR_INDICATOR;
+    }
+
+    volatile uint32_t sink   = 0;
+    int8_t            offset = 0;
+    uint64_t          start  = _bench_now_ns();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        for (uint32_t capture = 0; capture < _bench_capture_count; capture++) {
+            sink += reference_determine_polynomial(_polynomials, LH2_POLYNOMIAL_COUNT, bits[capture], &offset);
+        }
+    }
+    uint64_t reference_ns = _bench_now_ns() - start;
+
+    start = _bench_now_ns();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        for (uint32_t capture = 0; capture < _bench_capture_count; capture++) {
+            sink += _determine_polynomial(bits[capture], &offset);
+        }
+    }
+    uint64_t search_ns = _bench_now_ns() - start;
+    free(bits);
+
+    printf("  %u/%u captures with a different polynomial or offset, %u with a polynomial found\n", mismatches, _bench_capture_count, found);
+    printf("  previous search:    %.0f ns per capture\n", (double)reference_ns / (BENCH_ROUNDS * _bench_capture_count));
+    printf("  bit-sliced search:  %.0f ns per capture (x%.1f)\n", (double)search_ns / (BENCH_ROUNDS * _bench_capture_count), (double)reference_ns / search_ns);
+
+    return mismatches;
+}
+
+static int _bench_position(void) {
+
+    db_lh2_t lh2 = { 0 };
+    db_lh2_position_clear_homographies();
+    for (uint8_t basestation = 0; basestation < BENCH_POSITION_BASESTATIONS; basestation++) {
+        db_lh2_position_set_homography(basestation, _bench_homographies[basestation]);
+    }
+    printf("%u positions seen by %u basestations, seed %u\n", _bench_options.count, BENCH_POSITION_BASESTATIONS, _bench_options.seed);
+
+    // Draw the positions and record the counts of the sweeps hitting them
+    uint32_t(*counts)[BENCH_POSITION_BASESTATIONS][LH2_SWEEP_COUNT] = malloc((size_t)_bench_options.count * sizeof(*counts));
+    double(*references)[2]                                          = malloc((size_t)_bench_options.count * sizeof(*references));
+    _bench_random_state                                             = _bench_options.seed ? _bench_options.seed : BENCH_SEED;
+    for (uint32_t fix = 0; fix < _bench_options.count; fix++) {
+        bool visible;
+        do {
+            references[fix][0] = BENCH_POSITION_MARGIN + _bench_random() * (BENCH_POSITION_AREA - 2 * BENCH_POSITION_MARGIN);
+            references[fix][1] = BENCH_POSITION_MARGIN + _bench_random() * (BENCH_POSITION_AREA - 2 * BENCH_POSITION_MARGIN);
+            visible            = true;
+            for (uint8_t basestation = 0; basestation < BENCH_POSITION_BASESTATIONS; basestation++) {
+                visible &= _bench_position_counts(basestation, references[fix][0], references[fix][1], counts[fix][basestation]);
+            }
+        } while (!visible);
+    }
+
+    // Feed the counts of each rotation to the solver, as the driver decodes them
+    uint32_t mismatches = 0;
+    double   max_error  = 0;
+    uint64_t total_ns   = 0;
+    uint32_t timestamp  = 0;
+    for (uint32_t round = 0; round < BENCH_ROUNDS; round++) {
+        for (uint32_t fix = 0; fix < _bench_options.count; fix++) {
+            timestamp += BENCH_ROTATION_US;
+            for (uint8_t basestation = 0; basestation < BENCH_POSITION_BASESTATIONS; basestation++) {
+                for (uint8_t sweep = 0; sweep < LH2_SWEEP_COUNT; sweep++) {
+                    lh2.locations[sweep][basestation].selected_polynomial = basestation * 2 + sweep;
+                    lh2.locations[sweep][basestation].lfsr_location       = counts[fix][basestation][sweep];
+                    lh2.timestamps[sweep][basestation]                    = timestamp + sweep * BENCH_ROTATION_US / 2;
+                    lh2.data_ready[sweep][basestation]                    = DB_LH2_PROCESSED_DATA_AVAILABLE;
+                }
+            }
+
+            db_lh2_position_t position = { 0 };
+            uint64_t          start    = _bench_now_ns();
+            bool              updated  = db_lh2_position_update(&lh2, &position);
+            total_ns += _bench_now_ns() - start;
+
+            // The sweeps are used once, the next update has nothing new
+            bool   repeated = db_lh2_position_update(&lh2, &position);
+            double error    = hypot(position.x - references[fix][0], position.y - references[fix][1]);
+            if (round == 0 && (!updated || repeated || position.basestations != BENCH_POSITION_BASESTATIONS || !(error <= BENCH_POSITION_TOLERANCE))) {
+                if (mismatches < BENCH_MAX_ERRORS) {
+                    printf("  position (%.1f, %.1f): (%.1f, %.1f) from %u basestations, updated %u, repeated %u\n", references[fix][0], references[fix][1], position.x, position.y, position.basestations, updated, repeated);
+                }
+                mismatches++;
+            }
+            if (round == 0 && error > max_error) {
+                max_error = error;
+            }
+        }
+    }
+    free(counts);
+    free(references);
+
+    printf("  %u/%u positions wrong, max error %.3f mm (tolerance %.1f mm)\n", mismatches, _bench_options.count, max_error, BENCH_POSITION_TOLERANCE);
+    printf("  %.0f ns per fix, including the clock reads\n", (double)total_ns / (BENCH_ROUNDS * _bench_options.count));
+
+    return mismatches;
+}
+
+static bool _bench_position_counts(uint8_t basestation, double x, double y, uint32_t counts[LH2_SWEEP_COUNT]) {
+
+    // Camera point: invert the calibration homography (adjugate matrix, the scale does not matter)
+    const float(*h)[3] = _bench_homographies[basestation];
+    double inverse[3][3];
+    for (uint8_t row = 0; row < 3; row++) {
+        for (uint8_t column = 0; column < 3; column++) {
+            inverse[row][column] = (double)h[(column + 1) % 3][(row + 1) % 3] * h[(column + 2) % 3][(row + 2) % 3] - (double)h[(column + 1) % 3][(row + 2) % 3] * h[(column + 2) % 3][(row + 1) % 3];
+        }
+    }
+    double w        = inverse[2][0] * x + inverse[2][1] * y + inverse[2][2];
+    double camera_x = (inverse[0][0] * x + inverse[0][1] * y + inverse[0][2]) / w;
+    double camera_y = (inverse[1][0] * x + inverse[1][1] * y + inverse[1][2]) / w;
+    if (fabs(camera_x) > 1 || fabs(camera_y) > 1) {
+        return false;
+    }
+
+    // Angles of the rotor when the laser planes hit: the azimuth is in their middle, the elevation sets their gap
+    double azimuth           = M_PI - atan(camera_x);
+    double gap               = 2 * (asin(-camera_y * tan(BENCH_SWEEP_ANGLE / 2)) + BENCH_SWEEP_ANGLE);
+    double radians_per_count = 2 * M_PI * BENCH_LFSR_TICKS / _bench_basestation_periods[basestation];
+    counts[0]                = (uint32_t)lround((azimuth - gap / 2) / radians_per_count);
+    counts[1]                = (uint32_t)lround((azimuth + gap / 2) / radians_per_count);
+    return counts[1] < LH2_LFSR_PERIOD;
+}
+
+static int _bench_budget(void) {
+
+    printf("LH2 decoding, %u basestations (%u polynomials)\n", LH2_BASESTATION_COUNT, LH2_POLYNOMIAL_COUNT);
+#if LH2_LFSR_SOLVER_BABY_STEPS > 0
+    printf("  solver:        %s, %u baby steps\n", BENCH_SOLVER_NAME, LH2_LFSR_SOLVER_BABY_STEPS);
+#else
+    printf("  solver:        %s, checkpoints every %u LFSR positions\n", BENCH_SOLVER_NAME, LH2_CHECKPOINT_SPACING);
+#endif
+    printf("  RAM:           %u bytes (budget %u)\n", LH2_TABLES_RAM_BYTES, LH2_RAM_BUDGET);
+    printf("  flash:         %u bytes\n", LH2_TABLES_FLASH_BYTES);
+    printf("  worst lookup:  %u steps of the checkpoint search (budget %u), a lookup per sweep\n", LH2_SOLVER_MAX_STEPS, LH2_LFSR_SOLVER_STEP_BUDGET);
+
+    return 0;
+}
+
+static bool _bench_parse_options(int argc, char **argv) {
+    int option;
+    while ((option = getopt(argc, argv, "f:n:s:")) != -1) {
+        switch (option) {
+            case 'f':
+                _bench_options.file = optarg;
+                break;
+            case 'n':
+                _bench_options.count = strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                _bench_options.seed = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                return false;
+        }
+    }
+    return optind == argc;
+}
+
+static bool _bench_load_captures(void) {
+
+    if (_bench_options.file == NULL) {
+        _bench_capture_count = _bench_options.count;
+        _bench_captures      = malloc((size_t)_bench_capture_count * LH2_CAPTURE_SIZE);
+        // xorshift32 gets stuck on zero
+        _bench_random_state = _bench_options.seed ? _bench_options.seed : BENCH_SEED;
+        for (uint32_t capture = 0; capture < _bench_capture_count; capture++) {
+            _bench_synthesize_capture(_bench_captures[capture], capture % 2);
+        }
+        printf("%u synthesized captures, seed %u\n", _bench_capture_count, _bench_options.seed);
+        return _bench_capture_count > 0;
+    }
+
+    FILE *file = fopen(_bench_options.file, "rb");
+    if (file == NULL) {
+        printf("Cannot open %s\n", _bench_options.file);
+        return false;
+    }
+
+    // Header: magic, version, capture size and 2 reserved bytes, then timestamp (uint32) + samples of each capture
+    uint8_t header[8];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, BENCH_FILE_MAGIC, 4) != 0 || header[4] != BENCH_FILE_VERSION || header[5] != LH2_CAPTURE_SIZE) {
+        printf("%s is not a capture file of %u bytes captures\n", _bench_options.file, LH2_CAPTURE_SIZE);
+        fclose(file);
+        return false;
+    }
+
+    uint8_t record[sizeof(uint32_t) + LH2_CAPTURE_SIZE];
+    while (fread(record, 1, sizeof(record), file) == sizeof(record)) {
+        _bench_captures = realloc(_bench_captures, (size_t)(_bench_capture_count + 1) * LH2_CAPTURE_SIZE);
+        memcpy(_bench_captures[_bench_capture_count++], &record[sizeof(uint32_t)], LH2_CAPTURE_SIZE);
+    }
+    fclose(file);
+
+    printf("%u captures read from %s\n", _bench_capture_count, _bench_options.file);
+    return _bench_capture_count > 0;
+}
+
+static void _bench_synthesize_capture(uint8_t *samples, bool noisy) {
+
+    // Times of the edges: every chip starts with one, the ones have a second one in their middle
+    double   edges[2 * (uint32_t)(BENCH_SAMPLES / BENCH_CHIP_SAMPLES + 2)];
+    uint32_t edge_count = 0;
+    uint32_t polynomial = _polynomials[(uint32_t)(_bench_random() * LH2_POLYNOMIAL_COUNT)];
+    uint32_t state      = 1 + (uint32_t)(_bench_random() * LH2_LFSR_PERIOD);
+    for (double time = -_bench_random() * BENCH_CHIP_SAMPLES; time < BENCH_SAMPLES; time += BENCH_CHIP_SAMPLES) {
+        uint32_t bit = __builtin_popcount(state & polynomial) & 0x01;
+        state        = ((state << 1) | bit) & 0x0001FFFF;
+        edges[edge_count++] = time + (noisy ? (_bench_random() - 0.5) * BENCH_EDGE_JITTER : 0);
+        if (bit) {
+            edges[edge_count++] = time + BENCH_CHIP_SAMPLES / 2 + (noisy ? (_bench_random() - 0.5) * BENCH_EDGE_JITTER : 0);
+        }
+    }
+
+    memset(samples, 0, LH2_CAPTURE_SIZE);
+    uint32_t level = _bench_random() < 0.5;
+    uint32_t edge  = 0;
+    for (uint32_t sample = 0; sample < BENCH_SAMPLES; sample++) {
+        while (edge < edge_count && edges[edge] <= sample) {
+            level ^= 1;
+            edge++;
+        }
+        if (level ^ (noisy && _bench_random() < BENCH_FLIP_RATE)) {
+            samples[sample / 8] |= 0x80 >> (sample % 8);
+        }
+    }
+}
+
+static uint32_t _bench_run_count(const uint8_t *samples) {
+    uint32_t runs     = 1;
+    uint32_t previous = samples[0] >> 7;
+    for (uint32_t sample = 1; sample <= BENCH_SAMPLES; sample++) {
+        // the sample following the capture is silence
+        uint32_t current = (sample < BENCH_SAMPLES) ? (samples[sample / 8] >> (7 - sample % 8)) & 0x01 : 0;
+        runs += current != previous;
+        previous = current;
+    }
+    return runs;
+}
+
+static double _bench_random(void) {
+    _bench_random_state ^= _bench_random_state << 13;
+    _bench_random_state ^= _bench_random_state >> 17;
+    _bench_random_state ^= _bench_random_state << 5;
+    return _bench_random_state / 4294967296.0;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file
+ * @brief       Host implementation of the peripherals used by the LH2 driver, for the LH2 decoding benchmarks
+ *
+ * The registers are plain variables and the high frequency timer reads the monotonic clock of
+ * the host, so that the capture timestamps and the age of the LH2 data stay meaningful.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <stdint.h>
+#include <time.h>
+#include <nrf.h>
+
+#include "timer_hf.h"
+
+//=========================== variables ========================================
+
+NRF_PPI_Type    bench_ppi    = { 0 };
+NRF_SPIM_Type   bench_spim   = { 0 };
+NRF_GPIOTE_Type bench_gpiote = { 0 };
+NRF_GPIO_Type   bench_p0     = { 0 };
+NRF_GPIO_Type   bench_p1     = { 0 };
+
+//=========================== public ===========================================
+
+void db_timer_hf_init(timer_hf_t timer) {
+    (void)timer;
+}
+
+uint32_t db_timer_hf_now(timer_hf_t timer) {
+    (void)timer;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000ULL + now.tv_nsec / 1000);
+}
+
+void db_timer_hf_delay_us(timer_hf_t timer, uint32_t us) {
+    // The TS4231 initialization waits are not needed on the host
+    (void)timer;
+    (void)us;
+}
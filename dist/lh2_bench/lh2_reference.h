@@ -0,0 +1,36 @@
+#ifndef __LH2_REFERENCE_H
+#define __LH2_REFERENCE_H
+
+/**
+ * @file
+ * @brief       Previous implementations of the LH2 decoding functions, the references of the LH2 decoding benchmarks
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <stdint.h>
+
+//=========================== public ===========================================
+
+/**
+ * @brief   Demodulate a capture by counting the samples between zero crossings one at a time
+ *
+ * @param[in]   samples     LH2_CAPTURE_SIZE bytes of SPI samples, demodulated as if followed by as many bytes of silence
+ *
+ * @return  the demodulated bits, MSB first
+ */
+uint64_t reference_demodulate_light(const uint8_t *samples);
+
+/**
+ * @brief   Find the polynomial of demodulated bits by running the seed through each polynomial one after the other
+ *
+ * @param[in]   polynomials         known polynomials, the ties go to the first one
+ * @param[in]   polynomial_count    number of polynomials to try (max 32)
+ * @param[in]   chipsH1             demodulated bits
+ * @param[out]  start_val           number of bits skipped at the beginning of the sequence
+ *
+ * @return  index of the polynomial, 0xFF if none matches
+ */
+uint8_t reference_determine_polynomial(const uint32_t *polynomials, uint8_t polynomial_count, uint64_t chipsH1, int8_t *start_val);
+
+#endif
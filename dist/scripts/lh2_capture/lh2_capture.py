@@ -0,0 +1,195 @@
+#!/usr/bin/env python
+
+"""Record raw LH2 captures from a DotBot and replay them through its decoding pipeline.
+
+Requires the 01bsp_lighthouse_capture application on the DotBot.
+
+Capture file format (all integers are little endian):
+  - header: b"LH2C", format version (uint8), capture size in bytes (uint8), 2 reserved bytes
+  - then one record per capture: timestamp in microseconds (uint32) + SPI samples
+"""
+
+import logging
+import struct
+import time
+
+from enum import Enum
+
+import click
+import serial
+import structlog
+
+from dotbot.hdlc import hdlc_encode, HDLCHandler, HDLCState
+from dotbot.serial_interface import SerialInterface, SerialInterfaceException
+
+
+BAUDRATE = 1000000
+CAPTURE_SIZE = 64
+FILE_MAGIC = b"LH2C"
+FILE_VERSION = 1
+FILE_HEADER = struct.Struct("<4sBBxx")
+CAPTURE_RECORD = struct.Struct(f"<I{CAPTURE_SIZE}s")
+RESULT_RECORD = struct.Struct("<IBII")
+POLYNOMIAL_ERROR = 0xFF
+REPLAY_TIMEOUT = 1  # seconds
+HISTOGRAM_BIN_US = 100
+
+
+class MessageType(Enum):
+    """Types of messages exchanged with the capture application."""
+
+    LH2_CAPTURE_MSG_CAPTURE = 1
+    LH2_CAPTURE_MSG_RESULT = 2
+
+
+class CaptureInterface:
+    """Class used to exchange captures with the DotBot."""
+
+    def __init__(self, port, baudrate):
+        self.hdlc_handler = HDLCHandler()
+        self.captures = []
+        self.results = []
+        self.serial = SerialInterface(port, baudrate, self.on_byte_received)
+
+    def on_byte_received(self, byte):
+        self.hdlc_handler.handle_byte(byte)
+        if self.hdlc_handler.state == HDLCState.READY:
+            payload = self.hdlc_handler.payload
+            if not payload:
+                return
+            if (
+                payload[0] == MessageType.LH2_CAPTURE_MSG_CAPTURE.value
+                and len(payload) == 1 + CAPTURE_RECORD.size
+            ):
+                self.captures.append(CAPTURE_RECORD.unpack(payload[1:]))
+            elif (
+                payload[0] == MessageType.LH2_CAPTURE_MSG_RESULT.value
+                and len(payload) == 1 + RESULT_RECORD.size
+            ):
+                self.results.append(RESULT_RECORD.unpack(payload[1:]))
+
+    def replay(self, timestamp, samples):
+        """Send one capture and wait for its decoding result."""
+        expected = len(self.results) + 1
+        buffer = bytearray()
+        buffer += int(MessageType.LH2_CAPTURE_MSG_CAPTURE.value).to_bytes(
+            length=1, byteorder="little"
+        )
+        buffer += CAPTURE_RECORD.pack(timestamp, samples)
+        self.serial.write(hdlc_encode(buffer))
+        start = time.time()
+        while len(self.results) < expected:
+            if time.time() - start > REPLAY_TIMEOUT:
+                return None
+            time.sleep(0.0001)
+        return self.results[-1]
+
+
+def read_captures(capture_file):
+    magic, version, capture_size = FILE_HEADER.unpack(
+        capture_file.read(FILE_HEADER.size)
+    )
+    if magic != FILE_MAGIC or version != FILE_VERSION or capture_size != CAPTURE_SIZE:
+        raise click.ClickException("Unsupported capture file")
+    while True:
+        record = capture_file.read(CAPTURE_RECORD.size)
+        if len(record) < CAPTURE_RECORD.size:
+            break
+        yield CAPTURE_RECORD.unpack(record)
+
+
+def print_histogram(durations):
+    bins = {}
+    for duration in durations:
+        index = duration // HISTOGRAM_BIN_US
+        bins[index] = bins.get(index, 0) + 1
+    largest = max(bins.values())
+    for index in sorted(bins):
+        bar = "#" * max(1, int(50 * bins[index] / largest))
+        print(
+            f"  {index * HISTOGRAM_BIN_US:6d}-{(index + 1) * HISTOGRAM_BIN_US - 1:6d}us "
+            f"{bins[index]:7d} {bar}"
+        )
+
+
+@click.group()
+@click.option(
+    "-p",
+    "--port",
+    default="/dev/ttyACM0",
+    help="Serial port of the DotBot.",
+)
+@click.pass_context
+def main(ctx, port):
+    # Disable logging configure in PyDotBot
+    structlog.configure(
+        wrapper_class=structlog.make_filtering_bound_logger(logging.CRITICAL),
+    )
+    ctx.obj = port
+
+
+@main.command()
+@click.option(
+    "-d",
+    "--duration",
+    default=10.0,
+    help="Recording duration in seconds.",
+)
+@click.argument("output", type=click.File(mode="wb"))
+@click.pass_obj
+def record(port, duration, output):
+    """Record the raw LH2 captures streamed by the DotBot."""
+    try:
+        interface = CaptureInterface(port, BAUDRATE)
+    except (SerialInterfaceException, serial.serialutil.SerialException) as exc:
+        raise click.ClickException(f"Error: {exc}")
+    time.sleep(duration)
+    captures = list(interface.captures)
+    output.write(FILE_HEADER.pack(FILE_MAGIC, FILE_VERSION, CAPTURE_SIZE))
+    for timestamp, samples in captures:
+        output.write(CAPTURE_RECORD.pack(timestamp, samples))
+    print(f"{len(captures)} captures recorded ({len(captures) / duration:.1f}/s)")
+
+
+@main.command()
+@click.argument("capture_file", type=click.File(mode="rb"))
+@click.pass_obj
+def replay(port, capture_file):
+    """Replay a capture file through the decoding pipeline of the DotBot."""
+    try:
+        interface = CaptureInterface(port, BAUDRATE)
+    except (SerialInterfaceException, serial.serialutil.SerialException) as exc:
+        raise click.ClickException(f"Error: {exc}")
+    durations = []
+    decoded = 0
+    lost = 0
+    polynomials = {}
+    for timestamp, samples in read_captures(capture_file):
+        result = interface.replay(timestamp, samples)
+        if result is None:
+            lost += 1
+            continue
+        _, polynomial, _, duration_us = result
+        durations.append(duration_us)
+        if polynomial != POLYNOMIAL_ERROR:
+            decoded += 1
+            polynomials[polynomial] = polynomials.get(polynomial, 0) + 1
+    if not durations:
+        raise click.ClickException("No result received")
+    total_us = sum(durations)
+    print(f"Captures replayed:  {len(durations)} ({lost} without answer)")
+    print(
+        f"Decoded:            {decoded} ({100 * decoded / len(durations):.1f}%), "
+        f"per polynomial: {dict(sorted(polynomials.items()))}"
+    )
+    print(
+        f"Decoding time:      mean {total_us / len(durations):.0f}us, "
+        f"min {min(durations)}us, max {max(durations)}us"
+    )
+    print(f"Throughput:         {1e6 * len(durations) / total_us:.1f} sweeps/s")
+    print("Decoding time histogram:")
+    print_histogram(durations)
+
+
+if __name__ == "__main__":
+    main()
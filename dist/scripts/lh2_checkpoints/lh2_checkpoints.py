@@ -0,0 +1,252 @@
+#!/usr/bin/env python
+
+"""Generate the LFSR checkpoint tables of the LH2 checkpoint solver.
+
+The checkpoint solver (LH2_LFSR_SOLVER_BABY_STEPS=0) runs the LFSR of a sweep
+forward and backward until it reaches a checkpoint, a known state stored every
+`spacing` positions. Checkpoints are found with a collision-free perfect hash
+(hash and displace), so each step costs one table read per direction.
+
+Denser checkpoints use more flash but need fewer steps:
+
+    python lh2_checkpoints.py generate --spacing 512 ../../../build/include/lh2_checkpoints.h
+    python lh2_checkpoints.py benchmark
+"""
+
+import argparse
+import sys
+
+LFSR_PERIOD = 131071
+LFSR_MASK = 0x1FFFF
+LFSR_SEED = 0x00001
+INDEX_POS = 17
+BUCKET_MULT = 0x9E3779B1
+SLOT_MULT = 0x85EBCA6B
+MAX_DISPLACEMENT = 0xFFFF
+SPACINGS = [64, 128, 256, 512, 1024, 2048]
+POLYNOMIALS = [
+    0x0001D258, 0x00017E04, 0x0001FF6B, 0x00013F67,
+    0x0001B9EE, 0x000198D1, 0x000178C7, 0x00018A55,
+    0x00015777, 0x0001D911, 0x00015769, 0x0001991F,
+    0x00012BD0, 0x0001CF73, 0x0001365D, 0x000197F5,
+    0x000194A0, 0x0001B279, 0x00013A34, 0x0001AE41,
+    0x000180D4, 0x00017891, 0x00012E64, 0x00017C72,
+    0x00019C6D, 0x00013F32, 0x0001AE14, 0x00014E76,
+    0x00013C97, 0x000130CB, 0x00013750, 0x0001CB8D,
+]
+
+HEADER_FORMAT = """/*
+ * PLEASE DON'T EDIT
+ *
+ * This file was automatically generated by dist/scripts/lh2_checkpoints/lh2_checkpoints.py
+ * with: --spacing {spacing} --polynomials {polynomials}
+ */
+
+#ifndef __LH2_CHECKPOINTS_H
+#define __LH2_CHECKPOINTS_H
+
+#include <stdint.h>
+
+#include "lh2.h"
+
+{defines}
+
+#if LH2_POLYNOMIAL_COUNT <= LH2_CHECKPOINT_POLYNOMIALS
+// Only the polynomials of the LH2_BASESTATION_COUNT basestations use flash
+
+/// Displacement of each bucket, chosen so that no two checkpoints of a polynomial share a slot
+static const uint16_t _lh2_checkpoint_displacements[LH2_POLYNOMIAL_COUNT][1 << LH2_CHECKPOINT_BUCKET_BITS] = {{
+{displacements}
+}};
+
+/// Checkpoint table, entries are (index << LH2_CHECKPOINT_INDEX_POS) | state, 0 for empty slots
+static const uint32_t _lh2_checkpoint_table[LH2_POLYNOMIAL_COUNT][1 << LH2_CHECKPOINT_SLOT_BITS] = {{
+{table}
+}};
+#endif
+
+#endif /* __LH2_CHECKPOINTS_H */
+"""
+
+
+def lfsr_sequence(polynomial):
+    """Return the list of the states of the LFSR, indexed by position."""
+    states = [0] * LFSR_PERIOD
+    state = LFSR_SEED
+    for position in range(LFSR_PERIOD):
+        states[position] = state
+        state = ((state << 1) | (bin(state & polynomial).count("1") & 1)) & LFSR_MASK
+    return states
+
+
+def bucket_of(state, bucket_bits):
+    return ((state * BUCKET_MULT) & 0xFFFFFFFF) >> (32 - bucket_bits)
+
+
+def slot_of(state, displacement, slot_bits):
+    return (((state ^ displacement) * SLOT_MULT) & 0xFFFFFFFF) >> (32 - slot_bits)
+
+
+def table_geometry(spacing):
+    count = (LFSR_PERIOD + spacing - 1) // spacing
+    # 4 checkpoints per bucket on average, table at most 80% full
+    bucket_bits = max(1, (count // 4 - 1).bit_length())
+    slot_bits = (count * 5 // 4 - 1).bit_length()
+    return count, bucket_bits, slot_bits
+
+
+def build_tables(states, spacing):
+    """Hash and displace: place the largest buckets first, each with the first displacement that fits."""
+    count, bucket_bits, slot_bits = table_geometry(spacing)
+    buckets = [[] for _ in range(1 << bucket_bits)]
+    for index in range(count):
+        state = states[index * spacing]
+        buckets[bucket_of(state, bucket_bits)].append((index, state))
+
+    displacements = [0] * (1 << bucket_bits)
+    table = [0] * (1 << slot_bits)
+    for bucket in sorted(range(len(buckets)), key=lambda b: -len(buckets[b])):
+        if not buckets[bucket]:
+            continue
+        for displacement in range(MAX_DISPLACEMENT + 1):
+            slots = {slot_of(state, displacement, slot_bits) for _, state in buckets[bucket]}
+            if len(slots) == len(buckets[bucket]) and all(table[slot] == 0 for slot in slots):
+                break
+        else:
+            sys.exit(f"No perfect hash found for spacing {spacing}")
+        displacements[bucket] = displacement
+        for index, state in buckets[bucket]:
+            table[slot_of(state, displacement, slot_bits)] = (index << INDEX_POS) | state
+    return displacements, table
+
+
+def lookup(displacements, table, state, bucket_bits, slot_bits):
+    displacement = displacements[bucket_of(state, bucket_bits)]
+    entry = table[slot_of(state, displacement, slot_bits)]
+    if (entry & LFSR_MASK) == state:
+        return entry >> INDEX_POS
+    return None
+
+
+def flash_bytes(spacing, polynomials=1):
+    _, bucket_bits, slot_bits = table_geometry(spacing)
+    return polynomials * ((2 << bucket_bits) + (4 << slot_bits))
+
+
+def iterations(spacing):
+    """Number of solver iterations (one LFSR step in each direction) for every LFSR position."""
+    last = ((LFSR_PERIOD + spacing - 1) // spacing - 1) * spacing
+    for position in range(LFSR_PERIOD):
+        backward = position % spacing
+        forward = (spacing - backward) if position < last else (LFSR_PERIOD - position)
+        yield min(backward, forward)
+
+
+def format_defines(defines):
+    """Format (name, value, comment) tuples as aligned macros, the way clang-format does."""
+    name_width = max(len(name) for name, _, _ in defines)
+    value_width = max(len(value) for _, value, _ in defines)
+    return "\n".join(
+        f"#define {name:<{name_width}} {value:<{value_width}}  ///< {comment}"
+        for name, value, comment in defines
+    )
+
+
+def format_rows(rows, fmt, per_line):
+    """Format one row per polynomial, the rows of each basestation after the first one only build if it is used."""
+    lines = []
+    for polynomial, row in enumerate(rows):
+        if polynomial > 0 and polynomial % 2 == 0:
+            if polynomial > 2:
+                lines.append("#endif")
+            lines.append(f"#if LH2_POLYNOMIAL_COUNT > {polynomial}")
+        lines.append("    {")
+        for start in range(0, len(row), per_line):
+            values = ", ".join(fmt.format(value) for value in row[start : start + per_line])
+            lines.append(f"        {values},")
+        lines.append("    },")
+    if len(rows) > 2:
+        lines.append("#endif")
+    return "\n".join(lines)
+
+
+def generate(args):
+    count, bucket_bits, slot_bits = table_geometry(args.spacing)
+    all_displacements = []
+    all_tables = []
+    for polynomial in POLYNOMIALS[: args.polynomials]:
+        states = lfsr_sequence(polynomial)
+        displacements, table = build_tables(states, args.spacing)
+        # Check every checkpoint is found, and that no other state is mistaken for one
+        for position, state in enumerate(states):
+            index = lookup(displacements, table, state, bucket_bits, slot_bits)
+            expected = position // args.spacing if position % args.spacing == 0 else None
+            assert index == expected, f"bad lookup for position {position}"
+        all_displacements.append(displacements)
+        all_tables.append(table)
+
+    defines = [
+        ("LH2_CHECKPOINT_SPACING", f"{args.spacing}", "Number of LFSR positions between 2 checkpoints"),
+        ("LH2_CHECKPOINT_COUNT", f"{count}", "Number of checkpoints per polynomial"),
+        ("LH2_CHECKPOINT_POLYNOMIALS", f"{args.polynomials}", "Number of polynomials with checkpoints"),
+        ("LH2_CHECKPOINT_INDEX_POS", f"{INDEX_POS}", "Position of the checkpoint index in a table entry, the LFSR state uses the 17 lower bits"),
+        ("LH2_CHECKPOINT_BUCKET_BITS", f"{bucket_bits}", "log2 of the number of displacement buckets per polynomial"),
+        ("LH2_CHECKPOINT_BUCKET_MULT", f"0x{BUCKET_MULT:08X}", "Multiplier hashing an LFSR state into its displacement bucket"),
+        ("LH2_CHECKPOINT_SLOT_BITS", f"{slot_bits}", "log2 of the number of table slots per polynomial"),
+        ("LH2_CHECKPOINT_SLOT_MULT", f"0x{SLOT_MULT:08X}", "Multiplier hashing a displaced LFSR state into its table slot"),
+        ("LH2_CHECKPOINT_FLASH_BYTES", f"{flash_bytes(args.spacing)}", "Flash used by the tables of each polynomial"),
+    ]
+    args.output.write(
+        HEADER_FORMAT.format(
+            spacing=args.spacing,
+            polynomials=args.polynomials,
+            defines=format_defines(defines),
+            displacements=format_rows(all_displacements, "{}", 16),
+            table=format_rows(all_tables, "0x{:08X}", 8),
+        )
+    )
+
+
+def benchmark(args):
+    print(f"{'spacing':>8} {'flash (B)':>10} {'mean steps':>11} {'max steps':>10}")
+    for spacing in SPACINGS:
+        steps = list(iterations(spacing))
+        print(
+            f"{spacing:8d} {flash_bytes(spacing, args.polynomials):10d} "
+            f"{sum(steps) / len(steps):11.1f} {max(steps):10d}"
+        )
+    print("Each step runs the LFSR once in each direction and does 2 table lookups,")
+    print("so the solver time is proportional to the number of steps.")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument(
+        "-n",
+        "--polynomials",
+        type=int,
+        default=len(POLYNOMIALS),
+        choices=range(2, len(POLYNOMIALS) + 1, 2),
+        metavar="[2-32]",
+        help=f"Number of polynomials with checkpoints, 2 per basestation (default: {len(POLYNOMIALS)}).",
+    )
+    commands = parser.add_subparsers(dest="command", required=True)
+    generate_parser = commands.add_parser("generate", help="Generate the checkpoint tables header.")
+    generate_parser.add_argument(
+        "-s",
+        "--spacing",
+        type=int,
+        default=2048,
+        choices=SPACINGS,
+        help="Number of LFSR positions between 2 checkpoints (default: 2048).",
+    )
+    generate_parser.add_argument("output", type=argparse.FileType("w"), help="Header file to write.")
+    generate_parser.set_defaults(func=generate)
+    benchmark_parser = commands.add_parser("benchmark", help="Print the steps versus flash tradeoff of each spacing.")
+    benchmark_parser.set_defaults(func=benchmark)
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
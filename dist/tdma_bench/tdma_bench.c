@@ -0,0 +1,456 @@
+/**
+ * @file
+ * @brief       Host tests and benchmarks of the TDMA drivers
+ *
+ * The TDMA server driver is built for the host computer, on top of a radio that does nothing
+ * (see tdma_bench_bsp.c), and its internal functions are called directly, like those of the
+ * drivers it depends on. Each command checks one of them against a reference:
+ *
+ * - `lookup`: the hash index of the client ids, with 10, 100 and 1000 registered clients, against
+ *   the linear scan of the TDMA table it replaced, and reports their speed
+ * - `queue`: the packet queue, with random pushes, peeks, pops and clears, against a FIFO of
+ *   whole packets
+ * - `drift`: the clock drift estimator, on synthetic clocks from -50 to +120 ppm with jittered
+ *   timestamps, against the true drift and the true local time 8 sync periods ahead, across a
+ *   restart of the remote clock
+ *
+ * Build it from the root of the repository with `make tdma-bench`, then for example:
+ *
+ *     dist/tdma_bench/tdma_bench lookup
+ *     dist/tdma_bench/tdma_bench queue
+ *     dist/tdma_bench/tdma_bench drift
+ *
+ * The commands exit with an error status if the results differ from the reference.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include "tdma_server/tdma_server_default.c"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "clock_drift.h"
+
+//=========================== defines ==========================================
+
+#define BENCH_MAX_ERRORS    5     ///< Max number of mismatches printed per command
+#define BENCH_LOOKUP_ROUNDS 1000  ///< Number of times every client is looked up to time the lookups
+#define BENCH_LOOKUP_EVICT  4     ///< One client out of BENCH_LOOKUP_EVICT is evicted then registered again
+#define BENCH_QUEUE_OPS     200000  ///< Number of random operations on each queue
+#define BENCH_QUEUE_GUARD   16      ///< Number of bytes checked after the end of the byte ring
+#define BENCH_QUEUE_MAX     1024    ///< Size of the largest queue checked
+#define BENCH_DRIFT_SAMPLES 400     ///< Number of samples of each synthetic clock, the remote clock restarts halfway
+#define BENCH_DRIFT_AHEAD   8       ///< Number of sync periods between the newest sample and the predicted time
+#define BENCH_DRIFT_SIGMAS  5.0     ///< Tolerance of the estimates, in standard deviations of the least squares fit
+
+#if TDMA_SERVER_MAX_CLIENTS < 1000
+#error "The lookup benchmark registers 1000 clients, build it with TDMA_SERVER_MAX_CLIENTS=1024"
+#endif
+
+/// Command of the benchmark
+typedef struct {
+    const char *name;         ///< Name given on the command line
+    int (*run)(void);         ///< Run the command, returns the number of mismatches
+    const char *description;  ///< Help text
+} bench_command_t;
+
+/// Packet of the reference FIFO, its bytes are computed from its sequence number
+typedef struct {
+    uint32_t sequence;  ///< Sequence number of the packet
+    uint8_t  length;    ///< Length of the packet
+} bench_packet_t;
+
+//=========================== prototypes =======================================
+
+/**
+ * @brief   Read the monotonic clock of the host
+ *
+ * @return  time in nanoseconds
+ */
+static uint64_t _bench_now_ns(void);
+
+/**
+ * @brief   Pseudo-random generator (xorshift64) of the client ids
+ *
+ * @return  a non-zero 64-bit number
+ */
+static uint64_t _bench_random(void);
+
+/**
+ * @brief   Check the hash index of the client ids against a linear scan of the TDMA table
+ *
+ * @return  number of lookups where the index differs from the linear scan
+ */
+static int _bench_lookup(void);
+
+/**
+ * @brief   Check the lookup of every client of the TDMA table, and of as many unknown ids
+ *
+ * @param[in]   ids     ids of the registered clients
+ * @param[in]   count   number of registered clients
+ *
+ * @return  number of lookups where the index differs from the linear scan
+ */
+static int _bench_lookup_check(const uint64_t *ids, uint16_t count);
+
+/**
+ * @brief   Find a client by scanning the whole TDMA table, like the server did before the hash index
+ *
+ * @param[in]   tdma_table  pointer to the tdma table to search
+ * @param[in]   client      id of the client
+ *
+ * @return  table slot of the client, TDMA_SERVER_CLIENT_NOT_FOUND if it is not registered
+ */
+static int16_t _bench_linear_find(tdma_server_table_t *tdma_table, uint64_t client);
+
+/**
+ * @brief   Check the packet queue against a FIFO of whole packets, on queues of several sizes
+ *
+ * @return  number of operations where the queue differs from the reference
+ */
+static int _bench_queue(void);
+
+/**
+ * @brief   Compute the bytes of a packet of the queue benchmark
+ *
+ * @param[out]  packet      bytes of the packet
+ * @param[in]   sequence    sequence number of the packet
+ * @param[in]   length      length of the packet
+ */
+static void _bench_queue_packet(uint8_t *packet, uint32_t sequence, uint8_t length);
+
+/**
+ * @brief   Check the clock drift estimator on synthetic clocks, against their true drift and local time
+ *
+ * @return  number of samples after which an estimate is out of its tolerance, or the restart is missed
+ */
+static int _bench_drift(void);
+
+/**
+ * @brief   Check the clock drift estimator on one synthetic clock
+ *
+ * @param[in]   drift_ppm   rate of the local clock minus rate of the remote clock, in parts per million
+ * @param[in]   jitter_us   peak to peak jitter of the local timestamps, in microseconds
+ * @param[in]   period_us   time between 2 samples on the remote clock, in microseconds
+ *
+ * @return  number of samples after which an estimate is out of its tolerance, or the restart is missed
+ */
+static int _bench_drift_clock(double drift_ppm, double jitter_us, uint32_t period_us);
+
+//=========================== variables ========================================
+
+static uint64_t _bench_random_state = 1;  ///< State of the pseudo-random generator
+
+static const uint16_t _bench_lookup_sizes[] = { 10, 100, 1000 };
+static const uint16_t _bench_queue_sizes[]  = { 256, 300, 1000, BENCH_QUEUE_MAX };
+static const double   _bench_drift_ppms[]   = { -50, -20, 0, 20, 50, 120 };
+static const double   _bench_drift_jitters[] = { 0, 2, 10, 40 };
+static const uint32_t _bench_drift_periods[] = { 100000, 2000000 };  ///< Every sync frame of a 100 ms frame, and every 20th
+
+static bench_packet_t _bench_queue_fifo[BENCH_QUEUE_MAX];  ///< Reference FIFO, a packet takes at least 2 bytes of the queue
+
+static const bench_command_t _bench_commands[] = {
+    { "lookup", _bench_lookup, "check the hash index of the client ids against a linear scan" },
+    { "queue", _bench_queue, "check the packet queue against a FIFO of whole packets" },
+    { "drift", _bench_drift, "check the clock drift estimator on synthetic clocks from -50 to +120 ppm" },
+};
+
+//=========================== main =============================================
+
+int main(int argc, char **argv) {
+
+    for (size_t command = 0; argc == 2 && command < sizeof(_bench_commands) / sizeof(_bench_commands[0]); command++) {
+        if (strcmp(argv[1], _bench_commands[command].name) == 0) {
+            int errors = _bench_commands[command].run();
+            printf("%s: %s\n", _bench_commands[command].name, errors ? "FAILED" : "ok");
+            return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+    }
+
+    printf("Usage: %s COMMAND\n\nCommands:\n", argv[0]);
+    for (size_t command = 0; command < sizeof(_bench_commands) / sizeof(_bench_commands[0]); command++) {
+        printf("  %-12s %s\n", _bench_commands[command].name, _bench_commands[command].description);
+    }
+    return EXIT_FAILURE;
+}
+
+//=========================== private ==========================================
+
+static uint64_t _bench_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static uint64_t _bench_random(void) {
+    _bench_random_state ^= _bench_random_state << 13;
+    _bench_random_state ^= _bench_random_state >> 7;
+    _bench_random_state ^= _bench_random_state << 17;
+    return _bench_random_state;
+}
+
+static int _bench_lookup(void) {
+
+    int      errors = 0;
+    uint64_t ids[1000];
+
+    printf("lookup of a registered client, %u index buckets\n", TDMA_SERVER_CLIENT_INDEX_SIZE);
+
+    for (size_t size = 0; size < sizeof(_bench_lookup_sizes) / sizeof(_bench_lookup_sizes[0]); size++) {
+        uint16_t count = _bench_lookup_sizes[size];
+
+        // Register the clients in an empty table, the gateway has the id 0
+        memset(&_tdma_vars.tdma_table, 0, sizeof(_tdma_vars.tdma_table));
+        db_tdma_server_init(NULL, DB_RADIO_BLE_1MBit, 8);
+        for (uint16_t client = 0; client < count; client++) {
+            ids[client] = _bench_random();
+            _server_register_new_client(&_tdma_vars.tdma_table, ids[client]);
+        }
+        errors += _bench_lookup_check(ids, count);
+
+        // Evict some clients, which moves others around, and register them again
+        for (uint16_t client = 0; client < count; client += BENCH_LOOKUP_EVICT) {
+            _server_evict_client(&_tdma_vars.tdma_table, _server_find_client(&_tdma_vars.tdma_table, ids[client]));
+        }
+        for (uint16_t client = 0; client < count; client += BENCH_LOOKUP_EVICT) {
+            _server_register_new_client(&_tdma_vars.tdma_table, ids[client]);
+        }
+        errors += _bench_lookup_check(ids, count);
+
+        // Time the lookups of every client, in the order they registered
+        volatile int32_t sink  = 0;
+        uint64_t         start = _bench_now_ns();
+        for (uint32_t round = 0; round < BENCH_LOOKUP_ROUNDS; round++) {
+            for (uint16_t client = 0; client < count; client++) {
+                sink += _bench_linear_find(&_tdma_vars.tdma_table, ids[client]);
+            }
+        }
+        uint64_t linear_ns = _bench_now_ns() - start;
+
+        start = _bench_now_ns();
+        for (uint32_t round = 0; round < BENCH_LOOKUP_ROUNDS; round++) {
+            for (uint16_t client = 0; client < count; client++) {
+                sink += _server_find_client(&_tdma_vars.tdma_table, ids[client]);
+            }
+        }
+        uint64_t index_ns = _bench_now_ns() - start;
+
+        printf("  clients %4u: linear %6.1f ns, index %4.1f ns\n", count, (double)linear_ns / (BENCH_LOOKUP_ROUNDS * count), (double)index_ns / (BENCH_LOOKUP_ROUNDS * count));
+    }
+
+    return errors;
+}
+
+static int _bench_lookup_check(const uint64_t *ids, uint16_t count) {
+
+    int mismatches = 0;
+    for (uint16_t client = 0; client < 2 * count; client++) {
+        // the second half are ids that never registered
+        uint64_t id     = (client < count) ? ids[client] : _bench_random();
+        int16_t  slot   = _server_find_client(&_tdma_vars.tdma_table, id);
+        int16_t  linear = _bench_linear_find(&_tdma_vars.tdma_table, id);
+        if (slot != linear || (client < count && slot == TDMA_SERVER_CLIENT_NOT_FOUND)) {
+            if (mismatches < BENCH_MAX_ERRORS) {
+                printf("  client 0x%016llX: slot %d instead of %d\n", (unsigned long long)id, slot, linear);
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+static int16_t _bench_linear_find(tdma_server_table_t *tdma_table, uint64_t client) {
+
+    for (size_t i = 0; i <= tdma_table->table_index; i++) {
+        if (tdma_table->table[i].client == client) {
+            return i;
+        }
+    }
+    return TDMA_SERVER_CLIENT_NOT_FOUND;
+}
+
+static int _bench_queue(void) {
+
+    int errors = 0;
+
+    for (size_t size_index = 0; size_index < sizeof(_bench_queue_sizes) / sizeof(_bench_queue_sizes[0]); size_index++) {
+        uint16_t          size = _bench_queue_sizes[size_index];
+        uint8_t           buffer[BENCH_QUEUE_MAX + BENCH_QUEUE_GUARD];
+        db_packet_queue_t queue;
+
+        memset(buffer, 0xA5, sizeof(buffer));
+        db_packet_queue_init(&queue, buffer, size);
+
+        // Reference: FIFO of the packets, with the same accounting of the bytes
+        uint16_t head            = 0;
+        uint16_t count           = 0;
+        uint16_t used            = 0;
+        uint16_t high_water_mark = 0;
+        uint32_t dropped         = 0;
+        uint32_t sequence        = 0;
+        uint32_t mismatches      = 0;
+
+        for (uint32_t op = 0; op < BENCH_QUEUE_OPS; op++) {
+            uint8_t  packet[UINT8_MAX];
+            uint8_t  expected[UINT8_MAX];
+            uint64_t draw = _bench_random();
+            bool     ok   = true;
+
+            if (draw % 1000 == 0) {
+                db_packet_queue_clear(&queue);
+                head  = 0;
+                count = 0;
+                used  = 0;
+            } else if (draw % 8 < 3) {
+                // Mostly short packets, some long ones and some empty ones
+                uint8_t length = ((draw >> 8) % 16 == 0) ? (draw >> 16) % 256 : (draw >> 16) % 40;
+                _bench_queue_packet(packet, sequence, length);
+                bool not_dropped = true;
+                if (length > 0 && length < size) {
+                    while (used + 1 + length > size) {
+                        used -= 1 + _bench_queue_fifo[head].length;
+                        head = (head + 1) % BENCH_QUEUE_MAX;
+                        count--;
+                        dropped++;
+                        not_dropped = false;
+                    }
+                    _bench_queue_fifo[(head + count) % BENCH_QUEUE_MAX] = (bench_packet_t){ sequence++, length };
+                    count++;
+                    used += 1 + length;
+                    high_water_mark = (used > high_water_mark) ? used : high_water_mark;
+                }
+                ok = db_packet_queue_push(&queue, packet, length) == not_dropped;
+            } else if (draw % 8 < 6) {
+                db_packet_queue_pop(&queue);
+                if (count > 0) {
+                    used -= 1 + _bench_queue_fifo[head].length;
+                    head = (head + 1) % BENCH_QUEUE_MAX;
+                    count--;
+                }
+            } else {
+                uint8_t length          = db_packet_queue_peek(&queue, packet);
+                uint8_t expected_length = (count > 0) ? _bench_queue_fifo[head].length : 0;
+                _bench_queue_packet(expected, _bench_queue_fifo[head].sequence, expected_length);
+                ok = length == expected_length && db_packet_queue_front_length(&queue) == expected_length && memcmp(packet, expected, length) == 0;
+            }
+
+            db_packet_queue_stats_t stats;
+            db_packet_queue_get_stats(&queue, &stats);
+            ok = ok && stats.count == count && stats.used == used && stats.size == size && stats.high_water_mark == high_water_mark && stats.dropped == dropped;
+            for (uint16_t guard = size; guard < size + BENCH_QUEUE_GUARD; guard++) {
+                ok = ok && buffer[guard] == 0xA5;
+            }
+            if (!ok) {
+                if (errors + mismatches < BENCH_MAX_ERRORS) {
+                    printf("  size %u, operation %u: %u packets, %u bytes used, %u dropped instead of %u, %u, %u\n", size, op, stats.count, stats.used, stats.dropped, count, used, dropped);
+                }
+                mismatches++;
+            }
+        }
+
+        printf("  size %4u: %u/%u operations wrong, %u packets pushed, %u dropped\n", size, mismatches, BENCH_QUEUE_OPS, sequence, dropped);
+        errors += mismatches;
+    }
+
+    return errors;
+}
+
+static void _bench_queue_packet(uint8_t *packet, uint32_t sequence, uint8_t length) {
+    for (uint8_t i = 0; i < length; i++) {
+        packet[i] = (uint8_t)(sequence * 31 + i);
+    }
+}
+
+static int _bench_drift(void) {
+
+    int errors = 0;
+
+    printf("clock drift estimator, %u samples, prediction %u periods ahead, tolerance %.0f sigmas of the fit\n", DB_CLOCK_DRIFT_SAMPLES, BENCH_DRIFT_AHEAD, BENCH_DRIFT_SIGMAS);
+    printf("  period      drift  jitter | drift error (tolerance) | prediction error (tolerance, uncorrected)\n");
+    for (size_t period = 0; period < sizeof(_bench_drift_periods) / sizeof(_bench_drift_periods[0]); period++) {
+        for (size_t jitter = 0; jitter < sizeof(_bench_drift_jitters) / sizeof(_bench_drift_jitters[0]); jitter++) {
+            for (size_t ppm = 0; ppm < sizeof(_bench_drift_ppms) / sizeof(_bench_drift_ppms[0]); ppm++) {
+                errors += _bench_drift_clock(_bench_drift_ppms[ppm], _bench_drift_jitters[jitter], _bench_drift_periods[period]);
+            }
+        }
+    }
+
+    return errors;
+}
+
+static int _bench_drift_clock(double drift_ppm, double jitter_us, uint32_t period_us) {
+
+    // Standard deviations of the least squares fit over full windows: the timestamps are off by the uniform
+    // jitter and their rounding to a microsecond, the samples are evenly spaced by the period
+    double n           = DB_CLOCK_DRIFT_SAMPLES;
+    double noise_us    = sqrt(jitter_us * jitter_us / 12 + 1.0 / 12);
+    double spread_us2  = (double)period_us * period_us * n * (n * n - 1) / 12;
+    double ahead_us    = (BENCH_DRIFT_AHEAD + (n - 1) / 2) * period_us;
+    double drift_tol   = BENCH_DRIFT_SIGMAS * noise_us / sqrt(spread_us2) * 1e9 + 1;
+    double predict_tol = BENCH_DRIFT_SIGMAS * noise_us * sqrt(1 / n + ahead_us * ahead_us / spread_us2) + 1;
+
+    // Start close to the wrap around of both clocks
+    uint32_t remote_origin = UINT32_MAX - 10 * period_us - (uint32_t)(_bench_random() % period_us);
+    uint32_t local_origin  = (uint32_t)_bench_random();
+    double   rate          = 1 + drift_ppm / 1e6;
+
+    db_clock_drift_t drift;
+    db_clock_drift_init(&drift);
+
+    int    mismatches    = 0;
+    double drift_error   = 0;
+    double predict_error = 0;
+    for (uint32_t sample = 0; sample < BENCH_DRIFT_SAMPLES; sample++) {
+
+        // Halfway, the remote clock restarts and the estimator must start over from the next sample
+        uint32_t elapsed = (sample % (BENCH_DRIFT_SAMPLES / 2)) * period_us;
+        if (sample == BENCH_DRIFT_SAMPLES / 2) {
+            remote_origin = (uint32_t)_bench_random();
+            local_origin += (uint32_t)llround((BENCH_DRIFT_SAMPLES / 2) * period_us * rate);
+        }
+        double   jitter = ((double)(_bench_random() >> 11) / (1ULL << 53) - 0.5) * jitter_us;
+        uint32_t remote = remote_origin + elapsed;
+        uint32_t local  = local_origin + (uint32_t)llround(elapsed * rate + jitter);
+        db_clock_drift_add(&drift, remote, local);
+
+        uint8_t expected_count = (sample % (BENCH_DRIFT_SAMPLES / 2)) + 1;
+        if (expected_count > DB_CLOCK_DRIFT_SAMPLES) {
+            expected_count = DB_CLOCK_DRIFT_SAMPLES;
+        }
+        bool ok = drift.count == expected_count;
+
+        // Compare the estimates to the truth once the window is full
+        if (drift.count == DB_CLOCK_DRIFT_SAMPLES) {
+            uint32_t ahead   = elapsed + BENCH_DRIFT_AHEAD * period_us;
+            uint32_t truth   = local_origin + (uint32_t)llround(ahead * rate);
+            double   ppb     = fabs(db_clock_drift_get_ppb(&drift) - drift_ppm * 1e3);
+            double   predict = fabs((double)(int32_t)(db_clock_drift_local_time(&drift, remote_origin + ahead) - truth));
+            drift_error      = (ppb > drift_error) ? ppb : drift_error;
+            predict_error    = (predict > predict_error) ? predict : predict_error;
+            ok               = ok && ppb <= drift_tol && predict <= predict_tol;
+        }
+
+        if (!ok) {
+            if (mismatches < BENCH_MAX_ERRORS) {
+                printf("  %+.0f ppm, jitter %.0f us, sample %u: %u samples, %d ppb\n", drift_ppm, jitter_us, sample, drift.count, db_clock_drift_get_ppb(&drift));
+            }
+            mismatches++;
+        }
+    }
+
+    // A late timestamp within DB_CLOCK_DRIFT_MAX_ERROR_US is kept, a later one starts over
+    uint32_t elapsed = (BENCH_DRIFT_SAMPLES / 2) * period_us;
+    uint32_t local   = local_origin + (uint32_t)llround(elapsed * rate);
+    db_clock_drift_add(&drift, remote_origin + elapsed, local + DB_CLOCK_DRIFT_MAX_ERROR_US / 2);
+    mismatches += drift.count != DB_CLOCK_DRIFT_SAMPLES;
+    db_clock_drift_add(&drift, remote_origin + elapsed + period_us, local + (uint32_t)llround(period_us * rate) + 2 * DB_CLOCK_DRIFT_MAX_ERROR_US);
+    mismatches += drift.count != 1;
+
+    printf("  %4u ms %+6.0f ppm %4.0f us | %7.0f ppb (%7.0f) | %6.1f us (%6.1f, %7.1f)%s\n", period_us / 1000, drift_ppm, jitter_us, drift_error, drift_tol, predict_error, predict_tol,
+           fabs(drift_ppm) * (BENCH_DRIFT_AHEAD * period_us) / 1e6, mismatches ? " FAILED" : "");
+
+    return mismatches;
+}
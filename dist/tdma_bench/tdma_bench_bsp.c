@@ -0,0 +1,75 @@
+/**
+ * @file
+ * @brief       Host implementation of the radio and timer used by the TDMA drivers, for the TDMA benchmarks
+ *
+ * The benchmarks call the functions of the drivers directly, nothing is ever sent or received:
+ * the radio does nothing and the high frequency timer reads the monotonic clock of the host.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <nrf.h>
+
+#include "radio.h"
+#include "timer_hf.h"
+
+//=========================== variables ========================================
+
+NRF_FICR_Type sim_ficr = { 0 };
+
+//=========================== public ===========================================
+
+void db_radio_init(radio_cb_t callback, db_radio_mode_t mode) {
+    (void)callback;
+    (void)mode;
+}
+
+void db_radio_set_timestamp_timer(timer_hf_t timer, uint8_t channel) {
+    (void)timer;
+    (void)channel;
+}
+
+void db_radio_set_frequency(uint8_t freq) {
+    (void)freq;
+}
+
+void db_radio_set_channel(uint8_t channel) {
+    (void)channel;
+}
+
+void db_radio_tx(const uint8_t *packet, uint8_t length) {
+    (void)packet;
+    (void)length;
+}
+
+bool db_radio_tx_async(const uint8_t *packet, uint8_t length, radio_tx_cb_t callback) {
+    (void)packet;
+    (void)length;
+    (void)callback;
+    return true;
+}
+
+void db_radio_rx(void) {}
+
+void db_radio_disable(void) {}
+
+void db_timer_hf_init(timer_hf_t timer) {
+    (void)timer;
+}
+
+uint32_t db_timer_hf_now(timer_hf_t timer) {
+    (void)timer;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000ULL + now.tv_nsec / 1000);
+}
+
+void db_timer_hf_set_periodic_us(timer_hf_t timer, uint8_t channel, uint32_t us, timer_hf_cb_t cb) {
+    (void)timer;
+    (void)channel;
+    (void)us;
+    (void)cb;
+}
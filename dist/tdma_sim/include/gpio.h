@@ -0,0 +1,35 @@
+#ifndef __GPIO_H
+#define __GPIO_H
+
+/**
+ * @file
+ * @brief       Host replacement of the GPIO header of the BSP, for the TDMA simulator
+ *
+ * The TDMA drivers only use the GPIO types in their headers. The BSP header also defines the
+ * registers of the GPIO ports in a static variable, unused and reported as such in every file
+ * built for the host.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <stdint.h>
+
+//=========================== defines ==========================================
+
+typedef void (*gpio_cb_t)(void *ctx);  ///< Callback function prototype, it is called on each gpio interrupt
+
+/// GPIO mode
+typedef enum {
+    DB_GPIO_OUT,    ///< Floating output
+    DB_GPIO_IN,     ///< Floating input
+    DB_GPIO_IN_PU,  ///< Pull up input
+    DB_GPIO_IN_PD,  ///< Pull down input
+} gpio_mode_t;
+
+/// GPIO instance
+typedef struct {
+    uint8_t port;  ///< Port number of the GPIO
+    uint8_t pin;   ///< Pin number of the GPIO
+} gpio_t;
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __NRF_H
+#define __NRF_H
+
+/**
+ * @file
+ * @brief       Host replacement of the nRF MDK header, for the TDMA simulator
+ *
+ * Only provides what the headers included by the TDMA drivers need. The factory information
+ * registers are a variable of the simulator, updated with the device ID of the simulated node
+ * running the firmware code, so that db_device_id() works unmodified. The simulated events never
+ * preempt each other, so masking the interrupts does nothing.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Factory information registers, only the device ID and address are simulated
+typedef struct {
+    uint32_t DEVICEID[2];    ///< Device identifier
+    uint32_t DEVICEADDR[2];  ///< Device address
+} NRF_FICR_Type;
+
+extern NRF_FICR_Type sim_ficr;  ///< Factory information registers of the simulated node running the firmware code
+
+#define NRF_FICR (&sim_ficr)  ///< Factory information registers
+
+/// Read the interrupt mask register, the interrupts are never masked
+static inline uint32_t __get_PRIMASK(void) {
+    return 0;
+}
+
+/// Restore the interrupt mask register
+static inline void __set_PRIMASK(uint32_t primask) {
+    (void)primask;
+}
+
+/// Mask the interrupts
+static inline void __disable_irq(void) {}
+
+#endif
@@ -0,0 +1,153 @@
+/**
+ * @file
+ * @brief       Discrete-event core of the TDMA simulator: event queue, nodes and their clocks
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <nrf.h>
+
+#include "sim.h"
+
+//=========================== defines ==========================================
+
+#define SIM_NO_CLIENT 0  ///< No DotBot firmware state is loaded, node 0 is the gateway
+
+typedef struct {
+    sim_event_t *events;    ///< Binary min-heap of the pending events
+    uint32_t     count;     ///< Number of pending events
+    uint32_t     capacity;  ///< Number of events the heap can store before it grows
+    uint32_t     seq;       ///< Insertion order of the next event
+    uint16_t     loaded;    ///< DotBot whose firmware state is loaded
+} sim_vars_t;
+
+//=========================== variables ========================================
+
+sim_node_t           sim_nodes[SIM_MAX_NODES];
+uint16_t             sim_node_count;
+uint16_t             sim_node;
+uint64_t             sim_cursor;
+sim_packet_hook_t    sim_packet_hook;
+sim_receive_filter_t sim_receive_filter;
+NRF_FICR_Type        sim_ficr;
+
+static sim_vars_t _sim_vars = { 0 };
+
+//=========================== prototypes =======================================
+
+/**
+ * @brief   Return true if event a happens before event b
+ */
+static bool _event_before(const sim_event_t *a, const sim_event_t *b);
+
+//=========================== public ===========================================
+
+void sim_node_init(uint16_t node, uint64_t device_id, double ppm, uint32_t clock_offset, uint64_t seed) {
+    sim_node_t *n = &sim_nodes[node];
+    memset(n, 0, sizeof(sim_node_t));
+    n->device_id    = device_id;
+    n->clock_rate   = 1.0 + ppm / 1e6;
+    n->clock_offset = clock_offset;
+    n->rng          = seed ? seed : 1;
+    n->rssi         = INT8_MIN;
+}
+
+void sim_schedule(uint64_t time, sim_event_type_t type, uint16_t node, uint8_t channel, uint32_t arg) {
+    if (_sim_vars.count == _sim_vars.capacity) {
+        _sim_vars.capacity = _sim_vars.capacity ? _sim_vars.capacity * 2 : 1024;
+        _sim_vars.events   = realloc(_sim_vars.events, _sim_vars.capacity * sizeof(sim_event_t));
+        if (!_sim_vars.events) {
+            fprintf(stderr, "Out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    sim_event_t event = {
+        .time    = time,
+        .seq     = _sim_vars.seq++,
+        .type    = type,
+        .node    = node,
+        .channel = channel,
+        .arg     = arg,
+    };
+
+    // Sift the new event up from the last leaf
+    uint32_t index = _sim_vars.count++;
+    while (index > 0) {
+        uint32_t parent = (index - 1) / 2;
+        if (!_event_before(&event, &_sim_vars.events[parent])) {
+            break;
+        }
+        _sim_vars.events[index] = _sim_vars.events[parent];
+        index                   = parent;
+    }
+    _sim_vars.events[index] = event;
+}
+
+bool sim_next_event(sim_event_t *event) {
+    if (_sim_vars.count == 0) {
+        return false;
+    }
+
+    *event = _sim_vars.events[0];
+
+    // Sift the last event down from the root
+    sim_event_t last  = _sim_vars.events[--_sim_vars.count];
+    uint32_t    index = 0;
+    while (2 * index + 1 < _sim_vars.count) {
+        uint32_t child = 2 * index + 1;
+        if (child + 1 < _sim_vars.count && _event_before(&_sim_vars.events[child + 1], &_sim_vars.events[child])) {
+            child++;
+        }
+        if (!_event_before(&_sim_vars.events[child], &last)) {
+            break;
+        }
+        _sim_vars.events[index] = _sim_vars.events[child];
+        index                   = child;
+    }
+    if (_sim_vars.count > 0) {
+        _sim_vars.events[index] = last;
+    }
+    return true;
+}
+
+void sim_enter(uint16_t node, uint64_t time) {
+    sim_node   = node;
+    sim_cursor = (time > sim_nodes[node].busy_until) ? time : sim_nodes[node].busy_until;
+
+    // The firmware reads its device ID in the factory information registers
+    sim_ficr.DEVICEID[0] = (uint32_t)sim_nodes[node].device_id;
+    sim_ficr.DEVICEID[1] = (uint32_t)(sim_nodes[node].device_id >> 32);
+
+    // All the DotBots run the same firmware, swap in the state of this one
+    if (node != SIM_GATEWAY && node != _sim_vars.loaded) {
+        if (_sim_vars.loaded != SIM_NO_CLIENT) {
+            sim_client_save(_sim_vars.loaded);
+        }
+        sim_client_load(node);
+        _sim_vars.loaded = node;
+    }
+}
+
+void sim_leave(void) {
+    sim_nodes[sim_node].busy_until = sim_cursor;
+}
+
+uint32_t sim_local_time(uint16_t node, uint64_t time) {
+    const sim_node_t *n = &sim_nodes[node];
+    return n->clock_offset + (uint32_t)(uint64_t)((double)time * n->clock_rate);
+}
+
+//=========================== private ==========================================
+
+static bool _event_before(const sim_event_t *a, const sim_event_t *b) {
+    if (a->time != b->time) {
+        return a->time < b->time;
+    }
+    return a->seq < b->seq;
+}
@@ -0,0 +1,207 @@
+#ifndef __SIM_H
+#define __SIM_H
+
+/**
+ * @file
+ * @brief       Discrete-event core of the TDMA simulator
+ *
+ * The simulated nodes run the real firmware code: node 0 is the gateway (TDMA server) and the
+ * following nodes are the DotBots (TDMA clients). The code of a node only runs from an event
+ * (timer interrupt, end of a radio packet...), between sim_enter() and sim_leave(), and it takes
+ * no time except while it waits for the radio (db_radio_tx). A node handles one event at a time,
+ * the events of a busy node wait until it is done.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "radio.h"
+#include "timer_hf.h"
+
+//=========================== defines ==========================================
+
+#define SIM_MAX_NODES      1024  ///< Max number of simulated nodes, gateway included
+#define SIM_TIMER_COUNT    5     ///< Number of TIMER peripherals of a node
+#define SIM_TIMER_CHANNELS 6     ///< Number of channels of a TIMER peripheral
+#define SIM_GATEWAY        0     ///< Index of the gateway node
+
+/// Types of simulation events
+typedef enum {
+    SIM_EVENT_BOOT,        ///< A node is powered on
+    SIM_EVENT_TIMER,       ///< A timer channel of a node fires
+    SIM_EVENT_PACKET_END,  ///< A packet is over, it is delivered to the nodes listening
+    SIM_EVENT_UPLINK,      ///< The application of a DotBot queues a packet for the gateway
+    SIM_EVENT_DOWNLINK,    ///< The gateway queues a packet for a DotBot
+    SIM_EVENT_SAMPLE,      ///< Periodic sampling of the TDMA table of the gateway
+} sim_event_type_t;
+
+/// Simulation event
+typedef struct {
+    uint64_t         time;     ///< Time of the event, in microseconds of simulation time
+    uint32_t         seq;      ///< Insertion order, events at the same time are handled in this order
+    sim_event_type_t type;     ///< Type of the event
+    uint16_t         node;     ///< Node concerned by the event
+    uint8_t          channel;  ///< Timer and channel of a SIM_EVENT_TIMER event (timer * SIM_TIMER_CHANNELS + channel)
+    uint32_t         arg;      ///< Generation of a timer channel, or identifier of a packet
+} sim_event_t;
+
+/// Radio state of a node
+typedef enum {
+    SIM_RADIO_IDLE,  ///< Radio disabled
+    SIM_RADIO_RX,    ///< Radio listening
+    SIM_RADIO_TX,    ///< Radio sending a packet queued with db_radio_tx_async
+} sim_radio_state_t;
+
+/// Timer channel of a node
+typedef struct {
+    timer_hf_cb_t callback;    ///< Function called when the channel fires
+    uint32_t      period_us;   ///< Period of the channel, in microseconds of the node clock
+    bool          one_shot;    ///< Set when the channel fires only once
+    bool          armed;       ///< Set while the channel is waiting to fire
+    double        fire_at;     ///< Time when the channel fires, in microseconds of simulation time
+    uint32_t      generation;  ///< Incremented each time the channel is set, to ignore the outdated events
+    uint32_t      capture;     ///< Last value captured in the channel
+} sim_timer_channel_t;
+
+/// Simulated node
+typedef struct {
+    uint64_t            device_id;                                   ///< Device ID of the node
+    double              clock_rate;                                  ///< Microseconds of the node clock per microsecond of simulation time (drift)
+    uint32_t            clock_offset;                                ///< Value of the node clock at the start of the simulation
+    uint64_t            busy_until;                                  ///< Time when the node is done with the event it is handling
+    sim_timer_channel_t timers[SIM_TIMER_COUNT][SIM_TIMER_CHANNELS];  ///< Timer channels
+    uint64_t            rng;                                         ///< State of the random number generator
+    radio_cb_t          radio_callback;                              ///< Function called when a packet is received
+    db_radio_mode_t     radio_mode;                                  ///< Radio mode
+    uint8_t             radio_frequency;                             ///< Radio frequency, in MHz above 2400 MHz
+    sim_radio_state_t   radio_state;                                 ///< Radio state
+    uint64_t            listen_from;                                 ///< Time when the radio started listening
+    uint64_t            listen_until;                                ///< Time when the radio stopped listening, UINT64_MAX while it listens
+    bool                timestamp_enabled;                           ///< Set when the received packets are timestamped
+    timer_hf_t          timestamp_timer;                             ///< Timer timestamping the received packets
+    uint8_t             timestamp_channel;                           ///< Timer channel timestamping the received packets
+    int8_t              rssi;                                        ///< RSSI of the last received packet
+    uint32_t            tx_on_air;                                   ///< Identifier of the packet sent with db_radio_tx_async
+    uint8_t             tx_queued[UINT8_MAX];                        ///< Follow-up packet queued with db_radio_tx_async
+    uint8_t             tx_queued_length;                            ///< Length of the follow-up packet, 0 if there is none
+    radio_tx_cb_t       tx_callback;                                 ///< Completion callback of the packet on air
+    radio_tx_cb_t       tx_queued_callback;                          ///< Completion callback of the follow-up packet
+    db_radio_stats_t    radio_stats[DB_RADIO_MODE_COUNT];            ///< Reception statistics
+    uint64_t            radio_on_us;                                 ///< Time the radio spent sending, or listening until it last stopped
+} sim_node_t;
+
+/// Packet sent by a node
+typedef struct {
+    uint32_t        id;                ///< Identifier of the packet, in sending order
+    uint16_t        sender;            ///< Node sending the packet
+    db_radio_mode_t mode;              ///< Radio mode of the sender
+    uint8_t         frequency;         ///< Frequency of the sender
+    uint64_t        start;             ///< Time when the radio starts to ramp up
+    uint64_t        address;           ///< Time of the ADDRESS event, the receivers synchronize on it
+    uint64_t        end;               ///< Time when the packet is over
+    bool            aborted;           ///< Set when the sender disabled its radio before the end of the packet
+    bool            async;             ///< Set when the packet was sent with db_radio_tx_async
+    bool            collided;          ///< Set when another packet was on air on the same frequency at the same time
+    uint8_t         length;            ///< Length of the packet
+    uint8_t         data[UINT8_MAX];   ///< Bytes of the packet
+} sim_packet_t;
+
+/// Called at the end of each packet, once it is delivered, to collect statistics
+typedef void (*sim_packet_hook_t)(const sim_packet_t *packet, uint16_t receivers);
+
+/// Called before a received packet is handed to the radio callback of a node, returns false if the callback would ignore it right away
+typedef bool (*sim_receive_filter_t)(uint16_t node, const sim_packet_t *packet, bool crc_ok);
+
+//=========================== variables ========================================
+
+extern sim_node_t           sim_nodes[SIM_MAX_NODES];  ///< Simulated nodes
+extern uint16_t             sim_node_count;            ///< Number of simulated nodes
+extern uint16_t             sim_node;                  ///< Node running code
+extern uint64_t             sim_cursor;                ///< Time seen by the node running code, in microseconds of simulation time
+extern sim_packet_hook_t    sim_packet_hook;           ///< Function called at the end of each packet, can be NULL
+extern sim_receive_filter_t sim_receive_filter;        ///< Function filtering the received packets, can be NULL
+
+//=========================== public ===========================================
+
+/**
+ * @brief   Initialize a node, with its clock drifting by ppm parts per million
+ */
+void sim_node_init(uint16_t node, uint64_t device_id, double ppm, uint32_t clock_offset, uint64_t seed);
+
+/**
+ * @brief   Schedule an event
+ */
+void sim_schedule(uint64_t time, sim_event_type_t type, uint16_t node, uint8_t channel, uint32_t arg);
+
+/**
+ * @brief   Take the next event out of the queue
+ *
+ * @return  false if the queue is empty
+ */
+bool sim_next_event(sim_event_t *event);
+
+/**
+ * @brief   Start running the code of a node, at time or once the node is done with its previous event
+ */
+void sim_enter(uint16_t node, uint64_t time);
+
+/**
+ * @brief   Stop running the code of the current node
+ */
+void sim_leave(void);
+
+/**
+ * @brief   Convert a time of the simulation to the clock of a node
+ */
+uint32_t sim_local_time(uint16_t node, uint64_t time);
+
+/**
+ * @brief   Handle a SIM_EVENT_TIMER event
+ */
+void sim_timer_event(const sim_event_t *event);
+
+/**
+ * @brief   Handle a SIM_EVENT_PACKET_END event
+ */
+void sim_packet_event(const sim_event_t *event);
+
+/**
+ * @brief   Make each receiver lose a share of the packets, with an invalid CRC, on top of the collisions
+ *
+ * @param[in]   loss    probability that a receiver loses a packet, between 0 and 1
+ * @param[in]   seed    seed of the random number generator of the losses
+ */
+void sim_set_packet_loss(double loss, uint64_t seed);
+
+/**
+ * @brief   Add a narrowband interferer, the receivers lose a share of the packets sent in its band, with an invalid CRC
+ *
+ * @param[in]   from    lowest frequency of the band, in MHz above 2400 MHz
+ * @param[in]   to      highest frequency of the band, in MHz above 2400 MHz
+ * @param[in]   loss    probability that a receiver loses a packet sent in the band, between 0 and 1
+ */
+void sim_add_interference(uint8_t from, uint8_t to, double loss);
+
+/**
+ * @brief   Duration of a packet on air, ramp up included
+ */
+uint32_t sim_airtime_us(db_radio_mode_t mode, uint8_t length);
+
+/**
+ * @brief   Time the radio of a node spent sending or listening, until time
+ */
+uint64_t sim_radio_on_us(uint16_t node, uint64_t time);
+
+/**
+ * @brief   Save the firmware state of the node running code (see sim_client.c)
+ */
+void sim_client_save(uint16_t node);
+
+/**
+ * @brief   Restore the firmware state of a node (see sim_client.c)
+ */
+void sim_client_load(uint16_t node);
+
+#endif
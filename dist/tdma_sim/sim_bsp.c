@@ -0,0 +1,508 @@
+/**
+ * @file
+ * @brief       Simulated radio, high frequency timer and random number generator of the TDMA simulator
+ *
+ * The functions of radio.h, timer_hf.h and rng.h act on the node running code (sim_node).
+ *
+ * The radio medium is a single collision domain: every node hears every other node, and two packets
+ * on the same frequency that overlap in time are both lost (no capture effect). A node receives a
+ * packet if its radio listens on the frequency and mode of the packet from its ADDRESS event to its
+ * end, collided packets are delivered with an invalid CRC. On top of the collisions, each receiver
+ * gets a packet with an invalid CRC with the probability set by sim_set_packet_loss(), independently
+ * of the other receivers, and with the probability of each narrowband interferer (see sim_add_interference())
+ * whose band holds the frequency of the packet. The RSSI is not simulated.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "radio.h"
+#include "rng.h"
+#include "timer_hf.h"
+#include "sim.h"
+
+//=========================== defines ==========================================
+
+#define SIM_PACKET_POOL     4096  ///< Number of packets stored, a packet must end before 4096 other packets start
+#define SIM_PACKET_WINDOW   512   ///< Number of previous packets checked for collisions
+#define SIM_RADIO_RAMP_UP   40    ///< Radio ramp up time before sending, in microseconds (fast ramp up, see radio_default.c)
+#define SIM_RADIO_RSSI      -60   ///< RSSI of all the received packets, in dBm
+#define SIM_MAX_INTERFERERS 4     ///< Max number of narrowband interferers
+
+/// On-air timing of a radio mode, in microseconds
+typedef struct {
+    uint16_t byte_us;      ///< Duration of a byte of payload
+    uint16_t overhead_us;  ///< Duration of everything else: preamble, address, header, CRC (and coding indicator, terms in LR modes)
+    uint16_t address_us;   ///< Time between the start of the preamble and the ADDRESS event
+} sim_radio_timing_t;
+
+/// Narrowband interferer, a Wi-Fi network for instance
+typedef struct {
+    uint8_t from;  ///< Lowest frequency of the band, in MHz above 2400 MHz
+    uint8_t to;    ///< Highest frequency of the band
+    double  loss;  ///< Probability that a receiver gets a packet sent in the band with an invalid CRC
+} sim_interferer_t;
+
+typedef struct {
+    sim_packet_t     packets[SIM_PACKET_POOL];              ///< Last packets sent, indexed by their identifier
+    uint32_t         next_id;                               ///< Identifier of the next packet sent
+    double           loss;                                  ///< Probability that a receiver gets a packet with an invalid CRC, on top of the collisions
+    uint64_t         loss_rng;                              ///< State of the random number generator of the losses
+    sim_interferer_t interferers[SIM_MAX_INTERFERERS];      ///< Narrowband interferers
+    uint8_t          interferer_count;                      ///< Number of interferers
+} sim_bsp_vars_t;
+
+//=========================== variables ========================================
+
+static const sim_radio_timing_t _radio_timings[DB_RADIO_MODE_COUNT] = {
+    { 8, 80, 40 },     // DB_RADIO_BLE_1MBit: 1B preamble, 4B address, 2B header, 3B CRC
+    { 4, 44, 24 },     // DB_RADIO_BLE_2MBit: 2B preamble, 4B address, 2B header, 3B CRC
+    { 64, 720, 336 },  // DB_RADIO_BLE_LR125Kbit: 80us preamble, 256us address, CI and TERM1, coded header, CRC and TERM2
+    { 16, 462, 336 },  // DB_RADIO_BLE_LR500Kbit: same as above, header and CRC coded with S=2
+    { 32, 256, 160 },  // DB_RADIO_IEEE802154_250Kbit: 4B preamble, SFD, length, 2B FCS
+};
+
+static const uint8_t _ble_chan_to_freq[40] = {
+    4, 6, 8,
+    10, 12, 14, 16, 18,
+    20, 22, 24, 28,
+    30, 32, 34, 36, 38,
+    40, 42, 44, 46, 48,
+    50, 52, 54, 56, 58,
+    60, 62, 64, 66, 68,
+    70, 72, 74, 76, 78,
+    2, 26, 80  // Advertising channels
+};
+
+static sim_bsp_vars_t _sim_bsp_vars = { .next_id = 1, .loss_rng = 1 };
+
+//=========================== prototypes =======================================
+
+/**
+ * @brief   Draw whether a receiver loses a packet, with the probability set by sim_set_packet_loss() and the interferers on its frequency
+ */
+static bool _packet_lost(uint8_t frequency);
+
+/**
+ * @brief   Draw an event of a given probability, with the random number generator of the losses
+ */
+static bool _loss_draw(double probability);
+
+/**
+ * @brief   Convert a duration of the clock of the current node to simulation time
+ */
+static double _to_sim_us(uint32_t us);
+
+/**
+ * @brief   Arm a timer channel of the current node
+ */
+static void _timer_set(timer_hf_t timer, uint8_t channel, uint32_t us, timer_hf_cb_t cb, bool one_shot);
+
+/**
+ * @brief   Put a packet on air, from the current node at the current time
+ *
+ * @return  the packet
+ */
+static sim_packet_t *_radio_send(const uint8_t *packet, uint8_t length, bool async);
+
+/**
+ * @brief   Start listening, if the radio is not already
+ */
+static void _radio_listen(void);
+
+/**
+ * @brief   Stop listening, if the radio was
+ */
+static void _radio_mute(void);
+
+/**
+ * @brief   Put the follow-up packet queued with db_radio_tx_async on air
+ *
+ * @return  true if there was one
+ */
+static bool _radio_tx_next(void);
+
+//=========================== public ===========================================
+
+uint64_t sim_radio_on_us(uint16_t node, uint64_t time) {
+    const sim_node_t *n = &sim_nodes[node];
+    if (n->listen_until == UINT64_MAX && time > n->listen_from) {
+        return n->radio_on_us + time - n->listen_from;
+    }
+    return n->radio_on_us;
+}
+
+uint32_t sim_airtime_us(db_radio_mode_t mode, uint8_t length) {
+    return SIM_RADIO_RAMP_UP + _radio_timings[mode].overhead_us + length * _radio_timings[mode].byte_us;
+}
+
+void sim_timer_event(const sim_event_t *event) {
+    sim_node_t          *n  = &sim_nodes[event->node];
+    sim_timer_channel_t *ch = &n->timers[event->channel / SIM_TIMER_CHANNELS][event->channel % SIM_TIMER_CHANNELS];
+    if (!ch->armed || ch->generation != event->arg) {
+        return;
+    }
+
+    sim_enter(event->node, event->time);
+    if (ch->one_shot) {
+        ch->armed = false;
+    } else {
+        // Like the hardware, the next period starts when this one should have ended, not when its callback runs
+        ch->fire_at += _to_sim_us(ch->period_us);
+        sim_schedule((uint64_t)ceil(ch->fire_at), SIM_EVENT_TIMER, event->node, event->channel, ch->generation);
+    }
+    ch->callback();
+    sim_leave();
+}
+
+void sim_packet_event(const sim_event_t *event) {
+    sim_packet_t *packet    = &_sim_bsp_vars.packets[event->arg % SIM_PACKET_POOL];
+    uint16_t      receivers = 0;
+
+    // Check every packet that could have been on air at the same time
+    uint32_t first = (packet->id > SIM_PACKET_WINDOW) ? packet->id - SIM_PACKET_WINDOW : 1;
+    for (uint32_t id = first; id < _sim_bsp_vars.next_id; id++) {
+        const sim_packet_t *other = &_sim_bsp_vars.packets[id % SIM_PACKET_POOL];
+        if (id == packet->id || other->frequency != packet->frequency) {
+            continue;
+        }
+        if (other->start + SIM_RADIO_RAMP_UP < packet->end && other->end > packet->start + SIM_RADIO_RAMP_UP) {
+            packet->collided = true;
+            break;
+        }
+    }
+
+    for (uint16_t node = 0; node < sim_node_count && !packet->aborted; node++) {
+        sim_node_t *n = &sim_nodes[node];
+        if (node == packet->sender || n->radio_mode != packet->mode || n->radio_frequency != packet->frequency) {
+            continue;
+        }
+        if (n->listen_from > packet->address || n->listen_until < packet->end) {
+            continue;
+        }
+
+        db_radio_rx_metadata_t metadata = {
+            .timestamp = 0,
+            .rssi      = SIM_RADIO_RSSI,
+            .crc_ok    = !packet->collided && !_packet_lost(packet->frequency),
+        };
+        if (n->timestamp_enabled) {
+            // The ADDRESS event captures the timer through (D)PPI, without software latency
+            metadata.timestamp                                          = sim_local_time(node, packet->address);
+            n->timers[n->timestamp_timer][n->timestamp_channel].capture = metadata.timestamp;
+        }
+        n->rssi = metadata.rssi;
+        n->radio_stats[n->radio_mode].rx_packets++;
+        if (!metadata.crc_ok) {
+            n->radio_stats[n->radio_mode].rx_crc_errors++;
+        }
+        receivers++;
+        if (!n->radio_callback || (sim_receive_filter && !sim_receive_filter(node, packet, metadata.crc_ok))) {
+            continue;
+        }
+
+        sim_enter(node, packet->end);
+        uint8_t data[UINT8_MAX];
+        memcpy(data, packet->data, packet->length);
+        n->radio_callback(data, packet->length, &metadata);
+        sim_leave();
+    }
+
+    if (sim_packet_hook) {
+        sim_packet_hook(packet, receivers);
+    }
+
+    // Completion of a packet sent with db_radio_tx_async, unless the sender disabled its radio since
+    sim_node_t *sender = &sim_nodes[packet->sender];
+    if (!packet->async || packet->aborted || sender->tx_on_air != packet->id) {
+        return;
+    }
+    sim_enter(packet->sender, packet->end);
+    radio_tx_cb_t callback = sender->tx_callback;
+    sender->tx_on_air      = 0;
+    bool on_air            = _radio_tx_next();
+    if (callback) {
+        callback();
+    }
+    if (!on_air && !_radio_tx_next() && sender->radio_state == SIM_RADIO_TX) {
+        sender->radio_state = SIM_RADIO_RX;
+        _radio_listen();
+    }
+    sim_leave();
+}
+
+void sim_set_packet_loss(double loss, uint64_t seed) {
+    _sim_bsp_vars.loss     = loss;
+    _sim_bsp_vars.loss_rng = seed | 1;
+}
+
+void sim_add_interference(uint8_t from, uint8_t to, double loss) {
+    assert(_sim_bsp_vars.interferer_count < SIM_MAX_INTERFERERS);
+    _sim_bsp_vars.interferers[_sim_bsp_vars.interferer_count++] = (sim_interferer_t){ .from = from, .to = to, .loss = loss };
+}
+
+//=========================== radio ============================================
+
+void db_radio_init(radio_cb_t callback, db_radio_mode_t mode) {
+    sim_node_t *n     = &sim_nodes[sim_node];
+    n->radio_callback = callback;
+    n->radio_mode     = mode;
+    _radio_mute();
+    n->radio_state = SIM_RADIO_IDLE;
+}
+
+void db_radio_set_timestamp_timer(timer_hf_t timer, uint8_t channel) {
+    assert(timer < SIM_TIMER_COUNT && channel < SIM_TIMER_CHANNELS);
+    sim_node_t *n        = &sim_nodes[sim_node];
+    n->timestamp_timer   = timer;
+    n->timestamp_channel = channel;
+    n->timestamp_enabled = true;
+}
+
+void db_radio_set_frequency(uint8_t freq) {
+    sim_nodes[sim_node].radio_frequency = freq;
+}
+
+void db_radio_set_channel(uint8_t channel) {
+    if (sim_nodes[sim_node].radio_mode == DB_RADIO_IEEE802154_250Kbit) {
+        assert(channel >= 11 && channel <= 26);
+        db_radio_set_frequency(5 * (channel - 10));
+    } else {
+        assert(channel < sizeof(_ble_chan_to_freq));
+        db_radio_set_frequency(_ble_chan_to_freq[channel]);
+    }
+}
+
+void db_radio_set_network_address(uint32_t addr) {
+    (void)addr;
+}
+
+void db_radio_tx(const uint8_t *packet, uint8_t length) {
+    sim_node_t *n = &sim_nodes[sim_node];
+
+    // Like the radio driver, the packet is only sent if the radio was disabled
+    if (n->radio_state == SIM_RADIO_TX) {
+        return;
+    }
+    if (n->radio_state == SIM_RADIO_IDLE) {
+        // The code waits until the end of the packet
+        sim_cursor = _radio_send(packet, length, false)->end;
+    }
+    n->radio_state = SIM_RADIO_RX;
+    _radio_listen();
+}
+
+bool db_radio_tx_async(const uint8_t *packet, uint8_t length, radio_tx_cb_t callback) {
+    sim_node_t *n = &sim_nodes[sim_node];
+
+    if (n->radio_state == SIM_RADIO_IDLE) {
+        n->tx_on_air   = _radio_send(packet, length, true)->id;
+        n->tx_callback = callback;
+        n->radio_state = SIM_RADIO_TX;
+        return true;
+    }
+    if (n->radio_state == SIM_RADIO_TX && n->tx_queued_length == 0 && length > 0) {
+        memcpy(n->tx_queued, packet, length);
+        n->tx_queued_length   = length;
+        n->tx_queued_callback = callback;
+        return true;
+    }
+    return false;
+}
+
+void db_radio_rx(void) {
+    sim_node_t *n = &sim_nodes[sim_node];
+    if (n->radio_state == SIM_RADIO_TX) {
+        return;
+    }
+    n->radio_state = SIM_RADIO_RX;
+    _radio_listen();
+}
+
+int8_t db_radio_rssi(void) {
+    return sim_nodes[sim_node].rssi;
+}
+
+void db_radio_get_stats(db_radio_mode_t mode, db_radio_stats_t *stats) {
+    *stats = sim_nodes[sim_node].radio_stats[mode];
+}
+
+void db_radio_disable(void) {
+    sim_node_t *n = &sim_nodes[sim_node];
+
+    // The packet on air is cut short, and the follow-up packet dropped
+    if (n->tx_on_air) {
+        sim_packet_t *packet = &_sim_bsp_vars.packets[n->tx_on_air % SIM_PACKET_POOL];
+        if (packet->end > sim_cursor) {
+            n->radio_on_us -= packet->end - sim_cursor;
+            packet->end     = sim_cursor;
+            packet->aborted = true;
+        }
+        n->tx_on_air = 0;
+    }
+    n->tx_queued_length = 0;
+    _radio_mute();
+    n->radio_state = SIM_RADIO_IDLE;
+}
+
+//=========================== timer ============================================
+
+void db_timer_hf_init(timer_hf_t timer) {
+    assert(timer < SIM_TIMER_COUNT);
+}
+
+uint32_t db_timer_hf_now(timer_hf_t timer) {
+    (void)timer;
+    return sim_local_time(sim_node, sim_cursor);
+}
+
+void db_timer_hf_set_periodic_us(timer_hf_t timer, uint8_t channel, uint32_t us, timer_hf_cb_t cb) {
+    _timer_set(timer, channel, us, cb, false);
+}
+
+void db_timer_hf_set_oneshot_us(timer_hf_t timer, uint8_t channel, uint32_t us, timer_hf_cb_t cb) {
+    _timer_set(timer, channel, us, cb, true);
+}
+
+void db_timer_hf_set_oneshot_ms(timer_hf_t timer, uint8_t channel, uint32_t ms, timer_hf_cb_t cb) {
+    db_timer_hf_set_oneshot_us(timer, channel, ms * 1000UL, cb);
+}
+
+void db_timer_hf_set_oneshot_s(timer_hf_t timer, uint8_t channel, uint32_t s, timer_hf_cb_t cb) {
+    db_timer_hf_set_oneshot_us(timer, channel, s * 1000UL * 1000UL, cb);
+}
+
+void db_timer_hf_capture_on_ppi(timer_hf_t timer, uint8_t channel, uint8_t ppi_channel) {
+    (void)timer;
+    (void)channel;
+    (void)ppi_channel;
+}
+
+uint32_t db_timer_hf_get_capture(timer_hf_t timer, uint8_t channel) {
+    return sim_nodes[sim_node].timers[timer][channel].capture;
+}
+
+void db_timer_hf_delay_us(timer_hf_t timer, uint32_t us) {
+    (void)timer;
+    sim_cursor += (uint64_t)ceil(_to_sim_us(us));
+}
+
+void db_timer_hf_delay_ms(timer_hf_t timer, uint32_t ms) {
+    db_timer_hf_delay_us(timer, ms * 1000UL);
+}
+
+void db_timer_hf_delay_s(timer_hf_t timer, uint32_t s) {
+    db_timer_hf_delay_us(timer, s * 1000UL * 1000UL);
+}
+
+//=========================== rng ==============================================
+
+void db_rng_init(void) {}
+
+void db_rng_read(uint8_t *value) {
+    // xorshift64*
+    uint64_t *state = &sim_nodes[sim_node].rng;
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    *value = (uint8_t)((*state * 0x2545F4914F6CDD1DULL) >> 56);
+}
+
+//=========================== private ==========================================
+
+static bool _packet_lost(uint8_t frequency) {
+    if (_loss_draw(_sim_bsp_vars.loss)) {
+        return true;
+    }
+    for (uint8_t interferer = 0; interferer < _sim_bsp_vars.interferer_count; interferer++) {
+        const sim_interferer_t *band = &_sim_bsp_vars.interferers[interferer];
+        if (frequency >= band->from && frequency <= band->to && _loss_draw(band->loss)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool _loss_draw(double probability) {
+    if (probability <= 0) {
+        return false;
+    }
+    // xorshift64*, apart from the generators of the nodes so that the losses don't change their behavior
+    uint64_t *state = &_sim_bsp_vars.loss_rng;
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return (double)((*state * 0x2545F4914F6CDD1DULL) >> 11) / (double)(1ULL << 53) < probability;
+}
+
+static double _to_sim_us(uint32_t us) {
+    return (double)us / sim_nodes[sim_node].clock_rate;
+}
+
+static void _timer_set(timer_hf_t timer, uint8_t channel, uint32_t us, timer_hf_cb_t cb, bool one_shot) {
+    assert(timer < SIM_TIMER_COUNT && channel < SIM_TIMER_CHANNELS);
+    assert(cb);
+
+    sim_timer_channel_t *ch = &sim_nodes[sim_node].timers[timer][channel];
+    ch->callback            = cb;
+    ch->period_us           = us;
+    ch->one_shot            = one_shot;
+    ch->armed               = true;
+    ch->fire_at             = (double)sim_cursor + _to_sim_us(us);
+    ch->generation++;
+    sim_schedule((uint64_t)ceil(ch->fire_at), SIM_EVENT_TIMER, sim_node, timer * SIM_TIMER_CHANNELS + channel, ch->generation);
+}
+
+static sim_packet_t *_radio_send(const uint8_t *packet, uint8_t length, bool async) {
+    sim_node_t   *n = &sim_nodes[sim_node];
+    sim_packet_t *p = &_sim_bsp_vars.packets[_sim_bsp_vars.next_id % SIM_PACKET_POOL];
+
+    _radio_mute();
+    memset(p, 0, sizeof(sim_packet_t));
+    p->id        = _sim_bsp_vars.next_id++;
+    p->sender    = sim_node;
+    p->mode      = n->radio_mode;
+    p->frequency = n->radio_frequency;
+    p->start     = sim_cursor;
+    p->address   = sim_cursor + SIM_RADIO_RAMP_UP + _radio_timings[n->radio_mode].address_us;
+    p->end       = sim_cursor + sim_airtime_us(n->radio_mode, length);
+    p->async     = async;
+    p->length    = length;
+    memcpy(p->data, packet, length);
+    n->radio_on_us += p->end - p->start;
+    sim_schedule(p->end, SIM_EVENT_PACKET_END, sim_node, 0, p->id);
+    return p;
+}
+
+static void _radio_listen(void) {
+    sim_node_t *n = &sim_nodes[sim_node];
+    if (n->listen_until == UINT64_MAX) {
+        return;
+    }
+    n->listen_from  = sim_cursor;
+    n->listen_until = UINT64_MAX;
+}
+
+static void _radio_mute(void) {
+    sim_node_t *n = &sim_nodes[sim_node];
+    if (n->listen_until == UINT64_MAX) {
+        n->listen_until = sim_cursor;
+        n->radio_on_us += sim_cursor - n->listen_from;
+    }
+}
+
+static bool _radio_tx_next(void) {
+    sim_node_t *n = &sim_nodes[sim_node];
+    if (n->tx_queued_length == 0) {
+        return false;
+    }
+    n->tx_on_air        = _radio_send(n->tx_queued, n->tx_queued_length, true)->id;
+    n->tx_callback      = n->tx_queued_callback;
+    n->tx_queued_length = 0;
+    return true;
+}
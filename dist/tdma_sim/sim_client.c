@@ -0,0 +1,29 @@
+/**
+ * @file
+ * @brief       TDMA client firmware of the simulated DotBots
+ *
+ * The driver keeps its state in a static variable, as there is a single instance on a DotBot.
+ * It is built here once for all the simulated DotBots, and the simulator swaps in the state of
+ * the DotBot about to run code (see sim_enter()).
+ *
+ * @copyright Inria, 2024
+ */
+
+#include "tdma_client/tdma_client_default.c"
+
+#include "sim.h"
+
+//=========================== variables ========================================
+
+static tdma_client_vars_t _sim_client_states[SIM_MAX_NODES] = { 0 };
+
+//=========================== public ===========================================
+
+void sim_client_save(uint16_t node) {
+    memcpy(&_sim_client_states[node], &_tdma_client_vars, sizeof(tdma_client_vars_t));
+}
+
+void sim_client_load(uint16_t node) {
+    // The pointers to the queue buffers stay valid, they point to the static variable
+    memcpy(&_tdma_client_vars, &_sim_client_states[node], sizeof(tdma_client_vars_t));
+}
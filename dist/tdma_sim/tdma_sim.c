@@ -0,0 +1,871 @@
+/**
+ * @file
+ * @brief       Discrete-event simulator of a DotBot swarm using the TDMA drivers
+ *
+ * The real TDMA server (gateway) and client (DotBots) drivers are built for the host computer,
+ * on top of a simulated radio and high frequency timer (see sim_bsp.c). The simulated swarm boots,
+ * registers with the gateway and exchanges application traffic, and the simulator reports:
+ *
+ * - the time it takes the DotBots to join, each and all of them, and the registration attempts lost to collisions
+ * - the share of their slot time the DotBots and the gateway use
+ * - the delivery ratio, latency distribution and throughput of each traffic flow
+ * - the share of time the radio of the DotBots is on, to compare with and without low-power mode
+ * - the packets sent again, the duplicates and the airtime of the acknowledged data packets, under a given packet loss
+ * - the channels the gateway hops over and the goodput of the swarm, under narrowband interference
+ *
+ * Build it from the root of the repository with `make tdma-sim`, then for example:
+ *
+ *     dist/tdma_sim/tdma_sim --clients 200 --mode ble2m --uplink 50:16 --downlink 200:5 --duration 60
+ *
+ * The traffic flows start once a DotBot has joined, messages sent during the last second of the
+ * simulation are left out of the statistics. See `tdma_sim --help` for all the options.
+ *
+ * The data packets are only acknowledged and sent again if the drivers are built with acknowledged traffic classes, for example:
+ *
+ *     make tdma-sim TDMA_SIM_CFLAGS="-DTDMA_SERVER_MAX_CLIENTS=512 -DTDMA_SERVER_ACKED_PRIORITIES=7 -DTDMA_CLIENT_ACKED_PRIORITIES=7"
+ *     dist/tdma_sim/tdma_sim --clients 100 --loss 10
+ *
+ * Likewise the gateway only hops channels if the server driver is built with TDMA_SERVER_CHANNEL_HOPPING,
+ * to compare the goodput with and without hopping next to a Wi-Fi network on channel 1 (2401 to 2423 MHz):
+ *
+ *     make tdma-sim TDMA_SIM_CFLAGS="-DTDMA_SERVER_MAX_CLIENTS=512 -DTDMA_SERVER_CHANNEL_HOPPING=1"
+ *     dist/tdma_sim/tdma_sim --clients 100 --interference 12:22
+ *
+ * And the gateway only sizes the slots to the traffic of each DotBot if the server driver is built with
+ * TDMA_SERVER_ADAPTIVE_SLOTS, to compare with the fixed slots when a few DotBots stream bulk data:
+ *
+ *     make tdma-sim TDMA_SIM_CFLAGS="-DTDMA_SERVER_MAX_CLIENTS=512 -DTDMA_SERVER_ADAPTIVE_SLOTS=1"
+ *     dist/tdma_sim/tdma_sim --clients 30 --bulk 20:100 --bulk-share 20
+ *
+ * The DotBots send their join requests in the contention slots at the end of the frame, unless the server
+ * driver is built without them, to compare how fast a large swarm joins when all the DotBots power on at once:
+ *
+ *     make tdma-sim TDMA_SIM_CFLAGS="-DTDMA_SERVER_MAX_CLIENTS=512 -DTDMA_SERVER_MIN_CONTENTION_SLOTS=0 -DTDMA_SERVER_MAX_CONTENTION_SLOTS=0"
+ *     dist/tdma_sim/tdma_sim --clients 300 --join-spread 0
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "protocol.h"
+#include "radio.h"
+#include "tdma_client.h"
+#include "tdma_server.h"
+#include "sim.h"
+
+//=========================== defines ==========================================
+
+#define SIM_SAMPLE_PERIOD_US    10000    ///< Period of the join checks and of the sampling of the TDMA table
+#define SIM_TAIL_US             1000000  ///< Messages sent during the last microseconds of the simulation are left out of the statistics
+#define SIM_DEFAULT_FREQUENCY   8        ///< Default radio frequency (2408 MHz), like the DotBot applications
+#define SIM_DEFAULT_FRAME_US    20000    ///< Min duration of a TDMA frame, see TDMA_SERVER_DEFAULT_FRAME_DURATION_US
+#define SIM_APP_PAYLOAD_MIN     (1 + sizeof(uint32_t))  ///< Smallest application payload: data type and message number
+#define SIM_MAX_INTERFERENCE    4        ///< Max number of narrowband interferers, see SIM_MAX_INTERFERERS
+
+/// Traffic flows of the simulated applications
+typedef enum {
+    SIM_FLOW_UPLINK_TELEMETRY,  ///< DotBots to gateway, telemetry traffic class
+    SIM_FLOW_UPLINK_BULK,       ///< DotBots to gateway, bulk traffic class
+    SIM_FLOW_DOWNLINK_CONTROL,  ///< Gateway to DotBots, control traffic class
+    SIM_FLOW_COUNT,             ///< Number of flows
+} sim_flow_t;
+
+/// Categories of packets, for the collision statistics
+typedef enum {
+    SIM_PACKETS_REGISTRATION,  ///< Sent by a DotBot not registered yet
+    SIM_PACKETS_DOTBOT,        ///< Sent by a registered DotBot
+    SIM_PACKETS_GATEWAY,       ///< Sent by the gateway
+    SIM_PACKETS_COUNT,         ///< Number of categories
+} sim_packets_t;
+
+/// Configuration of a traffic flow
+typedef struct {
+    uint32_t period_ms;  ///< Time between two messages of a DotBot, 0 to disable the flow
+    uint8_t  size;       ///< Size of the application payload of the messages, after the protocol header
+} sim_flow_config_t;
+
+/// Narrowband interferer
+typedef struct {
+    uint8_t center;    ///< Center frequency, in MHz above 2400 MHz
+    uint8_t width;     ///< Width of the band, in MHz
+    double  loss_pct;  ///< Share of the packets sent in the band each receiver loses, in percent
+} sim_interference_t;
+
+/// Configuration of a simulation
+typedef struct {
+    uint16_t           clients;                             ///< Number of DotBots
+    db_radio_mode_t    mode;                                ///< Radio mode
+    uint8_t            frequency;                           ///< Radio frequency
+    uint32_t           duration_s;                          ///< Duration of the simulation, in seconds
+    uint32_t           join_spread_ms;                      ///< The DotBots boot at random during this time
+    double             drift_ppm;                           ///< Max clock drift of the nodes, in parts per million
+    uint64_t           seed;                                ///< Seed of the random number generators
+    bool               low_power;                           ///< Put the DotBots in low-power mode
+    double             loss_pct;                            ///< Share of the packets each receiver loses on top of the collisions, in percent
+    double             bulk_pct;                            ///< Share of the DotBots sending the bulk traffic, in percent
+    sim_interference_t interference[SIM_MAX_INTERFERENCE];  ///< Narrowband interferers
+    uint8_t            interference_count;                  ///< Number of interferers
+    bool               csv;                                 ///< Print the results as CSV
+    sim_flow_config_t  flows[SIM_FLOW_COUNT];               ///< Traffic flows
+} sim_config_t;
+
+/// Application message
+typedef struct {
+    uint64_t created;    ///< Time when the application queued the message
+    uint64_t delivered;  ///< Time when the message was received, 0 if it was not
+    uint16_t node;       ///< DotBot sending or receiving the message
+    uint8_t  flow;       ///< Flow of the message
+} sim_message_t;
+
+/// Statistics of a traffic flow
+typedef struct {
+    uint32_t sent;        ///< Number of messages sent, those of the last second excluded
+    uint32_t delivered;   ///< Number of these messages delivered
+    uint64_t bytes;       ///< Application bytes delivered
+    double   p50_ms;      ///< Median latency
+    double   p90_ms;      ///< 90th percentile of the latency
+    double   p99_ms;      ///< 99th percentile of the latency
+    double   max_ms;      ///< Max latency
+} sim_flow_stats_t;
+
+typedef struct {
+    sim_config_t   config;                            ///< Configuration of the simulation
+    uint64_t       end;                               ///< End of the simulation, in microseconds
+    uint64_t       rng;                               ///< State of the random number generator of the simulator
+    uint64_t       boot[SIM_MAX_NODES];               ///< Boot time of each node
+    uint64_t       joined[SIM_MAX_NODES];             ///< Time each DotBot joined, 0 until it does
+    sim_message_t *messages;                          ///< Application messages, indexed by their number
+    uint32_t       message_count;                     ///< Number of messages
+    uint32_t       message_capacity;                  ///< Number of messages that fit before the array grows
+    uint32_t       packets[SIM_PACKETS_COUNT];        ///< Number of packets sent, by category
+    uint32_t       collided[SIM_PACKETS_COUNT];       ///< Number of packets lost to collisions, by category
+    uint64_t       airtime_us[SIM_PACKETS_COUNT];     ///< Time spent on air, by category
+    uint32_t       resent[SIM_PACKETS_COUNT];         ///< Number of acknowledged data packets sent again, by category
+    uint64_t       ack_airtime_us;                    ///< Time spent on air by the block acknowledgements, the sequence numbers and the packets sent again
+    uint32_t       duplicates;                        ///< Number of application messages delivered more than once
+    double         dotbot_slots_us;                   ///< Slot time allocated to the DotBots
+    double         gateway_slots_us;                  ///< Slot time allocated to the gateway
+    uint32_t       frame_us;                          ///< Duration of the TDMA frame at the end of the simulation
+    uint16_t       table_slots;                       ///< Number of slots of the TDMA table at the end of the simulation
+    uint16_t       table_clients;                     ///< Number of clients registered at the end of the simulation
+    uint32_t       interfered;                        ///< Number of packets sent in the band of an interferer
+    uint8_t        hop_seed;                          ///< Seed of the channel hopping of the gateway, from its last sync frame, 0 if it doesn't hop
+    uint8_t        channels_used;                     ///< Number of channels the gateway hops over, from its last sync frame
+    uint8_t        min_channels_used;                 ///< Fewest channels the gateway hopped over
+} tdma_sim_vars_t;
+
+//=========================== variables ========================================
+
+static tdma_sim_vars_t _tdma_sim_vars = { 0 };
+
+static const uint8_t _flow_data_types[SIM_FLOW_COUNT] = {
+    DB_PROTOCOL_DOTBOT_DATA,   // SIM_FLOW_UPLINK_TELEMETRY
+    DB_PROTOCOL_LH2_RAW_DATA,  // SIM_FLOW_UPLINK_BULK
+    DB_PROTOCOL_CMD_MOVE_RAW,  // SIM_FLOW_DOWNLINK_CONTROL
+};
+
+static const char *_flow_names[SIM_FLOW_COUNT] = {
+    "uplink telemetry",
+    "uplink bulk",
+    "downlink control",
+};
+
+static const char *_mode_names[DB_RADIO_MODE_COUNT] = {
+    "ble1m",
+    "ble2m",
+    "lr125",
+    "lr500",
+    "ieee802154",
+};
+
+//=========================== prototypes =======================================
+
+/**
+ * @brief   Return a random number from the random number generator of the simulator
+ */
+static uint64_t _random(void);
+
+/**
+ * @brief   Parse a flow option, formatted as period_ms[:size]
+ *
+ * @return  false if the option is invalid
+ */
+static bool _parse_flow(const char *option, sim_flow_config_t *flow);
+
+/**
+ * @brief   Parse an interference option, formatted as center[:width[:pct]]
+ *
+ * @return  false if the option is invalid
+ */
+static bool _parse_interference(const char *option, sim_interference_t *interference);
+
+/**
+ * @brief   Check if a frequency is in the band of an interferer
+ */
+static bool _interfered(uint8_t frequency);
+
+/**
+ * @brief   Parse the command line
+ */
+static void _parse_arguments(int argc, char **argv);
+
+/**
+ * @brief   Boot a node, gateway or DotBot
+ */
+static void _boot(uint16_t node, uint64_t time);
+
+/**
+ * @brief   Queue an application message, from a DotBot to the gateway or from the gateway to a DotBot
+ */
+static void _send_message(uint16_t dotbot, sim_flow_t flow, uint64_t time);
+
+/**
+ * @brief   Check which DotBots joined, and measure how the TDMA table is allocated
+ */
+static void _sample(uint64_t time);
+
+/**
+ * @brief   Mark the application message carried by a data packet as delivered
+ */
+static void _receive_message(uint8_t *packet, uint8_t length, bool downlink);
+
+/**
+ * @brief   Application callback of the gateway
+ */
+static void _gateway_callback(uint8_t *packet, uint8_t length);
+
+/**
+ * @brief   Application callback of the DotBots
+ */
+static void _dotbot_callback(uint8_t *packet, uint8_t length);
+
+/**
+ * @brief   Count the packets, their airtime and the collisions (see sim_packet_hook_t)
+ */
+static void _packet_hook(const sim_packet_t *packet, uint16_t receivers);
+
+/**
+ * @brief   Skip the packets the radio callback of a node ignores right away (see sim_receive_filter_t)
+ */
+static bool _receive_filter(uint16_t node, const sim_packet_t *packet, bool crc_ok);
+
+/**
+ * @brief   Compute the statistics of a traffic flow
+ */
+static void _flow_stats(sim_flow_t flow, sim_flow_stats_t *stats);
+
+/**
+ * @brief   Print the results of the simulation
+ */
+static void _report(void);
+
+//=========================== main =============================================
+
+int main(int argc, char **argv) {
+    _parse_arguments(argc, argv);
+    const sim_config_t *config = &_tdma_sim_vars.config;
+
+    _tdma_sim_vars.rng = config->seed;
+    _tdma_sim_vars.end = (uint64_t)config->duration_s * 1000000;
+    sim_node_count     = config->clients + 1;
+    sim_packet_hook    = &_packet_hook;
+    sim_receive_filter = &_receive_filter;
+    sim_set_packet_loss(config->loss_pct / 100.0, config->seed);
+    for (uint8_t index = 0; index < config->interference_count; index++) {
+        const sim_interference_t *interference = &config->interference[index];
+        uint8_t                   from         = (interference->center > interference->width / 2) ? interference->center - interference->width / 2 : 0;
+        sim_add_interference(from, interference->center + interference->width / 2, interference->loss_pct / 100.0);
+    }
+
+    // The gateway boots first, the DotBots at random during the join spread
+    for (uint16_t node = 0; node < sim_node_count; node++) {
+        uint64_t device_id = _random();
+        while (device_id == DB_BROADCAST_ADDRESS || device_id == DB_GATEWAY_ADDRESS) {
+            device_id = _random();
+        }
+        double ppm = config->drift_ppm * (2.0 * (double)(_random() >> 11) / (double)(1ULL << 53) - 1.0);
+        sim_node_init(node, device_id, ppm, (uint32_t)_random(), _random());
+        uint64_t boot = (node == SIM_GATEWAY) ? 0 : 1 + _random() % ((uint64_t)config->join_spread_ms * 1000 + 1);
+        sim_schedule(boot, SIM_EVENT_BOOT, node, 0, 0);
+    }
+    sim_schedule(SIM_SAMPLE_PERIOD_US, SIM_EVENT_SAMPLE, SIM_GATEWAY, 0, 0);
+
+    sim_event_t event;
+    while (sim_next_event(&event) && event.time < _tdma_sim_vars.end) {
+        switch (event.type) {
+            case SIM_EVENT_BOOT:
+                _boot(event.node, event.time);
+                break;
+            case SIM_EVENT_TIMER:
+                sim_timer_event(&event);
+                break;
+            case SIM_EVENT_PACKET_END:
+                sim_packet_event(&event);
+                break;
+            case SIM_EVENT_UPLINK:
+            case SIM_EVENT_DOWNLINK:
+                _send_message(event.node, (sim_flow_t)event.channel, event.time);
+                sim_schedule(event.time + config->flows[event.channel].period_ms * 1000ULL, event.type, event.node, event.channel, 0);
+                break;
+            case SIM_EVENT_SAMPLE:
+                _sample(event.time);
+                sim_schedule(event.time + SIM_SAMPLE_PERIOD_US, SIM_EVENT_SAMPLE, SIM_GATEWAY, 0, 0);
+                break;
+        }
+    }
+
+    _report();
+    return EXIT_SUCCESS;
+}
+
+//=========================== private ==========================================
+
+static uint64_t _random(void) {
+    // splitmix64
+    uint64_t z = (_tdma_sim_vars.rng += 0x9E3779B97F4A7C15ULL);
+    z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z          = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static bool _parse_flow(const char *option, sim_flow_config_t *flow) {
+    char         *end;
+    unsigned long period = strtoul(option, &end, 10);
+    unsigned long size   = flow->size;
+    if (*end == ':') {
+        size = strtoul(end + 1, &end, 10);
+    }
+    if (*end != '\0' || size < SIM_APP_PAYLOAD_MIN || size > DB_BLE_PAYLOAD_MAX_LENGTH - sizeof(protocol_header_t)) {
+        return false;
+    }
+    flow->period_ms = period;
+    flow->size      = size;
+    return true;
+}
+
+static bool _parse_interference(const char *option, sim_interference_t *interference) {
+    char         *end;
+    unsigned long center   = strtoul(option, &end, 10);
+    unsigned long width    = 20;
+    double        loss_pct = 100;
+    if (*end == ':') {
+        width = strtoul(end + 1, &end, 10);
+    }
+    if (*end == ':') {
+        loss_pct = strtod(end + 1, &end);
+    }
+    if (*end != '\0' || center > 100 || width > 100 || loss_pct < 0 || loss_pct > 100) {
+        return false;
+    }
+    interference->center   = center;
+    interference->width    = width;
+    interference->loss_pct = loss_pct;
+    return true;
+}
+
+static bool _interfered(uint8_t frequency) {
+    const sim_config_t *config = &_tdma_sim_vars.config;
+    for (uint8_t index = 0; index < config->interference_count; index++) {
+        const sim_interference_t *interference = &config->interference[index];
+        if (frequency + interference->width / 2 >= interference->center && frequency <= interference->center + interference->width / 2) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void _parse_arguments(int argc, char **argv) {
+    sim_config_t *config = &_tdma_sim_vars.config;
+    *config              = (sim_config_t){
+                     .clients        = 50,
+                     .mode           = DB_RADIO_BLE_1MBit,
+                     .frequency      = SIM_DEFAULT_FREQUENCY,
+                     .duration_s     = 30,
+                     .join_spread_ms = 1000,
+                     .drift_ppm      = 20,
+                     .seed           = 1,
+                     .low_power      = false,
+                     .loss_pct       = 0,
+                     .bulk_pct       = 100,
+                     .csv            = false,
+                     .flows          = {
+            { .period_ms = 100, .size = 16 },  // SIM_FLOW_UPLINK_TELEMETRY
+            { .period_ms = 0, .size = 64 },    // SIM_FLOW_UPLINK_BULK
+            { .period_ms = 500, .size = 5 },   // SIM_FLOW_DOWNLINK_CONTROL
+        },
+    };
+
+    static const struct option options[] = {
+        { "clients", required_argument, NULL, 'n' },
+        { "mode", required_argument, NULL, 'm' },
+        { "frequency", required_argument, NULL, 'f' },
+        { "duration", required_argument, NULL, 't' },
+        { "join-spread", required_argument, NULL, 'j' },
+        { "drift", required_argument, NULL, 'p' },
+        { "uplink", required_argument, NULL, 'u' },
+        { "bulk", required_argument, NULL, 'b' },
+        { "bulk-share", required_argument, NULL, 'k' },
+        { "downlink", required_argument, NULL, 'd' },
+        { "seed", required_argument, NULL, 's' },
+        { "low-power", no_argument, NULL, 'l' },
+        { "loss", required_argument, NULL, 'e' },
+        { "interference", required_argument, NULL, 'i' },
+        { "csv", no_argument, NULL, 'c' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+
+    int  option;
+    bool valid = true;
+    while ((option = getopt_long(argc, argv, "n:m:f:t:j:p:u:b:k:d:s:le:i:ch", options, NULL)) != -1) {
+        switch (option) {
+            case 'n':
+                config->clients = strtoul(optarg, NULL, 10);
+                valid &= config->clients >= 1 && config->clients < SIM_MAX_NODES && config->clients <= TDMA_SERVER_MAX_CLIENTS;
+                break;
+            case 'm':
+                valid = false;
+                for (uint8_t mode = 0; mode <= DB_RADIO_BLE_LR500Kbit; mode++) {
+                    if (strcmp(optarg, _mode_names[mode]) == 0) {
+                        config->mode = mode;
+                        valid        = true;
+                    }
+                }
+                break;
+            case 'f':
+                config->frequency = strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                config->duration_s = strtoul(optarg, NULL, 10);
+                valid &= config->duration_s > SIM_TAIL_US / 1000000;
+                break;
+            case 'j':
+                config->join_spread_ms = strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                config->drift_ppm = strtod(optarg, NULL);
+                break;
+            case 'u':
+                valid &= _parse_flow(optarg, &config->flows[SIM_FLOW_UPLINK_TELEMETRY]);
+                break;
+            case 'b':
+                valid &= _parse_flow(optarg, &config->flows[SIM_FLOW_UPLINK_BULK]);
+                break;
+            case 'k':
+                config->bulk_pct = strtod(optarg, NULL);
+                valid &= config->bulk_pct >= 0 && config->bulk_pct <= 100;
+                break;
+            case 'd':
+                valid &= _parse_flow(optarg, &config->flows[SIM_FLOW_DOWNLINK_CONTROL]);
+                break;
+            case 's':
+                config->seed = strtoull(optarg, NULL, 10);
+                break;
+            case 'l':
+                config->low_power = true;
+                break;
+            case 'e':
+                config->loss_pct = strtod(optarg, NULL);
+                valid &= config->loss_pct >= 0 && config->loss_pct <= 100;
+                break;
+            case 'i':
+                valid &= config->interference_count < SIM_MAX_INTERFERENCE && _parse_interference(optarg, &config->interference[config->interference_count++]);
+                break;
+            case 'c':
+                config->csv = true;
+                break;
+            default:
+                valid = false;
+                break;
+        }
+        if (!valid || option == 'h') {
+            fprintf(valid ? stdout : stderr,
+                    "Usage: %s [options]\n"
+                    "  -n, --clients N          number of DotBots (default 50, max %d)\n"
+                    "  -m, --mode MODE          radio mode: ble1m, ble2m, lr125 or lr500 (default ble1m)\n"
+                    "  -f, --frequency F        radio frequency, in MHz above 2400 MHz (default %d)\n"
+                    "  -t, --duration S         duration of the simulation, in seconds (default 30)\n"
+                    "  -j, --join-spread MS     the DotBots boot at random during the first MS milliseconds (default 1000)\n"
+                    "  -p, --drift PPM          max clock drift of the nodes, in parts per million (default 20)\n"
+                    "  -u, --uplink MS[:SIZE]   each DotBot sends telemetry every MS milliseconds, 0 to disable (default 100:16)\n"
+                    "  -b, --bulk MS[:SIZE]     each DotBot sends bulk data every MS milliseconds, 0 to disable (default 0:64)\n"
+                    "  -k, --bulk-share PCT     only PCT percent of the DotBots send the bulk data, the others only telemetry (default 100)\n"
+                    "  -d, --downlink MS[:SIZE] the gateway sends a command to each DotBot every MS milliseconds, 0 to disable (default 500:5)\n"
+                    "  -s, --seed SEED          seed of the random number generators (default 1)\n"
+                    "  -l, --low-power          the DotBots only listen during the first slot of the frame and their downlink slot\n"
+                    "  -e, --loss PCT           each receiver loses PCT percent of the packets on top of the collisions (default 0)\n"
+                    "  -i, --interference F[:W[:PCT]]\n"
+                    "                           narrowband interferer W MHz wide (default 20) centered F MHz above 2400 MHz, each receiver\n"
+                    "                           loses PCT percent (default 100) of the packets sent in its band, up to %d interferers\n"
+                    "  -c, --csv                print the results as CSV\n"
+                    "SIZE is the length of the application payload, after the protocol header (min %zu)\n",
+                    argv[0], TDMA_SERVER_MAX_CLIENTS < SIM_MAX_NODES - 1 ? TDMA_SERVER_MAX_CLIENTS : SIM_MAX_NODES - 1, SIM_DEFAULT_FREQUENCY, SIM_MAX_INTERFERENCE, SIM_APP_PAYLOAD_MIN);
+            exit(valid ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+}
+
+static void _boot(uint16_t node, uint64_t time) {
+    const sim_config_t *config = &_tdma_sim_vars.config;
+
+    _tdma_sim_vars.boot[node] = time;
+    sim_enter(node, time);
+    if (node == SIM_GATEWAY) {
+        db_tdma_server_init(&_gateway_callback, config->mode, config->frequency);
+    } else {
+        db_tdma_client_init(&_dotbot_callback, config->mode, config->frequency);
+        db_tdma_client_set_low_power(config->low_power);
+    }
+    sim_leave();
+}
+
+static void _send_message(uint16_t dotbot, sim_flow_t flow, uint64_t time) {
+    if (_tdma_sim_vars.message_count == _tdma_sim_vars.message_capacity) {
+        _tdma_sim_vars.message_capacity = _tdma_sim_vars.message_capacity ? _tdma_sim_vars.message_capacity * 2 : 65536;
+        _tdma_sim_vars.messages         = realloc(_tdma_sim_vars.messages, _tdma_sim_vars.message_capacity * sizeof(sim_message_t));
+        if (!_tdma_sim_vars.messages) {
+            fprintf(stderr, "Out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    uint32_t       number  = _tdma_sim_vars.message_count++;
+    sim_message_t *message = &_tdma_sim_vars.messages[number];
+    message->created       = time;
+    message->delivered     = 0;
+    message->node          = dotbot;
+    message->flow          = flow;
+
+    // Data packet: protocol header, data type, message number, then padding up to the size of the flow
+    bool    downlink = (flow == SIM_FLOW_DOWNLINK_CONTROL);
+    uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH] = { 0 };
+    sim_enter(downlink ? SIM_GATEWAY : dotbot, time);
+    size_t length  = db_protocol_header_to_buffer(packet, downlink ? sim_nodes[dotbot].device_id : DB_BROADCAST_ADDRESS);
+    packet[length] = _flow_data_types[flow];
+    memcpy(&packet[length + 1], &number, sizeof(uint32_t));
+    length += _tdma_sim_vars.config.flows[flow].size;
+    if (downlink) {
+        db_tdma_server_tx(packet, length);
+    } else {
+        db_tdma_client_tx(packet, length);
+    }
+    sim_leave();
+}
+
+static void _sample(uint64_t time) {
+    const sim_config_t *config = &_tdma_sim_vars.config;
+
+    // Start the traffic of the DotBots that just joined, at a random phase
+    for (uint16_t node = 1; node < sim_node_count; node++) {
+        if (_tdma_sim_vars.joined[node] || !_tdma_sim_vars.boot[node]) {
+            continue;
+        }
+        sim_enter(node, time);
+        bool registered = (db_tdma_client_get_status() == DB_TDMA_CLIENT_REGISTERED);
+        sim_leave();
+        if (!registered) {
+            continue;
+        }
+        _tdma_sim_vars.joined[node] = time;
+        for (uint8_t flow = 0; flow < SIM_FLOW_COUNT; flow++) {
+            uint64_t period_us = config->flows[flow].period_ms * 1000ULL;
+            // The first DotBots send the bulk traffic, they boot in a random order
+            if (flow == SIM_FLOW_UPLINK_BULK && node > config->clients * config->bulk_pct / 100 + 0.5) {
+                continue;
+            }
+            if (period_us > 0) {
+                sim_schedule(time + _random() % period_us, (flow == SIM_FLOW_DOWNLINK_CONTROL) ? SIM_EVENT_DOWNLINK : SIM_EVENT_UPLINK, node, flow, 0);
+            }
+        }
+    }
+
+    // Slot time of the DotBots and of the gateway, the frame is never shorter than the default frame
+    uint32_t frame_us;
+    uint16_t clients;
+    uint16_t table_index;
+    db_tdma_server_get_table_info(&frame_us, &clients, &table_index);
+    if (frame_us < SIM_DEFAULT_FRAME_US) {
+        frame_us = SIM_DEFAULT_FRAME_US;
+    }
+    // In adaptive mode the consecutive slots of a DotBot all hold the duration of the group, count it once
+    uint64_t dotbot_us = 0;
+    uint64_t previous  = sim_nodes[SIM_GATEWAY].device_id;
+    for (uint16_t slot = 0; slot <= table_index; slot++) {
+        tdma_table_entry_t entry;
+        db_tdma_server_get_client_info(&entry, slot);
+        if (entry.client != sim_nodes[SIM_GATEWAY].device_id && entry.client != previous) {
+            dotbot_us += entry.tx_duration;
+        }
+        previous = entry.client;
+    }
+    _tdma_sim_vars.dotbot_slots_us += (double)SIM_SAMPLE_PERIOD_US * dotbot_us / frame_us;
+    _tdma_sim_vars.gateway_slots_us += (double)SIM_SAMPLE_PERIOD_US * (frame_us - dotbot_us) / frame_us;
+    _tdma_sim_vars.frame_us      = frame_us;
+    _tdma_sim_vars.table_slots   = table_index + 1;
+    _tdma_sim_vars.table_clients = clients;
+}
+
+static void _receive_message(uint8_t *packet, uint8_t length, bool downlink) {
+    const protocol_header_t *header = (const protocol_header_t *)packet;
+    if (length < sizeof(protocol_header_t) + SIM_APP_PAYLOAD_MIN || header->packet_type != DB_PACKET_DATA) {
+        return;
+    }
+
+    uint32_t number;
+    memcpy(&number, &packet[sizeof(protocol_header_t) + 1], sizeof(uint32_t));
+    if (number >= _tdma_sim_vars.message_count) {
+        return;
+    }
+    sim_message_t *message = &_tdma_sim_vars.messages[number];
+    if (downlink != (message->flow == SIM_FLOW_DOWNLINK_CONTROL) || (downlink && message->node != sim_node)) {
+        return;
+    }
+    if (message->delivered) {
+        _tdma_sim_vars.duplicates++;
+        return;
+    }
+    message->delivered = sim_cursor;
+}
+
+static void _gateway_callback(uint8_t *packet, uint8_t length) {
+    _receive_message(packet, length, false);
+}
+
+static void _dotbot_callback(uint8_t *packet, uint8_t length) {
+    _receive_message(packet, length, true);
+}
+
+static void _packet_hook(const sim_packet_t *packet, uint16_t receivers) {
+    (void)receivers;
+
+    sim_packets_t category = SIM_PACKETS_GATEWAY;
+    if (packet->sender != SIM_GATEWAY) {
+        category = _tdma_sim_vars.joined[packet->sender] ? SIM_PACKETS_DOTBOT : SIM_PACKETS_REGISTRATION;
+    }
+    _tdma_sim_vars.packets[category]++;
+    _tdma_sim_vars.airtime_us[category] += packet->end - packet->start;
+    if (packet->collided) {
+        _tdma_sim_vars.collided[category]++;
+    }
+    if (_interfered(packet->frequency)) {
+        _tdma_sim_vars.interfered++;
+    }
+
+    // Airtime of the acknowledgements, of the sequence numbers and of the packets sent again
+    const protocol_header_t *header  = (const protocol_header_t *)packet->data;
+    uint32_t                 byte_us = sim_airtime_us(packet->mode, 1) - sim_airtime_us(packet->mode, 0);
+    if (packet->length < sizeof(protocol_header_t) + sizeof(protocol_tdma_data_t)) {
+        return;
+    }
+    switch (header->packet_type) {
+        case DB_PACKET_TDMA_SYNC_FRAME:
+            // Channels the gateway hops over, the sync frames of the gateways that don't hop end before
+            if (packet->length >= sizeof(protocol_header_t) + sizeof(protocol_sync_frame_t)) {
+                protocol_sync_frame_t sync_frame;
+                uint64_t              channel_map = 0;
+                memcpy(&sync_frame, &packet->data[sizeof(protocol_header_t)], sizeof(protocol_sync_frame_t));
+                memcpy(&channel_map, sync_frame.channel_map, sizeof(sync_frame.channel_map));
+                _tdma_sim_vars.hop_seed      = sync_frame.hop_seed;
+                _tdma_sim_vars.channels_used = __builtin_popcountll(channel_map);
+                if (_tdma_sim_vars.min_channels_used == 0 || _tdma_sim_vars.channels_used < _tdma_sim_vars.min_channels_used) {
+                    _tdma_sim_vars.min_channels_used = _tdma_sim_vars.channels_used;
+                }
+            }
+            break;
+        case DB_PACKET_TDMA_ACK:
+            _tdma_sim_vars.ack_airtime_us += packet->end - packet->start;
+            break;
+        case DB_PACKET_TDMA_DATA:
+        {
+            protocol_tdma_data_t data;
+            memcpy(&data, &packet->data[sizeof(protocol_header_t)], sizeof(protocol_tdma_data_t));
+            if (data.retries > 0) {
+                _tdma_sim_vars.resent[category]++;
+                _tdma_sim_vars.ack_airtime_us += packet->end - packet->start;
+            } else {
+                _tdma_sim_vars.ack_airtime_us += sizeof(protocol_tdma_data_t) * byte_us;
+            }
+        } break;
+        case DB_PACKET_TDMA_AGGREGATE_ACKED:
+            for (size_t offset = sizeof(protocol_header_t); offset + sizeof(protocol_tdma_aggregate_record_t) + sizeof(protocol_tdma_data_t) <= packet->length;) {
+                protocol_tdma_aggregate_record_t record;
+                protocol_tdma_data_t             data;
+                memcpy(&record, &packet->data[offset], sizeof(protocol_tdma_aggregate_record_t));
+                memcpy(&data, &packet->data[offset + sizeof(protocol_tdma_aggregate_record_t)], sizeof(protocol_tdma_data_t));
+                if (data.retries > 0) {
+                    _tdma_sim_vars.resent[category]++;
+                    _tdma_sim_vars.ack_airtime_us += (sizeof(protocol_tdma_aggregate_record_t) + record.length) * byte_us;
+                } else {
+                    _tdma_sim_vars.ack_airtime_us += sizeof(protocol_tdma_data_t) * byte_us;
+                }
+                offset += sizeof(protocol_tdma_aggregate_record_t) + record.length;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static bool _receive_filter(uint16_t node, const sim_packet_t *packet, bool crc_ok) {
+    // The gateway counts the packets with an invalid CRC received during the join slots, the DotBots drop them
+    if (!crc_ok) {
+        return node == SIM_GATEWAY;
+    }
+
+    // Both TDMA drivers drop the packets for another address or firmware version
+    const protocol_header_t *header = (const protocol_header_t *)packet->data;
+    if (packet->length < sizeof(protocol_header_t) || header->version != DB_FIRMWARE_VERSION) {
+        return false;
+    }
+    if (header->dst != DB_BROADCAST_ADDRESS && header->dst != sim_nodes[node].device_id) {
+        return false;
+    }
+
+    // The DotBots only act on the packets of the gateway, the others go to the application, which ignores them
+    return node == SIM_GATEWAY || packet->sender == SIM_GATEWAY;
+}
+
+static int _compare_latencies(const void *a, const void *b) {
+    uint64_t la = *(const uint64_t *)a;
+    uint64_t lb = *(const uint64_t *)b;
+    return (la > lb) - (la < lb);
+}
+
+static void _flow_stats(sim_flow_t flow, sim_flow_stats_t *stats) {
+    memset(stats, 0, sizeof(sim_flow_stats_t));
+    uint64_t *latencies = malloc((_tdma_sim_vars.message_count + 1) * sizeof(uint64_t));
+    if (!latencies) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t number = 0; number < _tdma_sim_vars.message_count; number++) {
+        const sim_message_t *message = &_tdma_sim_vars.messages[number];
+        if (message->flow != flow || message->created + SIM_TAIL_US > _tdma_sim_vars.end) {
+            continue;
+        }
+        stats->sent++;
+        if (message->delivered) {
+            latencies[stats->delivered++] = message->delivered - message->created;
+            stats->bytes += _tdma_sim_vars.config.flows[flow].size;
+        }
+    }
+
+    if (stats->delivered > 0) {
+        qsort(latencies, stats->delivered, sizeof(uint64_t), &_compare_latencies);
+        stats->p50_ms = latencies[(stats->delivered - 1) * 50 / 100] / 1000.0;
+        stats->p90_ms = latencies[(stats->delivered - 1) * 90 / 100] / 1000.0;
+        stats->p99_ms = latencies[(stats->delivered - 1) * 99 / 100] / 1000.0;
+        stats->max_ms = latencies[stats->delivered - 1] / 1000.0;
+    }
+    free(latencies);
+}
+
+static void _report(void) {
+    const sim_config_t *config = &_tdma_sim_vars.config;
+
+    // Join times, and time from the first boot until the whole swarm joined
+    uint64_t *join_us    = malloc(SIM_MAX_NODES * sizeof(uint64_t));
+    uint16_t  joined     = 0;
+    uint64_t  first_boot = UINT64_MAX;
+    uint64_t  last_join  = 0;
+    for (uint16_t node = 1; node < sim_node_count; node++) {
+        first_boot = (_tdma_sim_vars.boot[node] < first_boot) ? _tdma_sim_vars.boot[node] : first_boot;
+        if (_tdma_sim_vars.joined[node]) {
+            join_us[joined++] = _tdma_sim_vars.joined[node] - _tdma_sim_vars.boot[node];
+            last_join         = (_tdma_sim_vars.joined[node] > last_join) ? _tdma_sim_vars.joined[node] : last_join;
+        }
+    }
+    qsort(join_us, joined, sizeof(uint64_t), &_compare_latencies);
+    double join_p50_ms = joined ? join_us[(joined - 1) / 2] / 1000.0 : NAN;
+    double join_p90_ms = joined ? join_us[(joined - 1) * 90 / 100] / 1000.0 : NAN;
+    double join_max_ms = joined ? join_us[joined - 1] / 1000.0 : NAN;
+    double join_all_ms = (joined == config->clients) ? (last_join - first_boot) / 1000.0 : NAN;
+    free(join_us);
+
+    // Slot utilization, the DotBots only count once they joined
+    double dotbot_use  = _tdma_sim_vars.dotbot_slots_us > 0 ? 100.0 * _tdma_sim_vars.airtime_us[SIM_PACKETS_DOTBOT] / _tdma_sim_vars.dotbot_slots_us : 0;
+    double gateway_use = _tdma_sim_vars.gateway_slots_us > 0 ? 100.0 * _tdma_sim_vars.airtime_us[SIM_PACKETS_GATEWAY] / _tdma_sim_vars.gateway_slots_us : 0;
+
+    // Share of time the radio of the DotBots is on, since they booted
+    double radio_on_us = 0;
+    double powered_us  = 0;
+    for (uint16_t node = 1; node < sim_node_count; node++) {
+        radio_on_us += sim_radio_on_us(node, _tdma_sim_vars.end);
+        powered_us += _tdma_sim_vars.end - _tdma_sim_vars.boot[node];
+    }
+    double radio_duty = powered_us > 0 ? 100.0 * radio_on_us / powered_us : 0;
+
+    sim_flow_stats_t flows[SIM_FLOW_COUNT];
+    for (uint8_t flow = 0; flow < SIM_FLOW_COUNT; flow++) {
+        _flow_stats(flow, &flows[flow]);
+    }
+    double measured_s = (double)(_tdma_sim_vars.end - SIM_TAIL_US) / 1e6;
+
+    // Share of the airtime of the registered DotBots and of the gateway used to acknowledge the data packets and send them again
+    uint64_t data_airtime_us = _tdma_sim_vars.airtime_us[SIM_PACKETS_DOTBOT] + _tdma_sim_vars.airtime_us[SIM_PACKETS_GATEWAY];
+    double   ack_airtime     = data_airtime_us > 0 ? 100.0 * _tdma_sim_vars.ack_airtime_us / data_airtime_us : 0;
+
+    // Application bytes delivered by all the flows, and share of the packets sent next to an interferer
+    uint64_t goodput_bytes = 0;
+    uint32_t packets       = 0;
+    for (uint8_t flow = 0; flow < SIM_FLOW_COUNT; flow++) {
+        goodput_bytes += flows[flow].bytes;
+    }
+    for (uint8_t category = 0; category < SIM_PACKETS_COUNT; category++) {
+        packets += _tdma_sim_vars.packets[category];
+    }
+    double interfered = packets > 0 ? 100.0 * _tdma_sim_vars.interfered / packets : 0;
+
+    if (config->csv) {
+        printf("clients,mode,duration_s,seed,joined,join_p50_ms,join_p90_ms,join_max_ms,join_all_ms,registration_packets,registration_collisions,frame_ms,dotbot_slot_use,gateway_slot_use,low_power,radio_duty");
+        for (uint8_t flow = 0; flow < SIM_FLOW_COUNT; flow++) {
+            printf(",f%u_sent,f%u_delivered,f%u_p50_ms,f%u_p90_ms,f%u_p99_ms,f%u_max_ms,f%u_bytes_per_s", flow, flow, flow, flow, flow, flow, flow);
+        }
+        printf(",loss_pct,dotbot_resent,gateway_resent,duplicates,ack_airtime,interferers,hopping,channels_used,min_channels_used,interfered_packets,goodput_bytes_per_s");
+        printf("\n%u,%s,%u,%lu,%u,%.1f,%.1f,%.1f,%.1f,%u,%u,%.1f,%.1f,%.1f,%u,%.2f",
+               config->clients, _mode_names[config->mode], config->duration_s, (unsigned long)config->seed, joined, join_p50_ms, join_p90_ms, join_max_ms, join_all_ms,
+               _tdma_sim_vars.packets[SIM_PACKETS_REGISTRATION], _tdma_sim_vars.collided[SIM_PACKETS_REGISTRATION],
+               _tdma_sim_vars.frame_us / 1000.0, dotbot_use, gateway_use, config->low_power, radio_duty);
+        for (uint8_t flow = 0; flow < SIM_FLOW_COUNT; flow++) {
+            printf(",%u,%u,%.1f,%.1f,%.1f,%.1f,%.0f", flows[flow].sent, flows[flow].delivered, flows[flow].p50_ms, flows[flow].p90_ms, flows[flow].p99_ms, flows[flow].max_ms, flows[flow].bytes / measured_s);
+        }
+        printf(",%.1f,%u,%u,%u,%.2f", config->loss_pct, _tdma_sim_vars.resent[SIM_PACKETS_DOTBOT], _tdma_sim_vars.resent[SIM_PACKETS_GATEWAY], _tdma_sim_vars.duplicates, ack_airtime);
+        printf(",%u,%u,%u,%u,%.1f,%.0f", config->interference_count, _tdma_sim_vars.hop_seed != 0, _tdma_sim_vars.channels_used, _tdma_sim_vars.min_channels_used, interfered, goodput_bytes / measured_s);
+        printf("\n");
+        return;
+    }
+
+    printf("%u DotBots, %s, %u s, drift up to %.0f ppm, %.1f%% packet loss, seed %lu\n", config->clients, _mode_names[config->mode], config->duration_s, config->drift_ppm, config->loss_pct, (unsigned long)config->seed);
+    printf("join:          %u/%u joined, time p50 %.1f ms, p90 %.1f ms, max %.1f ms, all joined %.1f ms after the first boot\n", joined, config->clients, join_p50_ms, join_p90_ms, join_max_ms, join_all_ms);
+    printf("registration:  %u packets, %u lost to collisions\n", _tdma_sim_vars.packets[SIM_PACKETS_REGISTRATION], _tdma_sim_vars.collided[SIM_PACKETS_REGISTRATION]);
+    printf("table:         %u clients in %u slots, frame %.1f ms\n", _tdma_sim_vars.table_clients, _tdma_sim_vars.table_slots, _tdma_sim_vars.frame_us / 1000.0);
+    printf("slots:         DotBots use %.1f%% of their slot time, gateway %.1f%%\n", dotbot_use, gateway_use);
+    printf("collisions:    %u of %u DotBot packets, %u of %u gateway packets\n",
+           _tdma_sim_vars.collided[SIM_PACKETS_DOTBOT], _tdma_sim_vars.packets[SIM_PACKETS_DOTBOT], _tdma_sim_vars.collided[SIM_PACKETS_GATEWAY], _tdma_sim_vars.packets[SIM_PACKETS_GATEWAY]);
+    printf("radio:         on %.2f%% of the time on the DotBots%s\n", radio_duty, config->low_power ? ", in low-power mode" : "");
+    printf("reliability:   %u DotBot and %u gateway packets sent again, %u duplicates delivered, acknowledgements and retransmissions use %.1f%% of the airtime\n",
+           _tdma_sim_vars.resent[SIM_PACKETS_DOTBOT], _tdma_sim_vars.resent[SIM_PACKETS_GATEWAY], _tdma_sim_vars.duplicates, ack_airtime);
+    if (_tdma_sim_vars.hop_seed != 0) {
+        printf("channels:      hopping over %u channels (fewest %u), %.1f%% of the packets sent next to %u interferers\n", _tdma_sim_vars.channels_used, _tdma_sim_vars.min_channels_used, interfered, config->interference_count);
+    } else {
+        printf("channels:      single frequency %u MHz above 2400 MHz, %.1f%% of the packets sent next to %u interferers\n", config->frequency, interfered, config->interference_count);
+    }
+    printf("goodput:       %.0f B/s of application data delivered\n", goodput_bytes / measured_s);
+    for (uint8_t flow = 0; flow < SIM_FLOW_COUNT; flow++) {
+        const sim_flow_stats_t *stats = &flows[flow];
+        if (config->flows[flow].period_ms == 0) {
+            continue;
+        }
+        printf("%-16s  delivered %u/%u (%.1f%%), latency p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms, %.0f B/s\n",
+               _flow_names[flow], stats->delivered, stats->sent, stats->sent ? 100.0 * stats->delivered / stats->sent : 0,
+               stats->p50_ms, stats->p90_ms, stats->p99_ms, stats->max_ms, stats->bytes / measured_s);
+    }
+}
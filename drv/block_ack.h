@@ -0,0 +1,74 @@
+#ifndef __BLOCK_ACK_H
+#define __BLOCK_ACK_H
+
+/**
+ * @defgroup    drv_block_ack    Block acknowledgement window
+ * @ingroup     drv
+ * @brief       Track the sequence numbers received on a link, and the ones a block acknowledgement covers
+ *
+ * The sender numbers the packets of a link with an 8-bit sequence number. The receiver keeps the last
+ * sequence number received and a bitmap of the packets received before it. The window both drops the
+ * retransmissions of the packets already received and fills the block acknowledgement sent back, from
+ * which the sender tells the packets received from the lost ones. The window doesn't depend on any
+ * peripheral, so it can be built and tested on a host computer.
+ *
+ * @{
+ * @file
+ * @copyright Inria, 2024
+ * @}
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//=========================== defines ==========================================
+
+#define DB_BLOCK_ACK_WINDOW 16  ///< Number of sequence numbers covered by a window, one bit each
+
+/// Receive window of a link, and content of the block acknowledgement that reports it
+typedef struct {
+    uint8_t  seq;     ///< sequence number of the last packet received
+    uint16_t bitmap;  ///< packets received, bit i for sequence number seq - i, 0 until a packet is received
+} db_block_ack_t;
+
+/// Fate of a packet sent, according to a block acknowledgement
+typedef enum {
+    DB_BLOCK_ACK_PENDING,  ///< the packet was sent after the last packet received, wait for the next acknowledgement
+    DB_BLOCK_ACK_ACKED,    ///< the packet was received
+    DB_BLOCK_ACK_LOST,     ///< a later packet was received but not this one
+} db_block_ack_status_t;
+
+//=========================== public ===========================================
+
+/**
+ * @brief   Initialize an empty window
+ *
+ * @param[out]  window      Pointer to the window
+ */
+void db_block_ack_init(db_block_ack_t *window);
+
+/**
+ * @brief   Add a packet received to the window
+ *
+ * The first transmission of a packet is never a duplicate: one with a sequence number already in the
+ * window means the sender restarted its sequence numbers, and the window starts over from it.
+ *
+ * @param[in,out]   window          Pointer to the window
+ * @param[in]       seq             Sequence number of the packet
+ * @param[in]       retransmission  true if the packet was sent before
+ *
+ * @return                          false if the packet is a duplicate, true otherwise
+ */
+bool db_block_ack_rx(db_block_ack_t *window, uint8_t seq, bool retransmission);
+
+/**
+ * @brief   Tell from a block acknowledgement if a packet sent was received
+ *
+ * @param[in]   ack     Pointer to the block acknowledgement
+ * @param[in]   seq     Sequence number of the packet
+ *
+ * @return              Fate of the packet, the packets older than the window are lost
+ */
+db_block_ack_status_t db_block_ack_status(const db_block_ack_t *ack, uint8_t seq);
+
+#endif
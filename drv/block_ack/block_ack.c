@@ -0,0 +1,59 @@
+/**
+ * @file
+ * @ingroup drv_block_ack
+ *
+ * @brief  Implementation of the block acknowledgement window, the sequence numbers received on a link.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "block_ack.h"
+
+//=========================== public ===========================================
+
+void db_block_ack_init(db_block_ack_t *window) {
+    window->seq    = 0;
+    window->bitmap = 0;
+}
+
+bool db_block_ack_rx(db_block_ack_t *window, uint8_t seq, bool retransmission) {
+
+    // Start over with the first packet, or with a new packet that isn't ahead of the window
+    int8_t ahead = (int8_t)(seq - window->seq);
+    if (window->bitmap == 0 || (ahead <= 0 && !retransmission)) {
+        window->seq    = seq;
+        window->bitmap = 1;
+        return true;
+    }
+
+    // Slide the window up to a newer packet
+    if (ahead > 0) {
+        window->bitmap = (ahead < DB_BLOCK_ACK_WINDOW) ? (uint16_t)(window->bitmap << ahead) | 1 : 1;
+        window->seq    = seq;
+        return true;
+    }
+
+    // A retransmission older than the window can't be told from a duplicate, let it through
+    uint8_t behind = -ahead;
+    if (behind >= DB_BLOCK_ACK_WINDOW) {
+        return true;
+    }
+    bool received = window->bitmap & (1 << behind);
+    window->bitmap |= 1 << behind;
+    return !received;
+}
+
+db_block_ack_status_t db_block_ack_status(const db_block_ack_t *ack, uint8_t seq) {
+
+    if (ack->bitmap == 0) {
+        return DB_BLOCK_ACK_PENDING;
+    }
+    uint8_t behind = ack->seq - seq;
+    if (behind < DB_BLOCK_ACK_WINDOW && (ack->bitmap & (1 << behind))) {
+        return DB_BLOCK_ACK_ACKED;
+    }
+    // Packets are numbered in sending order, those after the last one received are still on their way
+    return (behind < 128) ? DB_BLOCK_ACK_LOST : DB_BLOCK_ACK_PENDING;
+}
@@ -0,0 +1,67 @@
+#ifndef __CHANNEL_HOP_H
+#define __CHANNEL_HOP_H
+
+/**
+ * @defgroup    drv_channel_hop    Channel hopping sequence
+ * @ingroup     drv
+ * @brief       Pick the BLE data channel of each TDMA frame, out of the channels left after blacklisting
+ *
+ * The sequence follows the BLE channel selection algorithm #1: the channel of frame n is
+ * (start + n * increment) mod 37, where the start and the increment (between 5 and 16) come from a
+ * seed. A blacklisted channel is replaced by one of the channels used, picked from the same
+ * number, so that the frames on the other channels keep their channel when the blacklist changes.
+ * The sequence doesn't depend on any peripheral, so it can be built and tested on a host computer.
+ *
+ * @{
+ * @file
+ * @copyright Inria, 2024
+ * @}
+ */
+
+#include <stdint.h>
+
+//=========================== defines ==========================================
+
+#define DB_CHANNEL_HOP_CHANNELS 37                                            ///< Number of BLE data channels, the advertising channels are left out
+#define DB_CHANNEL_HOP_ALL      ((1ULL << DB_CHANNEL_HOP_CHANNELS) - 1)  ///< Channel map with all the data channels
+
+/// Channel hopping sequence, use the db_channel_hop_* functions to access it
+typedef struct {
+    uint64_t map;                             ///< channels used, bit i for BLE data channel i
+    uint8_t  seed;                            ///< seed of the sequence
+    uint8_t  start;                           ///< channel of frame 0, before blacklisting
+    uint8_t  increment;                       ///< channels skipped from one frame to the next, before blacklisting
+    uint8_t  used_count;                      ///< number of channels used
+    uint8_t  used[DB_CHANNEL_HOP_CHANNELS];  ///< channels used, in increasing order
+} db_channel_hop_t;
+
+//=========================== public ===========================================
+
+/**
+ * @brief   Initialize a sequence
+ *
+ * @param[out]  hop     Pointer to the sequence
+ * @param[in]   seed    Seed of the sequence, the gateways pick different seeds to hop differently
+ * @param[in]   map     Channels used, bit i for BLE data channel i
+ */
+void db_channel_hop_init(db_channel_hop_t *hop, uint8_t seed, uint64_t map);
+
+/**
+ * @brief   Change the channels used by a sequence
+ *
+ * @param[in,out]   hop     Pointer to the sequence
+ * @param[in]       map     Channels used, bit i for BLE data channel i, all of them if none is set
+ */
+void db_channel_hop_set_map(db_channel_hop_t *hop, uint64_t map);
+
+/**
+ * @brief   Get the channel of a frame
+ *
+ * @param[in]   hop     Pointer to the sequence
+ * @param[in]   frame   Number of the frame
+ *
+ * @return              BLE data channel of the frame, between 0 and 36
+ */
+uint8_t db_channel_hop_channel(const db_channel_hop_t *hop, uint16_t frame);
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * @file
+ * @ingroup drv_channel_hop
+ *
+ * @brief  Implementation of the channel hopping sequence of the TDMA frames.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <stdint.h>
+#include "channel_hop.h"
+
+//=========================== public ===========================================
+
+void db_channel_hop_init(db_channel_hop_t *hop, uint8_t seed, uint64_t map) {
+    hop->seed      = seed;
+    hop->start     = seed % DB_CHANNEL_HOP_CHANNELS;
+    hop->increment = 5 + (seed >> 4) % 12;
+    db_channel_hop_set_map(hop, map);
+}
+
+void db_channel_hop_set_map(db_channel_hop_t *hop, uint64_t map) {
+
+    // Without any channel left, hop over all of them
+    map &= DB_CHANNEL_HOP_ALL;
+    if (map == 0) {
+        map = DB_CHANNEL_HOP_ALL;
+    }
+
+    hop->map        = map;
+    hop->used_count = 0;
+    for (uint8_t channel = 0; channel < DB_CHANNEL_HOP_CHANNELS; channel++) {
+        if (map & (1ULL << channel)) {
+            hop->used[hop->used_count++] = channel;
+        }
+    }
+}
+
+uint8_t db_channel_hop_channel(const db_channel_hop_t *hop, uint16_t frame) {
+
+    // 37 is prime, so every increment visits all the channels once every 37 frames
+    uint8_t channel = (hop->start + (uint32_t)frame * hop->increment) % DB_CHANNEL_HOP_CHANNELS;
+    if (hop->map & (1ULL << channel)) {
+        return channel;
+    }
+    return hop->used[channel % hop->used_count];
+}
@@ -0,0 +1,94 @@
+#ifndef __CLOCK_DRIFT_H
+#define __CLOCK_DRIFT_H
+
+/**
+ * @defgroup    drv_clock_drift    Clock drift estimator
+ * @ingroup     drv
+ * @brief       Estimate the drift of the local clock against a remote clock
+ *
+ * Each sample pairs a timestamp of the remote clock with the local timestamp of the same event, for
+ * instance the reception of a TDMA sync frame. A least squares line fitted over the last samples
+ * gives the rate of the local clock relative to the remote one, so that remote times and durations
+ * can be converted to local ones between two samples. The estimator doesn't depend on any peripheral,
+ * so it can be built and tested on a host computer.
+ *
+ * @{
+ * @file
+ * @copyright Inria, 2024
+ * @}
+ */
+
+#include <stdint.h>
+
+//=========================== defines ==========================================
+
+#ifndef DB_CLOCK_DRIFT_SAMPLES
+#define DB_CLOCK_DRIFT_SAMPLES 8  ///< Number of samples the line is fitted over
+#endif
+
+#ifndef DB_CLOCK_DRIFT_MAX_PPB
+#define DB_CLOCK_DRIFT_MAX_PPB 500000  ///< Max drift accepted, in parts per billion, the crystals are specified for less than 50 ppm
+#endif
+
+#ifndef DB_CLOCK_DRIFT_MAX_ERROR_US
+#define DB_CLOCK_DRIFT_MAX_ERROR_US 1000  ///< A sample further than this from the fitted line means the remote clock restarted, the estimator starts over
+#endif
+
+/// Clock drift estimator, use the db_clock_drift_* functions to access it
+typedef struct {
+    uint32_t remote[DB_CLOCK_DRIFT_SAMPLES];  ///< remote timestamps of the samples
+    uint32_t local[DB_CLOCK_DRIFT_SAMPLES];   ///< local timestamps of the samples
+    uint8_t  count;                           ///< number of samples stored
+    uint8_t  newest;                          ///< index of the newest sample
+    int32_t  drift_ppb;                       ///< rate of the local clock minus rate of the remote clock, in parts per billion
+    int32_t  offset_us;                       ///< fitted local time of the newest sample, relative to its local timestamp
+} db_clock_drift_t;
+
+//=========================== public ===========================================
+
+/**
+ * @brief   Initialize an estimator without samples, it assumes both clocks run at the same rate
+ *
+ * @param[out]  drift   Pointer to the estimator
+ */
+void db_clock_drift_init(db_clock_drift_t *drift);
+
+/**
+ * @brief   Add a sample and fit the line again
+ *
+ * @param[in,out]   drift       Pointer to the estimator
+ * @param[in]       remote_ts   Timestamp of the event on the remote clock, in microseconds
+ * @param[in]       local_ts    Timestamp of the event on the local clock, in microseconds
+ */
+void db_clock_drift_add(db_clock_drift_t *drift, uint32_t remote_ts, uint32_t local_ts);
+
+/**
+ * @brief   Convert a time of the remote clock to the local clock
+ *
+ * @param[in]   drift       Pointer to the estimator, with at least one sample
+ * @param[in]   remote_ts   Time on the remote clock, in microseconds
+ *
+ * @return                  Time on the local clock, in microseconds
+ */
+uint32_t db_clock_drift_local_time(const db_clock_drift_t *drift, uint32_t remote_ts);
+
+/**
+ * @brief   Convert a duration measured by the remote clock to the local clock
+ *
+ * @param[in]   drift       Pointer to the estimator
+ * @param[in]   duration_us Duration on the remote clock, in microseconds
+ *
+ * @return                  Duration on the local clock, in microseconds
+ */
+uint32_t db_clock_drift_local_duration(const db_clock_drift_t *drift, uint32_t duration_us);
+
+/**
+ * @brief   Return the drift of the local clock
+ *
+ * @param[in]   drift   Pointer to the estimator
+ *
+ * @return              Rate of the local clock minus rate of the remote clock, in parts per billion
+ */
+int32_t db_clock_drift_get_ppb(const db_clock_drift_t *drift);
+
+#endif
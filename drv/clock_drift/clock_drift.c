@@ -0,0 +1,126 @@
+/**
+ * @file
+ * @ingroup drv_clock_drift
+ *
+ * @brief  Implementation of the clock drift estimator, a least squares line fitted over the last timestamps of a remote clock.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <stdint.h>
+#include "clock_drift.h"
+
+//=========================== defines ==========================================
+
+#define CLOCK_DRIFT_PPB        1000000000LL  ///< Parts per billion in one
+#define CLOCK_DRIFT_MAX_AGE_US (1L << 26)    ///< Samples older than this (about a minute) are left out of the fit, so that the sums can't overflow
+#define CLOCK_DRIFT_MIN_SPREAD 1000000LL     ///< Min spread of the remote timestamps to fit a slope (two samples a millisecond apart)
+
+//=========================== prototypes =======================================
+
+/**
+ * @brief   Divide, rounding to the nearest integer
+ *
+ * @param[in]   numerator      Numerator, positive or negative
+ * @param[in]   denominator    Denominator, positive
+ *
+ * @return                     Rounded quotient
+ */
+static int64_t _div_round(int64_t numerator, int64_t denominator);
+
+/**
+ * @brief   Fit the line over the samples stored, relative to the newest one
+ *
+ * @param[in,out]   drift   Pointer to the estimator
+ */
+static void _fit(db_clock_drift_t *drift);
+
+//=========================== public ===========================================
+
+void db_clock_drift_init(db_clock_drift_t *drift) {
+    drift->count     = 0;
+    drift->newest    = 0;
+    drift->drift_ppb = 0;
+    drift->offset_us = 0;
+}
+
+void db_clock_drift_add(db_clock_drift_t *drift, uint32_t remote_ts, uint32_t local_ts) {
+
+    // Start over if the sample doesn't fit the line, the remote clock restarted or too much time passed
+    if (drift->count > 0) {
+        int32_t error = (int32_t)(local_ts - db_clock_drift_local_time(drift, remote_ts));
+        if (error > DB_CLOCK_DRIFT_MAX_ERROR_US || error < -DB_CLOCK_DRIFT_MAX_ERROR_US) {
+            db_clock_drift_init(drift);
+        }
+    }
+
+    // Overwrite the oldest sample once all are used
+    drift->newest                = (drift->count == 0) ? 0 : (drift->newest + 1) % DB_CLOCK_DRIFT_SAMPLES;
+    drift->remote[drift->newest] = remote_ts;
+    drift->local[drift->newest]  = local_ts;
+    if (drift->count < DB_CLOCK_DRIFT_SAMPLES) {
+        drift->count++;
+    }
+
+    _fit(drift);
+}
+
+uint32_t db_clock_drift_local_time(const db_clock_drift_t *drift, uint32_t remote_ts) {
+    int32_t elapsed = (int32_t)(remote_ts - drift->remote[drift->newest]);
+    return drift->local[drift->newest] + drift->offset_us + elapsed + (int32_t)_div_round((int64_t)elapsed * drift->drift_ppb, CLOCK_DRIFT_PPB);
+}
+
+uint32_t db_clock_drift_local_duration(const db_clock_drift_t *drift, uint32_t duration_us) {
+    return duration_us + (int32_t)_div_round((int64_t)duration_us * drift->drift_ppb, CLOCK_DRIFT_PPB);
+}
+
+int32_t db_clock_drift_get_ppb(const db_clock_drift_t *drift) {
+    return drift->drift_ppb;
+}
+
+//=========================== private ==========================================
+
+static int64_t _div_round(int64_t numerator, int64_t denominator) {
+    if (numerator < 0) {
+        return -((-numerator + denominator / 2) / denominator);
+    }
+    return (numerator + denominator / 2) / denominator;
+}
+
+static void _fit(db_clock_drift_t *drift) {
+
+    // x is the remote time and y the local time minus the remote time, both relative to the newest sample,
+    // so that the values stay small and the slope of y is the drift
+    int64_t n   = 0;
+    int64_t sx  = 0;
+    int64_t sy  = 0;
+    int64_t sxx = 0;
+    int64_t sxy = 0;
+    for (uint8_t index = 0; index < drift->count; index++) {
+        int32_t x = (int32_t)(drift->remote[index] - drift->remote[drift->newest]);
+        if (x < -CLOCK_DRIFT_MAX_AGE_US) {
+            continue;
+        }
+        int32_t y = (int32_t)(drift->local[index] - drift->local[drift->newest]) - x;
+        n++;
+        sx += x;
+        sy += y;
+        sxx += (int64_t)x * x;
+        sxy += (int64_t)x * y;
+    }
+
+    // The slope is unknown until the samples span some time, keep the previous one meanwhile
+    int64_t spread = n * sxx - sx * sx;
+    if (spread >= CLOCK_DRIFT_MIN_SPREAD) {
+        int64_t drift_ppb = _div_round((n * sxy - sx * sy) * 1000, spread / 1000000);
+        if (drift_ppb > DB_CLOCK_DRIFT_MAX_PPB) {
+            drift_ppb = DB_CLOCK_DRIFT_MAX_PPB;
+        } else if (drift_ppb < -DB_CLOCK_DRIFT_MAX_PPB) {
+            drift_ppb = -DB_CLOCK_DRIFT_MAX_PPB;
+        }
+        drift->drift_ppb = (int32_t)drift_ppb;
+    }
+
+    // The line goes through the mean of the samples, this averages the jitter of the timestamps
+    drift->offset_us = (int32_t)_div_round(sy - _div_round(sx * drift->drift_ppb, CLOCK_DRIFT_PPB), n);
+}
@@ -0,0 +1,91 @@
+#ifndef __LH2_POSITION_H
+#define __LH2_POSITION_H
+
+/**
+ * @defgroup    drv_lh2_position    LH2 planar position solver
+ * @ingroup     drv
+ * @brief       Compute a planar position from LH2 sweeps, using a calibration homography per basestation
+ *
+ * The cost of a position fix is fixed: a few trigonometric functions and a 3x3 projection per basestation,
+ * without any iteration. The solver only relies on the LH2 data structures, so it can be built and tested
+ * on a host computer against recorded counts.
+ *
+ * @{
+ * @file
+ * @copyright Inria, 2024
+ * @}
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lh2.h"
+
+//=========================== defines ==========================================
+
+#define DB_LH2_POSITION_MAX_SWEEP_GAP_US (20000U)  ///< Max time between the 2 sweeps used in a position fix, one rotation of the basestation
+
+/// LH2 camera point, position of the DotBot in the projection plane of a basestation
+typedef struct {
+    float x;  ///< Horizontal coordinate
+    float y;  ///< Vertical coordinate
+} db_lh2_camera_point_t;
+
+/// LH2 planar position
+typedef struct {
+    float    x;             ///< X coordinate, in the unit of the calibration homographies
+    float    y;             ///< Y coordinate, in the unit of the calibration homographies
+    uint32_t timestamp;     ///< Timestamp of the most recent sweep used, in microseconds
+    uint8_t  basestations;  ///< Number of basestations averaged in this position
+} db_lh2_position_t;
+
+//=========================== public ===========================================
+
+/**
+ * @brief   Set the calibration homography of a basestation
+ *
+ * The homography maps the camera points of the basestation to the plane the DotBot moves on.
+ *
+ * @param[in]   basestation     Index of the basestation (channel - 1)
+ * @param[in]   homography      3x3 homography matrix, row major
+ */
+void db_lh2_position_set_homography(uint8_t basestation, const float homography[3][3]);
+
+/**
+ * @brief   Forget the calibration homography of all basestations
+ */
+void db_lh2_position_clear_homographies(void);
+
+/**
+ * @brief   Convert the LFSR counts of both sweeps of a basestation into a camera point
+ *
+ * @param[in]   polynomial      Polynomial the counts belong to
+ * @param[in]   count1          LFSR count of the first sweep
+ * @param[in]   count2          LFSR count of the second sweep
+ * @param[out]  point           Pointer to the computed camera point
+ */
+void db_lh2_position_camera_point(uint8_t polynomial, uint32_t count1, uint32_t count2, db_lh2_camera_point_t *point);
+
+/**
+ * @brief   Project a camera point on the plane of a calibrated basestation
+ *
+ * @param[in]   basestation     Index of the basestation
+ * @param[in]   point           Pointer to the camera point
+ * @param[out]  position        Pointer to the projected position
+ *
+ * @return                      false if the basestation is not calibrated or the point projects to infinity
+ */
+bool db_lh2_position_project(uint8_t basestation, const db_lh2_camera_point_t *point, db_lh2_position_t *position);
+
+/**
+ * @brief   Compute a position from the sweeps not used yet by a previous fix
+ *
+ * Each calibrated basestation with both sweeps available contributes, and the contributions are averaged.
+ *
+ * @param[in]   lh2             Pointer to the lh2 instance
+ * @param[out]  position        Pointer to the computed position
+ *
+ * @return                      true if a new position was computed
+ */
+bool db_lh2_position_update(const db_lh2_t *lh2, db_lh2_position_t *position);
+
+#endif
@@ -0,0 +1,147 @@
+/**
+ * @file
+ * @ingroup drv_lh2_position
+ *
+ * @brief  Implementation of the LH2 planar position solver.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "lh2.h"
+#include "lh2_position.h"
+
+//=========================== defines ==========================================
+
+#define LH2_POSITION_LFSR_PERIOD    (131071U)     ///< Period of the LH2 LFSRs, larger counts are errors
+#define LH2_POSITION_LFSR_TICKS     (8U)          ///< Number of 48MHz basestation ticks per LFSR bit
+#define LH2_POSITION_SWEEP_ANGLE    (M_PI / 3)    ///< Angle between the 2 tilted laser planes of a basestation
+#define LH2_POSITION_TAN_HALF_SWEEP (0.5773503f)  ///< tan(pi / 6), tilt of the laser planes
+#define LH2_POSITION_MIN_W          (1e-6f)       ///< Smallest homogeneous coordinate accepted when projecting
+
+typedef struct {
+    float    homographies[LH2_BASESTATION_COUNT][3][3];  ///< Calibration homography of each basestation
+    bool     calibrated[LH2_BASESTATION_COUNT];          ///< Whether the homography of a basestation is set
+    uint32_t timestamps[LH2_BASESTATION_COUNT];          ///< Timestamp of the most recent sweep already used by a fix
+} lh2_position_vars_t;
+
+//=========================== variables ========================================
+
+/// Rotation period of the basestations, in 48MHz ticks, indexed by channel - 1
+static const uint32_t _basestation_periods[16] = {
+    959000,
+    957000,
+    953000,
+    949000,
+    947000,
+    943000,
+    941000,
+    939000,
+    937000,
+    929000,
+    919000,
+    911000,
+    907000,
+    901000,
+    893000,
+    887000,
+};
+
+static lh2_position_vars_t _lh2_position_vars = { 0 };
+
+//=========================== public ===========================================
+
+void db_lh2_position_set_homography(uint8_t basestation, const float homography[3][3]) {
+    if (basestation >= LH2_BASESTATION_COUNT) {
+        return;
+    }
+    memcpy(_lh2_position_vars.homographies[basestation], homography, sizeof(_lh2_position_vars.homographies[basestation]));
+    _lh2_position_vars.calibrated[basestation] = true;
+}
+
+void db_lh2_position_clear_homographies(void) {
+    memset(&_lh2_position_vars, 0, sizeof(lh2_position_vars_t));
+}
+
+void db_lh2_position_camera_point(uint8_t polynomial, uint32_t count1, uint32_t count2, db_lh2_camera_point_t *point) {
+    // Angles of the rotor when each laser plane hit the photodiode
+    float radians_per_count = (float)(2 * M_PI * LH2_POSITION_LFSR_TICKS) / (float)_basestation_periods[polynomial >> 1];
+    float a1                = (float)count1 * radians_per_count;
+    float a2                = (float)count2 * radians_per_count;
+
+    // The azimuth is in the middle of the 2 hits, the elevation depends on the gap between them
+    float gap = (count1 < count2) ? (a2 - a1) : (a1 - a2);
+    point->x  = -tanf(0.5f * (a1 + a2));
+    point->y  = -sinf(0.5f * gap - (float)LH2_POSITION_SWEEP_ANGLE) / LH2_POSITION_TAN_HALF_SWEEP;
+}
+
+bool db_lh2_position_project(uint8_t basestation, const db_lh2_camera_point_t *point, db_lh2_position_t *position) {
+    if (basestation >= LH2_BASESTATION_COUNT || !_lh2_position_vars.calibrated[basestation]) {
+        return false;
+    }
+
+    const float(*h)[3] = _lh2_position_vars.homographies[basestation];
+    float w            = h[2][0] * point->x + h[2][1] * point->y + h[2][2];
+    if (fabsf(w) < LH2_POSITION_MIN_W) {
+        return false;
+    }
+    position->x = (h[0][0] * point->x + h[0][1] * point->y + h[0][2]) / w;
+    position->y = (h[1][0] * point->x + h[1][1] * point->y + h[1][2]) / w;
+    return true;
+}
+
+bool db_lh2_position_update(const db_lh2_t *lh2, db_lh2_position_t *position) {
+    db_lh2_position_t result = { 0 };
+
+    for (uint8_t basestation = 0; basestation < LH2_BASESTATION_COUNT; basestation++) {
+        if (!_lh2_position_vars.calibrated[basestation]) {
+            continue;
+        }
+        if (lh2->data_ready[0][basestation] != DB_LH2_PROCESSED_DATA_AVAILABLE || lh2->data_ready[1][basestation] != DB_LH2_PROCESSED_DATA_AVAILABLE) {
+            continue;
+        }
+
+        // Only use sweeps of the same rotation, with at least one of them not used by a previous fix
+        uint32_t ts0    = lh2->timestamps[0][basestation];
+        uint32_t ts1    = lh2->timestamps[1][basestation];
+        uint32_t latest = ((int32_t)(ts1 - ts0) > 0) ? ts1 : ts0;
+        uint32_t gap    = (latest == ts1) ? ts1 - ts0 : ts0 - ts1;
+        if (gap > DB_LH2_POSITION_MAX_SWEEP_GAP_US || latest == _lh2_position_vars.timestamps[basestation]) {
+            continue;
+        }
+
+        const db_lh2_location_t *sweep0 = &lh2->locations[0][basestation];
+        const db_lh2_location_t *sweep1 = &lh2->locations[1][basestation];
+        if (sweep0->selected_polynomial >= LH2_POLYNOMIAL_COUNT || sweep0->lfsr_location >= LH2_POSITION_LFSR_PERIOD || sweep1->lfsr_location >= LH2_POSITION_LFSR_PERIOD) {
+            continue;
+        }
+
+        db_lh2_camera_point_t point;
+        db_lh2_position_t     projected;
+        db_lh2_position_camera_point(sweep0->selected_polynomial, sweep0->lfsr_location, sweep1->lfsr_location, &point);
+        if (!db_lh2_position_project(basestation, &point, &projected)) {
+            continue;
+        }
+
+        _lh2_position_vars.timestamps[basestation] = latest;
+        result.x += projected.x;
+        result.y += projected.y;
+        if (result.basestations == 0 || (int32_t)(latest - result.timestamp) > 0) {
+            result.timestamp = latest;
+        }
+        result.basestations++;
+    }
+
+    if (result.basestations == 0) {
+        return false;
+    }
+
+    position->x            = result.x / result.basestations;
+    position->y            = result.y / result.basestations;
+    position->timestamp    = result.timestamp;
+    position->basestations = result.basestations;
+    return true;
+}
@@ -0,0 +1,112 @@
+#ifndef __PACKET_QUEUE_H
+#define __PACKET_QUEUE_H
+
+/**
+ * @defgroup    drv_packet_queue    Packet queue
+ * @ingroup     drv
+ * @brief       FIFO of variable length packets stored in a byte ring
+ *
+ * Each packet is stored as its length (1 byte) followed by its bytes, so a queue holds many short
+ * packets or a few long ones. When a new packet doesn't fit, the oldest packets are dropped to make
+ * room for it, and the drops are counted. The queue doesn't depend on any peripheral, so it can be
+ * built and tested on a host computer.
+ *
+ * The queue doesn't lock itself. A push updates the read side too when it drops packets, so when the
+ * packets are popped from an interrupt, the code pushing them or clearing the queue from thread mode
+ * masks that interrupt meanwhile.
+ *
+ * @{
+ * @file
+ * @copyright Inria, 2024
+ * @}
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//=========================== defines ==========================================
+
+/// Packet queue, use the db_packet_queue_* functions to access it
+typedef struct {
+    uint8_t *buffer;           ///< byte ring storing the packets, each one prefixed with its length
+    uint16_t size;             ///< size of the byte ring
+    uint16_t read_index;       ///< position of the oldest packet in the byte ring
+    uint16_t used;             ///< number of bytes used, length prefixes included
+    uint16_t count;            ///< number of packets in the queue
+    uint16_t high_water_mark;  ///< largest number of bytes used since the queue was initialized
+    uint32_t dropped;          ///< number of packets dropped because the queue was full
+} db_packet_queue_t;
+
+/// Packet queue statistics
+typedef struct __attribute__((packed)) {
+    uint16_t count;            ///< number of packets waiting in the queue
+    uint16_t used;             ///< number of bytes used, length prefixes included
+    uint16_t size;             ///< size of the queue, in bytes
+    uint16_t high_water_mark;  ///< largest number of bytes used since the queue was initialized
+    uint32_t dropped;          ///< number of packets dropped because the queue was full
+} db_packet_queue_stats_t;
+
+//=========================== public ===========================================
+
+/**
+ * @brief   Initialize an empty queue and clear its statistics
+ *
+ * @param[out]  queue       Pointer to the queue
+ * @param[in]   buffer      Bytes array where the packets are stored
+ * @param[in]   size        Size of the bytes array, at least 256 so that any packet fits
+ */
+void db_packet_queue_init(db_packet_queue_t *queue, uint8_t *buffer, uint16_t size);
+
+/**
+ * @brief   Remove all the packets of a queue, its statistics are kept
+ *
+ * @param[in,out]   queue   Pointer to the queue
+ */
+void db_packet_queue_clear(db_packet_queue_t *queue);
+
+/**
+ * @brief   Add a packet at the end of a queue, dropping the oldest packets if there is not enough room
+ *
+ * @param[in,out]   queue   Pointer to the queue
+ * @param[in]       packet  Bytes of the packet
+ * @param[in]       length  Length of the packet, empty packets are ignored
+ *
+ * @return                  false if older packets were dropped, true otherwise
+ */
+bool db_packet_queue_push(db_packet_queue_t *queue, const uint8_t *packet, uint8_t length);
+
+/**
+ * @brief   Return the length of the oldest packet of a queue
+ *
+ * @param[in]   queue   Pointer to the queue
+ *
+ * @return              Length of the oldest packet, 0 if the queue is empty
+ */
+uint8_t db_packet_queue_front_length(const db_packet_queue_t *queue);
+
+/**
+ * @brief   Copy the oldest packet of a queue, without removing it
+ *
+ * @param[in]   queue   Pointer to the queue
+ * @param[out]  packet  Bytes array where the packet is copied, at least as long as the packet
+ *
+ * @return              Length of the packet, 0 if the queue is empty
+ */
+uint8_t db_packet_queue_peek(const db_packet_queue_t *queue, uint8_t *packet);
+
+/**
+ * @brief   Remove the oldest packet of a queue
+ *
+ * @param[in,out]   queue   Pointer to the queue
+ */
+void db_packet_queue_pop(db_packet_queue_t *queue);
+
+/**
+ * @brief   Read the statistics of a queue
+ *
+ * @param[in]   queue   Pointer to the queue
+ * @param[out]  stats   Pointer to the statistics to fill
+ */
+void db_packet_queue_get_stats(const db_packet_queue_t *queue, db_packet_queue_stats_t *stats);
+
+#endif
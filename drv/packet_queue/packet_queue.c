@@ -0,0 +1,133 @@
+/**
+ * @file
+ * @ingroup drv_packet_queue
+ *
+ * @brief  Implementation of the packet queue, a FIFO of variable length packets stored in a byte ring.
+ *
+ * @copyright Inria, 2024
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "packet_queue.h"
+
+//=========================== prototypes =======================================
+
+/**
+ * @brief   Copy bytes out of the byte ring, wrapping around its end
+ *
+ * @param[in]   queue   Pointer to the queue
+ * @param[in]   index   Position of the first byte to copy
+ * @param[out]  data    Bytes array to copy to
+ * @param[in]   length  Number of bytes to copy
+ */
+static void _ring_read(const db_packet_queue_t *queue, uint16_t index, uint8_t *data, uint16_t length);
+
+/**
+ * @brief   Copy bytes in the byte ring, wrapping around its end
+ *
+ * @param[in,out]   queue   Pointer to the queue
+ * @param[in]       index   Position where the first byte is copied
+ * @param[in]       data    Bytes array to copy from
+ * @param[in]       length  Number of bytes to copy
+ */
+static void _ring_write(db_packet_queue_t *queue, uint16_t index, const uint8_t *data, uint16_t length);
+
+//=========================== public ===========================================
+
+void db_packet_queue_init(db_packet_queue_t *queue, uint8_t *buffer, uint16_t size) {
+    queue->buffer          = buffer;
+    queue->size            = size;
+    queue->high_water_mark = 0;
+    queue->dropped         = 0;
+    db_packet_queue_clear(queue);
+}
+
+void db_packet_queue_clear(db_packet_queue_t *queue) {
+    queue->read_index = 0;
+    queue->used       = 0;
+    queue->count      = 0;
+}
+
+bool db_packet_queue_push(db_packet_queue_t *queue, const uint8_t *packet, uint8_t length) {
+    if (length == 0 || length >= queue->size) {
+        return true;
+    }
+
+    // Make room for the packet and its length prefix by dropping the oldest packets
+    bool dropped = false;
+    while (queue->used + 1 + length > queue->size) {
+        db_packet_queue_pop(queue);
+        queue->dropped++;
+        dropped = true;
+    }
+
+    uint16_t write_index = (queue->read_index + queue->used) % queue->size;
+    _ring_write(queue, write_index, &length, 1);
+    _ring_write(queue, (write_index + 1) % queue->size, packet, length);
+    queue->used += 1 + length;
+    queue->count++;
+
+    if (queue->used > queue->high_water_mark) {
+        queue->high_water_mark = queue->used;
+    }
+
+    return !dropped;
+}
+
+uint8_t db_packet_queue_front_length(const db_packet_queue_t *queue) {
+    if (queue->count == 0) {
+        return 0;
+    }
+    return queue->buffer[queue->read_index];
+}
+
+uint8_t db_packet_queue_peek(const db_packet_queue_t *queue, uint8_t *packet) {
+    uint8_t length = db_packet_queue_front_length(queue);
+    if (length > 0) {
+        _ring_read(queue, (queue->read_index + 1) % queue->size, packet, length);
+    }
+    return length;
+}
+
+void db_packet_queue_pop(db_packet_queue_t *queue) {
+    if (queue->count == 0) {
+        return;
+    }
+
+    uint16_t length   = 1 + queue->buffer[queue->read_index];
+    queue->read_index = (queue->read_index + length) % queue->size;
+    queue->used -= length;
+    queue->count--;
+}
+
+void db_packet_queue_get_stats(const db_packet_queue_t *queue, db_packet_queue_stats_t *stats) {
+    stats->count           = queue->count;
+    stats->used            = queue->used;
+    stats->size            = queue->size;
+    stats->high_water_mark = queue->high_water_mark;
+    stats->dropped         = queue->dropped;
+}
+
+//=========================== private ==========================================
+
+static void _ring_read(const db_packet_queue_t *queue, uint16_t index, uint8_t *data, uint16_t length) {
+    uint16_t first = queue->size - index;
+    if (length <= first) {
+        memcpy(data, &queue->buffer[index], length);
+    } else {
+        memcpy(data, &queue->buffer[index], first);
+        memcpy(data + first, queue->buffer, length - first);
+    }
+}
+
+static void _ring_write(db_packet_queue_t *queue, uint16_t index, const uint8_t *data, uint16_t length) {
+    uint16_t first = queue->size - index;
+    if (length <= first) {
+        memcpy(&queue->buffer[index], data, length);
+    } else {
+        memcpy(&queue->buffer[index], data, first);
+        memcpy(queue->buffer, data + first, length - first);
+    }
+}
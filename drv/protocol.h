@@ -15,6 +15,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 //=========================== defines ==========================================
 
@@ -24,6 +25,10 @@
 #define DB_GATEWAY_ADDRESS   0x0000000000000000UL  ///< Gateway address
 #define DB_MAX_WAYPOINTS     (16)                  ///< Max number of waypoints
 
+#define DB_PROTOCOL_TDMA_FLAG_LOW_POWER  (1 << 0)  ///< TDMA client only listening during the first slot of the frame and its downlink slot
+#define DB_PROTOCOL_TDMA_FLAG_AGGREGATE  (1 << 1)  ///< TDMA client receiving the data packets aggregated in DB_PACKET_TDMA_AGGREGATE frames
+#define DB_PROTOCOL_TDMA_FLAG_NEXT_TABLE (1 << 2)  ///< TDMA table of the next layout of the slots, the client switches to it at the frame announced by the sync frames
+
 /// Command type
 typedef enum {
     DB_PROTOCOL_CMD_MOVE_RAW       = 0,   ///< Move raw command type
@@ -39,18 +44,25 @@ typedef enum {
     DB_PROTOCOL_SAILBOT_DATA       = 10,  ///< SailBot specific data (for now GPS and direction)
     DB_PROTOCOL_CMD_XGO_ACTION     = 11,  ///< XGO action command
     DB_PROTOCOL_LH2_PROCESSED_DATA = 12,  ///< Lighthouse 2 data processed at the DotBot
+    DB_PROTOCOL_LH2_HOMOGRAPHY     = 13,  ///< Lighthouse 2 calibration homography of a basestation
+    DB_PROTOCOL_LH2_STATS          = 14,  ///< Lighthouse 2 pipeline profiling statistics, requested by the gateway, answered with one message per stage
 } protocol_data_type_t;
 
 /// Protocol packet type
 typedef enum {
-    DB_PACKET_BEACON            = 1,  ///< Beacon packet
-    DB_PACKET_JOIN_REQUEST      = 2,  ///< Join request packet
-    DB_PACKET_JOIN_RESPONSE     = 3,  ///< Join response packet
-    DB_PACKET_LEAVE             = 4,  ///< Leave packet
-    DB_PACKET_DATA              = 5,  ///< Data packet
-    DB_PACKET_TDMA_UPDATE_TABLE = 6,  ///< TDMA table update packet
-    DB_PACKET_TDMA_SYNC_FRAME   = 7,  ///< TDMA sync frame packet
-    DB_PACKET_TDMA_KEEP_ALIVE   = 8,  ///< TDMA keep alive packet
+    DB_PACKET_BEACON               = 1,   ///< Beacon packet
+    DB_PACKET_JOIN_REQUEST         = 2,   ///< Join request packet
+    DB_PACKET_JOIN_RESPONSE        = 3,   ///< Join response packet
+    DB_PACKET_LEAVE                = 4,   ///< Leave packet
+    DB_PACKET_DATA                 = 5,   ///< Data packet
+    DB_PACKET_TDMA_UPDATE_TABLE    = 6,   ///< TDMA table update packet
+    DB_PACKET_TDMA_SYNC_FRAME      = 7,   ///< TDMA sync frame packet
+    DB_PACKET_TDMA_KEEP_ALIVE      = 8,   ///< TDMA keep alive packet
+    DB_PACKET_TDMA_DEMAND          = 9,   ///< TDMA demand report, sent by a client that could not empty its queue during its slot
+    DB_PACKET_TDMA_AGGREGATE       = 10,  ///< TDMA aggregated downlink, data packets for several clients in a single radio frame
+    DB_PACKET_TDMA_DATA            = 11,  ///< TDMA acknowledged data packet, the payload of a data packet follows a protocol_tdma_data_t
+    DB_PACKET_TDMA_ACK             = 12,  ///< TDMA block acknowledgements of the acknowledged data packets received, one record per link
+    DB_PACKET_TDMA_AGGREGATE_ACKED = 13,  ///< TDMA aggregated downlink of acknowledged data packets, each record payload starts with a protocol_tdma_data_t
 } packet_type_t;
 
 /// Application type
@@ -68,6 +80,14 @@ typedef enum {
     ControlAuto   = 1,  ///< Automatic mode
 } protocol_control_mode_t;
 
+/// Traffic class of a packet, the TDMA queues send the packets of a class before those of the following ones
+typedef enum {
+    DB_PROTOCOL_PRIORITY_CONTROL   = 0,  ///< TDMA management packets and commands changing how a robot moves
+    DB_PROTOCOL_PRIORITY_TELEMETRY = 1,  ///< Periodic state of a robot (advertisement, location, direction...)
+    DB_PROTOCOL_PRIORITY_BULK      = 2,  ///< Large or bursty data (LH2 raw data, calibration, statistics...)
+    DB_PROTOCOL_PRIORITY_COUNT     = 3,  ///< Number of traffic classes
+} protocol_priority_t;
+
 /// DotBot protocol header
 typedef struct __attribute__((packed)) {
     uint8_t       version;      ///< Version of the firmware
@@ -123,6 +143,12 @@ typedef struct __attribute__((packed)) {
     uint32_t timestamp_us;         ///< How many microseconds passed since the sample was taken
 } protocol_lh2_processed_packet_t;
 
+/// DotBot protocol LH2 calibration homography, maps the camera points of a basestation to the LH2 location plane
+typedef struct __attribute__((packed)) {
+    uint8_t basestation;   ///< Index of the basestation (channel - 1)
+    float   matrix[3][3];  ///< Homography matrix, row major, the computed coordinates are the location coordinates divided by 1e6
+} protocol_lh2_homography_t;
+
 /// DotBot protocol TDMA table update [all units are in microseconds]
 typedef struct __attribute__((packed)) {
     uint32_t frame_period;       ///< duration of a full TDMA frame
@@ -131,13 +157,55 @@ typedef struct __attribute__((packed)) {
     uint32_t tx_start;           ///< start of slot for transmission
     uint16_t tx_duration;        ///< duration of the TX period
     uint32_t next_period_start;  ///< time until the start of the next TDMA frame
+    uint8_t  flags;              ///< DB_PROTOCOL_TDMA_FLAG_* modes granted to the client, rx_start and rx_duration are its downlink slot in low-power mode
 } protocol_tdma_table_t;
 
 /// DotBot protocol sync messages marks the start of a TDMA frame [all units are in microseconds]
 typedef struct __attribute__((packed)) {
-    uint32_t frame_period;  ///< duration of a full TDMA frame
+    uint32_t frame_period;        ///< duration of a full TDMA frame
+    uint32_t timestamp;           ///< time of the gateway clock when it sends the sync frame, the clients estimate their drift from it
+    uint16_t frame_offset;        ///< time between the start of the frame and the sync frame
+    uint8_t  sync_period;         ///< number of frames between two sync frames, a change of frame length is announced by a sync frame right away
+    uint16_t join_slot_duration;  ///< duration of a join slot, the join slots end with the frame and the clients not registered send their join request at the start of one
+    uint8_t  join_slots;          ///< number of join slots, 0 if the clients not registered send their join request at any time
+    uint32_t join_acked;          ///< join slots of the previous frame where the gateway accepted a join request, bit i for join slot i, the TDMA table follows, the bits of the join slots above 31 follow the sync frame
+    uint8_t  hop_seed;            ///< seed of the channel hopping sequence, 0 if the gateway stays on its frequency
+    uint16_t hop_frame;           ///< number of this frame in the channel hopping sequence, the clients change channel with each frame
+    uint8_t  channel_map[5];      ///< BLE data channels of the channel hopping sequence, bit i (little endian) for channel i, the others are blacklisted
+    uint8_t  table_switch;        ///< number of frames before the clients switch to the table received with DB_PROTOCOL_TDMA_FLAG_NEXT_TABLE, 1 for the next frame, 0 if no switch is announced
+    uint16_t join_window;         ///< contention window of the join requests in join slots, the number of clients the gateway estimates are joining
 } protocol_sync_frame_t;
 
+/// DotBot protocol TDMA keep alive, also sent by the clients to register
+typedef struct __attribute__((packed)) {
+    uint8_t flags;  ///< DB_PROTOCOL_TDMA_FLAG_* modes asked by the client
+} protocol_tdma_keep_alive_t;
+
+/// DotBot protocol TDMA aggregated downlink record, followed by the payload of a data packet (the bytes after its header)
+typedef struct __attribute__((packed)) {
+    uint64_t dst;     ///< Destination address of the data packet
+    uint8_t  length;  ///< Length of the payload that follows
+} protocol_tdma_aggregate_record_t;
+
+/// DotBot protocol TDMA acknowledged data, sequence number of the packet on the link between the gateway and a client
+typedef struct __attribute__((packed)) {
+    uint8_t seq;      ///< sequence number of the packet, incremented for each new packet sent on the link
+    uint8_t retries;  ///< number of times the packet was sent before, only retransmissions can be duplicates
+} protocol_tdma_data_t;
+
+/// DotBot protocol TDMA block acknowledgement record, the acknowledged data packets received from a node
+typedef struct __attribute__((packed)) {
+    uint64_t src;     ///< Address of the node that sent the data packets
+    uint8_t  seq;     ///< sequence number of the last packet received
+    uint16_t bitmap;  ///< packets received, bit i for sequence number seq - i
+} protocol_tdma_ack_t;
+
+/// DotBot protocol TDMA demand report, packets still waiting in the queue of a client at the end of its slot
+typedef struct __attribute__((packed)) {
+    uint8_t  queued_packets;  ///< number of packets waiting to be sent
+    uint16_t queued_bytes;    ///< total length of the packets waiting to be sent
+} protocol_tdma_demand_t;
+
 //=========================== public ===========================================
 
 /**
@@ -155,10 +223,11 @@ size_t db_protocol_header_to_buffer(uint8_t *buffer, uint64_t dst);
  *
  * @param[out]  buffer      Bytes array to write to
  * @param[in]   dst         Destination address written in the header
+ * @param[in]   keep_alive  Pointer to the keep alive payload
  *
  * @return                  Number of bytes written in the buffer
  */
-size_t db_protocol_tdma_keep_alive_to_buffer(uint8_t *buffer, uint64_t dst);
+size_t db_protocol_tdma_keep_alive_to_buffer(uint8_t *buffer, uint64_t dst, protocol_tdma_keep_alive_t *keep_alive);
 
 /**
  * @brief   Write a TDMA table update in a buffer
@@ -182,6 +251,61 @@ size_t db_protocol_tdma_table_update_to_buffer(uint8_t *buffer, uint64_t dst, pr
  */
 size_t db_protocol_tdma_sync_frame_to_buffer(uint8_t *buffer, uint64_t dst, protocol_sync_frame_t *sync_frame);
 
+/**
+ * @brief   Write the header of a TDMA aggregated downlink frame in a buffer, records are appended with db_protocol_tdma_aggregate_add
+ *
+ * @param[out]  buffer      Bytes array to write to
+ * @param[in]   dst         Destination address written in the header
+ * @param[in]   acked       true to aggregate acknowledged data packets (DB_PACKET_TDMA_DATA), false for data packets
+ *
+ * @return                  Number of bytes written in the buffer
+ */
+size_t db_protocol_tdma_aggregate_to_buffer(uint8_t *buffer, uint64_t dst, bool acked);
+
+/**
+ * @brief   Append a data packet to a TDMA aggregated downlink frame
+ *
+ * @param[in,out]  buffer          Bytes array containing the aggregated frame
+ * @param[in]      length          Current length of the aggregated frame
+ * @param[in]      packet          Data packet to append, header included
+ * @param[in]      packet_length   Length of the data packet
+ *
+ * @return                         New length of the aggregated frame
+ */
+size_t db_protocol_tdma_aggregate_add(uint8_t *buffer, size_t length, const uint8_t *packet, uint8_t packet_length);
+
+/**
+ * @brief   Write the header of a TDMA block acknowledgement frame in a buffer, records are appended with db_protocol_tdma_ack_add
+ *
+ * @param[out]  buffer      Bytes array to write to
+ * @param[in]   dst         Destination address written in the header
+ *
+ * @return                  Number of bytes written in the buffer
+ */
+size_t db_protocol_tdma_ack_to_buffer(uint8_t *buffer, uint64_t dst);
+
+/**
+ * @brief   Append a block acknowledgement record to a TDMA block acknowledgement frame
+ *
+ * @param[in,out]  buffer          Bytes array containing the block acknowledgement frame
+ * @param[in]      length          Current length of the block acknowledgement frame
+ * @param[in]      ack             Pointer to the record to append
+ *
+ * @return                         New length of the block acknowledgement frame
+ */
+size_t db_protocol_tdma_ack_add(uint8_t *buffer, size_t length, const protocol_tdma_ack_t *ack);
+
+/**
+ * @brief   Write a TDMA demand report in a buffer
+ *
+ * @param[out]  buffer      Bytes array to write to
+ * @param[in]   dst         Destination address written in the header
+ * @param[in]   demand      Pointer to the demand report
+ *
+ * @return                  Number of bytes written in the buffer
+ */
+size_t db_protocol_tdma_demand_to_buffer(uint8_t *buffer, uint64_t dst, protocol_tdma_demand_t *demand);
+
 /**
  * @brief   Write an application advertizement packet in a buffer
  *
@@ -215,4 +339,14 @@ size_t db_protocol_cmd_move_raw_to_buffer(uint8_t *buffer, uint64_t dst, protoco
  */
 size_t db_protocol_cmd_rgbled_to_buffer(uint8_t *buffer, uint64_t dst, protocol_rgbled_command_t *command);
 
+/**
+ * @brief   Return the traffic class of a packet, from its packet type and the type of its data
+ *
+ * @param[in]   packet      Bytes of the packet, header included
+ * @param[in]   length      Length of the packet
+ *
+ * @return                  Traffic class of the packet
+ */
+protocol_priority_t db_protocol_packet_priority(const uint8_t *packet, uint8_t length);
+
 #endif
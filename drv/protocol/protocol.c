@@ -33,8 +33,10 @@ size_t db_protocol_header_to_buffer(uint8_t *buffer, uint64_t dst) {
     return _protocol_header_to_buffer(buffer, dst, DB_PACKET_DATA);
 }
 
-size_t db_protocol_tdma_keep_alive_to_buffer(uint8_t *buffer, uint64_t dst) {
-    return _protocol_header_to_buffer(buffer, dst, DB_PACKET_TDMA_KEEP_ALIVE);
+size_t db_protocol_tdma_keep_alive_to_buffer(uint8_t *buffer, uint64_t dst, protocol_tdma_keep_alive_t *keep_alive) {
+    size_t header_length = _protocol_header_to_buffer(buffer, dst, DB_PACKET_TDMA_KEEP_ALIVE);
+    memcpy(buffer + sizeof(protocol_header_t), keep_alive, sizeof(protocol_tdma_keep_alive_t));
+    return header_length + sizeof(protocol_tdma_keep_alive_t);
 }
 
 size_t db_protocol_tdma_table_update_to_buffer(uint8_t *buffer, uint64_t dst, protocol_tdma_table_t *tdma_table) {
@@ -49,6 +51,36 @@ size_t db_protocol_tdma_sync_frame_to_buffer(uint8_t *buffer, uint64_t dst, prot
     return header_length + sizeof(protocol_sync_frame_t);
 }
 
+size_t db_protocol_tdma_aggregate_to_buffer(uint8_t *buffer, uint64_t dst, bool acked) {
+    return _protocol_header_to_buffer(buffer, dst, acked ? DB_PACKET_TDMA_AGGREGATE_ACKED : DB_PACKET_TDMA_AGGREGATE);
+}
+
+size_t db_protocol_tdma_aggregate_add(uint8_t *buffer, size_t length, const uint8_t *packet, uint8_t packet_length) {
+    const protocol_header_t         *header = (const protocol_header_t *)packet;
+    protocol_tdma_aggregate_record_t record = {
+        .dst    = header->dst,
+        .length = packet_length - sizeof(protocol_header_t),
+    };
+    memcpy(buffer + length, &record, sizeof(protocol_tdma_aggregate_record_t));
+    memcpy(buffer + length + sizeof(protocol_tdma_aggregate_record_t), packet + sizeof(protocol_header_t), record.length);
+    return length + sizeof(protocol_tdma_aggregate_record_t) + record.length;
+}
+
+size_t db_protocol_tdma_ack_to_buffer(uint8_t *buffer, uint64_t dst) {
+    return _protocol_header_to_buffer(buffer, dst, DB_PACKET_TDMA_ACK);
+}
+
+size_t db_protocol_tdma_ack_add(uint8_t *buffer, size_t length, const protocol_tdma_ack_t *ack) {
+    memcpy(buffer + length, ack, sizeof(protocol_tdma_ack_t));
+    return length + sizeof(protocol_tdma_ack_t);
+}
+
+size_t db_protocol_tdma_demand_to_buffer(uint8_t *buffer, uint64_t dst, protocol_tdma_demand_t *demand) {
+    size_t header_length = _protocol_header_to_buffer(buffer, dst, DB_PACKET_TDMA_DEMAND);
+    memcpy(buffer + sizeof(protocol_header_t), demand, sizeof(protocol_tdma_demand_t));
+    return header_length + sizeof(protocol_tdma_demand_t);
+}
+
 size_t db_protocol_advertizement_to_buffer(uint8_t *buffer, uint64_t dst, application_type_t application) {
     size_t header_length                        = _protocol_header_to_buffer(buffer, dst, DB_PACKET_DATA);
     *(buffer + header_length)                   = DB_PROTOCOL_ADVERTISEMENT;
@@ -69,3 +101,37 @@ size_t db_protocol_cmd_rgbled_to_buffer(uint8_t *buffer, uint64_t dst, protocol_
     memcpy(buffer + header_length + sizeof(uint8_t), command, sizeof(protocol_rgbled_command_t));
     return header_length + sizeof(uint8_t) + sizeof(protocol_rgbled_command_t);
 }
+
+protocol_priority_t db_protocol_packet_priority(const uint8_t *packet, uint8_t length) {
+    if (length < sizeof(protocol_header_t)) {
+        return DB_PROTOCOL_PRIORITY_BULK;
+    }
+
+    // TDMA management packets keep the schedule running, acknowledged data packets keep the class of their data
+    const protocol_header_t *header      = (const protocol_header_t *)packet;
+    size_t                   data_offset = sizeof(protocol_header_t);
+    if (header->packet_type == DB_PACKET_TDMA_DATA) {
+        data_offset += sizeof(protocol_tdma_data_t);
+    } else if (header->packet_type != DB_PACKET_DATA) {
+        return DB_PROTOCOL_PRIORITY_CONTROL;
+    }
+    if (length <= data_offset) {
+        return DB_PROTOCOL_PRIORITY_TELEMETRY;
+    }
+
+    switch ((protocol_data_type_t)packet[data_offset]) {
+        case DB_PROTOCOL_CMD_MOVE_RAW:
+        case DB_PROTOCOL_CONTROL_MODE:
+        case DB_PROTOCOL_LH2_WAYPOINTS:
+        case DB_PROTOCOL_GPS_WAYPOINTS:
+        case DB_PROTOCOL_CMD_XGO_ACTION:
+            return DB_PROTOCOL_PRIORITY_CONTROL;
+        case DB_PROTOCOL_LH2_RAW_DATA:
+        case DB_PROTOCOL_LH2_PROCESSED_DATA:
+        case DB_PROTOCOL_LH2_HOMOGRAPHY:
+        case DB_PROTOCOL_LH2_STATS:
+            return DB_PROTOCOL_PRIORITY_BULK;
+        default:
+            return DB_PROTOCOL_PRIORITY_TELEMETRY;
+    }
+}
@@ -13,13 +13,27 @@
  * @}
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <nrf.h>
 #include "radio.h"
 #include "protocol.h"
+#include "packet_queue.h"
 
 //=========================== defines ==========================================
 
+#ifndef TDMA_CLIENT_ACKED_PRIORITIES
+#define TDMA_CLIENT_ACKED_PRIORITIES 0  ///< Traffic classes sent to the gateway as acknowledged data packets and resent until acknowledged, one bit (1 << protocol_priority_t) per class, 0 to send every data packet once
+#endif
+
+#ifndef TDMA_CLIENT_MAX_RETRIES
+#define TDMA_CLIENT_MAX_RETRIES 3  ///< Max number of times an acknowledged data packet is resent, it is dropped afterwards
+#endif
+
+#ifndef TDMA_CLIENT_SCAN_DWELL_US
+#define TDMA_CLIENT_SCAN_DWELL_US 0  ///< Time spent on each BLE data channel while looking for a gateway that hops, 0 to wait on the frequency given to db_tdma_client_init
+#endif
+
 /// TDMA internal registrarion state
 typedef enum {
     DB_TDMA_CLIENT_UNREGISTERED,  ///< the DotBot is not registered with the gateway
@@ -94,10 +108,30 @@ void db_tdma_client_flush(void);
  */
 void db_tdma_client_empty(void);
 
+/**
+ * @brief Get the statistics of the TDMA queues of outgoing packets, one queue per traffic class (see db_protocol_packet_priority)
+ *
+ * @param[out] stats      statistics of each queue (packets and bytes waiting, high water mark, dropped packets), indexed by protocol_priority_t
+ */
+void db_tdma_client_get_queue_stats(db_packet_queue_stats_t stats[DB_PROTOCOL_PRIORITY_COUNT]);
+
 /**
  * @brief Return the status of the TDMA client. [Registered, Unregistered]
  *
  */
 db_tdma_registration_state_t db_tdma_client_get_status(void);
 
+/**
+ * @brief Ask the gateway for low-power mode, or go back to listening all the time
+ *
+ * In low-power mode the gateway sends the packets for the DotBot during one downlink slot per frame,
+ * and the receiver is only on during the first slot of the frame (sync frame and broadcast packets)
+ * and the downlink slot, with a guard time that grows with the clock drift measured at each sync frame.
+ * The receiver stays on until the gateway grants the downlink slot, and after a lost sync frame.
+ * The gateway holds the packets until the downlink slot of their DotBot, which takes room in its queues.
+ *
+ * @param[in] enable      true to switch to low-power mode, false to listen all the time
+ */
+void db_tdma_client_set_low_power(bool enable);
+
 #endif
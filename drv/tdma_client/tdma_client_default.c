@@ -9,6 +9,7 @@
  * @copyright Inria, 2024
  */
 #include <nrf.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 #include <stdbool.h>
@@ -19,6 +20,9 @@
 #include "timer_hf.h"
 #include "protocol.h"
 #include "device.h"
+#include "clock_drift.h"
+#include "block_ack.h"
+#include "channel_hop.h"
 #if defined(NRF5340_XXAA) && defined(NRF_NETWORK)
 #include "ipc.h"
 #endif
@@ -32,36 +36,104 @@
 #define TDMA_CLIENT_DEFAULT_TX_DURATION    5000                                ///< Default duration of the tdma frame, in microseconds.
 #define TDMA_CLIENT_HF_TIMER_CC_TX         0                                   ///< Which timer channel will be used for the TX state machine.
 #define TDMA_CLIENT_HF_TIMER_CC_RX         1                                   ///< Which timer channel will be used for the RX state machine.
+#define TDMA_CLIENT_HF_TIMER_CC_RX_TS      2                                   ///< Which timer channel captures the timestamp of the received packets.
 #define TDMA_CLIENT_MAX_DELAY_WITHOUT_TX   500000                              ///< Max amount of time that can pass without TXing anything
-#define TDMA_CLIENT_RING_BUFFER_SIZE       10                                  ///< Amount of TX packets the buffer can contain
+#define TDMA_CLIENT_MAX_FRAME_DURATION     2000000                             ///< Longest frame period accepted from a sync frame, a gateway with hundreds of clients has frames longer than half a second
+#define TDMA_CLIENT_RING_BUFFER_SIZE       1024                                ///< Size of the TX packets buffers of all the traffic classes, in bytes (each packet uses its length plus one byte)
+#define TDMA_CLIENT_UNACKED_BUFFER_SIZE    512                                 ///< Size of the buffer of the acknowledged data packets waiting for their acknowledgement, in bytes (each packet uses its length plus one byte)
+#define TDMA_CLIENT_CONTROL_BUFFER_SIZE    128                                 ///< Size of the buffer of the keep alive, acknowledgement and join packets waiting for the radio, in bytes
 #define RADIO_MESSAGE_MAX_SIZE             255                                 ///< Size of buffers used for SPI communications
 #define RADIO_TX_RAMP_UP_TIME              140                                 ///< time it takes the radio to start a transmission
+#define TDMA_CLIENT_LOW_POWER_GUARD_US     100                                 ///< Min time the receiver opens before, and stays open after, a slot in low-power mode (radio ramp up and interrupt latency)
+#define TDMA_CLIENT_JOIN_TIMEOUT_FRAMES    2                                   ///< Frames to wait for the table update after the gateway accepted a join request, before trying again
+#define TDMA_CLIENT_JOIN_MAX_WINDOW        64                                  ///< Largest contention window of the join requests, in join slots, when it doubles after each failed request
+#define TDMA_CLIENT_HOP_LOST_SYNC_PERIODS  8                                   ///< Sync periods without a sync frame before the DotBot stops following the channel hopping of the gateway
 #define TDMA_CLIENT_TIMER_HF               2
 
-typedef struct {
-    uint8_t  buffer[TDMA_CLIENT_RING_BUFFER_SIZE][DB_BLE_PAYLOAD_MAX_LENGTH];  ///< arrays of radio messages waiting to be sent
-    uint32_t packet_length[TDMA_CLIENT_RING_BUFFER_SIZE];                      ///< arrays of the length of the packets in the buffer
-    uint8_t  write_index;                                                      ///< Index for next write
-    uint8_t  read_index;                                                       ///< Index for next read
-    uint8_t  count;                                                            ///< Number of arrays in buffer
-} tdma_client_ring_buffer_t;
+/// Next step of the receive windows in low-power mode
+typedef enum {
+    TDMA_CLIENT_WINDOW_NONE,            ///< the receiver stays on until the next sync frame
+    TDMA_CLIENT_WINDOW_SYNC_OPEN,       ///< open the receiver for the first slot of the next frame, where the sync frame is sent
+    TDMA_CLIENT_WINDOW_SYNC_CLOSE,      ///< close the receiver at the end of the first slot of the frame
+    TDMA_CLIENT_WINDOW_DOWNLINK_OPEN,   ///< open the receiver for the downlink slot
+    TDMA_CLIENT_WINDOW_DOWNLINK_CLOSE,  ///< close the receiver at the end of the downlink slot
+} tdma_client_window_t;
 
 typedef struct {
-    tdma_client_cb_t             callback;                              ///< Function pointer, stores the callback to use in the RADIO_Irq handler.
-    tdma_client_table_t          tdma_client_table;                     ///< Timing table
-    db_tdma_registration_state_t registration_flag;                     ///< flag marking if the DotBot is registered with the Gateway or not.
-    db_tdma_rx_state_t           rx_flag;                               ///< flag marking if the DotBot's is receving or not.
-    uint32_t                     last_tx_packet_timestamp;              ///< Timestamp of when the last packet was sent
-    uint64_t                     device_id;                             ///< Device ID of the DotBot
-    tdma_client_ring_buffer_t    tx_ring_buffer;                        ///< ring buffer to queue the outgoing packets
-    uint8_t                      byte_onair_time;                       ///< How many microseconds it takes to send a byte of data
-    uint8_t                      radio_buffer[RADIO_MESSAGE_MAX_SIZE];  ///< Internal buffer that contains the command to send (from buttons)
+    tdma_client_cb_t             callback;                                           ///< Function pointer, stores the callback to use in the RADIO_Irq handler.
+    tdma_client_table_t          tdma_client_table;                                  ///< Timing table
+    db_tdma_registration_state_t registration_flag;                                  ///< flag marking if the DotBot is registered with the Gateway or not.
+    db_tdma_rx_state_t           rx_flag;                                            ///< flag marking if the DotBot's is receving or not.
+    uint32_t                     last_tx_packet_timestamp;                           ///< Timestamp of when the last packet was sent
+    uint64_t                     device_id;                                          ///< Device ID of the DotBot
+    db_packet_queue_t            tx_ring_buffer[DB_PROTOCOL_PRIORITY_COUNT];         ///< ring buffers to queue the outgoing packets, one per traffic class
+    uint8_t                      tx_ring_buffer_data[TDMA_CLIENT_RING_BUFFER_SIZE];  ///< bytes of the packets queued in the ring buffer
+    db_packet_queue_t            tx_control;                                         ///< Keep alive, acknowledgement and join packets waiting for the radio, they go first in the packet train
+    uint8_t                      tx_control_data[TDMA_CLIENT_CONTROL_BUFFER_SIZE];   ///< bytes of the packets queued in tx_control
+    uint8_t                      tx_in_flight;                                       ///< Number of packets of the train handed to the radio and not sent yet, at most the one on air and its follow-up
+    uint32_t                     tx_train_start_ts;                                  ///< Timestamp the time available to the data packets of the train is counted from
+    uint32_t                     tx_train_end_ts;                                    ///< Timestamp of the end of the last packet of the train, handed to the radio or queued in tx_control
+    uint16_t                     tx_train_max_us;                                    ///< Time available to the data packets of the train, from tx_train_start_ts
+    bool                         tx_demand_due;                                      ///< Set when the gateway must get the packets left in the queue, if some don't fit in the slot
+    uint8_t                      byte_onair_time;                                    ///< How many microseconds it takes to send a byte of data
+    uint16_t                     overhead_onair_time;                                ///< How many microseconds the preamble, address and CRC of a packet take on air
+    uint16_t                     address_time;                                       ///< How many microseconds pass between the start of a transmission and its ADDRESS event
+    uint8_t                      radio_buffer[RADIO_MESSAGE_MAX_SIZE];               ///< Internal buffer that contains the command to send (from buttons)
+    uint8_t                      rx_packet[RADIO_MESSAGE_MAX_SIZE];                  ///< Data packet extracted from an aggregated downlink frame
+    bool                         low_power;                                          ///< Set when the DotBot asks for low-power mode
+    bool                         low_power_granted;                                  ///< Set when the gateway gave a downlink slot to the DotBot, rx_start and rx_duration describe it
+    bool                         low_power_request;                                  ///< Set when the DotBot must tell the gateway its receive mode in its next slot
+    tdma_client_window_t         rx_window;                                          ///< Next step of the receive windows in low-power mode
+    bool                         sync_received;                                      ///< Set when the sync frame of the current frame was received, in low-power mode
+    uint8_t                      sync_period;                                        ///< Number of frames between two sync frames
+    uint8_t                      frames_since_sync;                                  ///< Number of frames since the last sync frame, in low-power mode and before joining
+    uint32_t                     frame_start_ts;                                     ///< Timestamp of the start of the current frame
+    uint32_t                     tx_slot_ts;                                         ///< Timestamp of the start of the next TX slot
+    db_clock_drift_t             clock_drift;                                        ///< Drift of the DotBot clock against the gateway clock, estimated from the sync frames
+    uint32_t                     sync_error_us;                                      ///< Error of the predicted start of frame, measured at each sync frame, the guard time grows with it
+    bool                         gateway_heard;                                      ///< Set once a sync frame was received, the DotBot waits for it before sending join requests
+    uint32_t                     join_start;                                         ///< Time between the start of the frame and the first join slot, the join slots end with the frame
+    uint16_t                     join_slot_duration;                                 ///< Duration of a join slot
+    uint8_t                      join_slots;                                         ///< Number of join slots announced by the gateway, 0 to send the join requests at random times
+    bool                         join_request_due;                                   ///< Set when the TX timer fires in the join slot picked, instead of at the start of the join slots
+    uint16_t                     join_window;                                        ///< Contention window of the join requests, in join slots, as many as the DotBots the gateway estimates are joining
+    bool                         join_window_announced;                              ///< Whether the gateway announces the join window, otherwise it doubles after each failed join request
+    uint16_t                     join_backoff;                                       ///< Number of join slots to let go before sending the next join request
+    uint8_t                      join_timeout;                                       ///< Frames left to wait for the table update after a join request, 0 if none is pending
+    uint8_t                      join_request_slot;                                  ///< Join slot of the last join request, the next sync frame tells if the gateway accepted it
+    bool                         join_feedback_due;                                  ///< Set from the last join request until the sync frame that answers it
+    uint64_t                     gateway_id;                                         ///< Device ID of the gateway, from its sync frames
+    db_block_ack_t               rx_data_window;                                     ///< Acknowledged data packets received from the gateway
+    bool                         ack_due;                                            ///< Set when the gateway must get a block acknowledgement in the next slot
+    db_channel_hop_t             hop;                                                ///< Channel hopping sequence of the gateway, from its sync frames
+    bool                         hopping;                                            ///< Set while the DotBot follows the channel hopping of the gateway
+    bool                         scanning;                                           ///< Set while the DotBot looks for a gateway over the BLE data channels
+    uint16_t                     hop_frame;                                          ///< Number of the current frame in the channel hopping sequence
+    uint32_t                     hop_frames_since_sync;                              ///< Number of frames hopped since the last sync frame
+    uint32_t                     hop_frame_ts;                                       ///< Predicted timestamp of the start of the current frame, the channel changes right before the frame starts
+    uint32_t                     hop_margin;                                         ///< Duration of the join slots at the end of the frame, a registered DotBot has nothing to receive there and changes channel early
+    protocol_tdma_table_t        next_table;                                         ///< Table of the next layout of the slots, received ahead of the switch
+    bool                         next_table_due;                                     ///< Set when next_table waits for the frame of the switch
+    bool                         next_table_announced;                               ///< Set when a sync frame announced the frame of the switch
+    uint32_t                     next_table_ts;                                      ///< Timestamp of the start of the frame where the DotBot switches to next_table
+#if TDMA_CLIENT_ACKED_PRIORITIES
+    uint8_t                      tx_seq;                                             ///< Sequence number of the next acknowledged data packet sent to the gateway
+    db_packet_queue_t            unacked;                                            ///< Acknowledged data packets sent and not acknowledged yet
+    uint8_t                      unacked_data[TDMA_CLIENT_UNACKED_BUFFER_SIZE];      ///< bytes of the packets waiting for their acknowledgement
+#endif
 } tdma_client_vars_t;
 
 //=========================== variables ========================================
 
 static tdma_client_vars_t _tdma_client_vars = { 0 };
 
+// Size of the TX packets buffer of each traffic class, in bytes, they add up to TDMA_CLIENT_RING_BUFFER_SIZE.
+static const uint16_t _tx_ring_buffer_sizes[DB_PROTOCOL_PRIORITY_COUNT] = {
+    256,  // DB_PROTOCOL_PRIORITY_CONTROL
+    256,  // DB_PROTOCOL_PRIORITY_TELEMETRY
+    512,  // DB_PROTOCOL_PRIORITY_BULK
+};
+
 // Transform the ble mode into how many microseconds it takes to send a single byte.
 static const uint8_t ble_mode_to_byte_time[] = {
     8,   // DB_RADIO_BLE_1MBit
@@ -70,9 +142,25 @@ static const uint8_t ble_mode_to_byte_time[] = {
     16,  // DB_RADIO_BLE_LR500Kbit
 };
 
+// Transform the ble mode into how many microseconds the preamble, address, header and CRC of a packet take (and the coding indicator and terms in long range).
+static const uint16_t ble_mode_to_overhead_time[] = {
+    80,   // DB_RADIO_BLE_1MBit
+    44,   // DB_RADIO_BLE_2MBit
+    720,  // DB_RADIO_BLE_LR125Kbit
+    462,  // DB_RADIO_BLE_LR500Kbit
+};
+
+// Transform the ble mode into the time between the start of a transmission and the ADDRESS event that timestamps it (fast ramp up, preamble and address).
+static const uint16_t ble_mode_to_address_time[] = {
+    80,   // DB_RADIO_BLE_1MBit
+    64,   // DB_RADIO_BLE_2MBit
+    376,  // DB_RADIO_BLE_LR125Kbit
+    376,  // DB_RADIO_BLE_LR500Kbit
+};
+
 //========================== prototypes ========================================
 
-static void tdma_client_callback(uint8_t *packet, uint8_t length);
+static void tdma_client_callback(uint8_t *packet, uint8_t length, const db_radio_rx_metadata_t *metadata);
 
 /// TDMA timer Interrupts
 static void timer_tx_interrupt(void);
@@ -87,49 +175,197 @@ static void timer_rx_interrupt(void);
 static void _protocol_tdma_set_table(const protocol_tdma_table_t *table);
 
 /**
- * @brief Initialize the ring buffer for spi captures
+ * @brief Check if a time falls in the frame where the DotBot switches to the table of the next layout, or after it
  *
- * @param[in]   rb  pointer to ring buffer structure
+ * @param[in]   timestamp   time to check, on the DotBot clock
+ * @return  true if the next table was announced and applies at this time
+ */
+static bool _next_table_reached(uint32_t timestamp);
+
+/**
+ * @brief Switch to the table of the next layout of the slots
  */
-static void _message_rb_init(tdma_client_ring_buffer_t *rb);
+static void _next_table_apply(void);
 
 /**
- * @brief add one element to the ring buffer for tdma captures
+ * @brief Sends all the queued messages that can be sent in during the TX timeslot
+ *
+ * The messages are sent back-to-back as a packet train, after the control packets already queued: the function
+ * hands the first ones to the radio and returns, the following ones are handed to the radio from its TX completion callback.
  *
- * @param[in]   rb          pointer to ring buffer structure
- * @param[in]   data        pointer to the data array to save in the ring buffer
- * @param[in]   packet_length   length of the packet to send trough the radio
+ * @param[in]    max_tx_duration_us     Time available to send messages, in microseconds
+ * @return  true if messages were waiting to be sent, false otherwise.
  */
-static void _message_rb_add(tdma_client_ring_buffer_t *rb, uint8_t data[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t packet_length);
+static bool _message_rb_tx_queue(uint16_t max_tx_duration_us);
 
 /**
- * @brief retrieve the oldest element from the ring buffer for tdma captures
+ * @brief Take out the next packet of the train: the control packets first, then the data packet that ends before the end of the
+ * packet train, by order of traffic class, and last the report of the packets left if some don't fit
  *
- * @param[in]    rb          pointer to ring buffer structure
- * @param[out]   data        pointer to the array where the ring buffer data will be saved
- * @param[out]   packet_length   length of the packet to send trough the radio
+ * @param[out]   packet     buffer where the packet is copied
+ * @return                  length of the packet, 0 if no packet fits in the time left
  */
-static bool _message_rb_get(tdma_client_ring_buffer_t *rb, uint8_t data[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t *packet_length);
+static uint8_t _message_rb_next(uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH]);
 
 /**
- * @brief Sends all the queued messages that can be sent in during the TX timeslot
+ * @brief Hand the next packets of the train to the radio, the one on air and its follow-up
+ */
+static void _message_rb_tx_fill(void);
+
+/**
+ * @brief TX completion callback of the packets of the train, hands the next packet to the radio
+ */
+static void _message_rb_tx_next(void);
+
+/**
+ * @brief Return when the next packet handed to the radio goes on air, after the packets of the train
  *
- * @param[in]    max_tx_duration_us     Time available to send messages, in microseconds
- * @return  true is a packet was sent, false if no packet was sent.
+ * @return  timestamp of the start of the next packet
  */
-static bool _message_rb_tx_queue(uint16_t max_tx_duration_us);
+static uint32_t _tx_start_ts(void);
+
+/**
+ * @brief Send the control packet in the radio buffer after the packets of the train, without waiting for it to go on air
+ *
+ * @param[in]   length      length of the packet
+ */
+static void _client_tx(size_t length);
+
+/**
+ * @brief Compute the length of a packet sent as an acknowledged data packet
+ *
+ * The data packets of the acknowledged traffic classes are acknowledged once the gateway is known,
+ * if they still fit in a radio frame with their sequence number.
+ *
+ * @param[in]   packet      packet taken out of the ring buffer
+ * @param[in]   length      length of the packet
+ * @return                  length of the packet with its sequence number, 0 if the packet is sent as is
+ */
+static uint8_t _acked_length(const uint8_t *packet, uint8_t length);
+
+#if TDMA_CLIENT_ACKED_PRIORITIES
+/**
+ * @brief Number a data packet about to be sent, and keep a copy of it until the gateway acknowledges it
+ *
+ * @param[in,out]   packet      packet taken out of the ring buffer, turned into an acknowledged data packet
+ * @param[in]       length      length of the packet
+ * @return                      length of the packet to send
+ */
+static uint8_t _tx_sequence(uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t length);
+
+/**
+ * @brief Drop the packets acknowledged, and queue again the lost ones in the ring buffer of their traffic class
+ *
+ * @param[in]   ack     block acknowledgement of the gateway, NULL to queue again all the packets left unacknowledged
+ */
+static void _unacked_check(const db_block_ack_t *ack);
+#endif
 
 /**
- * @brief sends a keep_alive packet to the gateway
+ * @brief Record an acknowledged data packet, and pass it up to the callback as a data packet if it was not received already
+ *
+ * @param[in,out]   packet      acknowledged data packet received, turned into a data packet
+ * @param[in]       length      length of the packet
+ */
+static void _rx_tdma_data(uint8_t *packet, uint8_t length);
+
+/**
+ * @brief acknowledge to the gateway the acknowledged data packets received
+ *
+ */
+static void _tx_ack_message(void);
+
+/**
+ * @brief sends a keep_alive packet to the gateway, which also registers an unregistered DotBot
  *
  */
 static void _tx_keep_alive_message(void);
 
 /**
- * @brief register with the gateway to request a TDMA slot
+ * @brief report the packets left in the queue to the gateway, if the report fits in the time left to the packet train
+ *
+ * @param[out]   packet     buffer where the report is written
+ * @param[in]    start_ts   Timestamp of the start of the report
+ * @return                  length of the report, 0 if it doesn't fit
+ */
+static uint8_t _tx_demand_message(uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH], uint32_t start_ts);
+
+/**
+ * @brief schedule the TX state machine timer at a given time
+ *
+ * @param[in]    timestamp  Timestamp of the start of the TX slot
+ */
+static void _tx_slot_at(uint32_t timestamp);
+
+/**
+ * @brief check if the receiver only listens during the first slot of the frame and the downlink slot
+ */
+static bool _low_power_active(void);
+
+/**
+ * @brief schedule the next step of the receive windows in low-power mode
+ *
+ * @param[in]    timestamp  Timestamp of the step
+ * @param[in]    window     Next step
+ */
+static void _low_power_window_at(uint32_t timestamp, tdma_client_window_t window);
+
+/**
+ * @brief open or close the receiver, and schedule the next step of the receive windows in low-power mode
+ */
+static void _low_power_window_next(void);
+
+/**
+ * @brief check if the receiver listens, it only stops in low-power mode between its receive windows
+ */
+static bool _radio_listening(void);
+
+/**
+ * @brief switch the receiver off, or once the packet train on air is sent
+ */
+static void _radio_off(void);
+
+/**
+ * @brief check if the DotBot lost track of the gateway, it scans or waits for a sync frame
+ */
+static bool _gateway_lost(void);
+
+/**
+ * @brief check if the RX state machine timer is free to change channel, it is when the receiver stays on until the next sync frame
+ */
+static bool _rx_timer_free(void);
+
+/**
+ * @brief change the channel of the receiver, the radio only takes the new frequency when it starts receiving again
+ *
+ * @param[in]    channel    BLE data channel
+ */
+static void _hop_retune(uint8_t channel);
+
+/**
+ * @brief change channel for the frames started since the last change, and schedule the next change before the next frame
  *
+ * After a few sync periods without a sync frame the DotBot lost track of the gateway, it scans for it, or waits
+ * on each channel of the sequence in turn long enough to hear a sync frame there.
  */
-static void _tx_tdma_register_message(void);
+static void _hop_next(void);
+
+/**
+ * @brief listen to another BLE data channel while looking for a gateway
+ */
+static void _scan_next(void);
+
+/**
+ * @brief send the join request in the join slot picked, or pick the join slot of the next request,
+ *        called by the TX state machine timer of a DotBot not registered yet
+ */
+static void _join_slot_next(void);
+
+/**
+ * @brief pick the join slot of the next join request in the contention window, after a join request
+ *        that collided or was left unanswered
+ */
+static void _join_backoff(void);
 
 /**
  * @brief get a random delay between 100ms and 228ms in microseconds
@@ -138,6 +374,14 @@ static void _tx_tdma_register_message(void);
  */
 static uint32_t _get_random_delay_us(void);
 
+/**
+ * @brief get a random number of join slots to let go before the next join request
+ *
+ * @param[in]    window     Contention window, in join slots
+ * @return  a number between 0 and window - 1
+ */
+static uint16_t _get_random_backoff(uint16_t window);
+
 //=========================== public ===========================================
 
 void db_tdma_client_init(tdma_client_cb_t callback, db_radio_mode_t radio_mode, uint8_t radio_freq) {
@@ -146,11 +390,26 @@ void db_tdma_client_init(tdma_client_cb_t callback, db_radio_mode_t radio_mode,
     db_timer_hf_init(TDMA_CLIENT_TIMER_HF);
 
     // Initialize the ring buffer of outbound messages
-    _message_rb_init(&_tdma_client_vars.tx_ring_buffer);
+    uint16_t offset = 0;
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        db_packet_queue_init(&_tdma_client_vars.tx_ring_buffer[priority], &_tdma_client_vars.tx_ring_buffer_data[offset], _tx_ring_buffer_sizes[priority]);
+        offset += _tx_ring_buffer_sizes[priority];
+    }
+#if TDMA_CLIENT_ACKED_PRIORITIES
+    db_packet_queue_init(&_tdma_client_vars.unacked, _tdma_client_vars.unacked_data, TDMA_CLIENT_UNACKED_BUFFER_SIZE);
+#endif
+    db_packet_queue_init(&_tdma_client_vars.tx_control, _tdma_client_vars.tx_control_data, TDMA_CLIENT_CONTROL_BUFFER_SIZE);
+    db_block_ack_init(&_tdma_client_vars.rx_data_window);
 
     // Initialize Radio
     db_radio_init(&tdma_client_callback, radio_mode);  // set the radio callback to our tdma catch function
+    db_radio_set_timestamp_timer(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_RX_TS);
     db_radio_set_frequency(radio_freq);                // pass through the rest of the arguments
+#if TDMA_CLIENT_SCAN_DWELL_US > 0
+    // Look for the gateway over the data channels, it may hop
+    _tdma_client_vars.scanning = true;
+    db_radio_set_channel(0);
+#endif
     db_radio_rx();                                     // start receiving packets
 
     // Start the random number generator
@@ -163,7 +422,9 @@ void db_tdma_client_init(tdma_client_cb_t callback, db_radio_mode_t radio_mode,
     _tdma_client_vars.callback = callback;
 
     // Save the on-air byte time
-    _tdma_client_vars.byte_onair_time = ble_mode_to_byte_time[radio_mode];
+    _tdma_client_vars.byte_onair_time     = ble_mode_to_byte_time[radio_mode];
+    _tdma_client_vars.overhead_onair_time = ble_mode_to_overhead_time[radio_mode];
+    _tdma_client_vars.address_time        = ble_mode_to_address_time[radio_mode];
 
     // Set the default time table
     _tdma_client_vars.tdma_client_table.frame_duration = TDMA_CLIENT_DEFAULT_FRAME_DURATION;
@@ -175,11 +436,16 @@ void db_tdma_client_init(tdma_client_cb_t callback, db_radio_mode_t radio_mode,
     // Set the starting states
     _tdma_client_vars.registration_flag = DB_TDMA_CLIENT_UNREGISTERED;
     _tdma_client_vars.rx_flag           = DB_TDMA_CLIENT_RX_ON;
+    _tdma_client_vars.sync_period       = 1;
+    db_clock_drift_init(&_tdma_client_vars.clock_drift);
 
     // Configure the Timers
     _tdma_client_vars.last_tx_packet_timestamp = db_timer_hf_now(TDMA_CLIENT_TIMER_HF);                                                  // start the counter saving when was the last packet sent.
     db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_TX, TDMA_CLIENT_DEFAULT_TX_START, &timer_tx_interrupt);     // start advertising behaviour
     db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_RX, TDMA_CLIENT_DEFAULT_RX_DURATION, &timer_rx_interrupt);  // check RX timer once per frame.
+#if TDMA_CLIENT_SCAN_DWELL_US > 0
+    db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_RX, TDMA_CLIENT_SCAN_DWELL_US, &timer_rx_interrupt);
+#endif
 }
 
 void db_tdma_client_set_table(const tdma_client_table_t *table) {
@@ -202,25 +468,61 @@ void db_tdma_client_get_table(tdma_client_table_t *table) {
 
 void db_tdma_client_tx(const uint8_t *packet, uint8_t length) {
 
-    // Add packet to the output buffer
-    _message_rb_add(&_tdma_client_vars.tx_ring_buffer, (uint8_t *)packet, length);
+    // Add packet to the output buffer of its traffic class. The timer and radio interrupts pop the queue, they are masked
+    // while the push, and the drops of the oldest packets it may need, update the queue
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    db_packet_queue_push(&_tdma_client_vars.tx_ring_buffer[db_protocol_packet_priority(packet, length)], packet, length);
+    __set_PRIMASK(primask);
 }
 
 void db_tdma_client_flush(void) {
     // Use the normal function to send queue messages, but with a really long time
-    // So that there is enough time to send everything.
+    // So that there is enough time to send everything. The interrupts also hand packets to the radio, they are masked meanwhile
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
     _message_rb_tx_queue(50000);
+    __set_PRIMASK(primask);
 }
 
 void db_tdma_client_empty(void) {
 
-    // Reinitialize the ring buffer to erase it
-    _message_rb_init(&_tdma_client_vars.tx_ring_buffer);
+    // Drop the queued packets, the statistics are kept, without the interrupts popping them meanwhile
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        db_packet_queue_clear(&_tdma_client_vars.tx_ring_buffer[priority]);
+    }
+#if TDMA_CLIENT_ACKED_PRIORITIES
+    db_packet_queue_clear(&_tdma_client_vars.unacked);
+#endif
+    __set_PRIMASK(primask);
+}
+
+void db_tdma_client_get_queue_stats(db_packet_queue_stats_t stats[DB_PROTOCOL_PRIORITY_COUNT]) {
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        db_packet_queue_get_stats(&_tdma_client_vars.tx_ring_buffer[priority], &stats[priority]);
+    }
 }
 
 db_tdma_registration_state_t db_tdma_client_get_status(void) {
     return _tdma_client_vars.registration_flag;
 }
+
+void db_tdma_client_set_low_power(bool enable) {
+
+    _tdma_client_vars.low_power         = enable;
+    _tdma_client_vars.low_power_request = (enable != _tdma_client_vars.low_power_granted);
+
+    // Listen all the time right away, the gateway is told during the next slot
+    if (!enable && _tdma_client_vars.low_power_granted) {
+        _tdma_client_vars.low_power_granted             = false;
+        _tdma_client_vars.tdma_client_table.rx_start    = 0;
+        _tdma_client_vars.tdma_client_table.rx_duration = _tdma_client_vars.tdma_client_table.frame_duration;
+        _tdma_client_vars.rx_flag                       = DB_TDMA_CLIENT_RX_ON;
+        db_radio_rx();
+    }
+}
 //=========================== private ==========================================
 
 static void _protocol_tdma_set_table(const protocol_tdma_table_t *table) {
@@ -230,100 +532,503 @@ static void _protocol_tdma_set_table(const protocol_tdma_table_t *table) {
     _tdma_client_vars.tdma_client_table.rx_duration    = table->rx_duration;
     _tdma_client_vars.tdma_client_table.tx_start       = table->tx_start;
     _tdma_client_vars.tdma_client_table.tx_duration    = table->tx_duration;
+
+    // Ask again for low-power mode if the gateway forgot it, for instance after evicting the DotBot
+    _tdma_client_vars.low_power_granted = _tdma_client_vars.low_power && (table->flags & DB_PROTOCOL_TDMA_FLAG_LOW_POWER);
+    _tdma_client_vars.low_power_request = (_tdma_client_vars.low_power != _tdma_client_vars.low_power_granted);
 }
 
-static void _message_rb_init(tdma_client_ring_buffer_t *rb) {
-    rb->write_index = 0;
-    rb->read_index  = 0;
-    rb->count       = 0;
+static bool _next_table_reached(uint32_t timestamp) {
+    // The drift of the clock moves the start of the frame by much less than half a slot
+    return _tdma_client_vars.next_table_due && _tdma_client_vars.next_table_announced && (int32_t)(timestamp + _tdma_client_vars.tdma_client_table.tx_duration / 2 - _tdma_client_vars.next_table_ts) >= 0;
 }
 
-static void _message_rb_add(tdma_client_ring_buffer_t *rb, uint8_t data[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t packet_length) {
+static void _next_table_apply(void) {
+    _protocol_tdma_set_table(&_tdma_client_vars.next_table);
+    _tdma_client_vars.next_table_due       = false;
+    _tdma_client_vars.next_table_announced = false;
+}
 
-    memcpy(rb->buffer[rb->write_index], data, DB_BLE_PAYLOAD_MAX_LENGTH);
-    rb->packet_length[rb->write_index] = packet_length;
-    rb->write_index                    = (rb->write_index + 1) % TDMA_CLIENT_RING_BUFFER_SIZE;
+static bool _message_rb_tx_queue(uint16_t max_tx_duration_us) {
 
-    if (rb->count < TDMA_CLIENT_RING_BUFFER_SIZE) {
-        rb->count++;
-    } else {
-        // Overwrite oldest data, adjust read_index
-        rb->read_index = (rb->read_index + 1) % TDMA_CLIENT_RING_BUFFER_SIZE;
+    bool packet_queued_flag = false;  ///< flag to keep track if a packet was waiting when this function was called
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        packet_queued_flag |= (_tdma_client_vars.tx_ring_buffer[priority].count > 0);
     }
-}
 
-static bool _message_rb_get(tdma_client_ring_buffer_t *rb, uint8_t data[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t *packet_length) {
-    if (rb->count == 0) {
-        // Buffer is empty
+    // Return if there was nothing to send
+    if (!packet_queued_flag) {
         return false;
     }
 
-    memcpy(data, rb->buffer[rb->read_index], DB_BLE_PAYLOAD_MAX_LENGTH);
-    *packet_length = rb->packet_length[rb->read_index];
-    rb->read_index = (rb->read_index + 1) % TDMA_CLIENT_RING_BUFFER_SIZE;
-    rb->count--;
+    // Update the last packet timer
+    _tdma_client_vars.last_tx_packet_timestamp = db_timer_hf_now(TDMA_CLIENT_TIMER_HF);
+
+    // The data packets follow the control packets of the train, the radio takes the next one while one is on air,
+    // and its completion callback keeps refilling it until nothing fits in the slot. The gateway is told if the slot was too short.
+    _tdma_client_vars.tx_train_start_ts = _tdma_client_vars.last_tx_packet_timestamp;
+    _tdma_client_vars.tx_train_max_us   = max_tx_duration_us;
+    _tdma_client_vars.tx_demand_due     = true;
+    _message_rb_tx_fill();
 
     return true;
 }
 
-static bool _message_rb_tx_queue(uint16_t max_tx_duration_us) {
+static uint8_t _message_rb_next(uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH]) {
 
-    // initialize variables
-    uint32_t start_tx_slot                     = db_timer_hf_now(TDMA_CLIENT_TIMER_HF);
-    uint8_t  length                            = 0;
-    uint8_t  packet[DB_BLE_PAYLOAD_MAX_LENGTH] = { 0 };
-    bool     packet_sent_flag                  = false;  ///< flag to keep track if a packet get sent during this function call
-
-    // Return if there is nothing to send
-    if (_tdma_client_vars.tx_ring_buffer.count == 0) {
-        return false;
+    // The control packets were given their place in the train when they were queued
+    if (_tdma_client_vars.tx_control.count > 0) {
+        uint8_t length = db_packet_queue_peek(&_tdma_client_vars.tx_control, packet);
+        db_packet_queue_pop(&_tdma_client_vars.tx_control);
+        return length;
     }
 
-    // Otherwise, send messages until queue is empty
-    while (_tdma_client_vars.tx_ring_buffer.count > 0) {
-        // retrieve the oldest packet from the queue
-        bool error = _message_rb_get(&_tdma_client_vars.tx_ring_buffer, packet, &length);
-        if (!error) {
-            break;
+    // The packet goes on air after the ones already handed to the radio
+    uint32_t start_ts     = _tx_start_ts();
+    uint32_t elapsed_us   = start_ts - _tdma_client_vars.tx_train_start_ts;
+    uint16_t packets_left = 0;  ///< number of packets that don't fit in the slot
+
+    // Strict priority: the packets of a traffic class go first, the following classes only use the time left
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        db_packet_queue_t *rb = &_tdma_client_vars.tx_ring_buffer[priority];
+        if (rb->count == 0) {
+            continue;
+        }
+
+        // Compute if there is still time to send the oldest packet [in microseconds], with its sequence number if it is acknowledged
+        uint8_t  length       = db_packet_queue_peek(rb, packet);
+        uint8_t  acked_length = _acked_length(packet, length);
+        uint16_t tx_time      = RADIO_TX_RAMP_UP_TIME + _tdma_client_vars.overhead_onair_time + ((acked_length > 0) ? acked_length : length) * _tdma_client_vars.byte_onair_time;
+        // otherwise, leave it in the queue for the next slot
+        if (elapsed_us + tx_time >= _tdma_client_vars.tx_train_max_us) {
+            packets_left += rb->count;
+            continue;
         }
-        // Compute if there is still time to send the packet [in microseconds]
-        uint16_t tx_time = RADIO_TX_RAMP_UP_TIME + length * _tdma_client_vars.byte_onair_time;
-        // If there is time to send the packet, send it
-        if (db_timer_hf_now(TDMA_CLIENT_TIMER_HF) + tx_time - start_tx_slot < max_tx_duration_us) {
 
-            // disable the radio, before sending.
+        // retrieve the oldest packet from the queue
+        db_packet_queue_pop(rb);
+#if TDMA_CLIENT_ACKED_PRIORITIES
+        length = _tx_sequence(packet, length);
+#endif
+        _tdma_client_vars.tx_train_end_ts = start_ts + RADIO_TX_RAMP_UP_TIME + _tdma_client_vars.overhead_onair_time + length * _tdma_client_vars.byte_onair_time;
+        return length;
+    }
+
+    // Let the gateway know the slot was too short, once per slot
+    if (packets_left == 0 || !_tdma_client_vars.tx_demand_due) {
+        return 0;
+    }
+    _tdma_client_vars.tx_demand_due = false;
+    uint8_t length                  = _tx_demand_message(packet, start_ts);
+    if (length > 0) {
+        _tdma_client_vars.tx_train_end_ts = start_ts + RADIO_TX_RAMP_UP_TIME + _tdma_client_vars.overhead_onair_time + length * _tdma_client_vars.byte_onair_time;
+    }
+    return length;
+}
+
+static void _message_rb_tx_fill(void) {
+    uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH];
+    while (_tdma_client_vars.tx_in_flight < 2) {
+        uint8_t length = _message_rb_next(packet);
+        if (length == 0) {
+            return;
+        }
+        // The packet is queued behind the one on air, or starts the train once RX is switched off
+        _tdma_client_vars.tx_in_flight++;
+        if (!db_radio_tx_async(packet, length, &_message_rb_tx_next)) {
             db_radio_disable();
-            db_radio_tx(packet, length);
-            packet_sent_flag = true;
-        } else {  // otherwise, put the packet back in the queue and leave
+            if (!db_radio_tx_async(packet, length, &_message_rb_tx_next)) {
+                _tdma_client_vars.tx_in_flight--;
+                return;
+            }
+        }
+    }
+}
 
-            _message_rb_add(&_tdma_client_vars.tx_ring_buffer, packet, length);
-            break;
+static void _message_rb_tx_next(void) {
+    // The timer interrupts also hand packets to the radio and switch it off, keep them away while the train is refilled
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (_tdma_client_vars.tx_in_flight > 0) {
+        _tdma_client_vars.tx_in_flight--;
+    }
+    _message_rb_tx_fill();
+
+    // The radio listens after sending, in low-power mode switch it off until the next receive window
+    if (_tdma_client_vars.tx_in_flight == 0 && !_radio_listening()) {
+        db_radio_disable();
+    }
+    __set_PRIMASK(primask);
+}
+
+static uint32_t _tx_start_ts(void) {
+    uint32_t now = db_timer_hf_now(TDMA_CLIENT_TIMER_HF);
+    if (_tdma_client_vars.tx_in_flight > 0 && (int32_t)(_tdma_client_vars.tx_train_end_ts - now) > 0) {
+        return _tdma_client_vars.tx_train_end_ts;
+    }
+    return now;
+}
+
+static void _client_tx(size_t length) {
+    // The packet takes its place in the train now, the packets queued after it count with its airtime
+    _tdma_client_vars.tx_train_end_ts = _tx_start_ts() + RADIO_TX_RAMP_UP_TIME + _tdma_client_vars.overhead_onair_time + length * _tdma_client_vars.byte_onair_time;
+    db_packet_queue_push(&_tdma_client_vars.tx_control, _tdma_client_vars.radio_buffer, length);
+    _message_rb_tx_fill();
+}
+
+static uint8_t _acked_length(const uint8_t *packet, uint8_t length) {
+
+    if (length < sizeof(protocol_header_t) || !_tdma_client_vars.gateway_heard) {
+        return 0;
+    }
+    const protocol_header_t *header = (const protocol_header_t *)packet;
+
+    // The packets sent again already carry their sequence number
+    if (header->packet_type == DB_PACKET_TDMA_DATA) {
+        return length;
+    }
+    if (!(TDMA_CLIENT_ACKED_PRIORITIES & (1 << db_protocol_packet_priority(packet, length))) || header->packet_type != DB_PACKET_DATA || length + sizeof(protocol_tdma_data_t) > DB_BLE_PAYLOAD_MAX_LENGTH) {
+        return 0;
+    }
+    return length + sizeof(protocol_tdma_data_t);
+}
+
+#if TDMA_CLIENT_ACKED_PRIORITIES
+static uint8_t _tx_sequence(uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t length) {
+
+    if (_acked_length(packet, length) == 0) {
+        return length;
+    }
+
+    // Number the new packets in the order they are sent, the packets sent again keep their sequence number
+    protocol_header_t *header = (protocol_header_t *)packet;
+    if (header->packet_type == DB_PACKET_DATA) {
+        protocol_tdma_data_t data = {
+            .seq     = _tdma_client_vars.tx_seq++,
+            .retries = 0,
+        };
+        memmove(packet + sizeof(protocol_header_t) + sizeof(protocol_tdma_data_t), packet + sizeof(protocol_header_t), length - sizeof(protocol_header_t));
+        memcpy(packet + sizeof(protocol_header_t), &data, sizeof(protocol_tdma_data_t));
+        header->packet_type = DB_PACKET_TDMA_DATA;
+        length += sizeof(protocol_tdma_data_t);
+    }
+
+    // Keep a copy of the packet until it is acknowledged, the oldest copies are dropped if the buffer is full
+    db_packet_queue_push(&_tdma_client_vars.unacked, packet, length);
+    return length;
+}
+
+static void _unacked_check(const db_block_ack_t *ack) {
+
+    uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH];
+
+    // Each packet is looked at once, those still waiting go back to the end of the buffer
+    for (uint16_t pending = _tdma_client_vars.unacked.count; pending > 0; pending--) {
+        uint8_t length = db_packet_queue_peek(&_tdma_client_vars.unacked, packet);
+        db_packet_queue_pop(&_tdma_client_vars.unacked);
+        protocol_tdma_data_t data;
+        memcpy(&data, packet + sizeof(protocol_header_t), sizeof(protocol_tdma_data_t));
+
+        // The gateway acknowledges the packets of a slot before the next one, without it the packet or the acknowledgement was lost
+        db_block_ack_status_t status = (ack == NULL) ? DB_BLOCK_ACK_LOST : db_block_ack_status(ack, data.seq);
+        if (status == DB_BLOCK_ACK_PENDING) {
+            db_packet_queue_push(&_tdma_client_vars.unacked, packet, length);
+            continue;
+        }
+
+        // Send the lost packets again from the ring buffer of their traffic class, unless they were sent too often
+        if (status == DB_BLOCK_ACK_LOST && data.retries < TDMA_CLIENT_MAX_RETRIES) {
+            data.retries++;
+            memcpy(packet + sizeof(protocol_header_t), &data, sizeof(protocol_tdma_data_t));
+            db_packet_queue_push(&_tdma_client_vars.tx_ring_buffer[db_protocol_packet_priority(packet, length)], packet, length);
         }
     }
-    // Update the last packet timer
-    _tdma_client_vars.last_tx_packet_timestamp = start_tx_slot;
+}
+#endif
 
-    // renable the Radio RX
-    if (_tdma_client_vars.rx_flag == DB_TDMA_CLIENT_RX_ON) {
-        db_radio_rx();
+static void _rx_tdma_data(uint8_t *packet, uint8_t length) {
+
+    if (length < sizeof(protocol_header_t) + sizeof(protocol_tdma_data_t)) {
+        return;
+    }
+    protocol_tdma_data_t data;
+    memcpy(&data, packet + sizeof(protocol_header_t), sizeof(protocol_tdma_data_t));
+
+    // Acknowledge the packets of the gateway in the next slot, even if already received: the acknowledgement was lost
+    protocol_header_t *header = (protocol_header_t *)packet;
+    if (header->src == _tdma_client_vars.gateway_id && _tdma_client_vars.registration_flag == DB_TDMA_CLIENT_REGISTERED) {
+        _tdma_client_vars.ack_due = true;
+        if (!db_block_ack_rx(&_tdma_client_vars.rx_data_window, data.seq, data.retries > 0)) {
+            return;
+        }
     }
 
-    return packet_sent_flag;
+    // Remove the sequence number
+    memmove(packet + sizeof(protocol_header_t), packet + sizeof(protocol_header_t) + sizeof(protocol_tdma_data_t), length - sizeof(protocol_header_t) - sizeof(protocol_tdma_data_t));
+    header->packet_type = DB_PACKET_DATA;
+    if (_tdma_client_vars.callback) {
+        _tdma_client_vars.callback(packet, length - sizeof(protocol_tdma_data_t));
+    }
+}
+
+static void _tx_ack_message(void) {
+
+    protocol_tdma_ack_t record = {
+        .src    = _tdma_client_vars.gateway_id,
+        .seq    = _tdma_client_vars.rx_data_window.seq,
+        .bitmap = _tdma_client_vars.rx_data_window.bitmap,
+    };
+    size_t length = db_protocol_tdma_ack_to_buffer(_tdma_client_vars.radio_buffer, DB_BROADCAST_ADDRESS);
+    length        = db_protocol_tdma_ack_add(_tdma_client_vars.radio_buffer, length, &record);
+    _client_tx(length);
+    _tdma_client_vars.ack_due = false;
 }
 
 static void _tx_keep_alive_message(void) {
 
-    size_t length = db_protocol_tdma_keep_alive_to_buffer(_tdma_client_vars.radio_buffer, DB_BROADCAST_ADDRESS);
-    db_radio_disable();
-    db_radio_tx(_tdma_client_vars.radio_buffer, length);
+    protocol_tdma_keep_alive_t keep_alive = {
+        .flags = DB_PROTOCOL_TDMA_FLAG_AGGREGATE | (_tdma_client_vars.low_power ? DB_PROTOCOL_TDMA_FLAG_LOW_POWER : 0),
+    };
+    size_t length = db_protocol_tdma_keep_alive_to_buffer(_tdma_client_vars.radio_buffer, DB_BROADCAST_ADDRESS, &keep_alive);
+    _client_tx(length);
+}
+
+static uint8_t _tx_demand_message(uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH], uint32_t start_ts) {
+
+    // The queues store one length byte per packet
+    uint16_t packets = 0;
+    uint16_t bytes   = 0;
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        packets += _tdma_client_vars.tx_ring_buffer[priority].count;
+        bytes += _tdma_client_vars.tx_ring_buffer[priority].used - _tdma_client_vars.tx_ring_buffer[priority].count;
+    }
+    protocol_tdma_demand_t demand = {
+        .queued_packets = (packets > UINT8_MAX) ? UINT8_MAX : packets,
+        .queued_bytes   = bytes,
+    };
+
+    // Only send the report if it fits in what is left of the slot
+    uint16_t tx_time = RADIO_TX_RAMP_UP_TIME + _tdma_client_vars.overhead_onair_time + (sizeof(protocol_header_t) + sizeof(protocol_tdma_demand_t)) * _tdma_client_vars.byte_onair_time;
+    if (start_ts + tx_time - _tdma_client_vars.tx_train_start_ts >= _tdma_client_vars.tx_train_max_us) {
+        return 0;
+    }
+
+    return db_protocol_tdma_demand_to_buffer(packet, DB_BROADCAST_ADDRESS, &demand);
+}
+
+static void _tx_slot_at(uint32_t timestamp) {
+
+    int32_t delay                = (int32_t)(timestamp - db_timer_hf_now(TDMA_CLIENT_TIMER_HF));
+    _tdma_client_vars.tx_slot_ts = timestamp;
+    db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_TX, (delay > 0) ? delay : 1, &timer_tx_interrupt);
+}
+
+static bool _low_power_active(void) {
+    return _tdma_client_vars.low_power_granted && _tdma_client_vars.registration_flag == DB_TDMA_CLIENT_REGISTERED;
+}
+
+static void _low_power_window_at(uint32_t timestamp, tdma_client_window_t window) {
+
+    int32_t delay                = (int32_t)(timestamp - db_timer_hf_now(TDMA_CLIENT_TIMER_HF));
+    _tdma_client_vars.rx_window = window;
+    db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_RX, (delay > 0) ? delay : 1, &timer_rx_interrupt);
+}
+
+static void _low_power_window_next(void) {
+
+    const tdma_client_table_t *table = &_tdma_client_vars.tdma_client_table;
+    uint32_t                   guard = TDMA_CLIENT_LOW_POWER_GUARD_US + 2 * _tdma_client_vars.sync_error_us;
+
+    switch (_tdma_client_vars.rx_window) {
+        case TDMA_CLIENT_WINDOW_SYNC_OPEN:
+            // Predict the start of the frame from the drift of the clock, the sync frame corrects it
+            _tdma_client_vars.frame_start_ts += db_clock_drift_local_duration(&_tdma_client_vars.clock_drift, table->frame_duration);
+            _tdma_client_vars.sync_received = false;
+            if (_next_table_reached(_tdma_client_vars.frame_start_ts)) {
+                _next_table_apply();
+            }
+            if (_tdma_client_vars.frames_since_sync < UINT8_MAX) {
+                _tdma_client_vars.frames_since_sync++;
+            }
+            if (_tdma_client_vars.hopping) {
+                _hop_next();
+            }
+            db_radio_rx();
+            _low_power_window_at(_tdma_client_vars.frame_start_ts + table->rx_duration + guard, TDMA_CLIENT_WINDOW_SYNC_CLOSE);
+            break;
+        case TDMA_CLIENT_WINDOW_SYNC_CLOSE:
+            // The frame changed length or the sync frame was lost, listen until the next one
+            if (!_tdma_client_vars.sync_received && _tdma_client_vars.frames_since_sync >= _tdma_client_vars.sync_period) {
+                _tdma_client_vars.rx_window = TDMA_CLIENT_WINDOW_NONE;
+                db_radio_rx();
+                if (_tdma_client_vars.hopping) {
+                    _hop_next();
+                }
+                break;
+            }
+            _radio_off();
+            if (table->rx_start > 0) {
+                _low_power_window_at(_tdma_client_vars.frame_start_ts + table->rx_start - guard, TDMA_CLIENT_WINDOW_DOWNLINK_OPEN);
+            } else {
+                _low_power_window_at(_tdma_client_vars.frame_start_ts + table->frame_duration - guard, TDMA_CLIENT_WINDOW_SYNC_OPEN);
+            }
+            break;
+        case TDMA_CLIENT_WINDOW_DOWNLINK_OPEN:
+            db_radio_rx();
+            _low_power_window_at(_tdma_client_vars.frame_start_ts + table->rx_start + table->rx_duration + guard, TDMA_CLIENT_WINDOW_DOWNLINK_CLOSE);
+            break;
+        case TDMA_CLIENT_WINDOW_DOWNLINK_CLOSE:
+            _radio_off();
+            _low_power_window_at(_tdma_client_vars.frame_start_ts + table->frame_duration - guard, TDMA_CLIENT_WINDOW_SYNC_OPEN);
+            break;
+        case TDMA_CLIENT_WINDOW_NONE:
+            db_radio_rx();
+            break;
+    }
 }
 
-static void _tx_tdma_register_message(void) {
+static bool _radio_listening(void) {
+    return !(_low_power_active() && (_tdma_client_vars.rx_window == TDMA_CLIENT_WINDOW_SYNC_OPEN || _tdma_client_vars.rx_window == TDMA_CLIENT_WINDOW_DOWNLINK_OPEN));
+}
 
-    size_t length = db_protocol_tdma_keep_alive_to_buffer(_tdma_client_vars.radio_buffer, DB_BROADCAST_ADDRESS);
+static void _radio_off(void) {
+    // The packet train switches the radio off once sent, if the receiver doesn't listen by then
+    if (_tdma_client_vars.tx_in_flight == 0) {
+        db_radio_disable();
+    }
+}
+
+static bool _gateway_lost(void) {
+    return _tdma_client_vars.scanning || (_tdma_client_vars.hopping && _tdma_client_vars.hop_frames_since_sync > TDMA_CLIENT_HOP_LOST_SYNC_PERIODS * _tdma_client_vars.sync_period);
+}
+
+static bool _rx_timer_free(void) {
+    return !_low_power_active() || _tdma_client_vars.rx_window == TDMA_CLIENT_WINDOW_NONE;
+}
+
+static void _hop_retune(uint8_t channel) {
+    // The packet train left on air is cut
     db_radio_disable();
-    db_radio_tx(_tdma_client_vars.radio_buffer, length);
+    _tdma_client_vars.tx_in_flight = 0;
+    db_packet_queue_clear(&_tdma_client_vars.tx_control);
+    db_radio_set_channel(channel);
+    if (_radio_listening()) {
+        db_radio_rx();
+    }
+}
+
+static void _hop_next(void) {
+
+    uint32_t frame_duration = db_clock_drift_local_duration(&_tdma_client_vars.clock_drift, _tdma_client_vars.tdma_client_table.frame_duration);
+    uint32_t guard          = TDMA_CLIENT_LOW_POWER_GUARD_US + 2 * _tdma_client_vars.sync_error_us;
+
+    // Once registered, change channel at the start of the join slots, the DotBot still hears the next sync frame if it missed a shorter frame duration
+    if (_tdma_client_vars.registration_flag == DB_TDMA_CLIENT_REGISTERED && _tdma_client_vars.hop_margin > guard) {
+        guard = _tdma_client_vars.hop_margin;
+    }
+
+    // Catch up with the frames started since the last change, the timer may fire late or before its time
+    bool new_frame = false;
+    while ((int32_t)(db_timer_hf_now(TDMA_CLIENT_TIMER_HF) - (_tdma_client_vars.hop_frame_ts + frame_duration - guard)) >= 0) {
+        _tdma_client_vars.hop_frame_ts += frame_duration;
+        _tdma_client_vars.hop_frame++;
+        _tdma_client_vars.hop_frames_since_sync++;
+        new_frame = true;
+    }
+
+    // The DotBot lost track of the gateway, for instance it missed the sync frame of a new frame duration. The gateway
+    // visits each channel of the sequence once every 37 frames, unless it blacklisted it since, so the DotBot waits
+    // on a channel for 37 sync periods before moving to the next one.
+    uint32_t lost_frames = TDMA_CLIENT_HOP_LOST_SYNC_PERIODS * _tdma_client_vars.sync_period;
+    uint32_t wait_frames = DB_CHANNEL_HOP_CHANNELS * _tdma_client_vars.sync_period;
+    if (_tdma_client_vars.hop_frames_since_sync <= lost_frames) {
+        if (new_frame) {
+            _hop_retune(db_channel_hop_channel(&_tdma_client_vars.hop, _tdma_client_vars.hop_frame));
+        }
+    } else if (TDMA_CLIENT_SCAN_DWELL_US > 0) {
+        _tdma_client_vars.hopping  = false;
+        _tdma_client_vars.scanning = true;
+        _scan_next();
+        return;
+    } else if (new_frame && (_tdma_client_vars.hop_frames_since_sync - lost_frames - 1) % wait_frames == 0) {
+        uint32_t wait = (_tdma_client_vars.hop_frames_since_sync - lost_frames - 1) / wait_frames;
+        _hop_retune(_tdma_client_vars.hop.used[(_tdma_client_vars.hop_frame + wait) % _tdma_client_vars.hop.used_count]);
+    }
+
+    // In low-power mode the receive windows change channel at the start of the frame
+    if (_rx_timer_free()) {
+        int32_t delay = (int32_t)(_tdma_client_vars.hop_frame_ts + frame_duration - guard - db_timer_hf_now(TDMA_CLIENT_TIMER_HF));
+        db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_RX, (delay > 0) ? delay : 1, &timer_rx_interrupt);
+    }
+}
+
+static void _scan_next(void) {
+    // Pick the channels at random, going through them in order may keep pace with the gateway and never meet it
+    uint8_t random_value;
+    db_rng_read(&random_value);
+    _hop_retune(random_value % DB_CHANNEL_HOP_CHANNELS);
+    if (_rx_timer_free()) {
+        db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_RX, TDMA_CLIENT_SCAN_DWELL_US, &timer_rx_interrupt);
+    }
+}
+
+static void _join_slot_next(void) {
+
+    uint32_t next_join_ts = _tdma_client_vars.tx_slot_ts + db_clock_drift_local_duration(&_tdma_client_vars.clock_drift, _tdma_client_vars.tdma_client_table.frame_duration);
+
+    // In the join slot picked: send the join request, the gateway answers with the TDMA table
+    if (_tdma_client_vars.join_request_due) {
+        _tdma_client_vars.join_request_due = false;
+        _tx_keep_alive_message();
+        _tdma_client_vars.last_tx_packet_timestamp = db_timer_hf_now(TDMA_CLIENT_TIMER_HF);
+        _tdma_client_vars.join_timeout             = 1;
+        _tdma_client_vars.join_request_slot        = _tdma_client_vars.join_backoff;
+        _tdma_client_vars.join_feedback_due        = true;
+        _tx_slot_at(next_join_ts);
+        return;
+    }
+
+    // Start of the join slots, the answer of the sync frame is stale by now
+    _tdma_client_vars.join_feedback_due = false;
+
+    // Without the table update the request collided or the gateway had no room left, try again
+    if (_tdma_client_vars.join_timeout > 0) {
+        _tdma_client_vars.join_timeout--;
+        if (_tdma_client_vars.join_timeout > 0) {
+            _tx_slot_at(next_join_ts);
+            return;
+        }
+        _join_backoff();
+    }
+
+    // The join slots only move in a frame that starts with a sync frame, skip the frames where it was lost
+    bool synced = _tdma_client_vars.frames_since_sync < _tdma_client_vars.sync_period;
+    if (_tdma_client_vars.frames_since_sync < UINT8_MAX) {
+        _tdma_client_vars.frames_since_sync++;
+    }
+    if (!synced || _tdma_client_vars.join_backoff >= _tdma_client_vars.join_slots) {
+        if (synced) {
+            _tdma_client_vars.join_backoff -= _tdma_client_vars.join_slots;
+        }
+        _tx_slot_at(next_join_ts);
+        return;
+    }
+
+    // Wait for the join slot picked, it is a single timer step away
+    uint32_t join_slot_ts              = _tdma_client_vars.tx_slot_ts + db_clock_drift_local_duration(&_tdma_client_vars.clock_drift, _tdma_client_vars.join_backoff * _tdma_client_vars.join_slot_duration);
+    int32_t  delay                     = (int32_t)(join_slot_ts - db_timer_hf_now(TDMA_CLIENT_TIMER_HF));
+    _tdma_client_vars.join_request_due = true;
+    db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_TX, (delay > 0) ? delay : 1, &timer_tx_interrupt);
+}
+
+static void _join_backoff(void) {
+    _tdma_client_vars.join_timeout = 0;
+
+    // Without the estimate of the gateway, binary exponential backoff: double the window after each failed join request
+    if (!_tdma_client_vars.join_window_announced && _tdma_client_vars.join_window < TDMA_CLIENT_JOIN_MAX_WINDOW) {
+        _tdma_client_vars.join_window = (2 * _tdma_client_vars.join_window < TDMA_CLIENT_JOIN_MAX_WINDOW) ? 2 * _tdma_client_vars.join_window : TDMA_CLIENT_JOIN_MAX_WINDOW;
+    }
+    _tdma_client_vars.join_backoff = _get_random_backoff(_tdma_client_vars.join_window);
 }
 
 static uint32_t _get_random_delay_us(void) {
@@ -334,6 +1039,15 @@ static uint32_t _get_random_delay_us(void) {
     return 100000 + (random_value >> 2) * 1000;
 }
 
+static uint16_t _get_random_backoff(uint16_t window) {
+
+    uint8_t random_low;
+    uint8_t random_high;
+    db_rng_read(&random_low);
+    db_rng_read(&random_high);
+    return ((random_high << 8) | random_low) % window;
+}
+
 //=========================== interrupt handlers ===============================
 
 /**
@@ -345,8 +1059,13 @@ static uint32_t _get_random_delay_us(void) {
  *
  * @param[in]   packet    pointer to the data array with the data packet
  * @param[in]   length    length of the packet received trough the radio
+ * @param[in]   metadata  reception metadata of the packet, packets with an invalid CRC are ignored
  */
-static void tdma_client_callback(uint8_t *packet, uint8_t length) {
+static void tdma_client_callback(uint8_t *packet, uint8_t length, const db_radio_rx_metadata_t *metadata) {
+
+    if (!metadata->crc_ok) {
+        return;
+    }
 
     uint8_t           *ptk_ptr = packet;
     protocol_header_t *header  = (protocol_header_t *)ptk_ptr;
@@ -369,62 +1088,203 @@ static void tdma_client_callback(uint8_t *packet, uint8_t length) {
         case DB_PACKET_TDMA_UPDATE_TABLE:
         {
             // Get the payload
-            uint8_t              *cmd_ptr = ptk_ptr + sizeof(protocol_header_t);
-            protocol_tdma_table_t tdma_table;
-            memcpy(&tdma_table, cmd_ptr, sizeof(protocol_tdma_table_t));
+            // Get the payload, the gateways without low-power mode send a table without flags
+            uint8_t              *cmd_ptr    = ptk_ptr + sizeof(protocol_header_t);
+            protocol_tdma_table_t tdma_table = { 0 };
+            size_t                copy       = length - sizeof(protocol_header_t);
+            memcpy(&tdma_table, cmd_ptr, (copy < sizeof(protocol_tdma_table_t)) ? copy : sizeof(protocol_tdma_table_t));
             const uint32_t next_period_start = tdma_table.next_period_start;
 
-            // Update the TDMA table
+            // The table of the next layout waits for the frame announced by the sync frames, the DotBot keeps its slots until then
+            if (tdma_table.flags & DB_PROTOCOL_TDMA_FLAG_NEXT_TABLE) {
+                if (_tdma_client_vars.registration_flag == DB_TDMA_CLIENT_REGISTERED) {
+                    _tdma_client_vars.next_table     = tdma_table;
+                    _tdma_client_vars.next_table_due = true;
+                }
+                break;
+            }
+
+            // Update the TDMA table, it replaces a next table not switched to yet
             _protocol_tdma_set_table(&tdma_table);
+            _tdma_client_vars.next_table_due       = false;
+            _tdma_client_vars.next_table_announced = false;
 
-            // Set the DotBot as registered
+            // Set the DotBot as registered, the table update answers its join request
             if (_tdma_client_vars.registration_flag == DB_TDMA_CLIENT_UNREGISTERED) {
                 _tdma_client_vars.registration_flag = DB_TDMA_CLIENT_REGISTERED;
+                _tdma_client_vars.join_request_due  = false;
+                _tdma_client_vars.join_timeout      = 0;
+                _tdma_client_vars.join_window       = 0;
             }
 
             // Update the state machine
             _tdma_client_vars.rx_flag = DB_TDMA_CLIENT_RX_WAIT;
 
             // Update the timer interrupts
-            db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_TX, next_period_start + _tdma_client_vars.tdma_client_table.tx_start, &timer_tx_interrupt);
-            db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_RX, next_period_start + _tdma_client_vars.tdma_client_table.rx_start, &timer_rx_interrupt);
+            _tx_slot_at(db_timer_hf_now(TDMA_CLIENT_TIMER_HF) + db_clock_drift_local_duration(&_tdma_client_vars.clock_drift, next_period_start + _tdma_client_vars.tdma_client_table.tx_start));
+            if (_low_power_active()) {
+                // In low-power mode, the receive windows start from the next sync frame
+                _tdma_client_vars.rx_window = TDMA_CLIENT_WINDOW_NONE;
+                db_radio_rx();
+            } else {
+                db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_RX, next_period_start + _tdma_client_vars.tdma_client_table.rx_start, &timer_rx_interrupt);
+            }
+            // The receiver stays on, it keeps changing channel with each frame
+            if (_tdma_client_vars.hopping) {
+                _hop_next();
+            }
 
         } break;
 
         case DB_PACKET_TDMA_SYNC_FRAME:
         {
-            // There is no payload for this packet
-            // Only resync the timer if the DotBot has already been registered.
-            if (_tdma_client_vars.registration_flag == DB_TDMA_CLIENT_REGISTERED) {
-
-                // Calculate delay caused by the transmission of the Sync frame by the server
-                uint16_t tx_time = RADIO_TX_RAMP_UP_TIME + (sizeof(protocol_header_t) + sizeof(protocol_sync_frame_t)) * _tdma_client_vars.byte_onair_time;
-
-                // Update the timer interrupts
-                db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_TX, _tdma_client_vars.tdma_client_table.tx_start - tx_time, &timer_tx_interrupt);
-                db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_RX, _tdma_client_vars.tdma_client_table.rx_start - tx_time, &timer_rx_interrupt);
-
-                // Update the frame period
-                uint8_t              *cmd_ptr = ptk_ptr + sizeof(protocol_header_t);
-                protocol_sync_frame_t sync_frame;
-                memcpy(&sync_frame, cmd_ptr, sizeof(protocol_sync_frame_t));
-                uint32_t frame_period = sync_frame.frame_period;
-
-                // Protect against receiving garbage
-                if (frame_period > 0 && frame_period < 500000) {
-                    _tdma_client_vars.tdma_client_table.frame_duration = frame_period;
-                    // Also update the RX_duration, because we are working on ALWAYS_ON mode
+            // Get the payload, the gateways without drift estimation only send the frame period, and the gateways without contention slots no join slots
+            uint8_t              *cmd_ptr    = ptk_ptr + sizeof(protocol_header_t);
+            protocol_sync_frame_t sync_frame = { 0 };
+            size_t                copy       = length - sizeof(protocol_header_t);
+            memcpy(&sync_frame, cmd_ptr, (copy < sizeof(protocol_sync_frame_t)) ? copy : sizeof(protocol_sync_frame_t));
+            uint32_t frame_period = sync_frame.frame_period;
+
+            // Only the acknowledged data packets sent by this gateway get a block acknowledgement
+            _tdma_client_vars.gateway_id = header->src;
+
+            // The gateway starts sending the sync frame at the time in its payload, the line fitted over
+            // the last sync frames converts the times of the gateway clock to the DotBot clock
+            uint32_t sync_ts = metadata->timestamp - _tdma_client_vars.address_time;
+            uint32_t frame_start_ts;
+            if (copy >= offsetof(protocol_sync_frame_t, join_slot_duration)) {
+                db_clock_drift_add(&_tdma_client_vars.clock_drift, sync_frame.timestamp, sync_ts);
+                frame_start_ts                = db_clock_drift_local_time(&_tdma_client_vars.clock_drift, sync_frame.timestamp - sync_frame.frame_offset);
+                _tdma_client_vars.sync_period = (sync_frame.sync_period > 0) ? sync_frame.sync_period : 1;
+            } else {
+                frame_start_ts                = sync_ts;
+                _tdma_client_vars.sync_period = 1;
+            }
+
+            // Switch to the next table at the frame announced, every sync frame until then repeats the announce
+            if (_tdma_client_vars.next_table_due && copy >= offsetof(protocol_sync_frame_t, join_window) && sync_frame.table_switch > 0) {
+                _tdma_client_vars.next_table_ts        = frame_start_ts + db_clock_drift_local_duration(&_tdma_client_vars.clock_drift, sync_frame.table_switch * frame_period);
+                _tdma_client_vars.next_table_announced = true;
+            }
+            if (_next_table_reached(frame_start_ts)) {
+                _next_table_apply();
+            }
+
+            // Protect against receiving garbage
+            if (frame_period > 0 && frame_period < TDMA_CLIENT_MAX_FRAME_DURATION) {
+                _tdma_client_vars.tdma_client_table.frame_duration = frame_period;
+                // Also update the RX_duration, because we are working on ALWAYS_ON mode
+                if (!_low_power_active()) {
                     _tdma_client_vars.tdma_client_table.rx_duration = frame_period;
                 }
+            }
 
-                // Also update the RX_duration, because we are working on ALWAYS_ON mode
+            // Follow the channel hopping of the gateway from this frame on, the gateways that don't hop stay on the channel of the sync frame
+            _tdma_client_vars.scanning = false;
+            if (copy >= offsetof(protocol_sync_frame_t, table_switch) && sync_frame.hop_seed != 0) {
+                uint64_t channel_map = 0;
+                memcpy(&channel_map, sync_frame.channel_map, sizeof(sync_frame.channel_map));
+                if (!_tdma_client_vars.hopping || _tdma_client_vars.hop.seed != sync_frame.hop_seed) {
+                    db_channel_hop_init(&_tdma_client_vars.hop, sync_frame.hop_seed, channel_map);
+                } else {
+                    db_channel_hop_set_map(&_tdma_client_vars.hop, channel_map);
+                }
+                _tdma_client_vars.hopping               = true;
+                _tdma_client_vars.hop_frame             = sync_frame.hop_frame;
+                _tdma_client_vars.hop_frame_ts          = frame_start_ts;
+                _tdma_client_vars.hop_margin            = db_clock_drift_local_duration(&_tdma_client_vars.clock_drift, sync_frame.join_slots * sync_frame.join_slot_duration);
+                _tdma_client_vars.hop_frames_since_sync = 0;
+            } else {
+                _tdma_client_vars.hopping = false;
+            }
+
+            // Before joining, the DotBot sends its join requests in the join slots of the frames, if the gateway has some
+            if (_tdma_client_vars.registration_flag == DB_TDMA_CLIENT_UNREGISTERED) {
+                if (_tdma_client_vars.hopping) {
+                    _hop_next();
+                }
+                _tdma_client_vars.gateway_heard     = true;
+                _tdma_client_vars.join_slots        = (copy >= offsetof(protocol_sync_frame_t, hop_seed)) ? sync_frame.join_slots : 0;
+                _tdma_client_vars.frames_since_sync = 0;
+                _tdma_client_vars.frame_start_ts    = frame_start_ts;
+                if (_tdma_client_vars.join_slots > 0) {
+                    _tdma_client_vars.join_slot_duration = sync_frame.join_slot_duration;
+                    _tdma_client_vars.join_start         = frame_period - _tdma_client_vars.join_slots * _tdma_client_vars.join_slot_duration;
+                    _tdma_client_vars.join_request_due   = false;
+
+                    // The gateway accepted the last join request if it sets its join slot, otherwise it collided.
+                    // The bits of the join slots that do not fit in the join_acked field follow the sync frame.
+                    if (_tdma_client_vars.join_feedback_due) {
+                        _tdma_client_vars.join_feedback_due = false;
+                        uint8_t join_slot                   = _tdma_client_vars.join_request_slot;
+                        bool    acked;
+                        if (join_slot < 8 * sizeof(sync_frame.join_acked)) {
+                            acked = sync_frame.join_acked & (1UL << join_slot);
+                        } else {
+                            size_t acked_byte = sizeof(protocol_sync_frame_t) + (join_slot - 8 * sizeof(sync_frame.join_acked)) / 8;
+                            acked             = acked_byte < copy && (cmd_ptr[acked_byte] & (1 << (join_slot % 8)));
+                        }
+                        if (acked) {
+                            _tdma_client_vars.join_timeout = TDMA_CLIENT_JOIN_TIMEOUT_FRAMES;
+                        } else {
+                            _join_backoff();
+                        }
+                    }
+                    // Spread the join requests over as many join slots as there are DotBots joining, at least a frame of them,
+                    // and pick the join slot again when the gateway changes its estimate. An older gateway doesn't announce it,
+                    // the window starts with a frame of join slots and doubles after each failed join request.
+                    _tdma_client_vars.join_window_announced = copy >= sizeof(protocol_sync_frame_t);
+                    uint16_t window                         = _tdma_client_vars.join_slots;
+                    if (_tdma_client_vars.join_window_announced && sync_frame.join_window > window) {
+                        window = sync_frame.join_window;
+                    } else if (!_tdma_client_vars.join_window_announced && _tdma_client_vars.join_window > window) {
+                        window = _tdma_client_vars.join_window;
+                    }
+                    if (_tdma_client_vars.join_window != window) {
+                        _tdma_client_vars.join_window  = window;
+                        _tdma_client_vars.join_backoff = _get_random_backoff(_tdma_client_vars.join_window);
+                    }
+                    _tx_slot_at(frame_start_ts + db_clock_drift_local_duration(&_tdma_client_vars.clock_drift, _tdma_client_vars.join_start));
+                }
+                break;
+            }
 
+            // Update the timer interrupts
+            _tx_slot_at(frame_start_ts + db_clock_drift_local_duration(&_tdma_client_vars.clock_drift, _tdma_client_vars.tdma_client_table.tx_start));
+            if (!_low_power_active()) {
+                int32_t rx_delay = (int32_t)(frame_start_ts + _tdma_client_vars.tdma_client_table.rx_start - db_timer_hf_now(TDMA_CLIENT_TIMER_HF));
+                db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_RX, (rx_delay > 0) ? rx_delay : 1, &timer_rx_interrupt);
+            }
+
+            if (_low_power_active()) {
+                // Compare with the predicted start of frame, errors of more than half a slot come from a change of the frame length, not from the drift
+                if (_tdma_client_vars.rx_window == TDMA_CLIENT_WINDOW_SYNC_CLOSE && !_tdma_client_vars.sync_received) {
+                    int32_t  error    = (int32_t)(frame_start_ts - _tdma_client_vars.frame_start_ts);
+                    uint32_t error_us = (error < 0) ? -error : error;
+                    if (error_us > _tdma_client_vars.sync_error_us && error_us < _tdma_client_vars.tdma_client_table.rx_duration / 2) {
+                        _tdma_client_vars.sync_error_us = error_us;
+                    } else if (error_us < _tdma_client_vars.sync_error_us) {
+                        _tdma_client_vars.sync_error_us -= (_tdma_client_vars.sync_error_us - error_us) / 8;
+                    }
+                }
+                _tdma_client_vars.sync_received     = true;
+                _tdma_client_vars.frames_since_sync = 0;
+
+                // Listen until the end of the first slot of the frame
+                uint32_t guard = TDMA_CLIENT_LOW_POWER_GUARD_US + 2 * _tdma_client_vars.sync_error_us;
+                db_radio_rx();
+                _low_power_window_at(frame_start_ts + _tdma_client_vars.tdma_client_table.rx_duration + guard, TDMA_CLIENT_WINDOW_SYNC_CLOSE);
+            } else {
                 // update the state machine
                 _tdma_client_vars.rx_flag = DB_TDMA_CLIENT_RX_ON;
 
                 // Enable radio RX
                 db_radio_rx();
             }
+            _tdma_client_vars.frame_start_ts = frame_start_ts;
+            if (_tdma_client_vars.hopping) {
+                _hop_next();
+            }
         } break;
 
         case DB_PACKET_DATA:
@@ -433,6 +1293,52 @@ static void tdma_client_callback(uint8_t *packet, uint8_t length) {
             }
             break;
 
+        case DB_PACKET_TDMA_DATA:
+            _rx_tdma_data(packet, length);
+            break;
+
+        case DB_PACKET_TDMA_ACK:
+#if TDMA_CLIENT_ACKED_PRIORITIES
+            // Drop the packets the gateway acknowledged, and send the lost ones again
+            for (size_t offset = sizeof(protocol_header_t); offset + sizeof(protocol_tdma_ack_t) <= length && header->src == _tdma_client_vars.gateway_id; offset += sizeof(protocol_tdma_ack_t)) {
+                protocol_tdma_ack_t record;
+                memcpy(&record, ptk_ptr + offset, sizeof(protocol_tdma_ack_t));
+                if (record.src == _tdma_client_vars.device_id) {
+                    db_block_ack_t ack = { .seq = record.seq, .bitmap = record.bitmap };
+                    _unacked_check(&ack);
+                }
+            }
+#endif
+            break;
+
+        case DB_PACKET_TDMA_AGGREGATE:
+        case DB_PACKET_TDMA_AGGREGATE_ACKED:
+        {
+            // Pass each data packet addressed to this DotBot to the callback, with its own header
+            size_t offset = sizeof(protocol_header_t);
+            while (offset + sizeof(protocol_tdma_aggregate_record_t) <= length) {
+                protocol_tdma_aggregate_record_t record;
+                memcpy(&record, ptk_ptr + offset, sizeof(protocol_tdma_aggregate_record_t));
+                offset += sizeof(protocol_tdma_aggregate_record_t);
+                if (offset + record.length > length) {
+                    break;
+                }
+                if ((record.dst == DB_BROADCAST_ADDRESS || record.dst == _tdma_client_vars.device_id) && _tdma_client_vars.callback) {
+                    protocol_header_t *data_header = (protocol_header_t *)_tdma_client_vars.rx_packet;
+                    memcpy(data_header, header, sizeof(protocol_header_t));
+                    data_header->packet_type = (header->packet_type == DB_PACKET_TDMA_AGGREGATE_ACKED) ? DB_PACKET_TDMA_DATA : DB_PACKET_DATA;
+                    data_header->dst         = record.dst;
+                    memcpy(_tdma_client_vars.rx_packet + sizeof(protocol_header_t), ptk_ptr + offset, record.length);
+                    if (data_header->packet_type == DB_PACKET_TDMA_DATA) {
+                        _rx_tdma_data(_tdma_client_vars.rx_packet, sizeof(protocol_header_t) + record.length);
+                    } else {
+                        _tdma_client_vars.callback(_tdma_client_vars.rx_packet, sizeof(protocol_header_t) + record.length);
+                    }
+                }
+                offset += record.length;
+            }
+        } break;
+
         // This is not a valid packet, ignore it
         default:
             break;
@@ -450,11 +1356,48 @@ static void timer_tx_interrupt(void) {
     // Check the state of the device.
     if (_tdma_client_vars.registration_flag == DB_TDMA_CLIENT_REGISTERED) {
 
-        // Prepare right now the next timer interruption
-        db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_TX, _tdma_client_vars.tdma_client_table.frame_duration, &timer_tx_interrupt);
+        // This slot is the first one of the next table if the sync frame of the switch was lost
+        if (_next_table_reached(_tdma_client_vars.tx_slot_ts)) {
+            _next_table_apply();
+        }
+
+        // Prepare right now the next timer interruption, one frame after the start of this slot on the gateway clock,
+        // or in the slots of the next table in the frame of the switch
+        uint32_t frame_duration = db_clock_drift_local_duration(&_tdma_client_vars.clock_drift, _tdma_client_vars.tdma_client_table.frame_duration);
+        uint32_t next_tx_slot   = _tdma_client_vars.tx_slot_ts + frame_duration;
+        if (_next_table_reached(next_tx_slot)) {
+            next_tx_slot = _tdma_client_vars.next_table_ts + db_clock_drift_local_duration(&_tdma_client_vars.clock_drift, _tdma_client_vars.next_table.tx_start);
+        }
+        while ((int32_t)(next_tx_slot - db_timer_hf_now(TDMA_CLIENT_TIMER_HF)) <= 0) {
+            next_tx_slot += frame_duration;
+        }
+        _tx_slot_at(next_tx_slot);
+
+        // The slot may belong to another DotBot by now, keep the packets until the gateway is heard again
+        if (_gateway_lost()) {
+            return;
+        }
+
+        // Tell the gateway first if the DotBot wants to switch to or from low-power mode
+        uint32_t start_tx_slot = db_timer_hf_now(TDMA_CLIENT_TIMER_HF);
+        if (_tdma_client_vars.low_power_request) {
+            _tx_keep_alive_message();
+            _tdma_client_vars.low_power_request        = false;
+            _tdma_client_vars.last_tx_packet_timestamp = db_timer_hf_now(TDMA_CLIENT_TIMER_HF);
+        }
+
+        // Acknowledge the data packets received from the gateway since the last slot
+        if (_tdma_client_vars.ack_due) {
+            _tx_ack_message();
+            _tdma_client_vars.last_tx_packet_timestamp = db_timer_hf_now(TDMA_CLIENT_TIMER_HF);
+        }
+#if TDMA_CLIENT_ACKED_PRIORITIES
+        // The packets the gateway didn't acknowledge since the last slot were lost, or their acknowledgement was
+        _unacked_check(NULL);
+#endif
 
         // send messages if available
-        packet_sent = _message_rb_tx_queue(_tdma_client_vars.tdma_client_table.tx_duration);
+        packet_sent = _message_rb_tx_queue(_tdma_client_vars.tdma_client_table.tx_duration - (db_timer_hf_now(TDMA_CLIENT_TIMER_HF) - start_tx_slot));
 
         // if no packet has been sent for a while, send a keep_alive ping to maintain the connection.
         if (!packet_sent) {
@@ -465,16 +1408,26 @@ static void timer_tx_interrupt(void) {
                 _tdma_client_vars.last_tx_packet_timestamp = db_timer_hf_now(TDMA_CLIENT_TIMER_HF);
             }
         }
+
+        // The radio listens after sending, in low-power mode switch it off until the next receive window
+        if (!_radio_listening()) {
+            _radio_off();
+        }
+    } else if (_tdma_client_vars.join_slots > 0) {  // Device is unregistered, the gateway has join slots
+
+        _join_slot_next();
     } else {  // Device is unregistered
 
         // Prepare right now the next timer interruption.
         uint32_t delay_time = _get_random_delay_us();
         db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_TX, delay_time, &timer_tx_interrupt);
 
-        // Try to register with the TDMA server
-        _tx_tdma_register_message();
-        // Save the timestamp of the last packet
-        _tdma_client_vars.last_tx_packet_timestamp = db_timer_hf_now(TDMA_CLIENT_TIMER_HF);
+        // Try to register with the TDMA server, once it was heard
+        if (_tdma_client_vars.gateway_heard) {
+            _tx_keep_alive_message();
+            // Save the timestamp of the last packet
+            _tdma_client_vars.last_tx_packet_timestamp = db_timer_hf_now(TDMA_CLIENT_TIMER_HF);
+        }
     }
 }
 
@@ -484,6 +1437,22 @@ static void timer_tx_interrupt(void) {
  */
 static void timer_rx_interrupt(void) {
 
+    // Change channel right before each frame, or look for the gateway, while the receiver stays on
+    if (_tdma_client_vars.hopping && _rx_timer_free()) {
+        _hop_next();
+        return;
+    }
+    if (_tdma_client_vars.scanning && _rx_timer_free()) {
+        _scan_next();
+        return;
+    }
+
+    // In low-power mode, the receiver only listens during the first slot of the frame and the downlink slot
+    if (_low_power_active()) {
+        _low_power_window_next();
+        return;
+    }
+
     // If the duration of the RX timer is equal to the frame duration
     // just leave the radio ON permanently
 
@@ -503,6 +1472,6 @@ static void timer_rx_interrupt(void) {
         uint32_t delay = _tdma_client_vars.tdma_client_table.frame_duration - _tdma_client_vars.tdma_client_table.rx_duration;
         db_timer_hf_set_oneshot_us(TDMA_CLIENT_TIMER_HF, TDMA_CLIENT_HF_TIMER_CC_RX, delay, &timer_rx_interrupt);
         // turn the radio OFF
-        db_radio_disable();
+        _radio_off();
     }
 }
@@ -99,6 +99,21 @@ void db_tdma_client_empty(void) {
     db_ipc_network_call(DB_IPC_TDMA_CLIENT_EMPTY_REQ);
 }
 
+void db_tdma_client_get_queue_stats(db_packet_queue_stats_t stats[DB_PROTOCOL_PRIORITY_COUNT]) {
+
+    // Request the network core to copy the statistics
+    db_ipc_network_call(DB_IPC_TDMA_CLIENT_QUEUE_REQ);
+
+    // Copy the variables over (one by one because memcpy doesnt like that ipc_shared_data is volatile)
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        stats[priority].count           = ipc_shared_data.tdma_client.queue_stats[priority].count;
+        stats[priority].used            = ipc_shared_data.tdma_client.queue_stats[priority].used;
+        stats[priority].size            = ipc_shared_data.tdma_client.queue_stats[priority].size;
+        stats[priority].high_water_mark = ipc_shared_data.tdma_client.queue_stats[priority].high_water_mark;
+        stats[priority].dropped         = ipc_shared_data.tdma_client.queue_stats[priority].dropped;
+    }
+}
+
 db_tdma_registration_state_t db_tdma_client_get_status(void) {
     db_ipc_network_call(DB_IPC_TDMA_CLIENT_STATUS_REQ);
     return ipc_shared_data.tdma_client.registration_state;
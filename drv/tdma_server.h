@@ -18,16 +18,117 @@
 #include "gpio.h"
 #include "radio.h"
 #include "protocol.h"
+#include "packet_queue.h"
 
 //=========================== defines ==========================================
 
-#define TDMA_SERVER_MAX_CLIENTS             100    ///< Max number of clients that can register with this server
+#ifndef TDMA_SERVER_MAX_CLIENTS
+#define TDMA_SERVER_MAX_CLIENTS 100  ///< Max number of clients that can register with this server (max 2048)
+#endif
 #define TDMA_SERVER_TIME_SLOT_DURATION_US   2500   ///< default timeslot for a tdma slot in microseconds
 #define TDMA_SERVER_MAX_GATEWAY_TX_DELAY_US 20000  ///< Max amount of microseconds that can elapse between gateway transmissions
+#ifndef TDMA_SERVER_CLIENT_TIMEOUT_US
+#define TDMA_SERVER_CLIENT_TIMEOUT_US 5000000  ///< Clients not heard for longer than this lose their slot, 0 to never evict clients
+#endif
 /// Total amount of slots available in the tdma table, adds extra slots to MAX_CLIENTS to accomodate the gateway slots
 #define TDMA_SERVER_MAX_TABLE_SLOTS \
-    TDMA_SERVER_MAX_CLIENTS +       \
-        TDMA_SERVER_MAX_CLIENTS / (TDMA_SERVER_MAX_GATEWAY_TX_DELAY / TDMA_SERVER_TIME_SLOT_DURATION - 1) + 1
+    (TDMA_SERVER_MAX_CLIENTS +      \
+     TDMA_SERVER_MAX_CLIENTS / (TDMA_SERVER_MAX_GATEWAY_TX_DELAY_US / TDMA_SERVER_TIME_SLOT_DURATION_US - 1) + 1)
+
+#if TDMA_SERVER_MAX_CLIENTS < 1 || TDMA_SERVER_MAX_CLIENTS > 2048
+#error "TDMA_SERVER_MAX_CLIENTS must be between 1 and 2048"
+#endif
+
+#ifndef TDMA_SERVER_DOWNLINK_AGGREGATION
+#define TDMA_SERVER_DOWNLINK_AGGREGATION 1  ///< Pack queued data packets for several clients in a single radio frame, only those for the clients announcing DB_PROTOCOL_TDMA_FLAG_AGGREGATE
+#endif
+
+#ifndef TDMA_SERVER_SYNC_INTERVAL_US
+#define TDMA_SERVER_SYNC_INTERVAL_US 100000  ///< Max time between two sync frames, short frames only start with a sync frame every few frames and the clients correct the drift of their clock in between
+#endif
+
+#ifndef TDMA_SERVER_MIN_CONTENTION_SLOTS
+#define TDMA_SERVER_MIN_CONTENTION_SLOTS 1  ///< Min number of contention slots at the end of the frame, where the clients not registered send their join requests
+#endif
+
+#ifndef TDMA_SERVER_MAX_CONTENTION_SLOTS
+#define TDMA_SERVER_MAX_CONTENTION_SLOTS 8  ///< Max number of contention slots, each one lengthens the frame, both 0 so that the clients send their join requests at any time
+#endif
+
+#if TDMA_SERVER_MIN_CONTENTION_SLOTS > TDMA_SERVER_MAX_CONTENTION_SLOTS
+#error "TDMA_SERVER_MIN_CONTENTION_SLOTS must not be above TDMA_SERVER_MAX_CONTENTION_SLOTS"
+#endif
+
+// Un-comment the following line to size the slot of each client according to its uplink traffic
+// #define TDMA_SERVER_ADAPTIVE_SLOTS 1   ///< Defined to give each client between 1 and TDMA_SERVER_MAX_SLOTS_PER_CLIENT consecutive slots, depending on the airtime it uses and the demand it reports
+
+#ifndef TDMA_SERVER_MAX_SLOTS_PER_CLIENT
+#define TDMA_SERVER_MAX_SLOTS_PER_CLIENT 4  ///< Max number of consecutive slots of a client in adaptive mode, a client never gets a gateway slot so the max is 7
+#endif
+
+#ifndef TDMA_SERVER_ADAPTIVE_PERIOD_FRAMES
+#define TDMA_SERVER_ADAPTIVE_PERIOD_FRAMES 50  ///< Number of frames between two reallocations of the slots in adaptive mode, each reallocation sends a new table to the clients that move
+#endif
+
+#ifndef TDMA_SERVER_ADAPTIVE_SWITCH_FRAMES
+#define TDMA_SERVER_ADAPTIVE_SWITCH_FRAMES 3  ///< Number of sync frames announcing the switch to a new layout of the slots, once the clients that move got their next table
+#endif
+
+#if TDMA_SERVER_ADAPTIVE_SWITCH_FRAMES < 1 || TDMA_SERVER_ADAPTIVE_SWITCH_FRAMES > 255
+#error "TDMA_SERVER_ADAPTIVE_SWITCH_FRAMES must be between 1 and 255"
+#endif
+
+#if TDMA_SERVER_MAX_SLOTS_PER_CLIENT < 1 || TDMA_SERVER_MAX_SLOTS_PER_CLIENT >= TDMA_SERVER_MAX_GATEWAY_TX_DELAY_US / TDMA_SERVER_TIME_SLOT_DURATION_US
+#error "TDMA_SERVER_MAX_SLOTS_PER_CLIENT must be between 1 and the number of slots between 2 gateway slots"
+#endif
+
+#ifndef TDMA_SERVER_ACKED_PRIORITIES
+#define TDMA_SERVER_ACKED_PRIORITIES 0  ///< Traffic classes sent to the clients as acknowledged data packets and resent until acknowledged, one bit (1 << protocol_priority_t) per class, 0 to send every data packet once
+#endif
+
+#ifndef TDMA_SERVER_MAX_RETRIES
+#define TDMA_SERVER_MAX_RETRIES 3  ///< Max number of times an acknowledged data packet is resent, it is dropped afterwards
+#endif
+
+#ifndef TDMA_SERVER_CHANNEL_HOPPING
+#define TDMA_SERVER_CHANNEL_HOPPING 0  ///< Set to 1 to change channel with each frame, over the BLE data channels, instead of staying on the frequency given to db_tdma_server_init
+#endif
+
+#ifndef TDMA_SERVER_HOP_MIN_PACKETS
+#define TDMA_SERVER_HOP_MIN_PACKETS 32  ///< Number of packets received on a channel before its CRC failures are checked
+#endif
+
+#ifndef TDMA_SERVER_HOP_MAX_CRC_ERRORS_PCT
+#define TDMA_SERVER_HOP_MAX_CRC_ERRORS_PCT 25  ///< Channels where more packets than this share (in percent) fail their CRC are blacklisted
+#endif
+
+#ifndef TDMA_SERVER_HOP_BLACKLIST_US
+#define TDMA_SERVER_HOP_BLACKLIST_US 30000000  ///< Time a channel stays blacklisted, it is tried again afterwards
+#endif
+
+#ifndef TDMA_SERVER_HOP_MIN_CHANNELS
+#define TDMA_SERVER_HOP_MIN_CHANNELS 8  ///< Min number of channels left in the hopping sequence, the channels beyond stay even if they fail
+#endif
+
+#if TDMA_SERVER_HOP_MIN_CHANNELS < 1 || TDMA_SERVER_HOP_MIN_CHANNELS > 37
+#error "TDMA_SERVER_HOP_MIN_CHANNELS must be between 1 and the 37 BLE data channels"
+#endif
+
+/// Number of buckets (log2) of the client id hash index, sized to keep the index at most half full
+#if TDMA_SERVER_MAX_CLIENTS <= 64
+#define TDMA_SERVER_CLIENT_INDEX_BITS 7
+#elif TDMA_SERVER_MAX_CLIENTS <= 128
+#define TDMA_SERVER_CLIENT_INDEX_BITS 8
+#elif TDMA_SERVER_MAX_CLIENTS <= 256
+#define TDMA_SERVER_CLIENT_INDEX_BITS 9
+#elif TDMA_SERVER_MAX_CLIENTS <= 512
+#define TDMA_SERVER_CLIENT_INDEX_BITS 10
+#elif TDMA_SERVER_MAX_CLIENTS <= 1024
+#define TDMA_SERVER_CLIENT_INDEX_BITS 11
+#else
+#define TDMA_SERVER_CLIENT_INDEX_BITS 12
+#endif
+#define TDMA_SERVER_CLIENT_INDEX_SIZE (1 << TDMA_SERVER_CLIENT_INDEX_BITS)  ///< Number of buckets of the client id hash index
 
 //=========================== variables ========================================
 
@@ -42,10 +143,11 @@ typedef struct {
 
 /// Data type to store the TDMA table
 typedef struct {
-    uint32_t           frame_duration_us;               ///< Duration of the entire TDMA frame [microseconds]
-    uint16_t           num_clients;                     ///< Number of clients currently connected to the tdma server
-    uint16_t           table_index;                     ///< index of the last entry in the tdma table, includes slots taken by the gateway
-    tdma_table_entry_t table[TDMA_SERVER_MAX_CLIENTS];  ///< array of tdma clients
+    uint32_t           frame_duration_us;                            ///< Duration of the entire TDMA frame [microseconds]
+    uint16_t           num_clients;                                  ///< Number of clients currently connected to the tdma server
+    uint16_t           table_index;                                  ///< index of the last entry in the tdma table, includes slots taken by the gateway
+    tdma_table_entry_t table[TDMA_SERVER_MAX_TABLE_SLOTS];           ///< array of tdma clients
+    uint16_t           client_index[TDMA_SERVER_CLIENT_INDEX_SIZE];  ///< open-addressing hash index of the client ids, each bucket holds the table slot of a client
 } tdma_server_table_t;
 
 typedef void (*tdma_server_cb_t)(uint8_t *packet, uint8_t length);  ///< Function pointer to the callback function called on packet receive
@@ -60,7 +162,7 @@ typedef void (*tdma_server_cb_t)(uint8_t *packet, uint8_t length);  ///< Functio
  *
  * @param[in] callback             pointer to a function that will be called each time a packet is received.
  * @param[in] radio_mode           BLE mode used by the radio (1MBit, 2MBit, LR125KBit, LR500Kbit)
- * @param[in] radio_freq           Frequency of the radio [0, 100]
+ * @param[in] radio_freq           Frequency of the radio [0, 100], unused with TDMA_SERVER_CHANNEL_HOPPING
  *
  */
 void db_tdma_server_init(tdma_server_cb_t callback, db_radio_mode_t radio_mode, uint8_t radio_freq);
@@ -77,10 +179,10 @@ void db_tdma_server_get_table_info(uint32_t *frame_duration_us, uint16_t *num_cl
 /**
  * @brief Get information about one client
  *
- * @param[in]   client_id  first client_id to copy
+ * @param[in]   client_id  index of the table entry to copy
  * @param[out]  client     copy of the table entry of a single client
  */
-void db_tdma_server_get_client_info(tdma_table_entry_t *client, uint8_t client_id);
+void db_tdma_server_get_client_info(tdma_table_entry_t *client, uint16_t client_id);
 
 /**
  * @brief Queues a single packet to send through the Radio
@@ -103,4 +205,11 @@ void db_tdma_server_flush(void);
  */
 void db_tdma_server_empty(void);
 
+/**
+ * @brief Get the statistics of the TDMA queues of outgoing packets, one queue per traffic class (see db_protocol_packet_priority)
+ *
+ * @param[out] stats      statistics of each queue (packets and bytes waiting, high water mark, dropped packets), indexed by protocol_priority_t
+ */
+void db_tdma_server_get_queue_stats(db_packet_queue_stats_t stats[DB_PROTOCOL_PRIORITY_COUNT]);
+
 #endif
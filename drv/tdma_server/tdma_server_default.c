@@ -19,6 +19,9 @@
 #include "timer_hf.h"
 #include "protocol.h"
 #include "device.h"
+#include "packet_queue.h"
+#include "block_ack.h"
+#include "channel_hop.h"
 #if defined(NRF5340_XXAA) && defined(NRF_NETWORK)
 #include "ipc.h"
 #endif
@@ -31,24 +34,61 @@
 #define TDMA_SERVER_DEFAULT_TX_START_US    0                                      ///< Start of TX slot, in microseconds.
 #define TDMA_SERVER_DEFAULT_TX_DURATION_US TDMA_SERVER_TIME_SLOT_DURATION_US      ///< Duration of TX slot, in microseconds.
 
-#define TDMA_SERVER_HF_TIMER_CC      0       ///< Which timer channel will be used for the TX state machine.
-#define TDMA_MAX_DELAY_WITHOUT_TX    500000  ///< Max amount of time that can pass without TXing anything
-#define TDMA_RING_BUFFER_SIZE        10      ///< Amount of TX packets the buffer can contain
-#define TDMA_NEW_CLIENT_BUFFER_SIZE  30      ///< Amount of clients waiting to register the buffer can contain
-#define RADIO_MESSAGE_MAX_SIZE       255     ///< Size of buffers used for SPI communications
-#define RADIO_TX_RAMP_UP_TIME        140     ///< time it takes the radio to start a transmission
-#define TDMA_TX_DEADTIME_US          100     ///< buffer time between tdma slot to avoid accidentally sen
-#define TDMA_SERVER_CLIENT_NOT_FOUND -1      ///< The client is not registered in the server's table.
+#define TDMA_SERVER_HF_TIMER_CC       0       ///< Which timer channel will be used for the TX state machine.
+#define TDMA_SERVER_HF_TIMER_CC_RX_TS 1       ///< Which timer channel captures the timestamp of the received packets.
+#define TDMA_MAX_DELAY_WITHOUT_TX     500000  ///< Max amount of time that can pass without TXing anything
+#define TDMA_RING_BUFFER_SIZE         1536    ///< Size of the TX packets buffers of all the traffic classes, in bytes (each packet uses its length plus one byte)
+#define TDMA_NEW_CLIENT_BUFFER_SIZE   30      ///< Amount of clients waiting to register the buffer can contain
+#define TDMA_UNACKED_BUFFER_SIZE      1536    ///< Size of the buffer of the acknowledged data packets waiting for their acknowledgement, in bytes (each packet uses its length plus five bytes)
+#define TDMA_CONTROL_BUFFER_SIZE      512     ///< Size of the buffer of the sync frames, table updates and acknowledgements waiting for the radio, in bytes
+#define RADIO_MESSAGE_MAX_SIZE        255     ///< Size of buffers used for SPI communications
+#define RADIO_TX_RAMP_UP_TIME         140     ///< time it takes the radio to start a transmission
+#define TDMA_TX_DEADTIME_US           100     ///< buffer time between tdma slot to avoid accidentally sen
+#define TDMA_SERVER_CLIENT_NOT_FOUND  -1      ///< The client is not registered in the server's table.
+
+#define TDMA_SERVER_CLIENT_INDEX_EMPTY 0xFFFF                                ///< Value of an unused bucket of the client index
+#define TDMA_SERVER_CLIENT_INDEX_MASK  (TDMA_SERVER_CLIENT_INDEX_SIZE - 1)  ///< Mask used to wrap around the client index
+
+#define TDMA_SERVER_GATEWAY_SLOT_PERIOD (TDMA_SERVER_MAX_GATEWAY_TX_DELAY_US / TDMA_SERVER_TIME_SLOT_DURATION_US)  ///< Every table slot multiple of this one belongs to the gateway
+#define TDMA_SERVER_MAX_JOIN_SLOTS      UINT8_MAX                                                                   ///< Max number of join slots in the contention slots, as many as the sync frame can announce
+#define TDMA_SERVER_JOIN_ACKED_SIZE     ((TDMA_SERVER_MAX_JOIN_SLOTS + 7) / 8)                                      ///< Size of the outcome mask of the join slots, one bit per join slot
+#define TDMA_SERVER_JOIN_COLLIDED_X100  239                                                                         ///< Average number of join requests hidden by a collision, in hundredths, when there is one request per join slot
+#define TDMA_SERVER_JOIN_BACKLOG_X100   139                                                                         ///< Increase of the number of clients joining for each collision, in hundredths, so that it stays unbiased (1 / (e - 2))
 
 #define TDMA_SERVER_TIMER_HF 2
 
+/// Acknowledged data packets exchanged with a client
 typedef struct {
-    uint8_t  buffer[TDMA_RING_BUFFER_SIZE][DB_BLE_PAYLOAD_MAX_LENGTH];  ///< arrays of radio messages waiting to be sent
-    uint32_t packet_length[TDMA_RING_BUFFER_SIZE];                      ///< arrays of the length of the packets in the buffer
-    uint8_t  write_index;                                               ///< Index for next write
-    uint8_t  read_index;                                                ///< Index for next read
-    uint8_t  count;                                                     ///< Number of arrays in buffer
-} tdma_ring_buffer_t;
+    db_block_ack_t rx;       ///< Acknowledged data packets received from the client
+    bool           ack_due;  ///< Set when the client must get a block acknowledgement in the next gateway slot
+    uint8_t        tx_seq;   ///< Sequence number of the next acknowledged data packet sent to the client
+} tdma_server_link_t;
+
+#if TDMA_SERVER_CHANNEL_HOPPING
+/// Reception statistics of a channel, they rate the channel when the server hops
+typedef struct {
+    uint16_t rx_packets;      ///< Number of packets received on the channel outside the contention slots, since the channel was last rated
+    uint16_t crc_errors;      ///< Number of these packets with an invalid CRC
+    uint32_t blacklisted_ts;  ///< Timestamp of when the channel was blacklisted
+} tdma_server_channel_t;
+#endif
+
+#if defined(TDMA_SERVER_ADAPTIVE_SLOTS)
+/// Client information kept while the slots are reallocated
+typedef struct {
+    uint64_t           client;         ///< ID of the client
+    uint32_t           last_heard_ts;  ///< Timestamp of the last packet received from the client
+    uint32_t           tx_start;       ///< Start of the client slot before the reallocation
+    uint32_t           tx_duration;    ///< Duration of the client slot before the reallocation
+    uint8_t            slots;          ///< Number of consecutive slots wanted by the client
+    uint16_t           start;          ///< First slot of the client in the next layout
+    bool               moved;          ///< Set when the slots of the client change in the next layout
+    bool               table_due;      ///< Set until the client that moves is sent its next table
+    bool               low_power;      ///< Set when the client is in low-power mode
+    bool               aggregate;      ///< Set when the client receives the aggregated data packets
+    tdma_server_link_t link;           ///< Acknowledged data packets exchanged with the client
+} tdma_server_plan_entry_t;
+#endif
 
 typedef struct {
     uint64_t buffer[TDMA_NEW_CLIENT_BUFFER_SIZE];  ///< arrays of client IDs waiting to register
@@ -58,23 +98,88 @@ typedef struct {
 } new_client_ring_buffer_t;
 
 typedef struct {
-    tdma_server_cb_t         callback;                              ///< Function pointer, stores the callback to use in the RADIO_Irq handler.
-    tdma_server_table_t      tdma_table;                            ///< Timing table
-    uint16_t                 active_slot_idx;                       ///< index of the current active slot in the TDMA table
-    uint32_t                 last_tx_packet_ts;                     ///< Timestamp of when the previous packet was sent
-    uint32_t                 frame_start_ts;                        ///< Timestamp of when the previous tdma superframe started
-    uint32_t                 slot_start_ts;                         ///< Timestamp of when the current tdma slot started
-    uint8_t                  byte_onair_time;                       ///< How many microseconds it takes to send a byte of data
-    uint64_t                 device_id;                             ///< Device ID of the DotBot
-    tdma_ring_buffer_t       tx_ring_buffer;                        ///< ring buffer to queue the outgoing packets
-    uint8_t                  radio_buffer[RADIO_MESSAGE_MAX_SIZE];  ///< Internal buffer that contains the command to send (from buttons)
-    new_client_ring_buffer_t new_clients_rb;                        //
+    tdma_server_cb_t         callback;                                    ///< Function pointer, stores the callback to use in the RADIO_Irq handler.
+    tdma_server_table_t      tdma_table;                                  ///< Timing table
+    uint32_t                 last_heard_ts[TDMA_SERVER_MAX_TABLE_SLOTS];  ///< Timestamp of the last packet received from the client of each slot
+    bool                     low_power[TDMA_SERVER_MAX_TABLE_SLOTS];      ///< Set when the client of each slot only listens during the first slot of the frame and its downlink slot
+    uint16_t                 low_power_clients;                           ///< Number of clients in low-power mode
+    bool                     aggregate[TDMA_SERVER_MAX_TABLE_SLOTS];      ///< Set when the client of each slot receives the aggregated data packets
+    uint16_t                 aggregate_clients;                           ///< Number of clients receiving the aggregated data packets
+    tdma_server_link_t       links[TDMA_SERVER_MAX_TABLE_SLOTS];          ///< Acknowledged data packets exchanged with the client of each slot
+    uint16_t                 acks_due;                                    ///< Number of clients waiting for a block acknowledgement
+    uint16_t                 active_slot_idx;                             ///< index of the current active slot in the TDMA table
+    uint32_t                 last_tx_packet_ts;                           ///< Timestamp of when the previous packet was sent
+    uint32_t                 frame_start_ts;                              ///< Timestamp of when the previous tdma superframe started
+    uint32_t                 slot_start_ts;                               ///< Timestamp of when the current tdma slot started
+    uint32_t                 current_frame_us;                            ///< Duration of the current frame, the changes of the table only apply from the next frame on
+    uint8_t                  frames_since_sync;                           ///< Number of frames since the last sync frame
+    uint8_t                  sync_period;                                 ///< Number of frames between two sync frames, announced by the last sync frame
+    uint32_t                 sync_frame_duration_us;                      ///< Frame duration announced by the last sync frame
+    uint8_t                  sync_contention_slots;                       ///< Number of contention slots announced by the last sync frame
+    uint8_t                  contention_slots;                            ///< Number of slots at the end of the frame where the clients not registered send their join requests
+    bool                     contention_active;                           ///< Set during the contention slots
+    uint32_t                 join_start_ts;                               ///< Timestamp of the first join slot of the current frame, the join slots end with the frame
+    uint8_t                  join_slots;                                  ///< Number of join slots in the contention slots
+    uint16_t                 join_slot_duration_us;                       ///< Duration of a join slot: a join request and a guard time
+    int16_t                  join_last_slot;                              ///< Last join slot of the current frame where a packet was received, -1 if none
+    bool                     join_last_collided;                          ///< Set when a packet with an invalid CRC was received in the last join slot
+    uint8_t                  join_busy;                                   ///< Number of join slots of the current frame where a packet was received
+    uint8_t                  join_collided;                               ///< Number of join slots of the current frame where a packet was received with an invalid CRC
+    uint8_t                  join_accepted;                               ///< Number of join slots of the current frame where a join request was accepted
+    uint8_t                  join_acked[TDMA_SERVER_JOIN_ACKED_SIZE];     ///< Join slots of the current frame where a join request was accepted, announced by the next sync frame, bit i for join slot i
+    uint32_t                 join_backlog_x100;                           ///< Estimated number of clients joining, in hundredths, announced by the sync frames as the contention window
+    uint8_t                  byte_onair_time;                             ///< How many microseconds it takes to send a byte of data
+    uint16_t                 overhead_onair_time;                         ///< How many microseconds the preamble, address and CRC of a packet take on air
+    uint64_t                 device_id;                                   ///< Device ID of the DotBot
+    db_packet_queue_t        tx_ring_buffer[DB_PROTOCOL_PRIORITY_COUNT];  ///< ring buffers to queue the outgoing packets, one per traffic class
+    uint8_t                  tx_ring_buffer_data[TDMA_RING_BUFFER_SIZE];  ///< bytes of the packets queued in the ring buffer
+    uint8_t                  radio_buffer[RADIO_MESSAGE_MAX_SIZE];        ///< Internal buffer that contains the command to send (from buttons)
+    db_packet_queue_t        tx_control;                                  ///< Sync frames, table updates and acknowledgements waiting for the radio, they go first in the packet train
+    uint8_t                  tx_control_data[TDMA_CONTROL_BUFFER_SIZE];   ///< bytes of the packets queued in tx_control
+    uint8_t                  tx_in_flight;                                ///< Number of packets of the train handed to the radio and not sent yet, at most the one on air and its follow-up
+    uint32_t                 tx_train_end_ts;                             ///< Timestamp of the end of the last packet of the train, handed to the radio or queued in tx_control
+    uint16_t                 tx_train_max_us;                             ///< Time available to the data packets of the train, from the start of the slot
+    new_client_ring_buffer_t new_clients_rb;                              //
+#if TDMA_SERVER_ACKED_PRIORITIES
+    db_packet_queue_t        unacked;                                     ///< Acknowledged data packets sent and not acknowledged yet, each one after the timestamp of its transmission
+    uint8_t                  unacked_data[TDMA_UNACKED_BUFFER_SIZE];      ///< bytes of the packets waiting for their acknowledgement
+#endif
+#if TDMA_SERVER_DOWNLINK_AGGREGATION
+    uint8_t                  aggregate_frame[DB_BLE_PAYLOAD_MAX_LENGTH];  ///< Buffer where the aggregated downlink frames are built
+#endif
+#if TDMA_SERVER_CHANNEL_HOPPING
+    db_channel_hop_t         hop;                                         ///< Channel hopping sequence announced by the last sync frame
+    uint64_t                 channel_map;                                 ///< Channels left after blacklisting, the sequence uses them from the next sync frame on
+    uint16_t                 hop_frame;                                   ///< Number of the current frame in the channel hopping sequence
+    uint8_t                  channel;                                     ///< BLE data channel of the current frame
+    tdma_server_channel_t    channels[DB_CHANNEL_HOP_CHANNELS];           ///< Reception statistics of each channel
+#endif
+#if defined(TDMA_SERVER_ADAPTIVE_SLOTS)
+    uint32_t                 airtime_us[TDMA_SERVER_MAX_TABLE_SLOTS];     ///< Uplink airtime used by the client of each slot since the last reallocation
+    uint32_t                 backlog_us[TDMA_SERVER_MAX_TABLE_SLOTS];     ///< Airtime of the packets the client of each slot reported as queued since the last reallocation
+    uint16_t                 max_packet_us[TDMA_SERVER_MAX_TABLE_SLOTS];  ///< Airtime of the longest packet sent by the client of each slot since the last reallocation
+    tdma_server_plan_entry_t plan[TDMA_SERVER_MAX_CLIENTS];               ///< Clients of the next layout of the slots, in the order of the table
+    uint16_t                 plan_count;                                  ///< Number of clients in the next layout
+    uint16_t                 plan_table_index;                            ///< Last slot of the table in the next layout
+    uint16_t                 plan_tables_due;                             ///< Number of clients that move and were not sent their next table yet
+    bool                     plan_pending;                                ///< Set from the reallocation until the frame where the clients switch to the next layout
+    uint8_t                  table_switch;                                ///< Number of frames before the switch to the next layout, announced by the sync frames, 0 until every client that moves got its next table
+    uint16_t                 frame_count;                                 ///< Number of frames since the last reallocation
+    bool                     replan;                                      ///< Set when the slots must be reallocated at the start of the next frame
+#endif
 } tdma_server_vars_t;
 
 //=========================== variables ========================================
 
 static tdma_server_vars_t _tdma_vars = { 0 };
 
+// Size of the TX packets buffer of each traffic class, in bytes, they add up to TDMA_RING_BUFFER_SIZE.
+static const uint16_t _tx_ring_buffer_sizes[DB_PROTOCOL_PRIORITY_COUNT] = {
+    384,  // DB_PROTOCOL_PRIORITY_CONTROL
+    512,  // DB_PROTOCOL_PRIORITY_TELEMETRY
+    640,  // DB_PROTOCOL_PRIORITY_BULK
+};
+
 // Transform the ble mode into how many microseconds it takes to send a single byte.
 static const uint8_t ble_mode_to_byte_time[] = {
     8,   // DB_RADIO_BLE_1MBit
@@ -83,46 +188,137 @@ static const uint8_t ble_mode_to_byte_time[] = {
     16,  // DB_RADIO_BLE_LR500Kbit
 };
 
+// Transform the ble mode into how many microseconds the preamble, address, header and CRC of a packet take (and the coding indicator and terms in long range).
+static const uint16_t ble_mode_to_overhead_time[] = {
+    80,   // DB_RADIO_BLE_1MBit
+    44,   // DB_RADIO_BLE_2MBit
+    720,  // DB_RADIO_BLE_LR125Kbit
+    462,  // DB_RADIO_BLE_LR500Kbit
+};
+
 //========================== prototypes ========================================
 
-static void tdma_server_callback(uint8_t *packet, uint8_t length);
+static void tdma_server_callback(uint8_t *packet, uint8_t length, const db_radio_rx_metadata_t *metadata);
 
 /// TDMA timer Interrupts
 static void timer_tdma_interrupt(void);
 
+#if TDMA_SERVER_DOWNLINK_AGGREGATION
 /**
- * @brief Initialize the ring buffer for spi captures
+ * @brief pack the data packets waiting at the front of the ring buffers together with a data packet taken out of one of them
  *
- * @param[in]   rb  pointer to ring buffer structure
+ * @param[in]       priority        traffic class of the data packet, the ring buffers of this class and the following ones are used
+ * @param[in,out]   packet          data packet taken out of the ring buffer, replaced by the aggregated frame
+ * @param[in]       packet_length   length of the data packet
+ * @param[in]       max_length      max length of the aggregated frame
+ * @return                          length of the packet to send, unchanged if nothing was aggregated
  */
-static void _message_rb_init(tdma_ring_buffer_t *rb);
+static uint8_t _message_rb_aggregate(uint8_t priority, uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t packet_length, size_t max_length);
+#endif
 
 /**
- * @brief add one element to the ring buffer for tdma captures
+ * @brief Sends all the queued messages that can be sent in during the TX timeslot, by order of traffic class
  *
- * @param[in]   rb          pointer to ring buffer structure
- * @param[in]   data        pointer to the data array to save in the ring buffer
- * @param[in]   packet_length   length of the packet to send trough the radio
+ * The messages are sent back-to-back as a packet train, after the control packets already queued: the function
+ * hands the first ones to the radio and returns, the following ones are handed to the radio from its TX completion callback.
+ *
+ * @param[in]    max_tx_duration_us     max time available to send messages.
+ * @return                              true if messages were waiting to be sent, false otherwise.
  */
-static void _message_rb_add(tdma_ring_buffer_t *rb, uint8_t data[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t packet_length);
+static bool _message_rb_tx_queue(uint16_t max_tx_duration_us);
 
 /**
- * @brief retrieve the oldest element from the ring buffer for tdma captures
+ * @brief Take out the next packet of the train: the control packets first, then the data packet that ends before the end of the packet train, by order of traffic class
  *
- * @param[in]    rb          pointer to ring buffer structure
- * @param[out]   data        pointer to the array where the ring buffer data will be saved
- * @param[out]   packet_length   length of the packet to send trough the radio
+ * @param[out]   packet     buffer where the packet (or the aggregated frame) is copied
+ * @return                  length of the packet, 0 if no packet fits in the time left
  */
-static bool _message_rb_get(tdma_ring_buffer_t *rb, uint8_t data[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t *packet_length);
+static uint8_t _message_rb_next(uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH]);
 
 /**
- * @brief Sends all the queued messages that can be sent in during the TX timeslot
+ * @brief Hand the next packets of the train to the radio, the one on air and its follow-up
+ */
+static void _message_rb_tx_fill(void);
+
+/**
+ * @brief TX completion callback of the packets of the train, hands the next packet to the radio
+ */
+static void _message_rb_tx_next(void);
+
+/**
+ * @brief Return when the next packet handed to the radio goes on air, after the packets of the train
  *
- * @param[in]    rb                     pointer to ring buffer structure
- * @param[in]    max_tx_duration_us     max time available to send messages.
- * @return                              true if a packet was sent, false if no packet was sent.
+ * @return  timestamp of the start of the next packet
  */
-static bool _message_rb_tx_queue(tdma_ring_buffer_t *rb, uint16_t max_tx_duration_us);
+static uint32_t _server_tx_start_ts(void);
+
+/**
+ * @brief Send the control packet in the radio buffer after the packets of the train, without waiting for it to go on air
+ *
+ * @param[in]   length      length of the packet
+ */
+static void _server_tx(size_t length);
+
+/**
+ * @brief Compute the length of a packet sent as an acknowledged data packet
+ *
+ * The unicast data packets of the acknowledged traffic classes to a registered client are acknowledged,
+ * if they still fit in a radio frame and in the buffer of the packets waiting for their acknowledgement.
+ *
+ * @param[in]   packet      packet taken out of the ring buffer
+ * @param[in]   length      length of the packet
+ * @return                  length of the packet with its sequence number, 0 if the packet is sent as is
+ */
+static uint8_t _server_acked_length(const uint8_t *packet, uint8_t length);
+
+#if TDMA_SERVER_ACKED_PRIORITIES
+/**
+ * @brief Number a data packet about to be sent, and keep a copy of it until the client acknowledges it
+ *
+ * @param[in,out]   packet      packet taken out of the ring buffer, turned into an acknowledged data packet
+ * @param[in]       length      length of the packet
+ * @return                      length of the packet to send
+ */
+static uint8_t _server_sequence(uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t length);
+
+/**
+ * @brief Drop the packets acknowledged, and queue again the lost ones in the ring buffer of their traffic class
+ *
+ * @param[in]   client      client that sent the block acknowledgement
+ * @param[in]   ack         block acknowledgement of the client, NULL to queue again the packets left unacknowledged for a frame
+ */
+static void _server_unacked_check(uint64_t client, const db_block_ack_t *ack);
+#endif
+
+/**
+ * @brief Record an acknowledged data packet received from a client, and turn it back into a data packet
+ *
+ * @param[in]       slot        slot of the client in the TDMA table, TDMA_SERVER_CLIENT_NOT_FOUND if it has none
+ * @param[in,out]   packet      acknowledged data packet received, turned into a data packet
+ * @param[in]       length      length of the packet
+ * @return                      length of the data packet, 0 if the packet was already received
+ */
+static uint8_t _server_rx_data(int16_t slot, uint8_t *packet, uint8_t length);
+
+/**
+ * @brief Send in a single packet the block acknowledgements due to the clients listening during this slot
+ *
+ * @param[in]    max_tx_duration_us  max time available to send the packet.
+ * @return                           true if a packet was sent, false if no packet was sent.
+ */
+static bool _tx_ack_message(uint16_t max_tx_duration_us);
+
+#if TDMA_SERVER_CHANNEL_HOPPING
+/**
+ * @brief Rate the channel of the frame that ended, update the blacklist and switch to the channel of the next frame
+ *
+ * A channel is blacklisted when too many of the packets received on it fail their CRC, and tried again
+ * after TDMA_SERVER_HOP_BLACKLIST_US. The changes of the blacklist only apply with a sync frame.
+ *
+ * @return              true if the channels used changed, the next frame must start with a sync frame to announce them
+ */
+static bool _server_hop_next(void);
+#endif
 
 /**
  * @brief Initialize the ring buffer for clients waiting to register.
@@ -180,6 +376,50 @@ static void _tx_sync_frame(void);
  */
 static void _tx_registration_messages(uint64_t client);
 
+/**
+ * @brief Return the gateway slot carrying the downlink packets of a low-power client
+ *
+ * @param[in]    slot   slot of the client in the TDMA table
+ * @return  the gateway slot before the slot of the client
+ */
+static uint16_t _server_downlink_slot(uint16_t slot);
+
+/**
+ * @brief Check if the destination of a packet listens during the current slot
+ *
+ * @param[in]    dst    destination address of the packet
+ * @return  false if the destination is in low-power mode and this slot is not one of its slots
+ */
+static bool _server_dst_listening(uint64_t dst);
+
+/**
+ * @brief Switch a client to or from low-power mode, and queue the new table for it
+ *
+ * @param[in]    slot       slot of the client in the TDMA table
+ * @param[in]    low_power  true if the client only listens during the first slot of the frame and its downlink slot
+ */
+static void _server_set_low_power(uint16_t slot, bool low_power);
+
+/**
+ * @brief Record if a client receives the data packets aggregated in a single frame
+ *
+ * The clients running a firmware older than the aggregation don't announce it in their keep alive packets.
+ *
+ * @param[in]    slot       slot of the client in the TDMA table
+ * @param[in]    aggregate  true if the client receives the aggregated data packets
+ */
+static void _server_set_aggregate(uint16_t slot, bool aggregate);
+
+#if TDMA_SERVER_DOWNLINK_AGGREGATION
+/**
+ * @brief Check if the destination of a data packet receives the aggregated data packets
+ *
+ * @param[in]    dst    destination address of the packet
+ * @return  true if the destination, every client for a broadcast packet, receives the aggregated data packets
+ */
+static bool _server_dst_aggregate(uint64_t dst);
+#endif
+
 /**
  * @brief find the slot in which a client is registered
  *
@@ -189,13 +429,135 @@ static void _tx_registration_messages(uint64_t client);
  */
 static int16_t _server_find_client(tdma_server_table_t *tdma_table, uint64_t client);
 
+/**
+ * @brief compute the duration of the frame, the contention slots follow the last slot of the table
+ *
+ * @param[in]   table_index index of the last slot of the table
+ * @return                  duration of the frame, never shorter than the default frame
+ */
+static uint32_t _server_frame_duration(uint16_t table_index);
+
+/**
+ * @brief change the number of contention slots, and the frame duration with it
+ *
+ * @param[in]   slots       number of contention slots
+ */
+static void _server_set_contention_slots(uint8_t slots);
+
+/**
+ * @brief resize the contention slots from the outcome of the join slots of the frame that ended
+ *
+ * Slotted ALOHA delivers the most join requests when there is about one request per join slot: a
+ * bit more than a third of the join slots are then idle, and a bit more than a quarter collide.
+ */
+static void _server_size_contention(void);
+
+/**
+ * @brief record that the join request received in a join slot was accepted, the next sync frame tells the client
+ *
+ * @param[in]   join_slot   join slot of the request, -1 if it was not received in a join slot
+ */
+static void _server_join_ack(int16_t join_slot);
+
 /**
  * @brief register a new client into the table.
  *
  * @param[in]   tdma_table  pointer to the tdma table to search
  * @param[in]   client      id of the client to register.
+ * @return                  true if the client was registered, false if the table is full.
+ */
+static bool _server_register_new_client(tdma_server_table_t *tdma_table, uint64_t client);
+
+/**
+ * @brief free the slot of a client and compact the table
+ *
+ * The last client of the table is moved into the freed slot, and the frame shrinks accordingly.
+ * The moved client is queued to receive its new TDMA table.
+ * In adaptive mode, the slots go to the gateway until the next reallocation compacts the table.
+ *
+ * @param[in]   tdma_table  pointer to the tdma table
+ * @param[in]   slot        table slot of the client to evict
+ */
+static void _server_evict_client(tdma_server_table_t *tdma_table, uint16_t slot);
+
+#if defined(TDMA_SERVER_ADAPTIVE_SLOTS)
+/**
+ * @brief reallocate the slots of all the clients according to their demand and compact the table
+ *
+ * Each client gets consecutive slots that never span a gateway slot. The table keeps the current layout, the clients
+ * that move are queued to receive their next table, and they all switch to it at a frame announced by the sync frames.
+ * A layout where no client moves applies right away.
+ *
+ * @param[in]   tdma_table  pointer to the tdma table
  */
-static void _server_register_new_client(tdma_server_table_t *tdma_table, uint64_t client);
+static void _server_plan_slots(tdma_server_table_t *tdma_table);
+
+/**
+ * @brief switch the table to the next layout computed by _server_plan_slots
+ *
+ * The clients evicted since the reallocation leave their slots to the gateway.
+ *
+ * @param[in]   tdma_table  pointer to the tdma table
+ */
+static void _server_plan_apply(tdma_server_table_t *tdma_table);
+
+/**
+ * @brief reallocate the slots at the start of a frame when due, and count the frames down to the switch to the next layout
+ *
+ * @return  true if the sync frame of this frame must be sent, to announce the switch or the new layout
+ */
+static bool _server_plan_next(void);
+
+/**
+ * @brief find a client that moves in the next layout, while the switch is pending
+ *
+ * @param[in]   client      id of the client
+ * @return                  the client in the next layout, NULL if no layout is pending or the client keeps its slots
+ */
+static const tdma_server_plan_entry_t *_server_plan_find(uint64_t client);
+
+/**
+ * @brief send their next table to the clients that move, while the switch to the next layout is pending
+ *
+ * @param[in]    max_tx_duration_us  max time available to send the tables, from the start of the slot
+ * @param[in]    force_first         true to send one table even if it doesn't fit, when no registration was sent in this slot
+ * @return                           true if a packet was sent
+ */
+static bool _server_plan_tx_queue(uint16_t max_tx_duration_us, bool force_first);
+
+/**
+ * @brief compute the first slot of a group of consecutive client slots, skipping the gateway slots
+ *
+ * @param[in]   slot    first free slot of the table
+ * @param[in]   count   number of consecutive slots
+ * @return              first slot of the group
+ */
+static uint16_t _server_plan_window(uint16_t slot, uint8_t count);
+#endif
+
+/**
+ * @brief compute the home bucket of a client id in the client index
+ *
+ * @param[in]   client      id of the client
+ * @return                  index of the first bucket to probe
+ */
+static uint16_t _client_index_hash(uint64_t client);
+
+/**
+ * @brief add a client to the client index, the client must not be in the index already
+ *
+ * @param[in]   tdma_table  pointer to the tdma table
+ * @param[in]   slot        table slot of the client, the slot entry must already hold the client id
+ */
+static void _client_index_insert(tdma_server_table_t *tdma_table, uint16_t slot);
+
+/**
+ * @brief remove a client from the client index, call it before its table slot is modified
+ *
+ * @param[in]   tdma_table  pointer to the tdma table
+ * @param[in]   client      id of the client to remove
+ */
+static void _client_index_remove(tdma_server_table_t *tdma_table, uint64_t client);
 
 //=========================== public ===========================================
 
@@ -204,15 +566,34 @@ void db_tdma_server_init(tdma_server_cb_t callback, db_radio_mode_t radio_mode,
     // Initialize high frequency clock
     db_timer_hf_init(TDMA_SERVER_TIMER_HF);
 
-    // Initialize the ring buffer of outbound messages
-    _message_rb_init(&_tdma_vars.tx_ring_buffer);
+    // Initialize the ring buffers of outbound messages
+    uint16_t offset = 0;
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        db_packet_queue_init(&_tdma_vars.tx_ring_buffer[priority], &_tdma_vars.tx_ring_buffer_data[offset], _tx_ring_buffer_sizes[priority]);
+        offset += _tx_ring_buffer_sizes[priority];
+    }
+
+#if TDMA_SERVER_ACKED_PRIORITIES
+    db_packet_queue_init(&_tdma_vars.unacked, _tdma_vars.unacked_data, TDMA_UNACKED_BUFFER_SIZE);
+#endif
+    db_packet_queue_init(&_tdma_vars.tx_control, _tdma_vars.tx_control_data, TDMA_CONTROL_BUFFER_SIZE);
 
     // Initialize the client buffer of outbound messages
     _client_rb_init(&_tdma_vars.new_clients_rb);
 
     // Initialize Radio
     db_radio_init(&tdma_server_callback, radio_mode);  // set the radio callback to our tdma catch function
+    db_radio_set_timestamp_timer(TDMA_SERVER_TIMER_HF, TDMA_SERVER_HF_TIMER_CC_RX_TS);
     db_radio_set_frequency(radio_freq);                // Pass through the rest of the arguments
+#if TDMA_SERVER_CHANNEL_HOPPING
+    // Hop over all the data channels, the seed makes the gateways hop differently from each other
+    uint64_t device_id = db_device_id();
+    uint8_t  seed      = device_id ^ (device_id >> 8) ^ (device_id >> 16) ^ (device_id >> 24);
+    db_channel_hop_init(&_tdma_vars.hop, (seed != 0) ? seed : 1, DB_CHANNEL_HOP_ALL);
+    _tdma_vars.channel_map = DB_CHANNEL_HOP_ALL;
+    _tdma_vars.channel     = db_channel_hop_channel(&_tdma_vars.hop, _tdma_vars.hop_frame);
+    db_radio_set_channel(_tdma_vars.channel);
+#endif
     db_radio_rx();                                     // start receiving packets
 
     // Retrieve the device ID.
@@ -222,7 +603,11 @@ void db_tdma_server_init(tdma_server_cb_t callback, db_radio_mode_t radio_mode,
     _tdma_vars.callback = callback;
 
     // Save the on-air byte time
-    _tdma_vars.byte_onair_time = ble_mode_to_byte_time[radio_mode];
+    _tdma_vars.byte_onair_time     = ble_mode_to_byte_time[radio_mode];
+    _tdma_vars.overhead_onair_time = ble_mode_to_overhead_time[radio_mode];
+
+    // A join slot fits a join request (keep alive packet) and a guard time for the clock of the client
+    _tdma_vars.join_slot_duration_us = RADIO_TX_RAMP_UP_TIME + _tdma_vars.overhead_onair_time + (sizeof(protocol_header_t) + sizeof(protocol_tdma_keep_alive_t)) * _tdma_vars.byte_onair_time + TDMA_TX_DEADTIME_US;
 
     // Set the default time table, and populate the first entry with the server
     _tdma_vars.tdma_table.frame_duration_us    = TDMA_SERVER_DEFAULT_FRAME_DURATION_US;
@@ -231,6 +616,12 @@ void db_tdma_server_init(tdma_server_cb_t callback, db_radio_mode_t radio_mode,
     _tdma_vars.tdma_table.table[0].rx_duration = TDMA_SERVER_DEFAULT_RX_DURATION_US;
     _tdma_vars.tdma_table.table[0].tx_start    = TDMA_SERVER_DEFAULT_TX_START_US;
     _tdma_vars.tdma_table.table[0].tx_duration = TDMA_SERVER_DEFAULT_TX_DURATION_US;
+    _server_set_contention_slots(TDMA_SERVER_MIN_CONTENTION_SLOTS);
+    _tdma_vars.current_frame_us = _tdma_vars.tdma_table.frame_duration_us;
+
+    // Index the server slot, the following gateway slots resolve to this first one
+    memset(_tdma_vars.tdma_table.client_index, 0xFF, sizeof(_tdma_vars.tdma_table.client_index));
+    _client_index_insert(&_tdma_vars.tdma_table, 0);
 
     // set the current active slot
     _tdma_vars.active_slot_idx = 0;
@@ -248,102 +639,362 @@ void db_tdma_server_get_table_info(uint32_t *frame_duration_us, uint16_t *num_cl
     *table_index       = _tdma_vars.tdma_table.table_index;
 }
 
-void db_tdma_server_get_client_info(tdma_table_entry_t *client, uint8_t client_id) {
+void db_tdma_server_get_client_info(tdma_table_entry_t *client, uint16_t client_id) {
+
+    if (client_id >= TDMA_SERVER_MAX_TABLE_SLOTS) {
+        return;
+    }
 
     // Copy and return one entry of the TDMA entry
     memcpy(client, &_tdma_vars.tdma_table.table[client_id], sizeof(tdma_table_entry_t));
 }
 
 void db_tdma_server_tx(const uint8_t *packet, uint8_t length) {
-    // Add packet to the output buffer
-    _message_rb_add(&_tdma_vars.tx_ring_buffer, (uint8_t *)packet, length);
+
+    // Add packet to the output buffer of its traffic class. The timer and radio interrupts pop the queue, they are masked
+    // while the push, and the drops of the oldest packets it may need, update the queue
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    db_packet_queue_push(&_tdma_vars.tx_ring_buffer[db_protocol_packet_priority(packet, length)], packet, length);
+    __set_PRIMASK(primask);
 }
 
 void db_tdma_server_flush(void) {
     // Use the normal function to send queue messages, but with a really long time
-    // So that there is enough time to send everything.
-    _message_rb_tx_queue(&_tdma_vars.tx_ring_buffer, 50000);
+    // So that there is enough time to send everything. The interrupts also hand packets to the radio, they are masked meanwhile
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    _message_rb_tx_queue(50000);
+    __set_PRIMASK(primask);
 }
 
 void db_tdma_server_empty(void) {
 
-    // Reinitialize the ring buffer to erase it
-    _message_rb_init(&_tdma_vars.tx_ring_buffer);
+    // Drop the queued packets, the statistics are kept, without the interrupts popping them meanwhile
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        db_packet_queue_clear(&_tdma_vars.tx_ring_buffer[priority]);
+    }
+#if TDMA_SERVER_ACKED_PRIORITIES
+    db_packet_queue_clear(&_tdma_vars.unacked);
+#endif
+    __set_PRIMASK(primask);
 }
 
-//=========================== private ==========================================
-
-static void _message_rb_init(tdma_ring_buffer_t *rb) {
-    rb->write_index = 0;
-    rb->read_index  = 0;
-    rb->count       = 0;
+void db_tdma_server_get_queue_stats(db_packet_queue_stats_t stats[DB_PROTOCOL_PRIORITY_COUNT]) {
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        db_packet_queue_get_stats(&_tdma_vars.tx_ring_buffer[priority], &stats[priority]);
+    }
 }
 
-static void _message_rb_add(tdma_ring_buffer_t *rb, uint8_t data[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t packet_length) {
+//=========================== private ==========================================
 
-    memcpy(rb->buffer[rb->write_index], data, DB_BLE_PAYLOAD_MAX_LENGTH);
-    rb->packet_length[rb->write_index] = packet_length;
-    rb->write_index                    = (rb->write_index + 1) % TDMA_RING_BUFFER_SIZE;
+static bool _message_rb_tx_queue(uint16_t max_tx_duration_us) {
 
-    if (rb->count < TDMA_RING_BUFFER_SIZE) {
-        rb->count++;
-    } else {
-        // Overwrite oldest data, adjust read_index
-        rb->read_index = (rb->read_index + 1) % TDMA_RING_BUFFER_SIZE;
+    bool packet_queued_flag = false;  ///< flag to keep track if a packet was waiting when this function was called
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        packet_queued_flag |= (_tdma_vars.tx_ring_buffer[priority].count > 0);
     }
-}
 
-static bool _message_rb_get(tdma_ring_buffer_t *rb, uint8_t data[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t *packet_length) {
-    if (rb->count == 0) {
-        // Buffer is empty
+    // Return if there was nothing to send
+    if (!packet_queued_flag) {
         return false;
     }
 
-    memcpy(data, rb->buffer[rb->read_index], DB_BLE_PAYLOAD_MAX_LENGTH);
-    *packet_length = rb->packet_length[rb->read_index];
-    rb->read_index = (rb->read_index + 1) % TDMA_RING_BUFFER_SIZE;
-    rb->count--;
+    // Update the last packet timer
+    _tdma_vars.last_tx_packet_ts = _tdma_vars.slot_start_ts;
+
+    // The data packets follow the control packets of the train, the radio takes the next one while one is on air,
+    // and its completion callback keeps refilling it until nothing fits in the slot.
+    _tdma_vars.tx_train_max_us = max_tx_duration_us;
+    _message_rb_tx_fill();
 
     return true;
 }
 
-static bool _message_rb_tx_queue(tdma_ring_buffer_t *rb, uint16_t max_tx_duration_us) {
+static uint8_t _message_rb_next(uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH]) {
 
-    // initialize variables
-    uint8_t length                            = 0;
-    uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH] = { 0 };
-    bool    packet_sent_flag                  = false;  ///< flag to keep track if a packet get sent during this function call
-
-    // Return if there is nothing to send
-    if (rb->count == 0) {
-        return false;
+    // The control packets were given their place in the train when they were queued
+    if (_tdma_vars.tx_control.count > 0) {
+        uint8_t length = db_packet_queue_peek(&_tdma_vars.tx_control, packet);
+        db_packet_queue_pop(&_tdma_vars.tx_control);
+        return length;
     }
 
-    // Otherwise, send messages until queue is empty
-    while (rb->count > 0) {
+    // The packet goes on air after the ones already handed to the radio
+    uint32_t start_ts   = _server_tx_start_ts();
+    uint32_t elapsed_us = start_ts - _tdma_vars.slot_start_ts;
+
+    // Strict priority: the packets of a traffic class go first, the following classes only use the time left
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        db_packet_queue_t *rb = &_tdma_vars.tx_ring_buffer[priority];
+        if (rb->count == 0) {
+            continue;
+        }
+
+        // Move the packets of the low-power clients that don't listen during this slot to the back of the queue
+        if (_tdma_vars.low_power_clients > 0) {
+            uint16_t pending = rb->count;
+            while (pending > 0) {
+                uint8_t length = db_packet_queue_peek(rb, packet);
+                if (length >= sizeof(protocol_header_t) && _server_dst_listening(((protocol_header_t *)packet)->dst)) {
+                    break;
+                }
+                db_packet_queue_pop(rb);
+                db_packet_queue_push(rb, packet, length);
+                pending--;
+            }
+            if (pending == 0) {
+                continue;
+            }
+        }
+
+        // Compute if there is still time to send the oldest packet [in microseconds], with its sequence number if it is acknowledged
+        uint8_t  length       = db_packet_queue_peek(rb, packet);
+        uint8_t  acked_length = _server_acked_length(packet, length);
+        uint16_t tx_time      = RADIO_TX_RAMP_UP_TIME + _tdma_vars.overhead_onair_time + ((acked_length > 0) ? acked_length : length) * _tdma_vars.byte_onair_time;
+        // otherwise, leave it in the queue for the next slot
+        if (elapsed_us + tx_time >= _tdma_vars.tx_train_max_us) {
+            continue;
+        }
         // retrieve the oldest packet from the queue
-        bool error = _message_rb_get(rb, packet, &length);
-        if (!error) {
-            break;
+        db_packet_queue_pop(rb);
+#if TDMA_SERVER_ACKED_PRIORITIES
+        length = _server_sequence(packet, length);
+#endif
+#if TDMA_SERVER_DOWNLINK_AGGREGATION
+        // Send the following data packets in the same radio frame, as long as the frame fits in the time left
+        length = _message_rb_aggregate(priority, packet, length, (_tdma_vars.tx_train_max_us - elapsed_us - RADIO_TX_RAMP_UP_TIME - _tdma_vars.overhead_onair_time) / _tdma_vars.byte_onair_time);
+#endif
+        _tdma_vars.tx_train_end_ts = start_ts + RADIO_TX_RAMP_UP_TIME + _tdma_vars.overhead_onair_time + length * _tdma_vars.byte_onair_time;
+        return length;
+    }
+
+    return 0;
+}
+
+static void _message_rb_tx_fill(void) {
+    uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH];
+    while (_tdma_vars.tx_in_flight < 2) {
+        uint8_t length = _message_rb_next(packet);
+        if (length == 0) {
+            return;
         }
-        // Compute if there is still time to send the packet [in microseconds]
-        uint16_t tx_time = RADIO_TX_RAMP_UP_TIME + length * _tdma_vars.byte_onair_time;
-        // If there is time to send the packet, send it
-        if (db_timer_hf_now(TDMA_SERVER_TIMER_HF) + tx_time - _tdma_vars.slot_start_ts < max_tx_duration_us) {
-            // switch off RX, and send message.
+        // The packet is queued behind the one on air, or starts the train once RX is switched off
+        _tdma_vars.tx_in_flight++;
+        if (!db_radio_tx_async(packet, length, &_message_rb_tx_next)) {
             db_radio_disable();
-            db_radio_tx(packet, length);
-            packet_sent_flag = true;
-        } else {  // otherwise, put the packet back in the queue and leave
+            if (!db_radio_tx_async(packet, length, &_message_rb_tx_next)) {
+                _tdma_vars.tx_in_flight--;
+                return;
+            }
+        }
+    }
+}
 
-            _message_rb_add(rb, packet, length);
-            break;
+static void _message_rb_tx_next(void) {
+    // The timer interrupt also hands packets to the radio, keep it away while the train is refilled
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (_tdma_vars.tx_in_flight > 0) {
+        _tdma_vars.tx_in_flight--;
+    }
+    _message_rb_tx_fill();
+    __set_PRIMASK(primask);
+}
+
+static uint32_t _server_tx_start_ts(void) {
+    uint32_t now = db_timer_hf_now(TDMA_SERVER_TIMER_HF);
+    if (_tdma_vars.tx_in_flight > 0 && (int32_t)(_tdma_vars.tx_train_end_ts - now) > 0) {
+        return _tdma_vars.tx_train_end_ts;
+    }
+    return now;
+}
+
+static void _server_tx(size_t length) {
+    // The packet takes its place in the train now, the packets queued after it count with its airtime
+    _tdma_vars.tx_train_end_ts = _server_tx_start_ts() + RADIO_TX_RAMP_UP_TIME + _tdma_vars.overhead_onair_time + length * _tdma_vars.byte_onair_time;
+    db_packet_queue_push(&_tdma_vars.tx_control, _tdma_vars.radio_buffer, length);
+    _message_rb_tx_fill();
+}
+
+#if TDMA_SERVER_DOWNLINK_AGGREGATION
+static uint8_t _message_rb_aggregate(uint8_t priority, uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t packet_length, size_t max_length) {
+
+    if (max_length > DB_BLE_PAYLOAD_MAX_LENGTH) {
+        max_length = DB_BLE_PAYLOAD_MAX_LENGTH;
+    }
+
+    // Only data packets can be aggregated, and only if the next one is a data packet too, the acknowledged ones only together
+    if (packet_length < sizeof(protocol_header_t)) {
+        return packet_length;
+    }
+    uint8_t packet_type = ((protocol_header_t *)packet)->packet_type;
+    if (packet_type != DB_PACKET_DATA && packet_type != DB_PACKET_TDMA_DATA) {
+        return packet_length;
+    }
+    bool acked = (packet_type == DB_PACKET_TDMA_DATA);
+    if (!_server_dst_aggregate(((protocol_header_t *)packet)->dst)) {
+        return packet_length;
+    }
+
+    uint8_t *frame  = _tdma_vars.aggregate_frame;
+    size_t   length = db_protocol_tdma_aggregate_to_buffer(frame, DB_BROADCAST_ADDRESS, acked);
+    length          = db_protocol_tdma_aggregate_add(frame, length, packet, packet_length);
+    uint8_t records = 1;
+
+    // Fill the frame by order of traffic class, the classes before this one have nothing left that fits
+    uint8_t next[DB_BLE_PAYLOAD_MAX_LENGTH];
+    for (; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        db_packet_queue_t *rb = &_tdma_vars.tx_ring_buffer[priority];
+        while (rb->count > 0) {
+            uint8_t            next_length = db_packet_queue_peek(rb, next);
+            protocol_header_t *next_header = (protocol_header_t *)next;
+            if (next_length < sizeof(protocol_header_t) || (next_header->packet_type != DB_PACKET_DATA && next_header->packet_type != DB_PACKET_TDMA_DATA) || !_server_dst_listening(next_header->dst) || !_server_dst_aggregate(next_header->dst)) {
+                break;
+            }
+            uint8_t acked_length = _server_acked_length(next, next_length);
+            uint8_t sent_length  = (acked_length > 0) ? acked_length : next_length;
+            if ((acked_length > 0) != acked || length + sizeof(protocol_tdma_aggregate_record_t) + sent_length - sizeof(protocol_header_t) > max_length) {
+                break;
+            }
+            db_packet_queue_pop(rb);
+#if TDMA_SERVER_ACKED_PRIORITIES
+            next_length = _server_sequence(next, next_length);
+#endif
+            length = db_protocol_tdma_aggregate_add(frame, length, next, next_length);
+            records++;
         }
     }
-    // Update the last packet timer
-    _tdma_vars.last_tx_packet_ts = _tdma_vars.slot_start_ts;
 
-    return packet_sent_flag;
+    // A single packet is sent as is, it is shorter than its aggregated version
+    if (records == 1) {
+        return packet_length;
+    }
+    memcpy(packet, frame, length);
+    return length;
+}
+#endif
+
+static uint8_t _server_acked_length(const uint8_t *packet, uint8_t length) {
+
+    if (length < sizeof(protocol_header_t)) {
+        return 0;
+    }
+    const protocol_header_t *header = (const protocol_header_t *)packet;
+
+    // The packets sent again already carry their sequence number
+    if (header->packet_type == DB_PACKET_TDMA_DATA) {
+        return length;
+    }
+    if (!(TDMA_SERVER_ACKED_PRIORITIES & (1 << db_protocol_packet_priority(packet, length))) || header->packet_type != DB_PACKET_DATA || header->dst == DB_BROADCAST_ADDRESS) {
+        return 0;
+    }
+    // The copy kept until the acknowledgement is stored with its timestamp
+    if (length + sizeof(protocol_tdma_data_t) + sizeof(uint32_t) > DB_BLE_PAYLOAD_MAX_LENGTH || _server_find_client(&_tdma_vars.tdma_table, header->dst) <= 0) {
+        return 0;
+    }
+    return length + sizeof(protocol_tdma_data_t);
+}
+
+#if TDMA_SERVER_ACKED_PRIORITIES
+static uint8_t _server_sequence(uint8_t packet[DB_BLE_PAYLOAD_MAX_LENGTH], uint8_t length) {
+
+    if (_server_acked_length(packet, length) == 0) {
+        return length;
+    }
+
+    // Number the new packets in the order they are sent, the packets sent again keep their sequence number
+    protocol_header_t *header = (protocol_header_t *)packet;
+    if (header->packet_type == DB_PACKET_DATA) {
+        int16_t              slot = _server_find_client(&_tdma_vars.tdma_table, header->dst);
+        protocol_tdma_data_t data = {
+            .seq     = _tdma_vars.links[slot].tx_seq++,
+            .retries = 0,
+        };
+        memmove(packet + sizeof(protocol_header_t) + sizeof(protocol_tdma_data_t), packet + sizeof(protocol_header_t), length - sizeof(protocol_header_t));
+        memcpy(packet + sizeof(protocol_header_t), &data, sizeof(protocol_tdma_data_t));
+        header->packet_type = DB_PACKET_TDMA_DATA;
+        length += sizeof(protocol_tdma_data_t);
+    }
+
+    // Keep a copy of the packet until it is acknowledged, the oldest copies are dropped if the buffer is full
+    uint8_t  entry[DB_BLE_PAYLOAD_MAX_LENGTH];
+    uint32_t sent_ts = db_timer_hf_now(TDMA_SERVER_TIMER_HF);
+    memcpy(entry, &sent_ts, sizeof(uint32_t));
+    memcpy(entry + sizeof(uint32_t), packet, length);
+    db_packet_queue_push(&_tdma_vars.unacked, entry, sizeof(uint32_t) + length);
+    return length;
+}
+
+static void _server_unacked_check(uint64_t client, const db_block_ack_t *ack) {
+
+    uint32_t now = db_timer_hf_now(TDMA_SERVER_TIMER_HF);
+    uint8_t  entry[DB_BLE_PAYLOAD_MAX_LENGTH];
+
+    // Each packet is looked at once, those still waiting go back to the end of the buffer
+    for (uint16_t pending = _tdma_vars.unacked.count; pending > 0; pending--) {
+        uint8_t entry_length = db_packet_queue_peek(&_tdma_vars.unacked, entry);
+        db_packet_queue_pop(&_tdma_vars.unacked);
+
+        uint32_t           sent_ts;
+        uint8_t           *packet = entry + sizeof(uint32_t);
+        uint8_t            length = entry_length - sizeof(uint32_t);
+        protocol_header_t *header = (protocol_header_t *)packet;
+        memcpy(&sent_ts, entry, sizeof(uint32_t));
+        protocol_tdma_data_t data;
+        memcpy(&data, packet + sizeof(protocol_header_t), sizeof(protocol_tdma_data_t));
+
+        // A client acknowledges the packets of a frame in its next slot, without it the packet or the acknowledgement was lost
+        db_block_ack_status_t status = DB_BLOCK_ACK_PENDING;
+        if (ack == NULL) {
+            if ((int32_t)(now - sent_ts) > (int32_t)(_tdma_vars.current_frame_us + TDMA_SERVER_TIME_SLOT_DURATION_US)) {
+                status = DB_BLOCK_ACK_LOST;
+            }
+        } else if (header->dst == client) {
+            status = db_block_ack_status(ack, data.seq);
+        }
+
+        if (status == DB_BLOCK_ACK_PENDING) {
+            db_packet_queue_push(&_tdma_vars.unacked, entry, entry_length);
+            continue;
+        }
+
+        // Send the lost packets again from the ring buffer of their traffic class, unless the client left or they were sent too often
+        if (status == DB_BLOCK_ACK_LOST && data.retries < TDMA_SERVER_MAX_RETRIES && _server_find_client(&_tdma_vars.tdma_table, header->dst) > 0) {
+            data.retries++;
+            memcpy(packet + sizeof(protocol_header_t), &data, sizeof(protocol_tdma_data_t));
+            db_packet_queue_push(&_tdma_vars.tx_ring_buffer[db_protocol_packet_priority(packet, length)], packet, length);
+        }
+    }
+}
+#endif
+
+static uint8_t _server_rx_data(int16_t slot, uint8_t *packet, uint8_t length) {
+
+    if (length < sizeof(protocol_header_t) + sizeof(protocol_tdma_data_t)) {
+        return 0;
+    }
+    protocol_tdma_data_t data;
+    memcpy(&data, packet + sizeof(protocol_header_t), sizeof(protocol_tdma_data_t));
+
+    // Acknowledge the packet in the next gateway slot, even if it was already received: the acknowledgement was lost
+    if (slot != TDMA_SERVER_CLIENT_NOT_FOUND) {
+        tdma_server_link_t *link = &_tdma_vars.links[slot];
+        if (!link->ack_due) {
+            link->ack_due = true;
+            _tdma_vars.acks_due++;
+        }
+        if (!db_block_ack_rx(&link->rx, data.seq, data.retries > 0)) {
+            return 0;
+        }
+    }
+
+    // Remove the sequence number
+    memmove(packet + sizeof(protocol_header_t), packet + sizeof(protocol_header_t) + sizeof(protocol_tdma_data_t), length - sizeof(protocol_header_t) - sizeof(protocol_tdma_data_t));
+    ((protocol_header_t *)packet)->packet_type = DB_PACKET_DATA;
+    return length - sizeof(protocol_tdma_data_t);
 }
 
 static void _client_rb_init(new_client_ring_buffer_t *rb) {
@@ -386,17 +1037,22 @@ static bool _client_rb_tx_queue(new_client_ring_buffer_t *rb, uint16_t max_tx_du
 
     // check if there is something to send
     if (rb->count > 0) {
-        // and send messages until queue is empty
-        while (rb->count > 0) {
+        // and send messages until queue is empty, each client is looked at once
+        for (uint8_t pending = rb->count; pending > 0; pending--) {
             // retrieve the oldest packet from the queue
             bool error = _client_rb_get(rb, &client);
             if (!error) {
                 break;
             }
+            // A low-power client doesn't listen during this slot, keep the message for one of its slots
+            if (!_server_dst_listening(client)) {
+                _client_rb_add(rb, client);
+                continue;
+            }
             // Compute if there is still time to send the packet [in microseconds]
-            uint16_t tx_time = RADIO_TX_RAMP_UP_TIME + (sizeof(protocol_header_t) + sizeof(protocol_tdma_table_t)) * _tdma_vars.byte_onair_time;
-            // If there is time to send the packet, send it
-            if (db_timer_hf_now(TDMA_SERVER_TIMER_HF) + tx_time - _tdma_vars.slot_start_ts < max_tx_duration_us) {
+            uint16_t tx_time = RADIO_TX_RAMP_UP_TIME + _tdma_vars.overhead_onair_time + (sizeof(protocol_header_t) + sizeof(protocol_tdma_table_t)) * _tdma_vars.byte_onair_time;
+            // If there is time to send the packet, send it. One registration is always sent, a table update doesn't fit in the budget in the long range modes
+            if (!packet_sent_flag || _server_tx_start_ts() + tx_time - _tdma_vars.slot_start_ts < max_tx_duration_us) {
                 _tx_registration_messages(client);
                 packet_sent_flag = true;
             } else {  // otherwise, put the packet back in the queue and leave
@@ -432,12 +1088,46 @@ static bool _client_rb_id_exists(new_client_ring_buffer_t *rb, uint64_t client)
 
 static void _tx_sync_frame(void) {
     // This message signals the start of a TDMA frame
-    // Prepare packet payload
-    protocol_sync_frame_t frame = { _tdma_vars.tdma_table.frame_duration_us };
+    // Send the next one after as many frames as fit in the sync interval
+    uint32_t sync_period              = TDMA_SERVER_SYNC_INTERVAL_US / _tdma_vars.tdma_table.frame_duration_us;
+    _tdma_vars.sync_period            = (sync_period < 1) ? 1 : (sync_period > UINT8_MAX) ? UINT8_MAX : sync_period;
+    _tdma_vars.frames_since_sync      = 0;
+    _tdma_vars.sync_frame_duration_us = _tdma_vars.tdma_table.frame_duration_us;
+    _tdma_vars.sync_contention_slots  = _tdma_vars.contention_slots;
+
+    // Prepare packet payload, timestamped with the start of its TX so that the clients can estimate their drift
+    uint32_t              start_ts = _server_tx_start_ts();
+    protocol_sync_frame_t frame    = {
+        .frame_period       = _tdma_vars.tdma_table.frame_duration_us,
+        .timestamp          = start_ts,
+        .frame_offset       = start_ts - _tdma_vars.frame_start_ts,
+        .sync_period        = _tdma_vars.sync_period,
+        .join_slot_duration = _tdma_vars.join_slot_duration_us,
+        .join_slots         = _tdma_vars.join_slots,
+        .join_window        = (_tdma_vars.join_backlog_x100 + 50) / 100,
+    };
+    memcpy(&frame.join_acked, _tdma_vars.join_acked, sizeof(frame.join_acked));
+#if TDMA_SERVER_CHANNEL_HOPPING
+    // The clients that hear the sync frame follow the channel hopping from this frame on
+    frame.hop_seed  = _tdma_vars.hop.seed;
+    frame.hop_frame = _tdma_vars.hop_frame;
+    memcpy(frame.channel_map, &_tdma_vars.hop.map, sizeof(frame.channel_map));
+#endif
+#if defined(TDMA_SERVER_ADAPTIVE_SLOTS)
+    // The clients that got their next table switch to it at the frame announced
+    frame.table_switch = _tdma_vars.table_switch;
+#endif
     // Prepare packet header
     size_t length = db_protocol_tdma_sync_frame_to_buffer(_tdma_vars.radio_buffer, DB_BROADCAST_ADDRESS, &frame);
-    db_radio_disable();
-    db_radio_tx(_tdma_vars.radio_buffer, length);
+
+    // The join slots that do not fit in the join_acked field follow the sync frame, a byte for 8 of them
+    if (_tdma_vars.join_slots > 8 * sizeof(frame.join_acked)) {
+        size_t acked_length = (_tdma_vars.join_slots + 7) / 8 - sizeof(frame.join_acked);
+        memcpy(_tdma_vars.radio_buffer + length, _tdma_vars.join_acked + sizeof(frame.join_acked), acked_length);
+        length += acked_length;
+    }
+    memset(_tdma_vars.join_acked, 0, sizeof(_tdma_vars.join_acked));
+    _server_tx(length);
 }
 
 static void _tx_registration_messages(uint64_t client) {
@@ -448,6 +1138,10 @@ static void _tx_registration_messages(uint64_t client) {
 
     // Get the info of the client we are sending too.
     int16_t slot = _server_find_client(&_tdma_vars.tdma_table, client);
+    if (slot == TDMA_SERVER_CLIENT_NOT_FOUND) {
+        // The client was evicted while the message was queued
+        return;
+    }
 
     // global frame data
     table.frame_period = _tdma_vars.tdma_table.frame_duration_us;
@@ -457,44 +1151,236 @@ static void _tx_registration_messages(uint64_t client) {
     table.tx_duration = _tdma_vars.tdma_table.table[slot].tx_duration;
     table.tx_start    = _tdma_vars.tdma_table.table[slot].tx_start;
 
-    // Compute the time before the next frame. (as close as possible to the TX as you can, so that it's more accurate)
-    table.next_period_start = table.frame_period - (db_timer_hf_now(TDMA_SERVER_TIMER_HF) - _tdma_vars.frame_start_ts);
+    // A low-power client only listens during the first slot of the frame and the gateway slot before its own slot
+    if (_tdma_vars.low_power[slot]) {
+        table.rx_start    = _server_downlink_slot(slot) * TDMA_SERVER_DEFAULT_TX_DURATION_US;
+        table.rx_duration = TDMA_SERVER_TIME_SLOT_DURATION_US;
+        table.flags       = DB_PROTOCOL_TDMA_FLAG_LOW_POWER;
+    }
+
+#if defined(TDMA_SERVER_ADAPTIVE_SLOTS)
+    // A client that moves in the next layout gets its next slots, it keeps the current ones until the switch
+    const tdma_server_plan_entry_t *entry = _server_plan_find(client);
+    if (entry != NULL) {
+        table.frame_period = _server_frame_duration(_tdma_vars.plan_table_index);
+        table.rx_start     = TDMA_SERVER_DEFAULT_RX_START_US;
+        table.rx_duration  = table.frame_period;
+        table.tx_start     = entry->start * TDMA_SERVER_DEFAULT_TX_DURATION_US;
+        table.tx_duration  = entry->slots * TDMA_SERVER_DEFAULT_TX_DURATION_US;
+        if (_tdma_vars.low_power[slot]) {
+            table.rx_start    = _server_downlink_slot(entry->start) * TDMA_SERVER_DEFAULT_TX_DURATION_US;
+            table.rx_duration = TDMA_SERVER_TIME_SLOT_DURATION_US;
+        }
+        table.flags |= DB_PROTOCOL_TDMA_FLAG_NEXT_TABLE;
+    }
+#endif
+
+    // Compute the time before the next frame, from the start of the TX of the message so that it's more accurate
+    table.next_period_start = _tdma_vars.current_frame_us - (_server_tx_start_ts() - _tdma_vars.frame_start_ts);
 
     // Fill out the buffer with the TDMA message (header + table)
     size_t length = db_protocol_tdma_table_update_to_buffer(_tdma_vars.radio_buffer, client, &table);
 
     // Send the message
+    _server_tx(length);
+}
+
+static bool _tx_ack_message(uint16_t max_tx_duration_us) {
+
+    if (_tdma_vars.acks_due == 0) {
+        return false;
+    }
+
+    // One record per client, the low-power clients get theirs in their downlink slot
+    size_t   length  = db_protocol_tdma_ack_to_buffer(_tdma_vars.radio_buffer, DB_BROADCAST_ADDRESS);
+    uint16_t due     = _tdma_vars.acks_due;
+    uint16_t records = 0;
+    for (uint16_t slot = 1; slot <= _tdma_vars.tdma_table.table_index && due > 0; slot++) {
+        tdma_server_link_t *link = &_tdma_vars.links[slot];
+        if (!link->ack_due) {
+            continue;
+        }
+        due--;
+
+        // Stop when the packet is full, or when it would not fit in the time left
+        uint16_t tx_time = RADIO_TX_RAMP_UP_TIME + _tdma_vars.overhead_onair_time + (length + sizeof(protocol_tdma_ack_t)) * _tdma_vars.byte_onair_time;
+        if (length + sizeof(protocol_tdma_ack_t) > DB_BLE_PAYLOAD_MAX_LENGTH || tx_time >= max_tx_duration_us) {
+            break;
+        }
+        uint64_t client = _tdma_vars.tdma_table.table[slot].client;
+        if (!_server_dst_listening(client)) {
+            continue;
+        }
+        protocol_tdma_ack_t record = {
+            .src    = client,
+            .seq    = link->rx.seq,
+            .bitmap = link->rx.bitmap,
+        };
+        length        = db_protocol_tdma_ack_add(_tdma_vars.radio_buffer, length, &record);
+        link->ack_due = false;
+        records++;
+    }
+    if (records == 0) {
+        return false;
+    }
+    _tdma_vars.acks_due -= records;
+
+    _server_tx(length);
+    return true;
+}
+
+#if TDMA_SERVER_CHANNEL_HOPPING
+static bool _server_hop_next(void) {
+
+    uint32_t now = db_timer_hf_now(TDMA_SERVER_TIMER_HF);
+
+    // Rate the channel once enough packets were received on it, the last channels are kept whatever their rate
+    tdma_server_channel_t *stats = &_tdma_vars.channels[_tdma_vars.channel];
+    if (stats->rx_packets >= TDMA_SERVER_HOP_MIN_PACKETS) {
+        uint8_t channels_left = __builtin_popcountll(_tdma_vars.channel_map);
+        if (stats->crc_errors * 100UL > stats->rx_packets * (uint32_t)TDMA_SERVER_HOP_MAX_CRC_ERRORS_PCT && channels_left > TDMA_SERVER_HOP_MIN_CHANNELS) {
+            _tdma_vars.channel_map &= ~(1ULL << _tdma_vars.channel);
+            stats->blacklisted_ts = now;
+        }
+        stats->rx_packets = 0;
+        stats->crc_errors = 0;
+    }
+
+    // Try again the channels blacklisted long ago, the interference may be gone
+    for (uint8_t channel = 0; channel < DB_CHANNEL_HOP_CHANNELS; channel++) {
+        if (!(_tdma_vars.channel_map & (1ULL << channel)) && now - _tdma_vars.channels[channel].blacklisted_ts > TDMA_SERVER_HOP_BLACKLIST_US) {
+            _tdma_vars.channel_map |= 1ULL << channel;
+            _tdma_vars.channels[channel].rx_packets = 0;
+            _tdma_vars.channels[channel].crc_errors = 0;
+        }
+    }
+
+    // The clients only learn the new channels from a sync frame, the changes wait for one
+    bool changed = (_tdma_vars.channel_map != _tdma_vars.hop.map);
+    if (changed) {
+        db_channel_hop_set_map(&_tdma_vars.hop, _tdma_vars.channel_map);
+    }
+
+    // Switch channel, the radio only takes the new frequency when it starts receiving again, the packet train left on air is cut
+    _tdma_vars.hop_frame++;
+    _tdma_vars.channel = db_channel_hop_channel(&_tdma_vars.hop, _tdma_vars.hop_frame);
     db_radio_disable();
-    db_radio_tx(_tdma_vars.radio_buffer, length);
+    _tdma_vars.tx_in_flight = 0;
+    db_packet_queue_clear(&_tdma_vars.tx_control);
+    db_radio_set_channel(_tdma_vars.channel);
+    db_radio_rx();
+
+    return changed;
+}
+#endif
+
+static uint16_t _server_downlink_slot(uint16_t slot) {
+    // The slots of a client never span a gateway slot
+    return slot - slot % TDMA_SERVER_GATEWAY_SLOT_PERIOD;
+}
+
+static bool _server_dst_listening(uint64_t dst) {
+
+    // Everybody listens during the first slot of the frame
+    if (_tdma_vars.low_power_clients == 0 || _tdma_vars.active_slot_idx == 0) {
+        return true;
+    }
+    // Broadcast packets wait for the first slot of the next frame
+    if (dst == DB_BROADCAST_ADDRESS) {
+        return false;
+    }
+    int16_t slot = _server_find_client(&_tdma_vars.tdma_table, dst);
+    if (slot == TDMA_SERVER_CLIENT_NOT_FOUND || !_tdma_vars.low_power[slot]) {
+        return true;
+    }
+    return _server_downlink_slot(slot) == _tdma_vars.active_slot_idx;
+}
+
+static void _server_set_low_power(uint16_t slot, bool low_power) {
+
+    if (_tdma_vars.low_power[slot] == low_power) {
+        return;
+    }
+    _tdma_vars.low_power[slot] = low_power;
+    if (low_power) {
+        _tdma_vars.low_power_clients++;
+    } else {
+        _tdma_vars.low_power_clients--;
+    }
+
+    // Send the downlink slot to the client, or tell it to listen all the time again
+    uint64_t client = _tdma_vars.tdma_table.table[slot].client;
+    if (!_client_rb_id_exists(&_tdma_vars.new_clients_rb, client)) {
+        _client_rb_add(&_tdma_vars.new_clients_rb, client);
+    }
+}
+
+static void _server_set_aggregate(uint16_t slot, bool aggregate) {
+
+    if (_tdma_vars.aggregate[slot] == aggregate) {
+        return;
+    }
+    _tdma_vars.aggregate[slot] = aggregate;
+    if (aggregate) {
+        _tdma_vars.aggregate_clients++;
+    } else {
+        _tdma_vars.aggregate_clients--;
+    }
+}
+
+#if TDMA_SERVER_DOWNLINK_AGGREGATION
+static bool _server_dst_aggregate(uint64_t dst) {
+
+    if (dst == DB_BROADCAST_ADDRESS) {
+        return _tdma_vars.aggregate_clients == _tdma_vars.tdma_table.num_clients;
+    }
+    int16_t slot = _server_find_client(&_tdma_vars.tdma_table, dst);
+    return slot != TDMA_SERVER_CLIENT_NOT_FOUND && _tdma_vars.aggregate[slot];
 }
+#endif
 
 static int16_t _server_find_client(tdma_server_table_t *tdma_table, uint64_t client) {
 
-    for (size_t i = 0; i <= tdma_table->table_index; i++) {
-        if (tdma_table->table[i].client == client) {
-            return i;
+    // Linear probing, stops at the first empty bucket. The index is at most half full so few buckets are probed.
+    for (uint16_t bucket = _client_index_hash(client);; bucket = (bucket + 1) & TDMA_SERVER_CLIENT_INDEX_MASK) {
+        uint16_t slot = tdma_table->client_index[bucket];
+        if (slot == TDMA_SERVER_CLIENT_INDEX_EMPTY) {
+            return TDMA_SERVER_CLIENT_NOT_FOUND;
+        }
+        if (tdma_table->table[slot].client == client) {
+            return slot;
         }
     }
-    return TDMA_SERVER_CLIENT_NOT_FOUND;
 }
 
-static void _server_register_new_client(tdma_server_table_t *tdma_table, uint64_t client) {
+static bool _server_register_new_client(tdma_server_table_t *tdma_table, uint64_t client) {
+
+#if defined(TDMA_SERVER_ADAPTIVE_SLOTS)
+    // The next layout has no room for the clients registered before the switch, they try again after it
+    if (_tdma_vars.plan_pending) {
+        return false;
+    }
+#endif
 
     // Check if the next slot should go to the gateway
     //  YES: Assign next+1 slot to the new client
     //  NO: Assign next slot.
+    bool gateway_slot = ((tdma_table->table_index + 1) % TDMA_SERVER_GATEWAY_SLOT_PERIOD) == 0;
+
+    // Check there is room left in the table
+    if (tdma_table->num_clients >= TDMA_SERVER_MAX_CLIENTS || tdma_table->table_index + 1 + gateway_slot >= TDMA_SERVER_MAX_TABLE_SLOTS) {
+        return false;
+    }
 
     // Check if the next index of the table should be a gateway slot.
-    if (((tdma_table->table_index + 1) % (int)(TDMA_SERVER_MAX_GATEWAY_TX_DELAY_US / TDMA_SERVER_TIME_SLOT_DURATION_US)) == 0) {
+    if (gateway_slot) {
 
         // Compute the new frame duration knowing that we will add two new slots to the table (gateway + client)
-        uint32_t frame_duration = ((tdma_table->table_index + 2) + 1) * TDMA_SERVER_DEFAULT_TX_DURATION_US;
-        // if the new frame is smaller than the minimum frame time, keep the minimum frame time.
-        frame_duration = (frame_duration > TDMA_SERVER_DEFAULT_FRAME_DURATION_US) ? frame_duration : TDMA_SERVER_DEFAULT_FRAME_DURATION_US;
+        uint32_t frame_duration = _server_frame_duration(tdma_table->table_index + 2);
 
         // first slot belongs to the gateway.
         tdma_table->table_index += 1;
-        uint8_t idx = tdma_table->table_index;  // use a shorter variable to make the code more understandable
+        uint16_t idx = tdma_table->table_index;  // use a shorter variable to make the code more understandable
 
         tdma_table->table[idx].client      = _tdma_vars.device_id;
         tdma_table->table[idx].rx_start    = TDMA_SERVER_DEFAULT_RX_START_US;
@@ -516,12 +1402,10 @@ static void _server_register_new_client(tdma_server_table_t *tdma_table, uint64_
     } else {
         // first slot belongs to the client.
         tdma_table->table_index += 1;
-        uint8_t idx = tdma_table->table_index;  // use a shorter variable to make the code more understandable
+        uint16_t idx = tdma_table->table_index;  // use a shorter variable to make the code more understandable
 
         // Compute the new frame duration knowing that we will add one new slots to the table (client)
-        uint32_t frame_duration = (idx + 1) * TDMA_SERVER_DEFAULT_TX_DURATION_US;
-        // if the new frame is smaller than the minimum frame time, keep the minimum frame time.
-        frame_duration = (frame_duration > TDMA_SERVER_DEFAULT_FRAME_DURATION_US) ? frame_duration : TDMA_SERVER_DEFAULT_FRAME_DURATION_US;
+        uint32_t frame_duration = _server_frame_duration(idx);
 
         tdma_table->table[idx].client      = client;
         tdma_table->table[idx].rx_start    = TDMA_SERVER_DEFAULT_RX_START_US;
@@ -535,6 +1419,381 @@ static void _server_register_new_client(tdma_server_table_t *tdma_table, uint64_
 
     // Update the last slot, table index, number of clients, in the TDMA table
     tdma_table->num_clients += 1;
+    _client_index_insert(tdma_table, tdma_table->table_index);
+    _tdma_vars.last_heard_ts[tdma_table->table_index] = db_timer_hf_now(TDMA_SERVER_TIMER_HF);
+    _tdma_vars.low_power[tdma_table->table_index]     = false;
+    _tdma_vars.aggregate[tdma_table->table_index]     = false;
+    _tdma_vars.links[tdma_table->table_index]         = (tdma_server_link_t){ 0 };
+
+    return true;
+}
+
+static void _server_evict_client(tdma_server_table_t *tdma_table, uint16_t slot) {
+
+    uint64_t client = tdma_table->table[slot].client;
+    _client_index_remove(tdma_table, client);
+    if (_tdma_vars.low_power[slot]) {
+        _tdma_vars.low_power[slot] = false;
+        _tdma_vars.low_power_clients--;
+    }
+    _server_set_aggregate(slot, false);
+    if (_tdma_vars.links[slot].ack_due) {
+        _tdma_vars.links[slot].ack_due = false;
+        _tdma_vars.acks_due--;
+    }
+
+#if defined(TDMA_SERVER_ADAPTIVE_SLOTS)
+    // Hand the slots over to the gateway until the next reallocation compacts the table
+    for (uint16_t idx = slot; idx <= tdma_table->table_index && tdma_table->table[idx].client == client; idx++) {
+        tdma_table->table[idx].client      = _tdma_vars.device_id;
+        tdma_table->table[idx].tx_start    = idx * TDMA_SERVER_DEFAULT_TX_DURATION_US;
+        tdma_table->table[idx].tx_duration = TDMA_SERVER_DEFAULT_TX_DURATION_US;
+    }
+    tdma_table->num_clients -= 1;
+    _tdma_vars.replan = true;
+#else
+    // Move the last client into the freed slot, it only changes the tx_start of that client
+    uint16_t last = tdma_table->table_index;
+    if (slot != last) {
+        uint64_t moved = tdma_table->table[last].client;
+        _client_index_remove(tdma_table, moved);
+        tdma_table->table[slot].client   = moved;
+        tdma_table->table[slot].tx_start = slot * TDMA_SERVER_DEFAULT_TX_DURATION_US;
+        _tdma_vars.last_heard_ts[slot]   = _tdma_vars.last_heard_ts[last];
+        _tdma_vars.low_power[slot]       = _tdma_vars.low_power[last];
+        _tdma_vars.aggregate[slot]       = _tdma_vars.aggregate[last];
+        _tdma_vars.links[slot]           = _tdma_vars.links[last];
+        _client_index_insert(tdma_table, slot);
+
+        // Announce the new slot to the moved client
+        if (!_client_rb_id_exists(&_tdma_vars.new_clients_rb, moved)) {
+            _client_rb_add(&_tdma_vars.new_clients_rb, moved);
+        }
+    }
+    tdma_table->table_index -= 1;
+    tdma_table->num_clients -= 1;
+
+    // Drop the gateway slot left at the end of the table, if any
+    if (tdma_table->table_index > 0 && (tdma_table->table_index % TDMA_SERVER_GATEWAY_SLOT_PERIOD) == 0) {
+        tdma_table->table_index -= 1;
+    }
+
+    // Shrink the frame, without going under the minimum frame time
+    tdma_table->frame_duration_us = _server_frame_duration(tdma_table->table_index);
+    if (slot <= tdma_table->table_index) {
+        tdma_table->table[slot].rx_duration = tdma_table->frame_duration_us;
+    }
+#endif
+}
+
+static uint32_t _server_frame_duration(uint16_t table_index) {
+    uint32_t frame_duration = (table_index + 1 + _tdma_vars.contention_slots) * TDMA_SERVER_DEFAULT_TX_DURATION_US;
+    return (frame_duration > TDMA_SERVER_DEFAULT_FRAME_DURATION_US) ? frame_duration : TDMA_SERVER_DEFAULT_FRAME_DURATION_US;
+}
+
+static void _server_set_contention_slots(uint8_t slots) {
+
+    uint32_t join_slots         = (uint32_t)slots * TDMA_SERVER_TIME_SLOT_DURATION_US / _tdma_vars.join_slot_duration_us;
+    _tdma_vars.contention_slots = slots;
+    _tdma_vars.join_slots       = (join_slots < TDMA_SERVER_MAX_JOIN_SLOTS) ? join_slots : TDMA_SERVER_MAX_JOIN_SLOTS;
+
+    // The clients learn the new contention slots from the sync frame that announces the new frame duration
+    _tdma_vars.tdma_table.frame_duration_us = _server_frame_duration(_tdma_vars.tdma_table.table_index);
+}
+
+static void _server_size_contention(void) {
+
+    uint8_t  collided = _tdma_vars.join_collided;
+    uint8_t  accepted = _tdma_vars.join_accepted;
+    uint8_t  idle     = _tdma_vars.join_slots - _tdma_vars.join_busy;
+    uint8_t  slots    = _tdma_vars.contention_slots;
+    _tdma_vars.join_busy     = 0;
+    _tdma_vars.join_collided = 0;
+    _tdma_vars.join_accepted = 0;
+
+    // Track how many clients are joining: each idle or accepted join slot removes one, each collision adds 1.39 so that
+    // the estimate loses the clients accepted on average. A collision hides at least two of them, and at most the clients
+    // the table still has room for are joining. The requests refused by a full list of registrations stay in the backlog.
+    uint32_t room_x100           = (TDMA_SERVER_MAX_CLIENTS - _tdma_vars.tdma_table.num_clients) * 100;
+    uint32_t removed             = (idle + accepted) * 100;
+    uint32_t backlog             = _tdma_vars.join_backlog_x100 + collided * TDMA_SERVER_JOIN_BACKLOG_X100;
+    backlog                      = (backlog > removed) ? backlog - removed : 0;
+    backlog                      = (backlog > collided * 200) ? backlog : collided * 200;
+    backlog                      = (backlog < room_x100) ? backlog : room_x100;
+    _tdma_vars.join_backlog_x100 = backlog;
+
+    // Grow the join slots to the clients joining right away, as long as the table has room for them,
+    // the contention window of the clients spreads the rest over the next frames. Shrink one slot per frame afterwards.
+    uint32_t contenders = accepted + (collided * TDMA_SERVER_JOIN_COLLIDED_X100 + 50) / 100;
+    uint32_t joining    = (backlog + 50) / 100;
+    uint8_t  per_slot   = TDMA_SERVER_TIME_SLOT_DURATION_US / _tdma_vars.join_slot_duration_us;
+    uint32_t wanted     = (((joining > contenders) ? joining : contenders) + per_slot - 1) / per_slot;
+    bool     room       = _tdma_vars.tdma_table.num_clients < TDMA_SERVER_MAX_CLIENTS;
+    if (room && wanted > slots) {
+        slots = (wanted < TDMA_SERVER_MAX_CONTENTION_SLOTS) ? wanted : TDMA_SERVER_MAX_CONTENTION_SLOTS;
+    } else if ((wanted < slots || !room) && slots > TDMA_SERVER_MIN_CONTENTION_SLOTS) {
+        slots--;
+    }
+    if (slots != _tdma_vars.contention_slots) {
+        _server_set_contention_slots(slots);
+    }
+}
+
+static void _server_join_ack(int16_t join_slot) {
+    if (join_slot < 0 || (_tdma_vars.join_acked[join_slot / 8] & (1 << (join_slot % 8)))) {
+        return;
+    }
+    _tdma_vars.join_acked[join_slot / 8] |= 1 << (join_slot % 8);
+    _tdma_vars.join_accepted++;
+}
+
+#if defined(TDMA_SERVER_ADAPTIVE_SLOTS)
+static uint16_t _server_plan_window(uint16_t slot, uint8_t count) {
+
+    // Skip the gateway slot
+    if (slot % TDMA_SERVER_GATEWAY_SLOT_PERIOD == 0) {
+        slot++;
+    }
+    // Move to after the next gateway slot if the group would span it
+    if (slot % TDMA_SERVER_GATEWAY_SLOT_PERIOD + count > TDMA_SERVER_GATEWAY_SLOT_PERIOD) {
+        slot += TDMA_SERVER_GATEWAY_SLOT_PERIOD - slot % TDMA_SERVER_GATEWAY_SLOT_PERIOD + 1;
+    }
+    return slot;
+}
+
+static void _server_plan_slots(tdma_server_table_t *tdma_table) {
+
+    // List the clients in the order of the table, with the number of slots they need
+    uint16_t count = 0;
+    for (uint16_t slot = 1; slot <= tdma_table->table_index; slot++) {
+        uint64_t client = tdma_table->table[slot].client;
+        if (client == _tdma_vars.device_id || client == tdma_table->table[slot - 1].client) {
+            continue;
+        }
+        // Airtime needed per frame: the airtime used plus the airtime of the queued packets reported by the client
+        uint32_t airtime_us = (_tdma_vars.airtime_us[slot] + _tdma_vars.backlog_us[slot]) / _tdma_vars.frame_count;
+        uint32_t slots      = 1 + airtime_us / TDMA_SERVER_TIME_SLOT_DURATION_US;
+
+        // A client that leaves less than one of its packets of unused time is limited by its slots, give it one more
+        uint32_t current = tdma_table->table[slot].tx_duration / TDMA_SERVER_TIME_SLOT_DURATION_US;
+        if (airtime_us + _tdma_vars.max_packet_us[slot] > tdma_table->table[slot].tx_duration && slots <= current) {
+            slots = current + 1;
+        }
+
+        _tdma_vars.plan[count].client      = client;
+        _tdma_vars.plan[count].tx_start    = tdma_table->table[slot].tx_start;
+        _tdma_vars.plan[count].tx_duration = tdma_table->table[slot].tx_duration;
+        _tdma_vars.plan[count].slots       = (slots < TDMA_SERVER_MAX_SLOTS_PER_CLIENT) ? slots : TDMA_SERVER_MAX_SLOTS_PER_CLIENT;
+        count++;
+    }
+
+    // Lay the clients out from the start of the table
+    uint16_t next  = 1;
+    uint16_t moved = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        tdma_server_plan_entry_t *entry = &_tdma_vars.plan[i];
+
+        // Give up extra slots when the table would not have room left for one slot per remaining client
+        uint16_t remaining = count - i - 1;
+        uint16_t reserved  = remaining + remaining / (TDMA_SERVER_GATEWAY_SLOT_PERIOD - 1) + 1;
+        while (entry->slots > 1 && _server_plan_window(next, entry->slots) + entry->slots + reserved > TDMA_SERVER_MAX_TABLE_SLOTS) {
+            entry->slots--;
+        }
+
+        // The slots skipped to not span a gateway slot go to the gateway
+        entry->start = _server_plan_window(next, entry->slots);
+        entry->moved = (entry->start * TDMA_SERVER_DEFAULT_TX_DURATION_US != entry->tx_start || entry->slots * TDMA_SERVER_DEFAULT_TX_DURATION_US != entry->tx_duration);
+        next         = entry->start + entry->slots;
+
+        // The clients that move get their next table in the gateway slots
+        entry->table_due = entry->moved;
+        moved += entry->moved;
+    }
+    _tdma_vars.plan_count       = count;
+    _tdma_vars.plan_table_index = next - 1;
+    _tdma_vars.plan_tables_due  = moved;
+    _tdma_vars.table_switch     = 0;
+    _tdma_vars.replan           = false;
+
+    // Switching all the clients at the same frame keeps the slots of the two layouts apart
+    if (moved > 0) {
+        _tdma_vars.plan_pending = true;
+    } else {
+        _server_plan_apply(tdma_table);
+    }
+}
+
+static void _server_plan_apply(tdma_server_table_t *tdma_table) {
+
+    // Save the state of the clients, it changed since the reallocation
+    for (uint16_t i = 0; i < _tdma_vars.plan_count; i++) {
+        tdma_server_plan_entry_t *entry = &_tdma_vars.plan[i];
+        int16_t                   slot  = _server_find_client(tdma_table, entry->client);
+        if (slot == TDMA_SERVER_CLIENT_NOT_FOUND) {
+            // Evicted since the reallocation
+            entry->slots = 0;
+            continue;
+        }
+        entry->last_heard_ts = _tdma_vars.last_heard_ts[slot];
+        entry->low_power     = _tdma_vars.low_power[slot];
+        entry->aggregate     = _tdma_vars.aggregate[slot];
+        entry->link          = _tdma_vars.links[slot];
+    }
+
+    // Rebuild the table and the index from scratch, the slots of no client go to the gateway
+    memset(tdma_table->client_index, 0xFF, sizeof(tdma_table->client_index));
+    memset(_tdma_vars.low_power, 0, sizeof(_tdma_vars.low_power));
+    memset(_tdma_vars.aggregate, 0, sizeof(_tdma_vars.aggregate));
+    memset(_tdma_vars.links, 0, sizeof(_tdma_vars.links));
+    for (uint16_t slot = 0; slot <= _tdma_vars.plan_table_index; slot++) {
+        tdma_table->table[slot].client      = _tdma_vars.device_id;
+        tdma_table->table[slot].rx_start    = TDMA_SERVER_DEFAULT_RX_START_US;
+        tdma_table->table[slot].tx_start    = slot * TDMA_SERVER_DEFAULT_TX_DURATION_US;
+        tdma_table->table[slot].tx_duration = TDMA_SERVER_DEFAULT_TX_DURATION_US;
+    }
+    _client_index_insert(tdma_table, 0);
+
+    uint16_t clients = 0;
+    for (uint16_t i = 0; i < _tdma_vars.plan_count; i++) {
+        const tdma_server_plan_entry_t *entry = &_tdma_vars.plan[i];
+        if (entry->slots == 0) {
+            continue;
+        }
+        for (uint16_t slot = entry->start; slot < entry->start + entry->slots; slot++) {
+            tdma_table->table[slot].client      = entry->client;
+            tdma_table->table[slot].tx_start    = entry->start * TDMA_SERVER_DEFAULT_TX_DURATION_US;
+            tdma_table->table[slot].tx_duration = entry->slots * TDMA_SERVER_DEFAULT_TX_DURATION_US;
+        }
+        _client_index_insert(tdma_table, entry->start);
+        _tdma_vars.last_heard_ts[entry->start] = entry->last_heard_ts;
+        _tdma_vars.low_power[entry->start]     = entry->low_power;
+        _tdma_vars.aggregate[entry->start]     = entry->aggregate;
+        _tdma_vars.links[entry->start]         = entry->link;
+        clients++;
+    }
+    tdma_table->table_index = _tdma_vars.plan_table_index;
+    tdma_table->num_clients = clients;
+
+    // Resize the frame, without going under the minimum frame time
+    tdma_table->frame_duration_us = _server_frame_duration(tdma_table->table_index);
+    for (uint16_t slot = 0; slot <= tdma_table->table_index; slot++) {
+        tdma_table->table[slot].rx_duration = tdma_table->frame_duration_us;
+    }
+
+    // Start a new measurement period
+    memset(_tdma_vars.airtime_us, 0, sizeof(_tdma_vars.airtime_us));
+    memset(_tdma_vars.backlog_us, 0, sizeof(_tdma_vars.backlog_us));
+    memset(_tdma_vars.max_packet_us, 0, sizeof(_tdma_vars.max_packet_us));
+    _tdma_vars.frame_count  = 0;
+    _tdma_vars.plan_pending = false;
+}
+
+static bool _server_plan_next(void) {
+
+    _tdma_vars.frame_count++;
+
+    // Reallocate the slots periodically, or right away to compact the table after an eviction, once the tables of the last registrations are sent
+    if (!_tdma_vars.plan_pending) {
+        if ((_tdma_vars.replan || _tdma_vars.frame_count >= TDMA_SERVER_ADAPTIVE_PERIOD_FRAMES) && _tdma_vars.new_clients_rb.count == 0) {
+            _server_plan_slots(&_tdma_vars.tdma_table);
+        }
+        return false;
+    }
+
+    // Announce the switch once every client that moves got its next table
+    if (_tdma_vars.table_switch == 0) {
+        if (_tdma_vars.plan_tables_due > 0) {
+            return false;
+        }
+        _tdma_vars.table_switch = TDMA_SERVER_ADAPTIVE_SWITCH_FRAMES;
+        return true;
+    }
+
+    // Every frame until the switch repeats the announce, the switch frame announces the new frame duration
+    _tdma_vars.table_switch--;
+    if (_tdma_vars.table_switch == 0) {
+        _server_plan_apply(&_tdma_vars.tdma_table);
+    }
+    return true;
+}
+
+static const tdma_server_plan_entry_t *_server_plan_find(uint64_t client) {
+
+    if (!_tdma_vars.plan_pending) {
+        return NULL;
+    }
+    for (uint16_t i = 0; i < _tdma_vars.plan_count; i++) {
+        if (_tdma_vars.plan[i].client == client) {
+            return _tdma_vars.plan[i].moved ? &_tdma_vars.plan[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+static bool _server_plan_tx_queue(uint16_t max_tx_duration_us, bool force_first) {
+
+    bool packet_sent = false;
+    for (uint16_t i = 0; i < _tdma_vars.plan_count && _tdma_vars.plan_tables_due > 0; i++) {
+        tdma_server_plan_entry_t *entry = &_tdma_vars.plan[i];
+        // A low-power client doesn't listen during this slot, it gets its table in one of its slots
+        if (!entry->table_due || !_server_dst_listening(entry->client)) {
+            continue;
+        }
+        uint16_t tx_time = RADIO_TX_RAMP_UP_TIME + _tdma_vars.overhead_onair_time + (sizeof(protocol_header_t) + sizeof(protocol_tdma_table_t)) * _tdma_vars.byte_onair_time;
+        if (!(force_first && !packet_sent) && _server_tx_start_ts() + tx_time - _tdma_vars.slot_start_ts >= max_tx_duration_us) {
+            break;
+        }
+        _tx_registration_messages(entry->client);
+        entry->table_due = false;
+        _tdma_vars.plan_tables_due--;
+        packet_sent = true;
+    }
+    return packet_sent;
+}
+#endif
+
+static uint16_t _client_index_hash(uint64_t client) {
+    // Fold the 64-bit id and keep the top bits of a multiplicative hash
+    uint32_t folded = (uint32_t)client ^ (uint32_t)(client >> 32);
+    return (uint16_t)((folded * 0x9E3779B1) >> (32 - TDMA_SERVER_CLIENT_INDEX_BITS));
+}
+
+static void _client_index_insert(tdma_server_table_t *tdma_table, uint16_t slot) {
+
+    uint16_t bucket = _client_index_hash(tdma_table->table[slot].client);
+    while (tdma_table->client_index[bucket] != TDMA_SERVER_CLIENT_INDEX_EMPTY) {
+        bucket = (bucket + 1) & TDMA_SERVER_CLIENT_INDEX_MASK;
+    }
+    tdma_table->client_index[bucket] = slot;
+}
+
+static void _client_index_remove(tdma_server_table_t *tdma_table, uint64_t client) {
+
+    // Find the bucket of the client
+    uint16_t hole = _client_index_hash(client);
+    while (tdma_table->client_index[hole] != TDMA_SERVER_CLIENT_INDEX_EMPTY && tdma_table->table[tdma_table->client_index[hole]].client != client) {
+        hole = (hole + 1) & TDMA_SERVER_CLIENT_INDEX_MASK;
+    }
+    if (tdma_table->client_index[hole] == TDMA_SERVER_CLIENT_INDEX_EMPTY) {
+        return;
+    }
+
+    // Shift back the following entries of the probe sequence so that no tombstone is needed
+    uint16_t bucket = hole;
+    while (true) {
+        bucket        = (bucket + 1) & TDMA_SERVER_CLIENT_INDEX_MASK;
+        uint16_t slot = tdma_table->client_index[bucket];
+        if (slot == TDMA_SERVER_CLIENT_INDEX_EMPTY) {
+            break;
+        }
+        // An entry can fill the hole only if its home bucket is not between the hole and its current bucket
+        uint16_t home = _client_index_hash(tdma_table->table[slot].client);
+        if (((bucket - home) & TDMA_SERVER_CLIENT_INDEX_MASK) >= ((bucket - hole) & TDMA_SERVER_CLIENT_INDEX_MASK)) {
+            tdma_table->client_index[hole] = slot;
+            hole                           = bucket;
+        }
+    }
+    tdma_table->client_index[hole] = TDMA_SERVER_CLIENT_INDEX_EMPTY;
 }
 
 //=========================== interrupt handlers ===============================
@@ -548,8 +1807,41 @@ static void _server_register_new_client(tdma_server_table_t *tdma_table, uint64_
  *
  * @param[in]   packet    pointer to the data array with the data packet
  * @param[in]   length    length of the packet received trough the radio
+ * @param[in]   metadata  reception metadata of the packet, packets with an invalid CRC are ignored
  */
-static void tdma_server_callback(uint8_t *packet, uint8_t length) {
+static void tdma_server_callback(uint8_t *packet, uint8_t length, const db_radio_rx_metadata_t *metadata) {
+
+    // Record the outcome of the join slots, the packets with an invalid CRC are collisions
+    int16_t join_slot = -1;
+    if (_tdma_vars.contention_active) {
+        uint32_t slot_offset = (metadata->timestamp - _tdma_vars.join_start_ts) / _tdma_vars.join_slot_duration_us;
+        if (slot_offset < _tdma_vars.join_slots) {
+            join_slot = slot_offset;
+            if (join_slot != _tdma_vars.join_last_slot) {
+                _tdma_vars.join_last_slot     = join_slot;
+                _tdma_vars.join_last_collided = false;
+                _tdma_vars.join_busy++;
+            }
+            if (!metadata->crc_ok && !_tdma_vars.join_last_collided) {
+                _tdma_vars.join_last_collided = true;
+                _tdma_vars.join_collided++;
+            }
+        }
+    }
+
+#if TDMA_SERVER_CHANNEL_HOPPING
+    // Rate the channel of the frame, the join requests collide whatever the channel
+    if (!_tdma_vars.contention_active) {
+        _tdma_vars.channels[_tdma_vars.channel].rx_packets++;
+        if (!metadata->crc_ok) {
+            _tdma_vars.channels[_tdma_vars.channel].crc_errors++;
+        }
+    }
+#endif
+
+    if (!metadata->crc_ok) {
+        return;
+    }
 
     /*
     - Check message sender is in the TDMA table
@@ -580,18 +1872,38 @@ static void tdma_server_callback(uint8_t *packet, uint8_t length) {
     }
 
     // Handle unregistered DotBot
-    if (_server_find_client(&_tdma_vars.tdma_table, header->src) == TDMA_SERVER_CLIENT_NOT_FOUND) {
-
-        // register new client to the table
-        _server_register_new_client(&_tdma_vars.tdma_table, header->src);
-        // Put it in the list of clients to transmit to in your next turn.
-        _client_rb_add(&_tdma_vars.new_clients_rb, header->src);
+    int16_t slot = _server_find_client(&_tdma_vars.tdma_table, header->src);
+    if (slot == TDMA_SERVER_CLIENT_NOT_FOUND) {
+
+        // register new client to the table, and put it in the list of clients to transmit to in your next turn.
+        // Without room left in the list the request is ignored, the client tries again after a backoff.
+        if (_tdma_vars.new_clients_rb.count < TDMA_NEW_CLIENT_BUFFER_SIZE && _server_register_new_client(&_tdma_vars.tdma_table, header->src)) {
+            _client_rb_add(&_tdma_vars.new_clients_rb, header->src);
+            slot = _tdma_vars.tdma_table.table_index;
+            _server_join_ack(join_slot);
+        }
 
     } else {
 
-        // Handle Out-of-Slot messages
-        uint64_t current_client = _tdma_vars.tdma_table.table[_tdma_vars.active_slot_idx].client;
-        if (current_client != header->src) {
+        // Keep the client slot alive
+        _tdma_vars.last_heard_ts[slot] = db_timer_hf_now(TDMA_SERVER_TIMER_HF);
+
+#if defined(TDMA_SERVER_ADAPTIVE_SLOTS)
+        // Account for the airtime used by the client, and for the demand it reports
+        uint16_t airtime_us = RADIO_TX_RAMP_UP_TIME + _tdma_vars.overhead_onair_time + length * _tdma_vars.byte_onair_time;
+        _tdma_vars.airtime_us[slot] += airtime_us;
+        if (airtime_us > _tdma_vars.max_packet_us[slot]) {
+            _tdma_vars.max_packet_us[slot] = airtime_us;
+        }
+        if (header->packet_type == DB_PACKET_TDMA_DEMAND) {
+            protocol_tdma_demand_t demand;
+            memcpy(&demand, packet + sizeof(protocol_header_t), sizeof(protocol_tdma_demand_t));
+            _tdma_vars.backlog_us[slot] += demand.queued_packets * (RADIO_TX_RAMP_UP_TIME + _tdma_vars.overhead_onair_time) + demand.queued_bytes * _tdma_vars.byte_onair_time;
+        }
+#endif
+
+        // Handle Out-of-Slot messages, the contention slots and the empty slots of a short frame are not in the table
+        if (_tdma_vars.contention_active || _tdma_vars.active_slot_idx > _tdma_vars.tdma_table.table_index || _tdma_vars.tdma_table.table[_tdma_vars.active_slot_idx].client != header->src) {
 
             // Check that you don't already have a a reminder queued up for this client
             if (!_client_rb_id_exists(&_tdma_vars.new_clients_rb, header->src)) {
@@ -599,14 +1911,50 @@ static void tdma_server_callback(uint8_t *packet, uint8_t length) {
                 // Put it in the list of clients to transmit to in your next turn.
                 _client_rb_add(&_tdma_vars.new_clients_rb, header->src);
             }
+            // A client that missed its table update asks again in a join slot
+            _server_join_ack(join_slot);
+        }
+    }
+
+    // The keep alive packets tell if the client listens all the time or in low-power mode,
+    // a client sending a join request listens all the time until it gets its table,
+    // and if the client receives the aggregated data packets
+    if (header->packet_type == DB_PACKET_TDMA_KEEP_ALIVE && slot != TDMA_SERVER_CLIENT_NOT_FOUND) {
+        protocol_tdma_keep_alive_t keep_alive = { 0 };
+        if (length >= sizeof(protocol_header_t) + sizeof(protocol_tdma_keep_alive_t)) {
+            memcpy(&keep_alive, packet + sizeof(protocol_header_t), sizeof(protocol_tdma_keep_alive_t));
+        }
+        _server_set_low_power(slot, !_tdma_vars.contention_active && (keep_alive.flags & DB_PROTOCOL_TDMA_FLAG_LOW_POWER));
+        _server_set_aggregate(slot, keep_alive.flags & DB_PROTOCOL_TDMA_FLAG_AGGREGATE);
+    }
+
+#if TDMA_SERVER_ACKED_PRIORITIES
+    // Check the packets sent to the client against its block acknowledgement
+    if (header->packet_type == DB_PACKET_TDMA_ACK) {
+        for (size_t offset = sizeof(protocol_header_t); offset + sizeof(protocol_tdma_ack_t) <= length; offset += sizeof(protocol_tdma_ack_t)) {
+            protocol_tdma_ack_t record;
+            memcpy(&record, packet + offset, sizeof(protocol_tdma_ack_t));
+            if (record.src == _tdma_vars.device_id) {
+                db_block_ack_t ack = { .seq = record.seq, .bitmap = record.bitmap };
+                _server_unacked_check(header->src, &ack);
+            }
         }
     }
+#endif
 
     // Consume TDMA-only messages, don't let it go up to the application.
-    if (header->packet_type == DB_PACKET_TDMA_KEEP_ALIVE) {
+    if (header->packet_type == DB_PACKET_TDMA_KEEP_ALIVE || header->packet_type == DB_PACKET_TDMA_DEMAND || header->packet_type == DB_PACKET_TDMA_ACK) {
         return;
     }
 
+    // Acknowledge the acknowledged data packets, drop those already received and pass the others up as data packets
+    if (header->packet_type == DB_PACKET_TDMA_DATA) {
+        length = _server_rx_data(slot, packet, length);
+        if (length == 0) {
+            return;
+        }
+    }
+
     // Pipe the message to the user
     if (_tdma_vars.callback) {
         _tdma_vars.callback(packet, length);
@@ -622,40 +1970,98 @@ static void timer_tdma_interrupt(void) {
     // Save the timestamp start of the current slot, to ensure accurate computation of the end of the slot
     _tdma_vars.slot_start_ts = db_timer_hf_now(TDMA_SERVER_TIMER_HF);
 
-    // If there are not enough clients, make sure that the minimum frame time is respected, even if is just filled with empty slots.
-    uint8_t last_slot;
-    if (_tdma_vars.tdma_table.frame_duration_us > TDMA_SERVER_DEFAULT_FRAME_DURATION_US) {
-        // enough clients, wrap around the end of the list
-        last_slot = _tdma_vars.tdma_table.table_index + 1;
-    } else {
-        // not enough clients, use the default amount of slots for the default frame duration
-        last_slot = (TDMA_SERVER_DEFAULT_FRAME_DURATION_US / TDMA_SERVER_TIME_SLOT_DURATION_US);
-    }
+    // The frame holds the slots of the table, then the contention slots. If there are not enough clients,
+    // the minimum frame time is respected with empty slots before the contention slots.
+    // The clients registered in the contention slots extend the next frame, the others expect this one to end on time.
+    uint16_t last_slot = _tdma_vars.current_frame_us / TDMA_SERVER_TIME_SLOT_DURATION_US;
+
     // Update the active client for this slot. Wrap around after the end of the active clients is reached.
     _tdma_vars.active_slot_idx = (_tdma_vars.active_slot_idx + 1) % (last_slot);
 
+    // Listen for join requests during the contention slots
+    if (!_tdma_vars.contention_active && _tdma_vars.contention_slots > 0 && _tdma_vars.active_slot_idx >= last_slot - _tdma_vars.contention_slots) {
+        _tdma_vars.contention_active = true;
+        _tdma_vars.join_last_slot    = -1;
+        _tdma_vars.join_start_ts     = _tdma_vars.slot_start_ts + _tdma_vars.contention_slots * TDMA_SERVER_TIME_SLOT_DURATION_US - _tdma_vars.join_slots * _tdma_vars.join_slot_duration_us;
+    }
+
     // check if this is the start of the super frame to send a sync message.
     if (_tdma_vars.active_slot_idx == 0) {
 
         // Update last-superframe timestamp
         _tdma_vars.frame_start_ts = _tdma_vars.slot_start_ts;
 
-        // Send a resync frame
-        _tx_sync_frame();
+        // The data packets left from the last train wait behind the sync frame, for the budget of this slot
+        _tdma_vars.tx_train_max_us = 0;
+
+        // Size the contention slots of this frame to the join requests of the last one
+        bool join_requests = false;
+        if (_tdma_vars.contention_active) {
+            _tdma_vars.contention_active = false;
+            join_requests                = (_tdma_vars.join_busy != 0);
+            _server_size_contention();
+        }
+
+#if defined(TDMA_SERVER_ADAPTIVE_SLOTS)
+        // Reallocate the slots when due, the clients switch to the new layout at a frame announced by the sync frames
+        bool plan_sync = _server_plan_next();
+#endif
+        _tdma_vars.current_frame_us = _tdma_vars.tdma_table.frame_duration_us;
+
+        // Send a resync frame every few frames, or right away to announce a new frame duration, new contention slots or the join requests accepted
+        _tdma_vars.frames_since_sync++;
+        bool sync = _tdma_vars.frames_since_sync >= _tdma_vars.sync_period || _tdma_vars.sync_frame_duration_us != _tdma_vars.tdma_table.frame_duration_us || _tdma_vars.sync_contention_slots != _tdma_vars.contention_slots || join_requests;
+#if TDMA_SERVER_CHANNEL_HOPPING
+        // Change channel, and announce the channels blacklisted or tried again
+        sync |= _server_hop_next();
+#endif
+#if defined(TDMA_SERVER_ADAPTIVE_SLOTS)
+        sync |= plan_sync;
+#endif
+        if (sync) {
+            _tx_sync_frame();
+        }
     }
 
+#if TDMA_SERVER_CLIENT_TIMEOUT_US > 0
+    // Free the slot of the current client if it has been silent for too long, each client is checked once per frame
+    uint16_t slot = _tdma_vars.active_slot_idx;
+    if (!_tdma_vars.contention_active && slot <= _tdma_vars.tdma_table.table_index && _tdma_vars.tdma_table.table[slot].client != _tdma_vars.device_id) {
+        // A client can have several slots, its information is stored with the first one
+        slot = _server_find_client(&_tdma_vars.tdma_table, _tdma_vars.tdma_table.table[slot].client);
+        if ((int32_t)(db_timer_hf_now(TDMA_SERVER_TIMER_HF) - _tdma_vars.last_heard_ts[slot]) > TDMA_SERVER_CLIENT_TIMEOUT_US) {
+            _server_evict_client(&_tdma_vars.tdma_table, slot);
+        }
+    }
+#endif
+
     bool packet_sent = false;
 
-    // Check that it's your timeslot
-    if (_tdma_vars.tdma_table.table[_tdma_vars.active_slot_idx].client == _tdma_vars.device_id) {
+    // Check that it's your timeslot, the slots added to the table during the contention slots start with the next frame
+    if (!_tdma_vars.contention_active && _tdma_vars.active_slot_idx <= _tdma_vars.tdma_table.table_index && _tdma_vars.tdma_table.table[_tdma_vars.active_slot_idx].client == _tdma_vars.device_id) {
 
-        // Send registration messages. + Out of slot messages. (Use AT MOST, half of the available slot time.)
-        uint32_t remaining_slot_time_us = _tdma_vars.slot_start_ts + _tdma_vars.tdma_table.table[_tdma_vars.active_slot_idx].tx_duration - db_timer_hf_now(TDMA_SERVER_TIMER_HF);
-        packet_sent                     = _client_rb_tx_queue(&_tdma_vars.new_clients_rb, remaining_slot_time_us / 2 - TDMA_TX_DEADTIME_US);
+        // The data packets wait behind the control packets of the slot
+        _tdma_vars.tx_train_max_us = 0;
+
+        // Send registration messages. + Out of slot messages. (Use AT MOST, half of the slot time, counted from the start of the slot as the sync frame may already be sent.)
+        packet_sent = _client_rb_tx_queue(&_tdma_vars.new_clients_rb, _tdma_vars.tdma_table.table[_tdma_vars.active_slot_idx].tx_duration / 2 - TDMA_TX_DEADTIME_US);
+#if defined(TDMA_SERVER_ADAPTIVE_SLOTS)
+        // Then the next tables of the clients that move in the next layout, in the same budget
+        packet_sent |= _server_plan_tx_queue(_tdma_vars.tdma_table.table[_tdma_vars.active_slot_idx].tx_duration / 2 - TDMA_TX_DEADTIME_US, !packet_sent);
+#endif
+
+        // Acknowledge the data packets received since the last gateway slot, if the packets above left time for it,
+        // and queue again the packets left unacknowledged
+        int32_t remaining_slot_time_us = (int32_t)(_tdma_vars.slot_start_ts + _tdma_vars.tdma_table.table[_tdma_vars.active_slot_idx].tx_duration - _server_tx_start_ts()) - TDMA_TX_DEADTIME_US;
+        if (remaining_slot_time_us > 0) {
+            packet_sent |= _tx_ack_message((remaining_slot_time_us > UINT16_MAX) ? UINT16_MAX : remaining_slot_time_us);
+        }
+#if TDMA_SERVER_ACKED_PRIORITIES
+        _server_unacked_check(0, NULL);
+#endif
 
-        // send messages if available. time_available (slot_start + slot_duration - current_time)
-        remaining_slot_time_us = _tdma_vars.slot_start_ts + _tdma_vars.tdma_table.table[_tdma_vars.active_slot_idx].tx_duration - db_timer_hf_now(TDMA_SERVER_TIMER_HF);
-        packet_sent            = _message_rb_tx_queue(&_tdma_vars.tx_ring_buffer, remaining_slot_time_us - TDMA_TX_DEADTIME_US);
+        // send messages if available, the packet train counts its time from the start of the slot, after the packets already sent
+        packet_sent |= _message_rb_tx_queue(_tdma_vars.tdma_table.table[_tdma_vars.active_slot_idx].tx_duration - TDMA_TX_DEADTIME_US);
 
         // mark last time you sent anything
         if (packet_sent) {
@@ -73,7 +73,7 @@ void db_tdma_server_get_table_info(uint32_t *frame_duration_us, uint16_t *num_cl
     *table_index       = ipc_shared_data.tdma_server.table_index;
 }
 
-void db_tdma_server_get_client_info(tdma_table_entry_t *client, uint8_t client_id) {
+void db_tdma_server_get_client_info(tdma_table_entry_t *client, uint16_t client_id) {
 
     // Request a specific client
     ipc_shared_data.tdma_server.client_id = client_id;
@@ -103,6 +103,21 @@ void db_tdma_server_empty(void) {
     db_ipc_network_call(DB_IPC_TDMA_SERVER_EMPTY_REQ);
 }
 
+void db_tdma_server_get_queue_stats(db_packet_queue_stats_t stats[DB_PROTOCOL_PRIORITY_COUNT]) {
+
+    // Request the network core to copy the statistics
+    db_ipc_network_call(DB_IPC_TDMA_SERVER_QUEUE_REQ);
+
+    // Copy the variables over (one by one because memcpy doesnt like that ipc_shared_data is volatile)
+    for (uint8_t priority = 0; priority < DB_PROTOCOL_PRIORITY_COUNT; priority++) {
+        stats[priority].count           = ipc_shared_data.tdma_server.queue_stats[priority].count;
+        stats[priority].used            = ipc_shared_data.tdma_server.queue_stats[priority].used;
+        stats[priority].size            = ipc_shared_data.tdma_server.queue_stats[priority].size;
+        stats[priority].high_water_mark = ipc_shared_data.tdma_server.queue_stats[priority].high_water_mark;
+        stats[priority].dropped         = ipc_shared_data.tdma_server.queue_stats[priority].dropped;
+    }
+}
+
 //=========================== interrupt handlers ===============================
 
 void IPC_IRQHandler(void) {
@@ -0,0 +1,181 @@
+/**
+ * @file
+ * @ingroup samples_bsp
+ * @brief Record raw lighthouse 2 captures, or replay recorded ones through the LH2 decoding pipeline.
+ *
+ * By default, every raw SPI capture is streamed out over UART, in HDLC frames, as soon as it is received.
+ * As soon as a capture is received from the UART, the acquisition stops and the application switches to replay mode:
+ * each received capture is decoded by db_lh2_process_location() and the result is sent back with the decoding time.
+ *
+ * See dist/scripts/lh2_capture for the host side tool recording and replaying capture files.
+ *
+ * @copyright Inria, 2024
+ *
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <nrf.h>
+#include "board.h"
+#include "board_config.h"
+#include "hdlc.h"
+#include "lh2.h"
+#include "timer_hf.h"
+#include "uart.h"
+
+//=========================== defines ==========================================
+
+#define LH2_CAPTURE_BUFFER_MAX_BYTES (255U)                                       ///< Max bytes in an HDLC payload
+#define LH2_CAPTURE_UART_BAUDRATE    (1000000UL)                                  ///< UART baudrate, same as the gateway
+#define LH2_CAPTURE_UART_QUEUE_SIZE  ((LH2_CAPTURE_BUFFER_MAX_BYTES + 1) * 2)  ///< Size of the UART queue size (must by a power of 2)
+#define TIMER_HF_DEV                 (1)                                          ///< High frequency timer used to measure the decoding time
+#if defined(NRF5340_XXAA) && defined(NRF_APPLICATION)
+#define LH2_CAPTURE_UART_INDEX (1)  ///< Index of UART peripheral to use
+#else
+#define LH2_CAPTURE_UART_INDEX (0)  ///< Index of UART peripheral to use
+#endif
+
+/// Type of the messages exchanged with the host, first byte of each HDLC payload
+typedef enum {
+    LH2_CAPTURE_MSG_CAPTURE = 1,  ///< Raw capture (db_lh2_capture_t), streamed to the host when recording, sent by the host when replaying
+    LH2_CAPTURE_MSG_RESULT  = 2,  ///< Decoding result of a replayed capture (lh2_capture_result_t), sent to the host
+} lh2_capture_msg_t;
+
+/// Decoding result of a replayed capture
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp;            ///< timestamp of the replayed capture, as recorded
+    uint8_t  selected_polynomial;  ///< polynomial found, 0xFF if decoding failed
+    uint32_t lfsr_location;        ///< position in the LFSR sequence of the polynomial found
+    uint32_t duration_us;          ///< time spent decoding the capture, in microseconds
+} lh2_capture_result_t;
+
+typedef struct {
+    uint16_t current;                             ///< Current position in the queue
+    uint16_t last;                                ///< Position of the last item added in the queue
+    uint8_t  buffer[LH2_CAPTURE_UART_QUEUE_SIZE];  ///< Buffer containing the received bytes
+} lh2_capture_uart_queue_t;
+
+typedef struct {
+    db_lh2_t                 lh2;                                                ///< LH2 device descriptor
+    uint8_t                  hdlc_rx_buffer[LH2_CAPTURE_BUFFER_MAX_BYTES * 2];  ///< Buffer where message received on UART is stored
+    uint8_t                  hdlc_tx_buffer[LH2_CAPTURE_BUFFER_MAX_BYTES * 2];  ///< Internal buffer used for sending serial HDLC frames
+    uint8_t                  tx_buffer[LH2_CAPTURE_BUFFER_MAX_BYTES];           ///< Payload of the next message sent to the host
+    lh2_capture_uart_queue_t uart_queue;                                         ///< Queue used to process received UART bytes outside of interrupt
+    bool                     replaying;                                          ///< Whether the captures come from the host instead of the sensor
+    uint32_t                 timestamp_offset;                                   ///< Offset between the recorded timestamps and the local time
+} lh2_capture_vars_t;
+
+//=========================== variables ========================================
+
+static lh2_capture_vars_t _lh2_capture_vars;
+
+//=========================== callbacks ========================================
+
+static void _uart_callback(uint8_t data) {
+    _lh2_capture_vars.uart_queue.buffer[_lh2_capture_vars.uart_queue.last] = data;
+    _lh2_capture_vars.uart_queue.last                                      = (_lh2_capture_vars.uart_queue.last + 1) & (LH2_CAPTURE_UART_QUEUE_SIZE - 1);
+}
+
+//=========================== private ==========================================
+
+static void _send(size_t length) {
+    size_t frame_len = db_hdlc_encode(_lh2_capture_vars.tx_buffer, length, _lh2_capture_vars.hdlc_tx_buffer);
+    db_uart_write(LH2_CAPTURE_UART_INDEX, _lh2_capture_vars.hdlc_tx_buffer, frame_len);
+}
+
+static void _replay(db_lh2_capture_t *capture) {
+    // Stop the sensor and drop what it captured, from now on the captures come from the host.
+    // This is done for every capture: a capture ending right after db_lh2_stop() re-arms the acquisition.
+    db_lh2_stop();
+    db_lh2_capture_t discarded;
+    while (db_lh2_get_capture(&discarded)) {}
+
+    if (!_lh2_capture_vars.replaying) {
+        db_lh2_reset(&_lh2_capture_vars.lh2);
+        _lh2_capture_vars.replaying        = true;
+        _lh2_capture_vars.timestamp_offset = db_timer_hf_now(TIMER_HF_DEV) - capture->timestamp;
+    }
+
+    // Move the recorded timestamp to the local time base, so the data doesn't look outdated
+    uint32_t recorded_timestamp = capture->timestamp;
+    capture->timestamp += _lh2_capture_vars.timestamp_offset;
+
+    lh2_capture_result_t result = {
+        .timestamp           = recorded_timestamp,
+        .selected_polynomial = 0xFF,
+        .lfsr_location       = 0xFFFFFFFF,
+        .duration_us         = 0,
+    };
+
+    if (db_lh2_inject_capture(capture)) {
+        uint32_t start = db_timer_hf_now(TIMER_HF_DEV);
+        db_lh2_process_location(&_lh2_capture_vars.lh2);
+        result.duration_us = db_timer_hf_now(TIMER_HF_DEV) - start;
+
+        // Find where the pipeline stored this capture, if it could be decoded
+        for (uint8_t sweep = 0; sweep < LH2_SWEEP_COUNT; sweep++) {
+            for (uint8_t basestation = 0; basestation < LH2_BASESTATION_COUNT; basestation++) {
+                if (_lh2_capture_vars.lh2.data_ready[sweep][basestation] == DB_LH2_PROCESSED_DATA_AVAILABLE && _lh2_capture_vars.lh2.timestamps[sweep][basestation] == capture->timestamp) {
+                    result.selected_polynomial                                = _lh2_capture_vars.lh2.locations[sweep][basestation].selected_polynomial;
+                    result.lfsr_location                                      = _lh2_capture_vars.lh2.locations[sweep][basestation].lfsr_location;
+                    _lh2_capture_vars.lh2.data_ready[sweep][basestation] = DB_LH2_NO_NEW_DATA;
+                }
+            }
+        }
+    }
+
+    _lh2_capture_vars.tx_buffer[0] = LH2_CAPTURE_MSG_RESULT;
+    memcpy(&_lh2_capture_vars.tx_buffer[1], &result, sizeof(lh2_capture_result_t));
+    _send(1 + sizeof(lh2_capture_result_t));
+}
+
+static void _handle_uart_bytes(void) {
+    while (_lh2_capture_vars.uart_queue.current != _lh2_capture_vars.uart_queue.last) {
+        db_hdlc_state_t hdlc_state = db_hdlc_rx_byte(_lh2_capture_vars.uart_queue.buffer[_lh2_capture_vars.uart_queue.current]);
+        if (hdlc_state == DB_HDLC_STATE_READY) {
+            size_t msg_len = db_hdlc_decode(_lh2_capture_vars.hdlc_rx_buffer);
+            if (msg_len == 1 + sizeof(db_lh2_capture_t) && _lh2_capture_vars.hdlc_rx_buffer[0] == LH2_CAPTURE_MSG_CAPTURE) {
+                db_lh2_capture_t capture;
+                memcpy(&capture, &_lh2_capture_vars.hdlc_rx_buffer[1], sizeof(db_lh2_capture_t));
+                _replay(&capture);
+            }
+        }
+        _lh2_capture_vars.uart_queue.current = (_lh2_capture_vars.uart_queue.current + 1) & (LH2_CAPTURE_UART_QUEUE_SIZE - 1);
+    }
+}
+
+//=========================== main =============================================
+
+/**
+ *  @brief The program starts executing here.
+ */
+int main(void) {
+    // Initialize the board core features (voltage regulator)
+    db_board_init();
+
+    db_timer_hf_init(TIMER_HF_DEV);
+    db_uart_init(LH2_CAPTURE_UART_INDEX, &db_uart_rx, &db_uart_tx, LH2_CAPTURE_UART_BAUDRATE, &_uart_callback);
+
+    // Initialize the LH2
+    db_lh2_init(&_lh2_capture_vars.lh2, &db_lh2_d, &db_lh2_e);
+    db_lh2_start();
+
+    while (1) {
+        // wait until something happens e.g. an SPI or UART interrupt
+        __WFE();
+
+        _handle_uart_bytes();
+
+        if (_lh2_capture_vars.replaying) {
+            continue;
+        }
+
+        // Stream the raw captures out, undecoded
+        db_lh2_capture_t capture;
+        while (db_lh2_get_capture(&capture)) {
+            _lh2_capture_vars.tx_buffer[0] = LH2_CAPTURE_MSG_CAPTURE;
+            memcpy(&_lh2_capture_vars.tx_buffer[1], &capture, sizeof(db_lh2_capture_t));
+            _send(1 + sizeof(db_lh2_capture_t));
+        }
+    }
+}
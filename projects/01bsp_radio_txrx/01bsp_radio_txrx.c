@@ -48,9 +48,13 @@ static const gpio_t _dbg_pin = { .port = DB_LED1_PORT, .pin = DB_LED1_PIN };
 
 //=========================== functions =========================================
 
-static void radio_callback(uint8_t *packet, uint8_t length) {
+static void radio_callback(uint8_t *packet, uint8_t length, const db_radio_rx_metadata_t *metadata) {
     db_gpio_toggle(&_dbg_pin);
-    printf("(%dB): %s, RSSI: %i\n", length, (char *)packet, db_radio_rssi());
+    if (!metadata->crc_ok) {
+        printf("(%dB): invalid CRC, RSSI: %i\n", length, metadata->rssi);
+        return;
+    }
+    printf("(%dB): %s, RSSI: %i\n", length, (char *)packet, metadata->rssi);
 }
 
 //=========================== main ==============================================
@@ -25,11 +25,12 @@
 
 //=========================== variables ========================================
 
-static uint8_t            packet_tx[300] = { 0 };
-static tdma_table_entry_t clients[12]    = { 0 };
-static uint32_t           frame_duration_us;
-static uint16_t           num_clients;
-static uint16_t           table_index;
+static uint8_t                 packet_tx[300] = { 0 };
+static tdma_table_entry_t      clients[12]    = { 0 };
+static uint32_t                frame_duration_us;
+static uint16_t                num_clients;
+static uint16_t                table_index;
+static db_packet_queue_stats_t queue_stats[DB_PROTOCOL_PRIORITY_COUNT];
 
 //========================== prototypes ========================================
 
@@ -53,6 +54,7 @@ int main(void) {
         for (size_t i = 0; i < 12; i++) {
             db_tdma_server_get_client_info(&clients[i], i);
         }
+        db_tdma_server_get_queue_stats(queue_stats);
         // Print current status
         printf("[*] Frame duration = {%d}\n", frame_duration_us);
         printf("[*] Num. of Clients = {%d}\n", num_clients);
@@ -67,6 +69,9 @@ int main(void) {
         printf("[*] Client 8 = {%x}\n", (uint16_t)(clients[8].client >> 48));
         printf("[*] Client 9 = {%x}\n", (uint16_t)(clients[9].client >> 48));
         printf("[*] Client 10 = {%x}\n", (uint16_t)(clients[10].client >> 48));
+        for (uint8_t i = 0; i < DB_PROTOCOL_PRIORITY_COUNT; i++) {
+            printf("[*] TX queue %d = {%d packets, %d/%d bytes, max %d, dropped %d}\n", i, queue_stats[i].count, queue_stats[i].used, queue_stats[i].size, queue_stats[i].high_water_mark, queue_stats[i].dropped);
+        }
 
         // Send an advertisement message
         db_protocol_advertizement_to_buffer(packet_tx, DB_BROADCAST_ADDRESS, DotBot);
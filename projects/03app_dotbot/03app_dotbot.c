@@ -21,6 +21,7 @@
 #include "board_config.h"
 #include "device.h"
 #include "lh2.h"
+#include "lh2_position.h"
 #include "protocol.h"
 #include "motors.h"
 #include "radio.h"
@@ -35,6 +36,7 @@
 #define RADIO_APP                 (DotBot)  ///< DotBot Radio App
 #define TIMER_DEV                 (0)
 #define DB_LH2_UPDATE_DELAY_MS    (100U)   ///< 100ms delay between each LH2 data refresh
+#define DB_LH2_PROCESS_BUDGET_US  (5000U)  ///< Max time spent processing LH2 captures after each wake up
 #define DB_ADVERTIZEMENT_DELAY_MS (500U)   ///< 500ms delay between each advertizement packet sending
 #define DB_TIMEOUT_CHECK_DELAY_MS (200U)   ///< 200ms delay between each timeout delay check
 #define TIMEOUT_CHECK_DELAY_TICKS (17000)  ///< ~500 ms delay between packet received timeout checks
@@ -55,19 +57,22 @@
 #endif
 
 typedef struct {
-    uint32_t                 ts_last_packet_received;            ///< Last timestamp in microseconds a control packet was received
-    db_lh2_t                 lh2;                                ///< LH2 device descriptor
-    uint8_t                  radio_buffer[DB_BUFFER_MAX_BYTES];  ///< Internal buffer that contains the command to send (from buttons)
-    protocol_lh2_location_t  last_location;                      ///< Last computed LH2 location received
-    int16_t                  direction;                          ///< Current direction of the DotBot (angle in °)
-    protocol_control_mode_t  control_mode;                       ///< Remote control mode
-    protocol_lh2_waypoints_t waypoints;                          ///< List of waypoints
-    uint32_t                 waypoints_threshold;                ///< Distance to target waypoint threshold
-    uint8_t                  next_waypoint_idx;                  ///< Index of next waypoint to reach
-    bool                     update_control_loop;                ///< Whether the control loop need an update
-    bool                     advertize;                          ///< Whether an advertize packet should be sent
-    bool                     update_lh2;                         ///< Whether LH2 data must be processed
-    uint64_t                 device_id;                          ///< Device ID of the DotBot
+    uint32_t                 ts_last_packet_received;                    ///< Last timestamp in microseconds a control packet was received
+    db_lh2_t                 lh2;                                        ///< LH2 device descriptor
+    uint8_t                  radio_buffer[DB_BUFFER_MAX_BYTES];          ///< Internal buffer that contains the command to send (from buttons)
+    protocol_lh2_location_t  last_location;                              ///< Last computed LH2 location received
+    int16_t                  direction;                                  ///< Current direction of the DotBot (angle in °)
+    protocol_control_mode_t  control_mode;                               ///< Remote control mode
+    protocol_lh2_waypoints_t waypoints;                                  ///< List of waypoints
+    uint32_t                 waypoints_threshold;                        ///< Distance to target waypoint threshold
+    uint8_t                  next_waypoint_idx;                          ///< Index of next waypoint to reach
+    bool                     update_control_loop;                        ///< Whether the control loop need an update
+    bool                     advertize;                                  ///< Whether an advertize packet should be sent
+    bool                     update_lh2;                                 ///< Whether LH2 data must be processed
+    bool                     send_lh2_stats;                             ///< Whether the LH2 profiling statistics must be sent
+    float                    homographies[LH2_BASESTATION_COUNT][3][3];  ///< Homographies received from the gateway, not applied yet
+    bool                     update_homography[LH2_BASESTATION_COUNT];   ///< Whether the homography of each basestation must be applied
+    uint64_t                 device_id;                                  ///< Device ID of the DotBot
     db_log_dotbot_data_t     log_data;
 } dotbot_vars_t;
 
@@ -92,6 +97,8 @@ static void _timeout_check(void);
 static void _advertise(void);
 static void _compute_angle(const protocol_lh2_location_t *next, const protocol_lh2_location_t *origin, int16_t *angle);
 static void _update_control_loop(void);
+static void _update_location(const protocol_lh2_location_t *location);
+static void _send_lh2_stats(void);
 static void _update_lh2(void);
 
 //=========================== callbacks ========================================
@@ -130,16 +137,20 @@ static void radio_callback(uint8_t *pkt, uint8_t len) {
         case DB_PROTOCOL_LH2_LOCATION:
         {
             const protocol_lh2_location_t *location = (const protocol_lh2_location_t *)cmd_ptr;
-            int16_t                        angle    = -1000;
-            _compute_angle(location, &_dotbot_vars.last_location, &angle);
-            if (angle != DB_DIRECTION_INVALID) {
-                _dotbot_vars.last_location.x = location->x;
-                _dotbot_vars.last_location.y = location->y;
-                _dotbot_vars.last_location.z = location->z;
-                _dotbot_vars.direction       = angle;
+            _update_location(location);
+        } break;
+        case DB_PROTOCOL_LH2_HOMOGRAPHY:
+        {
+            // The position computation uses the homographies from the main loop, they are applied there
+            const protocol_lh2_homography_t *homography = (const protocol_lh2_homography_t *)cmd_ptr;
+            if (homography->basestation < LH2_BASESTATION_COUNT) {
+                memcpy(_dotbot_vars.homographies[homography->basestation], homography->matrix, sizeof(_dotbot_vars.homographies[0]));
+                _dotbot_vars.update_homography[homography->basestation] = true;
             }
-            _dotbot_vars.update_control_loop = (_dotbot_vars.control_mode == ControlAuto);
         } break;
+        case DB_PROTOCOL_LH2_STATS:
+            _dotbot_vars.send_lh2_stats = true;
+            break;
         case DB_PROTOCOL_CONTROL_MODE:
             db_motors_set_speed(0, 0);
             break;
@@ -179,6 +190,8 @@ int main(void) {
     _dotbot_vars.update_control_loop = false;
     _dotbot_vars.advertize           = false;
     _dotbot_vars.update_lh2          = false;
+    _dotbot_vars.send_lh2_stats      = false;
+    memset(_dotbot_vars.update_homography, 0, sizeof(_dotbot_vars.update_homography));
 
     // Retrieve the device id once at startup
     _dotbot_vars.device_id = db_device_id();
@@ -193,8 +206,28 @@ int main(void) {
     while (1) {
         __WFE();
 
+        // Apply the homographies received since the last iteration, a homography received while it is
+        // applied sets its flag again and is applied at the next iteration
+        for (uint8_t basestation = 0; basestation < LH2_BASESTATION_COUNT; basestation++) {
+            if (_dotbot_vars.update_homography[basestation]) {
+                _dotbot_vars.update_homography[basestation] = false;
+                db_lh2_position_set_homography(basestation, _dotbot_vars.homographies[basestation]);
+            }
+        }
+
         // Process available lighthouse data
-        db_lh2_process_location(&_dotbot_vars.lh2);
+        db_lh2_drain(&_dotbot_vars.lh2, true, DB_LH2_PROCESS_BUDGET_US, NULL);
+
+        // Compute the location on board, at the sweep rate, once the gateway has sent the calibration
+        db_lh2_position_t position;
+        if (db_lh2_position_update(&_dotbot_vars.lh2, &position)) {
+            protocol_lh2_location_t location = {
+                .x = (position.x > 0) ? (uint32_t)(position.x * 1e6) : 0,
+                .y = (position.y > 0) ? (uint32_t)(position.y * 1e6) : 0,
+                .z = 0,
+            };
+            _update_location(&location);
+        }
 
         if (_dotbot_vars.update_lh2) {
             // Check if data is ready to send
@@ -230,6 +263,11 @@ int main(void) {
             _dotbot_vars.update_control_loop = false;
         }
 
+        if (_dotbot_vars.send_lh2_stats) {
+            _send_lh2_stats();
+            _dotbot_vars.send_lh2_stats = false;
+        }
+
         if (_dotbot_vars.advertize) {
             size_t length = db_protocol_advertizement_to_buffer(_dotbot_vars.radio_buffer, DB_BROADCAST_ADDRESS, DotBot);
             db_tdma_client_tx(_dotbot_vars.radio_buffer, length);
@@ -308,6 +346,18 @@ static void _update_control_loop(void) {
 #endif
 }
 
+static void _update_location(const protocol_lh2_location_t *location) {
+    int16_t angle = DB_DIRECTION_INVALID;
+    _compute_angle(location, &_dotbot_vars.last_location, &angle);
+    if (angle != DB_DIRECTION_INVALID) {
+        _dotbot_vars.last_location.x = location->x;
+        _dotbot_vars.last_location.y = location->y;
+        _dotbot_vars.last_location.z = location->z;
+        _dotbot_vars.direction       = angle;
+    }
+    _dotbot_vars.update_control_loop = (_dotbot_vars.control_mode == ControlAuto);
+}
+
 static void _compute_angle(const protocol_lh2_location_t *next, const protocol_lh2_location_t *origin, int16_t *angle) {
     float dx       = ((float)next->x - (float)origin->x) / 1e6;
     float dy       = ((float)next->y - (float)origin->y) / 1e6;
@@ -324,6 +374,24 @@ static void _compute_angle(const protocol_lh2_location_t *next, const protocol_l
     }
 }
 
+static void _send_lh2_stats(void) {
+    db_lh2_stats_t stats;
+    if (!db_lh2_get_stats(&stats)) {
+        // LH2 profiling is not enabled
+        return;
+    }
+
+    // One message per stage: stage index followed by its statistics
+    for (uint8_t stage = 0; stage < DB_LH2_STAGE_COUNT; stage++) {
+        size_t length                       = db_protocol_header_to_buffer(_dotbot_vars.radio_buffer, DB_BROADCAST_ADDRESS);
+        _dotbot_vars.radio_buffer[length++] = DB_PROTOCOL_LH2_STATS;
+        _dotbot_vars.radio_buffer[length++] = stage;
+        memcpy(_dotbot_vars.radio_buffer + length, &stats.stages[stage], sizeof(db_lh2_stage_stats_t));
+        length += sizeof(db_lh2_stage_stats_t);
+        db_tdma_client_tx(_dotbot_vars.radio_buffer, length);
+    }
+}
+
 static void _timeout_check(void) {
     uint32_t ticks = db_timer_ticks(TIMER_DEV);
     if (ticks > _dotbot_vars.ts_last_packet_received + TIMEOUT_CHECK_DELAY_TICKS) {
@@ -38,10 +38,18 @@ static nrf53_net_vars_t _nrf53_net_vars = { 0 };
 
 //=========================== functions ========================================
 
-void radio_callback(uint8_t *packet, uint8_t length) {
+void radio_callback(uint8_t *packet, uint8_t length, const db_radio_rx_metadata_t *metadata) {
+    // Queue the packet for the application core, the packets received before it reads them are kept.
+    // The packet is dropped if the ring is full
     mutex_lock();
-    ipc_shared_data.radio.rx_pdu.length = length;
-    memcpy((void *)ipc_shared_data.radio.rx_pdu.buffer, packet, length);
+    uint8_t write = ipc_shared_data.radio.rx_write;
+    uint8_t next  = (write + 1) % RADIO_RX_PDU_COUNT;
+    if (next != ipc_shared_data.radio.rx_read) {
+        ipc_shared_data.radio.rx[write].pdu.length = length;
+        memcpy((void *)ipc_shared_data.radio.rx[write].pdu.buffer, packet, length);
+        memcpy((void *)&ipc_shared_data.radio.rx[write].metadata, metadata, sizeof(db_radio_rx_metadata_t));
+        ipc_shared_data.radio.rx_write = next;
+    }
     mutex_unlock();
     _nrf53_net_vars._data_received = true;
 }
@@ -114,6 +122,9 @@ int main(void) {
                 case DB_IPC_RADIO_RSSI_REQ:
                     ipc_shared_data.radio.rssi = db_radio_rssi();
                     break;
+                case DB_IPC_RADIO_STATS_REQ:
+                    db_radio_get_stats(ipc_shared_data.radio.stats_mode, (db_radio_stats_t *)&ipc_shared_data.radio.stats);
+                    break;
 
                 // RNG functions
                 case DB_IPC_RNG_INIT_REQ:
@@ -145,6 +156,9 @@ int main(void) {
                 case DB_IPC_TDMA_CLIENT_STATUS_REQ:
                     ipc_shared_data.tdma_client.registration_state = db_tdma_client_get_status();
                     break;
+                case DB_IPC_TDMA_CLIENT_QUEUE_REQ:
+                    db_tdma_client_get_queue_stats((db_packet_queue_stats_t *)ipc_shared_data.tdma_client.queue_stats);
+                    break;
 
                 // TDMA Server functions
                 case DB_IPC_TDMA_SERVER_INIT_REQ:
@@ -175,6 +189,9 @@ int main(void) {
                 case DB_IPC_TDMA_SERVER_EMPTY_REQ:
                     db_tdma_server_empty();
                     break;
+                case DB_IPC_TDMA_SERVER_QUEUE_REQ:
+                    db_tdma_server_get_queue_stats((db_packet_queue_stats_t *)ipc_shared_data.tdma_server.queue_stats);
+                    break;
                 default:
                     break;
             }